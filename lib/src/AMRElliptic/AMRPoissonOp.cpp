@@ -23,6 +23,7 @@
 #include "AMRPoissonOpF_F.H"
 #include "CCProjectorF_F.H"
 #include "MACProjectorF_F.H"
+#include "BoxKernels.H"
 
 #include "NamespaceHeader.H"
 
@@ -286,18 +287,27 @@ void AMRPoissonOp::residualI(LevelData<FArrayBox>&       a_lhs,
     CH_TIME("residual_no_comm");
   for (dit.begin(); dit.ok(); ++dit)
     {
-      const Box& region = dbl[dit];
-      FORT_OPERATORLAPRES(CHF_FRA(a_lhs[dit]),
-                          CHF_CONST_FRA(phi[dit]),
-                          CHF_CONST_FRA(a_rhs[dit]),
-                          CHF_BOX(region),
-                          CHF_CONST_REAL(m_dx),
-                          CHF_CONST_REAL(m_alpha),
-                          CHF_CONST_REAL(m_beta));
+      residualBox(a_lhs[dit], phi[dit], a_rhs[dit], dit(), dbl[dit]);
     }
   }
 }
 
+// ---------------------------------------------------------
+void AMRPoissonOp::residualBox(FArrayBox&       a_lhs,
+                               const FArrayBox& a_phi,
+                               const FArrayBox& a_rhs,
+                               const DataIndex& a_datInd,
+                               const Box&       a_region)
+{
+  FORT_OPERATORLAPRES(CHF_FRA(a_lhs),
+                      CHF_CONST_FRA(a_phi),
+                      CHF_CONST_FRA(a_rhs),
+                      CHF_BOX(a_region),
+                      CHF_CONST_REAL(m_dx),
+                      CHF_CONST_REAL(m_alpha),
+                      CHF_CONST_REAL(m_beta));
+}
+
 // ---------------------------------------------------------
 /**************************/
 // this preconditioner first initializes phihat to (IA)phihat = rhshat
@@ -605,6 +615,15 @@ void AMRPoissonOp::relax(LevelData<FArrayBox>&       a_e,
 {
   CH_TIME("AMRPoissonOp::relax");
 
+  // Each iteration reads the correction and the residual and writes the
+  // correction at least once (the kernels count their flops)
+  long long int numPts = 0;
+  for (DataIterator dit = a_e.dataIterator(); dit.ok(); ++dit)
+    {
+      numPts += a_e.disjointBoxLayout()[dit].numPts();
+    }
+  CH_BYTES(3*sizeof(Real)*a_e.nComp()*numPts*a_iterations);
+
   for (int i = 0; i < a_iterations; i++)
     {
       switch (s_relaxMode)
@@ -734,6 +753,100 @@ void AMRPoissonOp::prolongIncrement(LevelData<FArrayBox>&       a_phiThisLevel,
   }//end pragma
 }
 
+// ---------------------------------------------------------
+void AMRPoissonOp::prolongAndRelax(LevelData<FArrayBox>&       a_phiThisLevel,
+                                   const LevelData<FArrayBox>& a_correctCoarse,
+                                   const LevelData<FArrayBox>& a_rhsThisLevel,
+                                   int                         a_iterations)
+{
+  CH_TIME("AMRPoissonOp::prolongAndRelax");
+
+  if (s_relaxMode != 1 || a_iterations < 1)
+    {
+      prolongIncrement(a_phiThisLevel, a_correctCoarse);
+      relax(a_phiThisLevel, a_rhsThisLevel, a_iterations);
+      return;
+    }
+
+  CH_assert(a_phiThisLevel.ghostVect() >= IntVect::Unit);
+  CH_assert(a_correctCoarse.ghostVect() >= IntVect::Unit);
+  CH_assert(a_phiThisLevel.nComp() == a_rhsThisLevel.nComp());
+
+  // The ghost cells of a box that its neighbors cover get what the
+  // neighbors' prolongation gives them: the exchanged correction plus
+  // the exchanged coarse correction.  The coarse level is 2^D times
+  // smaller, so this costs less than exchanging after the prolongation.
+  LevelData<FArrayBox>& coarse = (LevelData<FArrayBox>&)a_correctCoarse;
+  const DisjointBoxLayout& dblCoar = a_correctCoarse.disjointBoxLayout();
+  if (!m_coarseExchangeCopier.isDefined() || !(m_coarseExchangeGrids == dblCoar))
+    {
+      m_coarseExchangeGrids = dblCoar;
+      m_coarseExchangeCopier.exchangeDefine(dblCoar, IntVect::Unit);
+    }
+  {
+    CH_TIME("AMRPoissonOp::prolongAndRelax::exchange");
+    coarse.exchange(coarse.interval(), m_coarseExchangeCopier);
+    if (s_exchangeMode == 0)
+      a_phiThisLevel.exchange(a_phiThisLevel.interval(), m_exchangeCopier);
+    else if (s_exchangeMode == 1)
+      a_phiThisLevel.exchangeNoOverlap(m_exchangeCopier);
+    else
+      MayDay::Abort("exchangeMode");
+  }
+
+  const DisjointBoxLayout& dbl = a_phiThisLevel.disjointBoxLayout();
+  DataIterator dit = a_phiThisLevel.dataIterator();
+  int nbox = dit.size();
+  {
+    CH_TIME("AMRPoissonOp::prolongAndRelax::red");
+#pragma omp parallel for
+    for (int ibox = 0; ibox < nbox; ibox++)
+      {
+        const Box& region = dbl[dit[ibox]];
+        FArrayBox& phiFab = a_phiThisLevel[dit[ibox]];
+        const FArrayBox& coarseFab = a_correctCoarse[dit[ibox]];
+
+        // Prolong onto the box and its face ghost cells inside the
+        // domain; those at the coarse-fine interface are replaced by the
+        // interpolation.  The 5 point stencil does not read the corners.
+        BoxKernels::prolong(phiFab, coarseFab, region, 2);
+        for (int idir = 0; idir < SpaceDim; idir++)
+          {
+            for (SideIterator sit; sit.ok(); sit.next())
+              {
+                Box ghost = m_domain & adjCellBox(region, idir, sit(), 1);
+                if (!ghost.isEmpty())
+                  {
+                    BoxKernels::prolong(phiFab, coarseFab, ghost, 2);
+                  }
+                homogeneousCFInterp(a_phiThisLevel, dit[ibox], idir, sit());
+              }
+          }
+        m_bc(phiFab, region, m_domain, m_dx, true);
+        gsrbBox(phiFab, a_rhsThisLevel[dit[ibox]], dit[ibox], region, 0);
+      }
+  }
+
+  // The black sweep and the remaining iterations as in levelGSRB
+  {
+    CH_TIME("AMRPoissonOp::prolongAndRelax::black");
+    homogeneousCFInterp(a_phiThisLevel);
+    if (s_exchangeMode == 0)
+      a_phiThisLevel.exchange(a_phiThisLevel.interval(), m_exchangeCopier);
+    else
+      a_phiThisLevel.exchangeNoOverlap(m_exchangeCopier);
+#pragma omp parallel for
+    for (int ibox = 0; ibox < nbox; ibox++)
+      {
+        const Box& region = dbl[dit[ibox]];
+        FArrayBox& phiFab = a_phiThisLevel[dit[ibox]];
+        m_bc(phiFab, region, m_domain, m_dx, true);
+        gsrbBox(phiFab, a_rhsThisLevel[dit[ibox]], dit[ibox], region, 1);
+      }
+  }
+  relax(a_phiThisLevel, a_rhsThisLevel, a_iterations - 1);
+}
+
 // ---------------------------------------------------------
 void AMRPoissonOp::AMRResidual(LevelData<FArrayBox>&              a_residual,
                                const LevelData<FArrayBox>&        a_phiFine,
@@ -920,6 +1033,44 @@ void AMRPoissonOp::AMRRestrictS(LevelData<FArrayBox>&       a_resCoarse, // outp
   }//end pragma
 }
 
+// ---------------------------------------------------------
+void AMRPoissonOp::residualAndRestrict(LevelData<FArrayBox>&       a_resCoarse,
+                                       const LevelData<FArrayBox>& a_residual,
+                                       const LevelData<FArrayBox>& a_correction,
+                                       const LevelData<FArrayBox>& a_coarseCorrection,
+                                       LevelData<FArrayBox>&       a_scratch)
+{
+  CH_TIME("AMRPoissonOp::residualAndRestrict");
+
+  LevelData<FArrayBox>& phi = (LevelData<FArrayBox>&)a_correction;
+  if (a_coarseCorrection.isDefined())
+    {
+      m_interpWithCoarser.coarseFineInterp(phi, a_coarseCorrection);
+    }
+  if (s_exchangeMode == 0)
+    phi.exchange(phi.interval(), m_exchangeCopier);
+  else if (s_exchangeMode == 1)
+    phi.exchangeNoOverlap(m_exchangeCopier);
+  else
+    MayDay::Abort("exchangeMode");
+
+  const DisjointBoxLayout& dbl = a_correction.disjointBoxLayout();
+  const DisjointBoxLayout& dblCoar = a_resCoarse.disjointBoxLayout();
+  DataIterator dit = a_correction.dataIterator();
+  int nbox = dit.size();
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
+    {
+      const Box& region = dbl[dit[ibox]];
+      m_bc(phi[dit[ibox]], region, m_domain, m_dx, true);
+
+      // the fine residual only lives in a_scratch, as in AMRRestrictS
+      FArrayBox& res = a_scratch[dit[ibox]];
+      residualBox(res, phi[dit[ibox]], a_residual[dit[ibox]], dit[ibox], region);
+      BoxKernels::average(a_resCoarse[dit[ibox]], res, dblCoar[dit[ibox]], m_refToCoarser);
+    }
+}
+
 // ---------------------------------------------------------
 /** a_correction += I[2h->h](a_coarseCorrection) */
 void AMRPoissonOp::AMRProlong(LevelData<FArrayBox>&       a_correction,
@@ -1260,24 +1411,7 @@ void AMRPoissonOp::levelGSRB( LevelData<FArrayBox>&       a_phi,
             
             m_bc( phiFab, region, m_domain, m_dx, true );
             
-            if (m_alpha == 0.0 && m_beta == 1.0 )
-            {
-              FORT_GSRBLAPLACIAN(CHF_FRA(phiFab),
-                                 CHF_CONST_FRA(a_rhs[dit[ibox]]),
-                                 CHF_BOX(region),
-                                 CHF_CONST_REAL(m_dx),
-                                 CHF_CONST_INT(whichPass));
-            }
-            else
-            {
-              FORT_GSRBHELMHOLTZ(CHF_FRA(phiFab),
-                                 CHF_CONST_FRA(a_rhs[dit[ibox]]),
-                                 CHF_BOX(region),
-                                 CHF_CONST_REAL(m_dx),
-                                 CHF_CONST_REAL(m_alpha),
-                                 CHF_CONST_REAL(m_beta),
-                                 CHF_CONST_INT(whichPass));
-            }
+            gsrbBox(phiFab, a_rhs[dit[ibox]], dit[ibox], region, whichPass);
           } // end loop through grids
         }
       }//end pragma
@@ -1285,6 +1419,33 @@ void AMRPoissonOp::levelGSRB( LevelData<FArrayBox>&       a_phi,
     } // end loop through red-black
 }
 
+// ---------------------------------------------------------
+void AMRPoissonOp::gsrbBox(FArrayBox&       a_phi,
+                           const FArrayBox& a_rhs,
+                           const DataIndex& a_datInd,
+                           const Box&       a_region,
+                           int              a_color)
+{
+  if (m_alpha == 0.0 && m_beta == 1.0 )
+    {
+      FORT_GSRBLAPLACIAN(CHF_FRA(a_phi),
+                         CHF_CONST_FRA(a_rhs),
+                         CHF_BOX(a_region),
+                         CHF_CONST_REAL(m_dx),
+                         CHF_CONST_INT(a_color));
+    }
+  else
+    {
+      FORT_GSRBHELMHOLTZ(CHF_FRA(a_phi),
+                         CHF_CONST_FRA(a_rhs),
+                         CHF_BOX(a_region),
+                         CHF_CONST_REAL(m_dx),
+                         CHF_CONST_REAL(m_alpha),
+                         CHF_CONST_REAL(m_beta),
+                         CHF_CONST_INT(a_color));
+    }
+}
+
 // ---------------------------------------------------------
 void AMRPoissonOp::levelMultiColor(LevelData<FArrayBox>&       a_phi,
                                    const LevelData<FArrayBox>& a_rhs)
@@ -0,0 +1,115 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include "FArrayBox.H"
+#include "LevelDataOps.H"
+#include "NamespaceHeader.H"
+
+// The part of a_data[a_d] that belongs to a_data: the valid box grown by
+// the ghost vector.  A FAB that is not cell-centered is used whole.
+static Box opBox(const LevelData<FArrayBox>& a_data, const DataIndex& a_d)
+{
+  const Box& fabBox = a_data[a_d].box();
+  if (!fabBox.cellCentered())
+    {
+      return fabBox;
+    }
+  Box region = grow(a_data.disjointBoxLayout()[a_d], a_data.ghostVect());
+  region &= fabBox;
+  return region;
+}
+
+template < >
+void LevelDataOps<FArrayBox>::mult( LevelData<FArrayBox>& a_lhs, const LevelData<FArrayBox>& a_rhs)
+{
+  int numcomp = a_lhs.nComp();
+  DataIterator dit=a_lhs.dataIterator(); int count=dit.size();
+#pragma omp parallel for
+  for(int i=0; i<count; i++)
+    {
+      const DataIndex& d=dit[i];
+      Box region = opBox(a_lhs, d);
+      region &= a_rhs[d].box();
+      a_lhs[d].mult(a_rhs[d], region, 0, 0, numcomp);
+    }
+}
+
+template < >
+void LevelDataOps<FArrayBox>::axby( LevelData<FArrayBox>& a_lhs, const LevelData<FArrayBox>& a_x,
+                                    const LevelData<FArrayBox>& a_y, Real a, Real b)
+{
+  int numcomp = a_lhs.nComp();
+  DataIterator dit=a_lhs.dataIterator(); int count=dit.size();
+#pragma omp parallel for
+  for(int i=0; i<count; i++)
+    {
+      const DataIndex& d=dit[i];
+      FArrayBox& data = a_lhs[d];
+      Box region = opBox(a_lhs, d);
+      data.copy(a_x[d], region);
+      data.mult(a, region, 0, numcomp);
+      region &= a_y[d].box();
+      data.plus(a_y[d], region, region, b, 0, 0, numcomp);
+    }
+}
+
+template < >
+void LevelDataOps<FArrayBox>::scale(LevelData<FArrayBox>& a_lhs, const Real& a_scale)
+{
+  int numcomp = a_lhs.nComp();
+  DataIterator dit=a_lhs.dataIterator(); int count=dit.size();
+#pragma omp parallel for
+  for(int i=0; i<count; i++)
+    {
+      const DataIndex& d=dit[i];
+      a_lhs[d].mult(a_scale, opBox(a_lhs, d), 0, numcomp);
+    }
+}
+
+template < >
+void LevelDataOps<FArrayBox>::plus(LevelData<FArrayBox>& a_lhs, const Real& a_inc)
+{
+  int numcomp = a_lhs.nComp();
+  DataIterator dit=a_lhs.dataIterator(); int count=dit.size();
+#pragma omp parallel for
+  for(int i=0; i<count; i++)
+    {
+      const DataIndex& d=dit[i];
+      a_lhs[d].plus(a_inc, opBox(a_lhs, d), 0, numcomp);
+    }
+}
+
+template < >
+void LevelDataOps<FArrayBox>::setToZero(LevelData<FArrayBox>& a_lhs)
+{
+  int numcomp = a_lhs.nComp();
+  DataIterator dit=a_lhs.dataIterator(); int count=dit.size();
+#pragma omp parallel for
+  for(int i=0; i<count; i++)
+    {
+      const DataIndex& d=dit[i];
+      a_lhs[d].setVal(0.0, opBox(a_lhs, d), 0, numcomp);
+    }
+}
+
+template < >
+void LevelDataOps<FArrayBox>::setVal(LevelData<FArrayBox>& a_lhs, const Real& a_val)
+{
+  int numcomp = a_lhs.nComp();
+  DataIterator dit=a_lhs.dataIterator(); int count=dit.size();
+#pragma omp parallel for
+  for(int i=0; i<count; i++)
+    {
+      const DataIndex& d=dit[i];
+      a_lhs[d].setVal(a_val, opBox(a_lhs, d), 0, numcomp);
+    }
+}
+
+#include "NamespaceFooter.H"
@@ -51,39 +51,47 @@ void VCAMRPoissonOp2::residualI(LevelData<FArrayBox>&       a_lhs,
 
   for (dit.begin(); dit.ok(); ++dit)
     {
-      const Box& region = dbl[dit()];
-      const FluxBox& thisBCoef = (*m_bCoef)[dit];
+      residualBox(a_lhs[dit], phi[dit], a_rhs[dit], dit(), dbl[dit()]);
+    } // end loop over boxes
+}
+
+void VCAMRPoissonOp2::residualBox(FArrayBox&       a_lhs,
+                                  const FArrayBox& a_phi,
+                                  const FArrayBox& a_rhs,
+                                  const DataIndex& a_datInd,
+                                  const Box&       a_region)
+{
+  const FluxBox& thisBCoef = (*m_bCoef)[a_datInd];
 
 #if CH_SPACEDIM == 1
-      FORT_VCCOMPUTERES1D
+  FORT_VCCOMPUTERES1D
 #elif CH_SPACEDIM == 2
-      FORT_VCCOMPUTERES2D
+  FORT_VCCOMPUTERES2D
 #elif CH_SPACEDIM == 3
-      FORT_VCCOMPUTERES3D
+  FORT_VCCOMPUTERES3D
 #else
-      This_will_not_compile!
+  This_will_not_compile!
 #endif
-                         (CHF_FRA(a_lhs[dit]),
-                          CHF_CONST_FRA(phi[dit]),
-                          CHF_CONST_FRA(a_rhs[dit]),
-                          CHF_CONST_REAL(m_alpha),
-                          CHF_CONST_FRA((*m_aCoef)[dit]),
-                          CHF_CONST_REAL(m_beta),
+                     (CHF_FRA(a_lhs),
+                      CHF_CONST_FRA(a_phi),
+                      CHF_CONST_FRA(a_rhs),
+                      CHF_CONST_REAL(m_alpha),
+                      CHF_CONST_FRA((*m_aCoef)[a_datInd]),
+                      CHF_CONST_REAL(m_beta),
 #if CH_SPACEDIM >= 1
-                          CHF_CONST_FRA(thisBCoef[0]),
+                      CHF_CONST_FRA(thisBCoef[0]),
 #endif
 #if CH_SPACEDIM >= 2
-                          CHF_CONST_FRA(thisBCoef[1]),
+                      CHF_CONST_FRA(thisBCoef[1]),
 #endif
 #if CH_SPACEDIM >= 3
-                          CHF_CONST_FRA(thisBCoef[2]),
+                      CHF_CONST_FRA(thisBCoef[2]),
 #endif
 #if CH_SPACEDIM >= 4
-                          This_will_not_compile!
+                      This_will_not_compile!
 #endif
-                          CHF_BOX(region),
-                          CHF_CONST_REAL(m_dx));
-    } // end loop over boxes
+                      CHF_BOX(a_region),
+                      CHF_CONST_REAL(m_dx));
 }
 
 /**************************/
@@ -278,6 +286,7 @@ void VCAMRPoissonOp2::setCoefs(const RefCountedPtr<LevelData<FArrayBox> >& a_aCo
 
   // Our relaxation parameter is officially out of date!
   m_lambdaNeedsResetting = true;
+  m_bCoefNeedsInterpolating = true;
 }
 
 void VCAMRPoissonOp2::resetLambda()
@@ -588,41 +597,60 @@ void VCAMRPoissonOp2::levelGSRB(LevelData<FArrayBox>&       a_phi,
 
       for (dit.begin(); dit.ok(); ++dit)
         {
-          const Box& region = dbl.get(dit());
-          const FluxBox& thisBCoef  = (*m_bCoef)[dit];
+          gsrbBox(a_phi[dit], a_rhs[dit], dit(), dbl.get(dit()), whichPass);
+        } // end loop through grids
+    } // end loop through red-black
+}
+
+void VCAMRPoissonOp2::gsrbBox(FArrayBox&       a_phi,
+                              const FArrayBox& a_rhs,
+                              const DataIndex& a_datInd,
+                              const Box&       a_region,
+                              int              a_color)
+{
+  const FluxBox& thisBCoef  = (*m_bCoef)[a_datInd];
 
 #if CH_SPACEDIM == 1
-          FORT_GSRBHELMHOLTZVC1D
+  FORT_GSRBHELMHOLTZVC1D
 #elif CH_SPACEDIM == 2
-          FORT_GSRBHELMHOLTZVC2D
+  FORT_GSRBHELMHOLTZVC2D
 #elif CH_SPACEDIM == 3
-          FORT_GSRBHELMHOLTZVC3D
+  FORT_GSRBHELMHOLTZVC3D
 #else
-          This_will_not_compile!
+  This_will_not_compile!
 #endif
-                                (CHF_FRA(a_phi[dit]),
-                                 CHF_CONST_FRA(a_rhs[dit]),
-                                 CHF_BOX(region),
-                                 CHF_CONST_REAL(m_dx),
-                                 CHF_CONST_REAL(m_alpha),
-                                 CHF_CONST_FRA((*m_aCoef)[dit]),
-                                 CHF_CONST_REAL(m_beta),
+                        (CHF_FRA(a_phi),
+                         CHF_CONST_FRA(a_rhs),
+                         CHF_BOX(a_region),
+                         CHF_CONST_REAL(m_dx),
+                         CHF_CONST_REAL(m_alpha),
+                         CHF_CONST_FRA((*m_aCoef)[a_datInd]),
+                         CHF_CONST_REAL(m_beta),
 #if CH_SPACEDIM >= 1
-                                 CHF_CONST_FRA(thisBCoef[0]),
+                         CHF_CONST_FRA(thisBCoef[0]),
 #endif
 #if CH_SPACEDIM >= 2
-                                 CHF_CONST_FRA(thisBCoef[1]),
+                         CHF_CONST_FRA(thisBCoef[1]),
 #endif
 #if CH_SPACEDIM >= 3
-                                 CHF_CONST_FRA(thisBCoef[2]),
+                         CHF_CONST_FRA(thisBCoef[2]),
 #endif
 #if CH_SPACEDIM >= 4
-                                 This_will_not_compile!
+                         This_will_not_compile!
 #endif
-                                 CHF_CONST_FRA(m_lambda[dit]),
-                                 CHF_CONST_INT(whichPass));
-        } // end loop through grids
-    } // end loop through red-black
+                         CHF_CONST_FRA(m_lambda[a_datInd]),
+                         CHF_CONST_INT(a_color));
+}
+
+void VCAMRPoissonOp2::prolongAndRelax(LevelData<FArrayBox>&       a_phiThisLevel,
+                                      const LevelData<FArrayBox>& a_correctCoarse,
+                                      const LevelData<FArrayBox>& a_rhsThisLevel,
+                                      int                         a_iterations)
+{
+  // Recompute the relaxation coefficient if needed.
+  resetLambda();
+
+  AMRPoissonOp::prolongAndRelax(a_phiThisLevel, a_correctCoarse, a_rhsThisLevel, a_iterations);
 }
 
 void VCAMRPoissonOp2::levelMultiColor(LevelData<FArrayBox>&       a_phi,
@@ -845,13 +873,26 @@ setTime(Real a_time)
 
   // Interpolate the b coefficient data if necessary / possible. If
   // the B coefficient depends upon the solution, the operator is nonlinear
-  // and the integrator must decide how to treat it.
+  // and the integrator must decide how to treat it. Data already
+  // interpolated at this time is still good, and so is lambda.
   if (!m_bCoefInterpolator.isNull() &&
       !m_bCoefInterpolator->dependsUponSolution())
-    m_bCoefInterpolator->interpolate(*m_bCoef, a_time);
+  {
+    if (m_bCoefNeedsInterpolating || (a_time != m_bCoefTime))
+    {
+      m_bCoefInterpolator->interpolate(*m_bCoef, a_time);
+      m_bCoefTime = a_time;
+      m_bCoefNeedsInterpolating = false;
 
-  // Our relaxation parameter is officially out of date!
-  m_lambdaNeedsResetting = true;
+      // Our relaxation parameter is officially out of date!
+      m_lambdaNeedsResetting = true;
+    }
+  }
+  else
+  {
+    // Our relaxation parameter is officially out of date!
+    m_lambdaNeedsResetting = true;
+  }
 
   // Set the time on the boundary holder.
   m_bc.setTime(a_time);
@@ -27,6 +27,7 @@
 int ViscousTensorOpFactory::s_coefficientAverageType = 1;
 //int ViscousTensorOp::s_prolongType = piecewiseConstant;
 int ViscousTensorOp::s_prolongType = linearInterp;
+bool ViscousTensorOp::s_fusedFluxes = false;
 
 void
 vtogetMultiColors(Vector<IntVect>& a_colors)
@@ -107,6 +108,11 @@ computeOperatorNoBCs(LevelData<FArrayBox>& a_lhs,
   //  Real dx = m_dx;
   const DisjointBoxLayout dbl= a_phi.getBoxes();
   DataIterator dit = a_phi.dataIterator();
+  if (s_fusedFluxes)
+    {
+      computeOperatorNoBCsFused(a_lhs, a_phi);
+      return;
+    }
   //this makes the lhs = alpha*phi
   m_levelOps.setToZero(a_lhs);
   incr(a_lhs, a_phi, m_alpha);
@@ -143,6 +149,62 @@ computeOperatorNoBCs(LevelData<FArrayBox>& a_lhs,
 /***/
 void
 ViscousTensorOp::
+computeOperatorNoBCsFused(LevelData<FArrayBox>& a_lhs,
+                          const LevelData<FArrayBox>& a_phi)
+{
+  CH_TIME("ViscousTensorOp::computeOperatorNoBCsFused");
+  const DisjointBoxLayout dbl= a_phi.getBoxes();
+  int ngrad = m_grad.nComp();
+  for (DataIterator dit = a_phi.dataIterator(); dit.ok(); ++dit)
+    {
+      Box gridBox = dbl.get(dit());
+      FArrayBox& lhsFAB = a_lhs[dit()];
+
+      //lhs = alpha*acoef*phi on the valid cells
+      lhsFAB.copy(a_phi[dit()], gridBox);
+      for (int ivar = 0; ivar < SpaceDim; ivar++)
+        {
+          lhsFAB.mult((*m_acoef)[dit()], gridBox, 0, ivar, 1);
+        }
+      lhsFAB.mult(m_alpha, gridBox, 0, lhsFAB.nComp());
+      if (m_beta == 0.)
+        {
+          continue;
+        }
+
+      //beta comes in through the divergence, so the fluxes stay unscaled
+      Real dxOverBeta = m_dx/m_beta;
+      for (int idir = 0; idir < SpaceDim; idir++)
+        {
+          Box faceBox = surroundingNodes(gridBox, idir);
+          size_t npts = faceBox.numPts();
+          size_t nscratch = npts*(1 + ngrad + m_ncomp);
+          if (m_faceScratch.size() < nscratch)
+            {
+              m_faceScratch.resize(nscratch);
+            }
+          Real* scratch = &(m_faceScratch[0]);
+          FArrayBox faceDiv( faceBox, 1,        scratch);
+          FArrayBox faceGrad(faceBox, ngrad,    scratch + npts);
+          FArrayBox faceFlux(faceBox, m_ncomp,  scratch + npts*(1 + ngrad));
+
+          getFaceDivAndGrad(faceDiv, faceGrad, a_phi[dit()], m_grad[dit()],
+                            m_domain, faceBox, idir, m_dx);
+          getFluxFromDivAndGrad(faceFlux, faceDiv, faceGrad,
+                                (*m_eta)[dit()][idir], (*m_lambda)[dit()][idir],
+                                faceBox, idir);
+          FORT_ADDDIVFLUXDIRVTOP(CHF_FRA(lhsFAB),
+                                 CHF_CONST_FRA(faceFlux),
+                                 CHF_BOX(gridBox),
+                                 CHF_REAL(dxOverBeta),
+                                 CHF_CONST_INT(m_ncomp),
+                                 CHF_CONST_INT(idir));
+        }
+    }
+}
+/***/
+void
+ViscousTensorOp::
 restrictResidual(LevelData<FArrayBox>&       a_resCoarse,
                  LevelData<FArrayBox>&       a_phiFine,
                  const LevelData<FArrayBox>& a_rhsFine)
@@ -24,6 +24,7 @@
 #include "BoxIterator.H"
 #include "AMR.H"
 #include "CH_Timer.H"
+#include "Arena.H"
 #include "NamespaceHeader.H"
 
 //#define SMALL_TIME 1.0e-8
@@ -788,6 +789,8 @@ void AMR::run(Real a_max_time, int a_max_step)
           (a_max_time - m_cur_time > m_time_eps*m_dt_base);
         ++m_cur_step, m_cur_time += old_dt_base)
     {
+        // Count the pooled FArrayBox temporaries still in use at its end
+        ArenaFrame stepFrame;
         s_step = m_cur_step;
 #ifdef CH_MPI
         wc_run0=MPI_Wtime();
@@ -894,6 +897,8 @@ void AMR::run(Real a_max_time, int a_max_step)
           break;
         }
     }
+  // The pooled FArrayBox temporaries are kept from step to step
+  PArena::releaseAll();
 
 #ifndef CH_DISABLE_SIGNALS
   // Re-instate the old Ctrl-C handler.
@@ -1458,6 +1463,9 @@ void AMR::regrid(int a_base_level)
     {
       m_amrlevels[level]->postRegrid(a_base_level);
     }
+
+  // The new boxes want temporaries of other sizes than the pooled ones
+  PArena::releaseAll();
 }
 //-----------------------------------------------------------------------
 
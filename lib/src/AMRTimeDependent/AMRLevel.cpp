@@ -18,6 +18,7 @@
 #include "NamespaceHeader.H"
 
 int AMRLevel::s_verbosity = 0;
+bool AMRLevel::s_restartOnWrittenRanks = false;
 
 //-----------------------------------------------------------------------
 bool AMRLevel::isDefined() const
@@ -144,6 +145,13 @@ int AMRLevel::refRatio() const
 }
 //-----------------------------------------------------------------------
 
+//-----------------------------------------------------------------------
+LevelData<FArrayBox>* AMRLevel::analysisData()
+{
+  return NULL;
+}
+//-----------------------------------------------------------------------
+
 //-----------------------------------------------------------------------
 void AMRLevel::time(Real a_time)
 {
@@ -188,6 +196,58 @@ int AMRLevel::verbosity()
 }
 //-----------------------------------------------------------------------
 
+//-----------------------------------------------------------------------
+// static
+void AMRLevel::restartOnWrittenRanks(bool a_restartOnWrittenRanks)
+{
+  s_restartOnWrittenRanks = a_restartOnWrittenRanks;
+}
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+// static
+bool AMRLevel::restartOnWrittenRanks()
+{
+  return(s_restartOnWrittenRanks);
+}
+//-----------------------------------------------------------------------
+
+#ifdef CH_USE_HDF5
+//-----------------------------------------------------------------------
+int AMRLevel::readCheckpointGrids(HDF5Handle&  a_handle,
+                                  Vector<Box>& a_boxes,
+                                  Vector<int>& a_procs) const
+{
+  int status = readLayout(a_handle, a_boxes, a_procs);
+  if (status != 0)
+  {
+    return status;
+  }
+
+  if (s_restartOnWrittenRanks && (a_procs.size() == a_boxes.size()))
+  {
+    for (int ibox = 0; ibox < a_procs.size(); ibox++)
+    {
+      a_procs[ibox] = a_procs[ibox] % numProc();
+    }
+  }
+  else
+  {
+    a_procs.resize(0);
+  }
+
+  if (s_verbosity >= 3)
+  {
+    pout() << "AMRLevel::readCheckpointGrids " << m_level << ": "
+           << a_boxes.size() << " boxes, "
+           << (a_procs.size() > 0 ? "on their written ranks" : "to be load balanced")
+           << endl;
+  }
+  return 0;
+}
+//-----------------------------------------------------------------------
+#endif
+
 //-----------------------------------------------------------------------
 void AMRLevel::preRegrid(int a_base_level, const Vector<Vector<Box> >& a_new_grids)
 {
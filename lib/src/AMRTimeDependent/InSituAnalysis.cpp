@@ -0,0 +1,592 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include "InSituAnalysis.H"
+#include "AMR.H"
+#include "AMRLevel.H"
+#include "AMRIO.H"
+#include "BoxIterator.H"
+#include "CoarseAverage.H"
+#include "computeNorm.H"
+#include "computeSum.H"
+#include "SPMD.H"
+#include "parstream.H"
+#include "NamespaceHeader.H"
+using namespace std;
+
+//-----------------------------------------------------------------------
+Real
+InSituHierarchy::
+dx(int a_level) const
+{
+  Real dx = m_dxCoarse;
+  for (int lev = 0; lev < a_level; ++lev)
+  {
+    dx /= m_refRatios[lev];
+  }
+  return dx;
+}
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+InSituStage::
+InSituStage()
+{
+}
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+InSituStage::
+~InSituStage()
+{
+}
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+void
+InSituStage::
+conclude()
+{
+}
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+InSituReduction::
+InSituReduction(const std::string& a_filename,
+                Operation a_operation,
+                int a_comp):
+  InSituStage(),
+  m_filename(a_filename),
+  m_operation(a_operation),
+  m_comp(a_comp),
+  m_value(0.)
+{
+}
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+void
+InSituReduction::
+process(const InSituHierarchy& a_hierarchy)
+{
+  Interval comps(m_comp, m_comp);
+  const Vector<LevelData<FArrayBox>*>& data = a_hierarchy.m_data;
+  const Vector<int>& refRatios = a_hierarchy.m_refRatios;
+  switch (m_operation)
+  {
+    case Min:
+      m_value = computeMin(data, refRatios, comps);
+      break;
+    case Max:
+      m_value = computeMax(data, refRatios, comps);
+      break;
+    case Sum:
+      m_value = computeSum(data, refRatios, a_hierarchy.m_dxCoarse, comps);
+      break;
+    case L1Norm:
+      m_value = computeNorm(data, refRatios, a_hierarchy.m_dxCoarse, comps, 1);
+      break;
+    case L2Norm:
+      m_value = computeNorm(data, refRatios, a_hierarchy.m_dxCoarse, comps, 2);
+      break;
+    default:
+      MayDay::Error("InSituReduction: unknown operation");
+  }
+
+  if (procID() == 0)
+  {
+    ofstream file(m_filename.c_str(), ios::app);
+    file << a_hierarchy.m_step << " "
+         << setprecision(12) << a_hierarchy.m_time << " "
+         << m_value << endl;
+  }
+}
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+Real
+InSituReduction::
+value() const
+{
+  return m_value;
+}
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+InSituSlice::
+InSituSlice(const std::string& a_prefix,
+            const SliceSpec& a_sliceSpec,
+            const Vector<std::string>& a_names):
+  InSituStage(),
+  m_prefix(a_prefix),
+  m_sliceSpec(a_sliceSpec),
+  m_names(a_names),
+  m_filename()
+{
+}
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+void
+InSituSlice::
+process(const InSituHierarchy& a_hierarchy)
+{
+  m_filename = "";
+  SliceSpec sliceSpec = m_sliceSpec;
+  Vector<DisjointBoxLayout> grids;
+  Vector<LevelData<FArrayBox>*> slices;
+  for (int lev = 0; lev < a_hierarchy.m_data.size(); ++lev)
+  {
+    // Slices stop at the first level the plane misses.
+    LevelData<FArrayBox>* slice = new LevelData<FArrayBox>;
+    a_hierarchy.m_data[lev]->degenerateLocalOnly(*slice, sliceSpec);
+    if (slice->disjointBoxLayout().size() == 0)
+    {
+      delete slice;
+      break;
+    }
+    grids.push_back(slice->disjointBoxLayout());
+    slices.push_back(slice);
+    if (lev < a_hierarchy.m_refRatios.size())
+    {
+      sliceSpec.position *= a_hierarchy.m_refRatios[lev];
+    }
+  }
+  if (slices.size() == 0)
+  {
+    return;
+  }
+
+  int ncomp = slices[0]->nComp();
+  Vector<string> names(ncomp);
+  for (int comp = 0; comp < ncomp; ++comp)
+  {
+    char name[32];
+    sprintf(name, "component_%d", comp);
+    names[comp] = (comp < m_names.size()) ? m_names[comp] : string(name);
+  }
+
+  Box domain;
+  a_hierarchy.m_domains[0].domainBox().degenerate(domain, m_sliceSpec);
+
+  char filename[1024];
+  sprintf(filename, "%s%06d.%dd.hdf5", m_prefix.c_str(), a_hierarchy.m_step, SpaceDim);
+  m_filename = filename;
+#ifdef CH_USE_HDF5
+  WriteAMRHierarchyHDF5(m_filename, grids, slices, names, domain,
+                        a_hierarchy.m_dxCoarse, 0., a_hierarchy.m_time,
+                        a_hierarchy.m_refRatios, slices.size());
+#endif
+
+  for (int lev = 0; lev < slices.size(); ++lev)
+  {
+    delete slices[lev];
+  }
+}
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+const std::string&
+InSituSlice::
+filename() const
+{
+  return m_filename;
+}
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+InSituIsoSurface::
+InSituIsoSurface(const std::string& a_prefix,
+                 int a_comp,
+                 Real a_isoValue):
+  InSituStage(),
+  m_prefix(a_prefix),
+  m_comp(a_comp),
+  m_isoValue(a_isoValue),
+  m_points()
+{
+}
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+void
+InSituIsoSurface::
+process(const InSituHierarchy& a_hierarchy)
+{
+  // The value, whether the cell is valid on this level and whether it is
+  // covered by the next finer level, with one ghost cell filled in from
+  // the neighboring boxes.
+  const int VALUE = 0, VALID = 1, COVERED = 2;
+  Vector<Real> localPoints;
+  int numLevels = a_hierarchy.m_data.size();
+  for (int lev = 0; lev < numLevels; ++lev)
+  {
+    const LevelData<FArrayBox>& data = *a_hierarchy.m_data[lev];
+    const DisjointBoxLayout& dbl = data.disjointBoxLayout();
+    Real dx = a_hierarchy.dx(lev);
+
+    LevelData<FArrayBox> work(dbl, 3, IntVect::Unit);
+    for (DataIterator dit = dbl.dataIterator(); dit.ok(); ++dit)
+    {
+      const Box& box = dbl[dit];
+      FArrayBox& workFab = work[dit];
+      workFab.setVal(0.);
+      workFab.copy(data[dit], box, m_comp, box, VALUE, 1);
+      workFab.setVal(1., box, VALID, 1);
+      if (lev < numLevels - 1)
+      {
+        const DisjointBoxLayout& finerDBL = a_hierarchy.m_data[lev+1]->disjointBoxLayout();
+        Vector<LayoutIndex> found;
+        finerDBL.findIntersecting(found, refine(box, a_hierarchy.m_refRatios[lev]));
+        for (int ibox = 0; ibox < found.size(); ibox++)
+        {
+          Box covered = coarsen(finerDBL[found[ibox]], a_hierarchy.m_refRatios[lev]);
+          covered &= box;
+          if (!covered.isEmpty())
+          {
+            workFab.setVal(1., covered, COVERED, 1);
+          }
+        }
+      }
+    }
+    work.exchange();
+
+    for (DataIterator dit = dbl.dataIterator(); dit.ok(); ++dit)
+    {
+      const FArrayBox& workFab = work[dit];
+      for (BoxIterator bit(dbl[dit]); bit.ok(); ++bit)
+      {
+        const IntVect& iv = bit();
+        Real v0 = workFab(iv, VALUE);
+        for (int dir = 0; dir < SpaceDim; ++dir)
+        {
+          IntVect jv = iv + BASISV(dir);
+          if ((workFab(jv, VALID) == 0.) ||
+              ((workFab(iv, COVERED) != 0.) && (workFab(jv, COVERED) != 0.)))
+          {
+            continue;
+          }
+          Real v1 = workFab(jv, VALUE);
+          if ((v0 < m_isoValue) == (v1 < m_isoValue))
+          {
+            continue;
+          }
+          Real frac = (m_isoValue - v0)/(v1 - v0);
+          for (int idir = 0; idir < SpaceDim; ++idir)
+          {
+            Real x = (iv[idir] + 0.5)*dx;
+            if (idir == dir)
+            {
+              x += frac*dx;
+            }
+            localPoints.push_back(x);
+          }
+        }
+      }
+    }
+  }
+
+  Vector<Vector<Real> > allPoints;
+  gather(allPoints, localPoints, 0);
+  m_points.resize(0);
+  if (procID() == 0)
+  {
+    for (int iproc = 0; iproc < allPoints.size(); ++iproc)
+    {
+      m_points.append(allPoints[iproc]);
+    }
+
+    char filename[1024];
+    sprintf(filename, "%s%06d.csv", m_prefix.c_str(), a_hierarchy.m_step);
+    ofstream file(filename);
+    const char* coords[] = {"x", "y", "z", "u", "v", "w"};
+    for (int idir = 0; idir < SpaceDim; ++idir)
+    {
+      file << (idir > 0 ? "," : "") << coords[idir];
+    }
+    file << endl << setprecision(12);
+    for (int i = 0; i < m_points.size(); i += SpaceDim)
+    {
+      for (int idir = 0; idir < SpaceDim; ++idir)
+      {
+        file << (idir > 0 ? "," : "") << m_points[i+idir];
+      }
+      file << endl;
+    }
+  }
+}
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+const Vector<Real>&
+InSituIsoSurface::
+points() const
+{
+  return m_points;
+}
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+InSituProjection::
+InSituProjection(const std::string& a_prefix,
+                 int a_comp,
+                 int a_direction,
+                 int a_coarsening):
+  InSituStage(),
+  m_prefix(a_prefix),
+  m_comp(a_comp),
+  m_direction(a_direction),
+  m_coarsening(a_coarsening),
+  m_image()
+{
+  CH_assert((a_direction >= 0) && (a_direction < SpaceDim));
+  CH_assert(a_coarsening >= 1);
+}
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+void
+InSituProjection::
+process(const InSituHierarchy& a_hierarchy)
+{
+  // Average a copy of the component down to level 0.
+  int numLevels = a_hierarchy.m_data.size();
+  Vector<LevelData<FArrayBox>*> average(numLevels);
+  for (int lev = 0; lev < numLevels; ++lev)
+  {
+    const LevelData<FArrayBox>& data = *a_hierarchy.m_data[lev];
+    average[lev] = new LevelData<FArrayBox>(data.disjointBoxLayout(), 1, IntVect::Zero);
+    data.copyTo(Interval(m_comp, m_comp), *average[lev], Interval(0, 0));
+  }
+  for (int lev = numLevels - 1; lev > 0; --lev)
+  {
+    CoarseAverage averager(average[lev]->disjointBoxLayout(), 1,
+                           a_hierarchy.m_refRatios[lev-1]);
+    averager.averageToCoarse(*average[lev-1], *average[lev]);
+  }
+
+  // The image is the domain flattened in m_direction and coarsened in the
+  // other directions.
+  IntVect coarsening = m_coarsening*IntVect::Unit;
+  coarsening[m_direction] = 1;
+  Box flat = a_hierarchy.m_domains[0].domainBox();
+  flat.setBig(m_direction, flat.smallEnd(m_direction));
+  m_image.define(coarsen(flat, coarsening), 1);
+  m_image.setVal(0.);
+
+  Real dx = a_hierarchy.m_dxCoarse;
+  Real weight = dx;
+  for (int idir = 0; idir < SpaceDim; ++idir)
+  {
+    if (idir != m_direction)
+    {
+      weight /= m_coarsening;
+    }
+  }
+  const DisjointBoxLayout& dbl = average[0]->disjointBoxLayout();
+  for (DataIterator dit = dbl.dataIterator(); dit.ok(); ++dit)
+  {
+    const FArrayBox& fab = (*average[0])[dit];
+    for (BoxIterator bit(dbl[dit]); bit.ok(); ++bit)
+    {
+      IntVect iv = bit();
+      iv[m_direction] = flat.smallEnd(m_direction);
+      m_image(coarsen(iv, coarsening), 0) += weight*fab(bit(), 0);
+    }
+  }
+#ifdef CH_MPI
+  FArrayBox localImage(m_image.box(), 1);
+  localImage.copy(m_image);
+  MPI_Allreduce(localImage.dataPtr(), m_image.dataPtr(), m_image.box().numPts(),
+                MPI_CH_REAL, MPI_SUM, Chombo_MPI::comm);
+#endif
+
+  for (int lev = 0; lev < numLevels; ++lev)
+  {
+    delete average[lev];
+  }
+
+#ifdef CH_USE_HDF5
+  if (procID() == 0)
+  {
+    char filename[1024];
+    sprintf(filename, "%s%06d.hdf5", m_prefix.c_str(), a_hierarchy.m_step);
+    writeFABname(&m_image, filename, Vector<string>(), dx*m_coarsening);
+  }
+#endif
+}
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+const FArrayBox&
+InSituProjection::
+image() const
+{
+  return m_image;
+}
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+InSituProbe::
+InSituProbe(const std::string& a_filename,
+            const AMRProbe& a_probe,
+            const Vector<std::string>& a_names):
+  InSituStage(),
+  m_filename(a_filename),
+  m_probe(a_probe),
+  m_names(a_names),
+  m_created(false),
+  m_values()
+{
+  CH_assert(a_names.size() > 0);
+}
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+void
+InSituProbe::
+process(const InSituHierarchy& a_hierarchy)
+{
+  m_probe.sample(m_values, a_hierarchy.m_data, a_hierarchy.m_refRatios,
+                 Interval(0, m_names.size() - 1));
+#ifdef CH_USE_HDF5
+  if (!m_created)
+  {
+    if (m_probe.createTimeSeries(m_filename, m_names) != 0)
+    {
+      MayDay::Warning("InSituProbe: could not create the time series file");
+    }
+    m_created = true;
+  }
+  if (m_probe.appendTimeSeries(m_filename, a_hierarchy.m_step,
+                               a_hierarchy.m_time, m_values) != 0)
+  {
+    MayDay::Warning("InSituProbe: could not append to the time series file");
+  }
+#endif
+}
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+const Vector<Real>&
+InSituProbe::
+values() const
+{
+  return m_values;
+}
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+InSituPipeline::
+InSituPipeline(Real a_dxCoarse):
+  Scheduler::PeriodicFunction(),
+  m_dxCoarse(a_dxCoarse),
+  m_AMR(NULL),
+  m_stages()
+{
+}
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+InSituPipeline::
+~InSituPipeline()
+{
+}
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+void
+InSituPipeline::
+add(RefCountedPtr<InSituStage> a_stage)
+{
+  CH_assert(!a_stage.isNull());
+  m_stages.push_back(a_stage);
+}
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+void
+InSituPipeline::
+setUp(AMR& a_AMR, int a_interval)
+{
+  m_AMR = &a_AMR;
+}
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+void
+InSituPipeline::
+setUp(AMR& a_AMR, Real a_interval)
+{
+  m_AMR = &a_AMR;
+}
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+void
+InSituPipeline::
+operator()(int a_step, Real a_time)
+{
+  CH_assert(m_AMR != NULL);
+  InSituHierarchy hierarchy;
+  hierarchy.m_dxCoarse = m_dxCoarse;
+  hierarchy.m_step = a_step;
+  hierarchy.m_time = a_time;
+
+  Vector<AMRLevel*> levels = m_AMR->getAMRLevels();
+  for (int lev = 0; lev < levels.size(); ++lev)
+  {
+    LevelData<FArrayBox>* data = levels[lev]->analysisData();
+    if ((data == NULL) || (data->disjointBoxLayout().size() == 0))
+    {
+      break;
+    }
+    hierarchy.m_data.push_back(data);
+    hierarchy.m_refRatios.push_back(levels[lev]->refRatio());
+    hierarchy.m_domains.push_back(levels[lev]->problemDomain());
+  }
+  if (hierarchy.m_data.size() == 0)
+  {
+    MayDay::Warning("InSituPipeline: the AMR levels have no analysis data");
+    return;
+  }
+  process(hierarchy);
+}
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+void
+InSituPipeline::
+conclude(int a_step, Real a_time)
+{
+  for (int i = 0; i < m_stages.size(); ++i)
+  {
+    m_stages[i]->conclude();
+  }
+}
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+void
+InSituPipeline::
+process(const InSituHierarchy& a_hierarchy)
+{
+  CH_TIME("InSituPipeline::process");
+  for (int i = 0; i < m_stages.size(); ++i)
+  {
+    m_stages[i]->process(a_hierarchy);
+  }
+}
+//-----------------------------------------------------------------------
+
+#include "NamespaceFooter.H"
@@ -14,6 +14,7 @@
 #include "SPMD.H"
 #include "PhysIBC.H"
 #include "LoHiSide.H"
+#include "BoxIterator.H"
 #include "CH_Timer.H"
 
 #include "LevelGodunov.H"
@@ -25,6 +26,8 @@ LevelGodunov::LevelGodunov()
 {
   m_dx           = 0.0;
   m_refineCoarse = 0;
+  m_maxTimeStepClass = 0;
+  m_timeStepCFL  = 1.0;
   m_isDefined    = false;
 }
 
@@ -151,6 +154,18 @@ void LevelGodunov::define(const DisjointBoxLayout&    a_thisDisjointBoxLayout,
                        m_numGhost);
     }
 
+  // Every box takes the level time step unless local time stepping is on
+  m_boxClass.define(m_grids);
+  for (DataIterator dit = m_grids.dataIterator(); dit.ok(); ++dit)
+    {
+      m_boxClass[dit()] = 0;
+    }
+
+  if (m_maxTimeStepClass > 0)
+    {
+      defineLocalTimeStepping();
+    }
+
   // Everything is defined
   m_isDefined = true;
 }
@@ -182,6 +197,27 @@ Real LevelGodunov::step(LevelData<FArrayBox>&       a_U,
   // Make sure everything is defined
   CH_assert(m_isDefined);
 
+  // With local time stepping, a box is only subcycled if a_dt exceeds its
+  // own CFL limit
+  if (m_maxTimeStepClass > 0)
+    {
+      int maxClass = assignTimeStepClasses(a_U,a_dt);
+      if (maxClass > 0)
+        {
+          return stepLocal(a_U,
+                           a_finerFluxRegister,
+                           a_coarserFluxRegister,
+                           a_S,
+                           a_UCoarseOld,
+                           a_TCoarseOld,
+                           a_UCoarseNew,
+                           a_TCoarseNew,
+                           a_time,
+                           a_dt,
+                           maxClass);
+        }
+    }
+
   CH_START(timeSetup);
 
   // Clear flux registers with next finer level
@@ -216,42 +252,10 @@ Real LevelGodunov::step(LevelData<FArrayBox>&       a_U,
   // Fill m_U's ghost cells using fillInterp
   if (m_hasCoarser)
     {
-      // Fraction "a_time" falls between the old and the new coarse times
-      Real alpha = (a_time - a_TCoarseOld) / (a_TCoarseNew - a_TCoarseOld);
-
-      // Truncate the fraction to the range [0,1] to remove floating-point
-      // subtraction roundoff effects
-      Real eps = 0.04 * a_dt / m_refineCoarse;
-
-      if (Abs(alpha) < eps)
-        {
-          alpha = 0.0;
-        }
-
-      if (Abs(1.0-alpha) < eps)
-        {
-          alpha = 1.0;
-        }
-
-      // Current time before old coarse time
-      if (alpha < 0.0)
-        {
-          MayDay::Error( "LevelGodunov::step: alpha < 0.0");
-        }
-
-      // Current time after new coarse time
-      if (alpha > 1.0)
-        {
-          MayDay::Error( "LevelGodunov::step: alpha > 1.0");
-        }
-
-      // Interpolate ghost cells from next coarser level using both space
-      // and time interpolation
-      m_patcher.fillInterp(m_U,
-                           a_UCoarseOld,
-                           a_UCoarseNew,
-                           alpha,
-                           0,0,m_numCons);
+      fillCoarseGhosts(m_U,
+                       a_UCoarseOld,a_TCoarseOld,
+                       a_UCoarseNew,a_TCoarseNew,
+                       a_time,a_dt);
     }
 
   // Potentially used in boundary conditions
@@ -368,6 +372,16 @@ Real LevelGodunov::step(LevelData<FArrayBox>&       a_U,
   Real local_dtNew = m_dx / maxWaveSpeed;
   Real dtNew;
 
+  if (m_maxTimeStepClass > 0)
+    {
+      // With local time stepping, the fastest boxes will be subcycled
+      CH_TIME("conclude::getDt");
+      Real minSpeed;
+      Real maxSpeed;
+      globalSpeedRange(minSpeed,maxSpeed,speeds);
+      dtNew = m_dx / referenceSpeed(minSpeed,maxSpeed);
+    }
+  else
   {
     CH_TIME("conclude::getDt");
 #ifdef CH_MPI
@@ -429,42 +443,10 @@ void LevelGodunov::computeWHalf(LayoutData<FluxBox>&        a_WHalf,
   // Fill U's ghost cells using fillInterp
   if (m_hasCoarser)
     {
-      // Fraction "a_time" falls between the old and the new coarse times
-      Real alpha = (a_time - a_TCoarseOld) / (a_TCoarseNew - a_TCoarseOld);
-
-      // Truncate the fraction to the range [0,1] to remove floating-point
-      // subtraction roundoff effects
-      Real eps = 0.04 * a_dt / m_refineCoarse;
-
-      if (Abs(alpha) < eps)
-        {
-          alpha = 0.0;
-        }
-
-      if (Abs(1.0-alpha) < eps)
-        {
-          alpha = 1.0;
-        }
-
-      // Current time before old coarse time
-      if (alpha < 0.0)
-        {
-          MayDay::Error( "LevelGodunov::step: alpha < 0.0");
-        }
-
-      // Current time after new coarse time
-      if (alpha > 1.0)
-        {
-          MayDay::Error( "LevelGodunov::step: alpha > 1.0");
-        }
-
-      // Interpolate ghost cells from next coarser level using both space
-      // and time interpolation
-      m_patcher.fillInterp(U,
-                           a_UCoarseOld,
-                           a_UCoarseNew,
-                           alpha,
-                           0,0,m_numCons);
+      fillCoarseGhosts(U,
+                       a_UCoarseOld,a_TCoarseOld,
+                       a_UCoarseNew,a_TCoarseNew,
+                       a_time,a_dt);
     }
 
   // Exchange all the data between grids at this level
@@ -664,9 +646,8 @@ Real LevelGodunov::getMaxWaveSpeed(const LevelData<FArrayBox>& a_U)
   // Initial maximum wave speed
   Real speed = 0.0;
 
-  // This computation doesn't need involve a time but the time being set
-  // is checked by PatchGodunov::getMaxWaveSpeed so we have to set it
-  // to something...
+  // The wave speed comes straight from the physics, which doesn't need a
+  // time
   Vector<Real> speeds(dit.size(), 0.0);
 #pragma omp parallel
   {
@@ -675,7 +656,6 @@ Real LevelGodunov::getMaxWaveSpeed(const LevelData<FArrayBox>& a_U)
 #pragma omp for 
     for(int ibox = 0; ibox < nbox; ibox++)
       {
-        m_patchGodunov[dit[ibox]].setCurrentTime(0.0);
         const Box& curBox = disjointBoxLayout.get(dit[ibox]);
 
       // Get maximum wave speed for this grid
@@ -711,6 +691,448 @@ Real LevelGodunov::getMaxWaveSpeed(const LevelData<FArrayBox>& a_U)
   return speed;
 }
 
+// Turn on local time stepping with classes 0 to "a_maxClass", each box
+// stepping at a CFL number of at most "a_cfl"
+void LevelGodunov::setLocalTimeStepping(int  a_maxClass,
+                                        Real a_cfl)
+{
+  CH_assert(a_maxClass >= 0);
+  CH_assert(a_cfl > 0.0);
+
+  m_maxTimeStepClass = a_maxClass;
+  m_timeStepCFL = a_cfl;
+
+  if (m_isDefined && (m_maxTimeStepClass > 0))
+    {
+      defineLocalTimeStepping();
+    }
+}
+
+// Define the storage used by local time stepping
+void LevelGodunov::defineLocalTimeStepping()
+{
+  CH_TIME("LevelGodunov::defineLocalTimeStepping");
+
+  m_UOld.define(m_grids,m_numCons);
+  m_UGhost.define(m_grids,m_numCons,m_numGhost*IntVect::Unit);
+  m_classMap.define(m_grids,1,IntVect::Unit);
+  m_classCorrection.define(m_grids,m_numCons,IntVect::Unit);
+
+  m_classCopier.exchangeDefine(m_grids,IntVect::Unit);
+  m_classReverseCopier = m_classCopier;
+  m_classReverseCopier.reverse();
+}
+
+// Minimum and maximum of the box wave speeds over all processors
+void LevelGodunov::globalSpeedRange(Real&               a_minSpeed,
+                                    Real&               a_maxSpeed,
+                                    const Vector<Real>& a_speeds) const
+{
+  // Use to restrict wave speeds away from zero
+  const Real smallSpeed = 1.0e-12;
+
+  // The maximum is reduced as the minimum of its negative so that a single
+  // reduction suffices
+  Real localRange[2];
+  localRange[0] =  1.0e300;
+  localRange[1] = -smallSpeed;
+  for (int ibox = 0; ibox < a_speeds.size(); ibox++)
+    {
+      Real speed = Max(a_speeds[ibox],smallSpeed);
+      localRange[0] = Min(localRange[0], speed);
+      localRange[1] = Min(localRange[1],-speed);
+    }
+
+  Real range[2];
+#ifdef CH_MPI
+  int result = MPI_Allreduce(localRange, range, 2, MPI_CH_REAL,
+                             MPI_MIN, Chombo_MPI::comm);
+  if (result != MPI_SUCCESS)
+    {
+      MayDay::Error("LevelGodunov::globalSpeedRange: MPI communcation error");
+    }
+#else
+  range[0] = localRange[0];
+  range[1] = localRange[1];
+#endif
+
+  a_maxSpeed = -range[1];
+  a_minSpeed = Min(range[0],a_maxSpeed);
+}
+
+// The wave speed that sets the time step of class 0: the slowest box takes
+// one step unless the fastest box would then need more than
+// 2^m_maxTimeStepClass substeps
+Real LevelGodunov::referenceSpeed(const Real& a_minSpeed,
+                                  const Real& a_maxSpeed) const
+{
+  return Max(a_minSpeed, a_maxSpeed / (1 << m_maxTimeStepClass));
+}
+
+// Assign a time step class to each box from the wave speeds in "a_U" and
+// return the largest class over all boxes.  A box of class k takes
+// substeps of a_dt/2^k, so its class is the smallest k for which that
+// substep is within its own CFL limit, m_timeStepCFL*m_dx/speed.
+int LevelGodunov::assignTimeStepClasses(const LevelData<FArrayBox>& a_U,
+                                        const Real&                 a_dt)
+{
+  CH_TIME("LevelGodunov::assignTimeStepClasses");
+
+  DataIterator dit = m_grids.dataIterator();
+  int nbox = dit.size();
+
+  Vector<Real> speeds(nbox, 0.0);
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
+    {
+      speeds[ibox] = m_patchGodunov[dit[ibox]].getGodunovPhysicsPtr()
+        ->getMaxWaveSpeed(a_U[dit[ibox]], m_grids[dit[ibox]]);
+    }
+
+  Real minSpeed;
+  Real maxSpeed;
+  globalSpeedRange(minSpeed,maxSpeed,speeds);
+
+  // Allow for roundoff in the comparison with the CFL limit
+  const Real maxCFL = (1.0 + 1.0e-10) * m_timeStepCFL;
+
+  // The largest class is computed from the global maximum so that all
+  // processors agree on it
+  int maxClass = 0;
+  while ((maxClass < m_maxTimeStepClass) &&
+         (a_dt * maxSpeed / m_dx > maxCFL * (1 << maxClass)))
+    {
+      maxClass++;
+    }
+
+  for (int ibox = 0; ibox < nbox; ibox++)
+    {
+      int boxClass = 0;
+      while ((boxClass < maxClass) &&
+             (a_dt * speeds[ibox] / m_dx > maxCFL * (1 << boxClass)))
+        {
+          boxClass++;
+        }
+      m_boxClass[dit[ibox]] = boxClass;
+    }
+
+  return maxClass;
+}
+
+// Add the flux corrections at faces between a box of class "a_class" and
+// boxes of other classes to "a_dU".  For such a face, the update of the
+// lower class box must use the sum over the substeps of the higher class
+// box instead of its own flux.  The lower class box subtracts its own
+// contribution and the higher class box adds each of its substeps, all in
+// the cell on the lower class side.  a_dU has one ghost cell which takes
+// the contributions to neighboring boxes.
+void LevelGodunov::incrementClassCorrection(FArrayBox&       a_dU,
+                                            const FArrayBox& a_classMap,
+                                            const FluxBox&   a_flux,
+                                            const int&       a_class,
+                                            const Real&      a_dt,
+                                            const Box&       a_box) const
+{
+  for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      const FArrayBox& flux = a_flux[idir];
+
+      SideIterator sit;
+      for (sit.begin(); sit.ok(); ++sit)
+        {
+          const Side::LoHiSide side = sit();
+          const int isign = sign(side);
+
+          // Cells just outside the box on this side, the face between a
+          // cell and the box, and the cell inside the box
+          const IntVect faceShift = (side == Side::Lo) ? BASISV(idir)
+                                                       : IntVect::Zero;
+          const IntVect inShift = -isign*BASISV(idir);
+          const Real scale = isign * a_dt / m_dx;
+
+          Box ghostBox = adjCellBox(a_box, idir, side, 1);
+          BoxIterator bit(ghostBox);
+          for (bit.begin(); bit.ok(); ++bit)
+            {
+              const IntVect& iv = bit();
+              int neighborClass = (int) a_classMap(iv,0);
+
+              // No box of this level or the same class
+              if ((neighborClass < 0) || (neighborClass == a_class))
+                {
+                  continue;
+                }
+
+              const IntVect cell = (neighborClass < a_class) ? iv
+                                                             : iv + inShift;
+              const IntVect face = iv + faceShift;
+              for (int comp = 0; comp < m_numCons; comp++)
+                {
+                  a_dU(cell,comp) += scale * flux(face,comp);
+                }
+            }
+        }
+    }
+}
+
+// Fill the ghost cells of "a_U" outside this level by space and time
+// interpolation from the next coarser level at time "a_time"
+void LevelGodunov::fillCoarseGhosts(LevelData<FArrayBox>&       a_U,
+                                    const LevelData<FArrayBox>& a_UCoarseOld,
+                                    const Real&                 a_TCoarseOld,
+                                    const LevelData<FArrayBox>& a_UCoarseNew,
+                                    const Real&                 a_TCoarseNew,
+                                    const Real&                 a_time,
+                                    const Real&                 a_dt)
+{
+  CH_assert(m_hasCoarser);
+
+  // Fraction "a_time" falls between the old and the new coarse times
+  Real alpha = (a_time - a_TCoarseOld) / (a_TCoarseNew - a_TCoarseOld);
+
+  // Truncate the fraction to the range [0,1] to remove floating-point
+  // subtraction roundoff effects
+  Real eps = 0.04 * a_dt / m_refineCoarse;
+
+  if (Abs(alpha) < eps)
+    {
+      alpha = 0.0;
+    }
+
+  if (Abs(1.0-alpha) < eps)
+    {
+      alpha = 1.0;
+    }
+
+  // Current time before old coarse time
+  if (alpha < 0.0)
+    {
+      MayDay::Error( "LevelGodunov::step: alpha < 0.0");
+    }
+
+  // Current time after new coarse time
+  if (alpha > 1.0)
+    {
+      MayDay::Error( "LevelGodunov::step: alpha > 1.0");
+    }
+
+  // Interpolate ghost cells from next coarser level using both space
+  // and time interpolation
+  m_patcher.fillInterp(a_U,
+                       a_UCoarseOld,
+                       a_UCoarseNew,
+                       alpha,
+                       0,0,m_numCons);
+}
+
+// Advance the solution by "a_dt" with local time stepping.  The step is
+// divided into 2^a_maxClass substeps of the finest class.  At the start of
+// each substep, the classes whose steps start there are advanced in order
+// of increasing class (coarse first, as for AMR subcycling) so that higher
+// classes can interpolate their ghost cells in time from lower classes.
+// At the end of each substep, the flux corrections are applied to the
+// classes whose steps end there.
+Real LevelGodunov::stepLocal(LevelData<FArrayBox>&       a_U,
+                             LevelFluxRegister&          a_finerFluxRegister,
+                             LevelFluxRegister&          a_coarserFluxRegister,
+                             const LevelData<FArrayBox>& a_S,
+                             const LevelData<FArrayBox>& a_UCoarseOld,
+                             const Real&                 a_TCoarseOld,
+                             const LevelData<FArrayBox>& a_UCoarseNew,
+                             const Real&                 a_TCoarseNew,
+                             const Real&                 a_time,
+                             const Real&                 a_dt,
+                             const int&                  a_maxClass)
+{
+  CH_TIME("LevelGodunov::stepLocal");
+
+  CH_assert(a_maxClass > 0);
+  CH_assert(a_maxClass <= m_maxTimeStepClass);
+
+  // Clear flux registers with next finer level
+  if (m_hasFiner)
+    {
+      a_finerFluxRegister.setToZero();
+    }
+
+  // Setup an interval corresponding to the conserved variables
+  Interval UInterval(0,m_numCons-1);
+  DataIterator dit = m_grids.dataIterator();
+  int nbox = dit.size();
+
+  // Number and size of the substeps of the highest class
+  const int numSubsteps = 1 << a_maxClass;
+  const Real dtSubstep = a_dt / numSubsteps;
+
+  // Mark each cell with the class of its box, -1 if not covered by this level
+  for (int ibox = 0; ibox < nbox; ibox++)
+    {
+      const DataIndex& datind = dit[ibox];
+      m_classMap[datind].setVal(-1.0);
+      m_classMap[datind].setVal((Real) m_boxClass[datind],m_grids[datind],0);
+
+      m_U[datind].copy(a_U[datind]);
+      m_UOld[datind].copy(a_U[datind]);
+      m_classCorrection[datind].setVal(0.0);
+    }
+  m_classMap.exchange(m_classMap.interval(),m_classCopier);
+
+  Vector<Real> speeds(nbox, 0.0);
+
+  for (int isub = 0; isub < numSubsteps; isub++)
+    {
+      const Real time = a_time + isub*dtSubstep;
+
+      for (int iclass = 0; iclass <= a_maxClass; iclass++)
+        {
+          // Number of highest class substeps per step of this class
+          const int stride = numSubsteps >> iclass;
+          if (isub % stride != 0)
+            {
+              continue;
+            }
+          const Real dtClass = stride*dtSubstep;
+
+          // Boxes of lower classes have already advanced past "time", so
+          // their values are interpolated in time between the start and the
+          // end of their current step.  All other boxes are at "time".
+          for (int ibox = 0; ibox < nbox; ibox++)
+            {
+              const DataIndex& datind = dit[ibox];
+              const Box& curBox = m_grids[datind];
+              FArrayBox& curUGhost = m_UGhost[datind];
+              const int boxClass = m_boxClass[datind];
+
+              curUGhost.copy(m_U[datind],curBox);
+              if (boxClass < iclass)
+                {
+                  const int boxStride = numSubsteps >> boxClass;
+                  const Real boxStart = a_time + (isub/boxStride)*boxStride*dtSubstep;
+                  const Real weight = (time - boxStart) / (boxStride*dtSubstep);
+
+                  curUGhost.mult(weight,curBox,0,m_numCons);
+                  curUGhost.plus(m_UOld[datind],curBox,curBox,1.0 - weight,
+                                 0,0,m_numCons);
+                }
+            }
+          m_UGhost.exchange(m_exchangeCopier);
+
+          if (m_hasCoarser)
+            {
+              fillCoarseGhosts(m_UGhost,
+                               a_UCoarseOld,a_TCoarseOld,
+                               a_UCoarseNew,a_TCoarseNew,
+                               time,a_dt);
+            }
+
+#pragma omp parallel for
+          for (int ibox = 0; ibox < nbox; ibox++)
+            {
+              const DataIndex& datind = dit[ibox];
+              if (m_boxClass[datind] != iclass)
+                {
+                  continue;
+                }
+
+              const Box& curBox = m_grids[datind];
+              FArrayBox& curU = m_UGhost[datind];
+
+              // The current source terms if they exist
+              FArrayBox zeroSource;
+              const FArrayBox* source = &zeroSource;
+              if (a_S.isDefined())
+                {
+                  source = &a_S[datind];
+                }
+
+              // The state at the start of this box's step
+              m_UOld[datind].copy(m_U[datind]);
+
+              FluxBox flux;
+              Real maxWaveSpeedGrid;
+
+              m_patchGodunov[datind].setCurrentTime(time);
+              m_patchGodunov[datind].updateState(curU,
+                                                 flux,
+                                                 maxWaveSpeedGrid,
+                                                 *source,
+                                                 dtClass,
+                                                 curBox);
+
+              speeds[ibox] = Max(speeds[ibox],maxWaveSpeedGrid);
+              m_U[datind].copy(curU,curBox);
+
+              // Fluxes at faces between classes
+              incrementClassCorrection(m_classCorrection[datind],
+                                       m_classMap[datind],
+                                       flux,
+                                       iclass,
+                                       dtClass,
+                                       curBox);
+
+              // Do flux register updates with the substep fluxes
+              for (int idir = 0; idir < SpaceDim; idir++)
+                {
+                  if (m_hasFiner)
+                    {
+                      a_finerFluxRegister.incrementCoarse(flux[idir],dtClass,
+                                                          datind,
+                                                          UInterval,
+                                                          UInterval,idir);
+                    }
+
+                  if (m_hasCoarser)
+                    {
+                      a_coarserFluxRegister.incrementFine(flux[idir],dtClass,
+                                                          datind,
+                                                          UInterval,
+                                                          UInterval,idir);
+                    }
+                }
+            }
+        }
+
+      // Move the corrections deposited in ghost cells to the boxes they
+      // belong to
+      m_classCorrection.exchange(UInterval,
+                                 m_classReverseCopier,
+                                 LDaddOp<FArrayBox>());
+
+      // Apply the corrections to the classes whose step ends here
+      for (int ibox = 0; ibox < nbox; ibox++)
+        {
+          const DataIndex& datind = dit[ibox];
+          const Box& curBox = m_grids[datind];
+          FArrayBox& correction = m_classCorrection[datind];
+
+          for (int idir = 0; idir < SpaceDim; idir++)
+            {
+              correction.setVal(0.0,adjCellLo(curBox,idir,1),0,m_numCons);
+              correction.setVal(0.0,adjCellHi(curBox,idir,1),0,m_numCons);
+            }
+
+          const int boxStride = numSubsteps >> m_boxClass[datind];
+          if ((isub+1) % boxStride == 0)
+            {
+              m_U[datind].plus(correction,curBox,0,0,m_numCons);
+              correction.setVal(0.0);
+            }
+        }
+    }
+
+  for (int ibox = 0; ibox < nbox; ibox++)
+    {
+      a_U[dit[ibox]].copy(m_U[dit[ibox]],m_grids[dit[ibox]]);
+    }
+
+  // The next time step is that of class 0
+  Real minSpeed;
+  Real maxSpeed;
+  globalSpeedRange(minSpeed,maxSpeed,speeds);
+
+  return m_dx / referenceSpeed(minSpeed,maxSpeed);
+}
+
 void LevelGodunov::highOrderLimiter(bool a_highOrderLimiter)
 {
   CH_assert(m_isDefined);
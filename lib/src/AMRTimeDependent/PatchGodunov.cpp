@@ -9,6 +9,7 @@
 #endif
 
 #include "LoHiSide.H"
+#include "CH_Timer.H"
 
 #include "PatchGodunov.H"
 #include "NamespaceHeader.H"
@@ -104,6 +105,7 @@ void PatchGodunov::updateState(FArrayBox&       a_U,
                                const Real&      a_dt,
                                const Box&       a_box)
 {
+  CH_TIME("PatchGodunov::updateState");
   CH_assert(isDefined());
   CH_assert(a_box == m_currentBox);
 
@@ -125,6 +127,8 @@ void PatchGodunov::updateState(FArrayBox&       a_U,
 
   // Get and return the maximum wave speed on this patch/grid
   a_maxWaveSpeed = m_gdnvPhysics->getMaxWaveSpeed(a_U, m_currentBox);
+
+  countBytes(a_U, numFlux, a_S, a_box);
 }
 
 void PatchGodunov::updateState(FArrayBox&       a_U,
@@ -135,6 +139,7 @@ void PatchGodunov::updateState(FArrayBox&       a_U,
                                const Real&      a_dt,
                                const Box&       a_box)
 {
+  CH_TIME("PatchGodunov::updateState");
   CH_assert(isDefined());
   CH_assert(a_box == m_currentBox);
 
@@ -155,6 +160,27 @@ void PatchGodunov::updateState(FArrayBox&       a_U,
 
   // Get and return the maximum wave speed on this patch/grid
   a_maxWaveSpeed = m_gdnvPhysics->getMaxWaveSpeed(a_U, m_currentBox);
+
+  countBytes(a_U, numFlux, a_S, a_box);
+}
+
+// State the memory traffic of updateState() for the kernel performance
+// report: the state with ghost cells and the source are read, and the
+// valid state and the fluxes are written.  The flops depend on the
+// physics and are left to it.  Called inside the updateState() timer,
+// on the thread that did the update, so the traffic is charged to it.
+void PatchGodunov::countBytes(const FArrayBox& a_U,
+                              const int&       a_numFlux,
+                              const FArrayBox& a_S,
+                              const Box&       a_box) const
+{
+  long long int words = a_U.nComp()*(a_U.box().numPts() + a_box.numPts())
+                      + a_S.nComp()*a_S.box().numPts();
+  for (int dir = 0; dir < SpaceDim; ++dir)
+    {
+      words += a_numFlux*surroundingNodes(a_box,dir).numPts();
+    }
+  CH_BYTES(words*sizeof(Real));
 }
 
 // Compute the time-centered values of the primitive variable on the
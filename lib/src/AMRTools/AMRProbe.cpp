@@ -0,0 +1,616 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include <cmath>
+#include <cstdio>
+#include "AMRProbe.H"
+#include "SPMD.H"
+#include "CH_HDF5.H"
+#include "NamespaceHeader.H"
+
+Real AMRProbe::s_missingValue = 1.0e30;
+
+#ifdef CH_USE_HDF5
+// target size of a chunk of a time series dataset, in bytes
+static const hsize_t s_chunkBytes = 1 << 20;
+#endif
+
+AMRProbe::AMRProbe()
+  :
+  m_isDefined(false),
+  m_dxCoarse(0.0),
+  m_origin(RealVect::Zero),
+  m_setStarts(1, 0),
+  m_stencilsValid(false)
+{
+}
+
+AMRProbe::AMRProbe(const ProblemDomain& a_domain,
+                   Real                 a_dxCoarse,
+                   const RealVect&      a_origin)
+  :
+  m_isDefined(false),
+  m_setStarts(1, 0),
+  m_stencilsValid(false)
+{
+  define(a_domain, a_dxCoarse, a_origin);
+}
+
+AMRProbe::~AMRProbe()
+{
+}
+
+void AMRProbe::define(const ProblemDomain& a_domain,
+                      Real                 a_dxCoarse,
+                      const RealVect&      a_origin)
+{
+  CH_assert(a_dxCoarse > 0);
+  m_domain   = a_domain;
+  m_dxCoarse = a_dxCoarse;
+  m_origin   = a_origin;
+  m_isDefined = true;
+  invalidate();
+}
+
+void AMRProbe::addPoint(const std::string& a_name,
+                        const RealVect&    a_point)
+{
+  addSet(a_name, Vector<RealVect>(1, a_point));
+}
+
+void AMRProbe::addLine(const std::string& a_name,
+                       const RealVect&    a_start,
+                       const RealVect&    a_end,
+                       int                a_numPoints)
+{
+  CH_assert(a_numPoints > 0);
+  Vector<RealVect> points(a_numPoints, a_start);
+  for (int i = 1; i < a_numPoints; i++)
+  {
+    Real s = Real(i)/(a_numPoints - 1);
+    points[i] = a_start + s*(a_end - a_start);
+  }
+  addSet(a_name, points);
+}
+
+void AMRProbe::addPlane(const std::string& a_name,
+                        const RealVect&    a_corner,
+                        const RealVect&    a_edge0,
+                        const RealVect&    a_edge1,
+                        int                a_numPoints0,
+                        int                a_numPoints1)
+{
+  CH_assert((a_numPoints0 > 0) && (a_numPoints1 > 0));
+  Vector<RealVect> points;
+  for (int j = 0; j < a_numPoints1; j++)
+  {
+    Real t = (a_numPoints1 > 1) ? Real(j)/(a_numPoints1 - 1) : 0.0;
+    for (int i = 0; i < a_numPoints0; i++)
+    {
+      Real s = (a_numPoints0 > 1) ? Real(i)/(a_numPoints0 - 1) : 0.0;
+      points.push_back(a_corner + s*a_edge0 + t*a_edge1);
+    }
+  }
+  addSet(a_name, points);
+}
+
+int AMRProbe::numPoints() const
+{
+  return m_points.size();
+}
+
+int AMRProbe::numSets() const
+{
+  return m_setNames.size();
+}
+
+const std::string& AMRProbe::setName(int a_set) const
+{
+  return m_setNames[a_set];
+}
+
+int AMRProbe::setStart(int a_set) const
+{
+  return m_setStarts[a_set];
+}
+
+int AMRProbe::setSize(int a_set) const
+{
+  return m_setStarts[a_set+1] - m_setStarts[a_set];
+}
+
+const Vector<RealVect>& AMRProbe::points() const
+{
+  return m_points;
+}
+
+void AMRProbe::invalidate()
+{
+  m_stencilsValid = false;
+  m_grids.resize(0);
+  m_stencils.resize(0);
+}
+
+void AMRProbe::addSet(const std::string&      a_name,
+                      const Vector<RealVect>& a_points)
+{
+  if (!m_isDefined)
+  {
+    MayDay::Error("AMRProbe: define the probe before adding points");
+  }
+  // sets are groups of the time series file, next to "step" and "time"
+  if (a_name.empty() || (a_name.find('/') != std::string::npos) ||
+      (a_name == "step") || (a_name == "time") || (a_name == "Chombo_global"))
+  {
+    MayDay::Error("AMRProbe: bad set name");
+  }
+  for (int iset = 0; iset < m_setNames.size(); iset++)
+  {
+    if (m_setNames[iset] == a_name)
+    {
+      MayDay::Error("AMRProbe: set names must be unique");
+    }
+  }
+
+  const Box& domainBox = m_domain.domainBox();
+  for (int i = 0; i < a_points.size(); i++)
+  {
+    for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      Real lo = m_origin[idir] + domainBox.smallEnd(idir)*m_dxCoarse;
+      Real hi = m_origin[idir] + (domainBox.bigEnd(idir) + 1)*m_dxCoarse;
+      if ((a_points[i][idir] < lo) || (a_points[i][idir] > hi))
+      {
+        MayDay::Error("AMRProbe: point outside the problem domain");
+      }
+    }
+  }
+
+  m_setNames.push_back(a_name);
+  m_points.append(a_points);
+  m_setStarts.push_back(m_points.size());
+  invalidate();
+}
+
+bool AMRProbe::sameGrids(const Vector<DisjointBoxLayout>& a_grids) const
+{
+  if (a_grids.size() != m_grids.size())
+  {
+    return false;
+  }
+  for (int lev = 0; lev < a_grids.size(); lev++)
+  {
+    if (!(a_grids[lev] == m_grids[lev]))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// wraps a_iv into a_domain in the periodic directions and clamps it in
+// the others
+static IntVect
+insideDomain(const IntVect& a_iv, const ProblemDomain& a_domain)
+{
+  const Box& domainBox = a_domain.domainBox();
+  IntVect iv = a_iv;
+  for (int idir = 0; idir < SpaceDim; idir++)
+  {
+    int lo = domainBox.smallEnd(idir);
+    int hi = domainBox.bigEnd(idir);
+    if (a_domain.isPeriodic(idir))
+    {
+      int n = hi - lo + 1;
+      iv[idir] = lo + ((iv[idir] - lo)%n + n)%n;
+    }
+    else
+    {
+      iv[idir] = Max(lo, Min(hi, iv[idir]));
+    }
+  }
+  return iv;
+}
+
+// true if the boxes of a_grids hold every cell of a_entries; the boxes
+// near the stencil are found once through the layout's spatial index
+static bool
+covers(const DisjointBoxLayout&          a_grids,
+       const Vector<ProbeStencilEntry>& a_entries)
+{
+  if (a_entries.size() == 0)
+  {
+    return true;
+  }
+  Box stencilBox(a_entries[0].m_cell, a_entries[0].m_cell);
+  for (int i = 1; i < a_entries.size(); i++)
+  {
+    stencilBox.minBox(Box(a_entries[i].m_cell, a_entries[i].m_cell));
+  }
+  Vector<LayoutIndex> found;
+  a_grids.findIntersecting(found, stencilBox);
+  for (int i = 0; i < a_entries.size(); i++)
+  {
+    bool inside = false;
+    for (int ibox = 0; (ibox < found.size()) && !inside; ibox++)
+    {
+      inside = a_grids[found[ibox]].contains(a_entries[i].m_cell);
+    }
+    if (!inside)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+void AMRProbe::stencil(Vector<ProbeStencilEntry>& a_entries,
+                       int                        a_point,
+                       const ProblemDomain&       a_domain,
+                       Real                       a_dx) const
+{
+  const RealVect& point = m_points[a_point];
+  IntVect base;
+  RealVect frac;
+  for (int idir = 0; idir < SpaceDim; idir++)
+  {
+    Real xi = (point[idir] - m_origin[idir])/a_dx - 0.5;
+    base[idir] = (int)floor(xi);
+    frac[idir] = xi - base[idir];
+  }
+  a_entries.resize(0);
+  for (int corner = 0; corner < (1 << SpaceDim); corner++)
+  {
+    ProbeStencilEntry entry;
+    entry.m_point = a_point;
+    entry.m_cell = base;
+    entry.m_weight = 1.0;
+    for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      if (corner & (1 << idir))
+      {
+        entry.m_cell[idir] += 1;
+        entry.m_weight *= frac[idir];
+      }
+      else
+      {
+        entry.m_weight *= 1.0 - frac[idir];
+      }
+    }
+    if (entry.m_weight > 0)
+    {
+      entry.m_cell = insideDomain(entry.m_cell, a_domain);
+      a_entries.push_back(entry);
+    }
+  }
+}
+
+void AMRProbe::buildStencils(const Vector<DisjointBoxLayout>& a_grids,
+                             const Vector<int>&               a_refRatios)
+{
+  CH_TIME("AMRProbe::buildStencils");
+  int numLevels = a_grids.size();
+  Vector<ProblemDomain> domains(numLevels);
+  Vector<Real> dx(numLevels);
+  if (numLevels > 0)
+  {
+    domains[0] = m_domain;
+    dx[0] = m_dxCoarse;
+  }
+  for (int lev = 1; lev < numLevels; lev++)
+  {
+    CH_assert(a_refRatios.size() >= lev);
+    domains[lev] = refine(domains[lev-1], a_refRatios[lev-1]);
+    dx[lev] = dx[lev-1]/a_refRatios[lev-1];
+  }
+
+  // multilinear stencil of each point on the finest level whose boxes
+  // hold the whole stencil; the cells of a stencil covered by a finer
+  // level hold the average of the finer data, as AMR keeps them
+  Vector<Vector<ProbeStencilEntry> > levelEntries(numLevels);
+  for (int ipt = 0; ipt < m_points.size(); ipt++)
+  {
+    for (int lev = numLevels - 1; lev >= 0; lev--)
+    {
+      Vector<ProbeStencilEntry> entries;
+      stencil(entries, ipt, domains[lev], dx[lev]);
+      if ((lev == 0) || covers(a_grids[lev], entries))
+      {
+        levelEntries[lev].append(entries);
+        break;
+      }
+    }
+  }
+
+  m_grids = a_grids;
+  m_stencils.resize(numLevels);
+  for (int lev = 0; lev < numLevels; lev++)
+  {
+    m_stencils[lev] = RefCountedPtr<LayoutData<Vector<ProbeStencilEntry> > >(
+      new LayoutData<Vector<ProbeStencilEntry> >(a_grids[lev]));
+    // each cell lies in at most one box of a disjoint layout
+    const Vector<ProbeStencilEntry>& entries = levelEntries[lev];
+    Vector<LayoutIndex> found;
+    for (int i = 0; i < entries.size(); i++)
+    {
+      const IntVect& iv = entries[i].m_cell;
+      a_grids[lev].findIntersecting(found, Box(iv, iv));
+      if ((found.size() > 0) && (a_grids[lev].procID(found[0]) == procID()))
+      {
+        (*m_stencils[lev])[DataIndex(found[0])].push_back(entries[i]);
+      }
+    }
+  }
+  m_stencilsValid = true;
+}
+
+void AMRProbe::finishSample(Vector<Real>&       a_values,
+                            const Vector<Real>& a_local,
+                            int                 a_numComps) const
+{
+  CH_TIME("AMRProbe::finishSample");
+  int stride = a_numComps + 1;
+  Vector<Real> sums = a_local;
+#ifdef CH_MPI
+  if (a_local.size() > 0)
+  {
+    Vector<Real> local = a_local;
+    MPI_Reduce(&(local[0]), &(sums[0]), local.size(), MPI_CH_REAL,
+               MPI_SUM, 0, Chombo_MPI::comm);
+  }
+#endif
+
+  a_values.resize(0);
+  if (procID() != 0)
+  {
+    return;
+  }
+  a_values.resize(numPoints()*a_numComps);
+  for (int ipt = 0; ipt < numPoints(); ipt++)
+  {
+    Real weight = sums[ipt*stride + a_numComps];
+    for (int comp = 0; comp < a_numComps; comp++)
+    {
+      a_values[ipt*a_numComps + comp] = (weight > 0) ?
+        sums[ipt*stride + comp]/weight : s_missingValue;
+    }
+  }
+}
+
+#ifdef CH_USE_HDF5
+
+static hid_t
+openProbeDataset(hid_t a_loc, const std::string& a_name)
+{
+#ifdef H516
+  return H5Dopen(a_loc, a_name.c_str());
+#else
+  return H5Dopen2(a_loc, a_name.c_str(), H5P_DEFAULT);
+#endif
+}
+
+// a dataset of a_rank dimensions with no rows yet, each row a_rowDims
+// (a_rank-1 dimensions), chunked along the rows
+static int
+createSeriesDataset(hid_t          a_loc,
+                    const char*    a_name,
+                    hid_t          a_type,
+                    int            a_rank,
+                    const hsize_t* a_rowDims)
+{
+  hsize_t dims[3], maxDims[3], chunk[3];
+  hsize_t rowSize = H5Tget_size(a_type);
+  for (int i = 1; i < a_rank; i++)
+  {
+    dims[i] = maxDims[i] = chunk[i] = Max(a_rowDims[i-1], (hsize_t)1);
+    rowSize *= chunk[i];
+  }
+  dims[0] = 0;
+  maxDims[0] = H5S_UNLIMITED;
+  chunk[0] = Max(s_chunkBytes/rowSize, (hsize_t)1);
+
+  hid_t space = H5Screate_simple(a_rank, dims, maxDims);
+  hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+  H5Pset_chunk(dcpl, a_rank, chunk);
+#ifdef H516
+  hid_t dataset = H5Dcreate(a_loc, a_name, a_type, space, dcpl);
+#else
+  hid_t dataset = H5Dcreate2(a_loc, a_name, a_type, space,
+                             H5P_DEFAULT, dcpl, H5P_DEFAULT);
+#endif
+  H5Pclose(dcpl);
+  H5Sclose(space);
+  if (dataset < 0)
+  {
+    return 2;
+  }
+  H5Dclose(dataset);
+  return 0;
+}
+
+// adds one row to a dataset made by createSeriesDataset
+static int
+appendRow(hid_t              a_loc,
+          const std::string& a_name,
+          hid_t              a_type,
+          const void*        a_row,
+          hsize_t            a_rowSize)
+{
+  hid_t dataset = openProbeDataset(a_loc, a_name);
+  if (dataset < 0)
+  {
+    return 2;
+  }
+  hid_t space = H5Dget_space(dataset);
+  int rank = H5Sget_simple_extent_ndims(space);
+  hsize_t dims[3];
+  H5Sget_simple_extent_dims(space, dims, NULL);
+  H5Sclose(space);
+  hsize_t count[3];
+  count[0] = 1;
+  hsize_t size = 1;
+  for (int i = 1; i < rank; i++)
+  {
+    count[i] = dims[i];
+    size *= dims[i];
+  }
+  if (size != a_rowSize)
+  {
+    H5Dclose(dataset);
+    return 1;
+  }
+
+  ch_offset_t offset[3] = {0, 0, 0};
+  offset[0] = dims[0];
+  dims[0] += 1;
+  H5Dset_extent(dataset, dims);
+  space = H5Dget_space(dataset);
+  H5Sselect_hyperslab(space, H5S_SELECT_SET, offset, NULL, count, NULL);
+  hid_t memSpace = H5Screate_simple(rank, count, NULL);
+  herr_t err = H5Dwrite(dataset, a_type, memSpace, space, H5P_DEFAULT, a_row);
+  H5Sclose(memSpace);
+  H5Sclose(space);
+  H5Dclose(dataset);
+  return (err < 0) ? 3 : 0;
+}
+
+int AMRProbe::createTimeSeries(const std::string&         a_filename,
+                               const Vector<std::string>& a_compNames) const
+{
+  CH_TIME("AMRProbe::createTimeSeries");
+  if (procID() != 0)
+  {
+    return 0;
+  }
+  HDF5Handle handle;
+  int err = handle.open(a_filename, HDF5Handle::CREATE_SERIAL);
+  if (err < 0)
+  {
+    return err;
+  }
+
+  int numComps = a_compNames.size();
+  HDF5HeaderData header;
+  header.m_int["num_components"] = numComps;
+  for (int comp = 0; comp < numComps; comp++)
+  {
+    char compName[64];
+    sprintf(compName, "component_%d", comp);
+    header.m_string[compName] = a_compNames[comp];
+  }
+  header.m_int["num_sets"] = numSets();
+  for (int iset = 0; iset < numSets(); iset++)
+  {
+    char setLabel[64];
+    sprintf(setLabel, "set_%d", iset);
+    header.m_string[setLabel] = m_setNames[iset];
+  }
+  header.m_real["dx"] = m_dxCoarse;
+  header.m_realvect["origin"] = m_origin;
+  header.m_box["prob_domain"] = m_domain.domainBox();
+  header.writeToFile(handle);
+
+  err = createSeriesDataset(handle.groupID(), "step", H5T_NATIVE_INT, 1, NULL);
+  err = Max(err, createSeriesDataset(handle.groupID(), "time", H5T_NATIVE_REAL, 1, NULL));
+  for (int iset = 0; (iset < numSets()) && (err == 0); iset++)
+  {
+    handle.setGroup("/" + m_setNames[iset]);
+
+    hsize_t dims[2];
+    dims[0] = setSize(iset);
+    dims[1] = SpaceDim;
+    hid_t space = H5Screate_simple(2, dims, NULL);
+#ifdef H516
+    hid_t dataset = H5Dcreate(handle.groupID(), "points", H5T_NATIVE_REAL,
+                              space, H5P_DEFAULT);
+#else
+    hid_t dataset = H5Dcreate2(handle.groupID(), "points", H5T_NATIVE_REAL,
+                               space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+#endif
+    Vector<Real> coords(setSize(iset)*SpaceDim);
+    for (int i = 0; i < setSize(iset); i++)
+    {
+      for (int idir = 0; idir < SpaceDim; idir++)
+      {
+        coords[i*SpaceDim + idir] = m_points[setStart(iset) + i][idir];
+      }
+    }
+    if ((dataset < 0) ||
+        (H5Dwrite(dataset, H5T_NATIVE_REAL, H5S_ALL, H5S_ALL, H5P_DEFAULT,
+                  &(coords[0])) < 0))
+    {
+      err = 2;
+    }
+    if (dataset >= 0)
+    {
+      H5Dclose(dataset);
+    }
+    H5Sclose(space);
+
+    hsize_t rowDims[2];
+    rowDims[0] = setSize(iset);
+    rowDims[1] = numComps;
+    err = Max(err, createSeriesDataset(handle.groupID(), "data",
+                                       H5T_NATIVE_REAL, 3, rowDims));
+  }
+  handle.close();
+  return err;
+}
+
+int AMRProbe::appendTimeSeries(const std::string&  a_filename,
+                               int                 a_step,
+                               Real                a_time,
+                               const Vector<Real>& a_values) const
+{
+  CH_TIME("AMRProbe::appendTimeSeries");
+  if (procID() != 0)
+  {
+    return 0;
+  }
+  if ((numPoints() == 0) || (a_values.size()%numPoints() != 0))
+  {
+    return 1;
+  }
+  int numComps = a_values.size()/numPoints();
+
+  // the file is opened for each row so that it is complete whenever the
+  // run stops
+  hid_t file = H5Fopen(a_filename.c_str(), H5F_ACC_RDWR, H5P_DEFAULT);
+  if (file < 0)
+  {
+    return file;
+  }
+  int err = appendRow(file, "step", H5T_NATIVE_INT, &a_step, 1);
+  err = Max(err, appendRow(file, "time", H5T_NATIVE_REAL, &a_time, 1));
+  for (int iset = 0; (iset < numSets()) && (err == 0); iset++)
+  {
+    err = appendRow(file, m_setNames[iset] + "/data", H5T_NATIVE_REAL,
+                    &(a_values[setStart(iset)*numComps]),
+                    setSize(iset)*numComps);
+  }
+  H5Fclose(file);
+  return err;
+}
+
+#endif // CH_USE_HDF5
+
+bool probeValue(Real*            a_values,
+                const FArrayBox& a_fab,
+                const IntVect&   a_cell,
+                const Interval&  a_comps)
+{
+  for (int comp = a_comps.begin(); comp <= a_comps.end(); comp++)
+  {
+    a_values[comp - a_comps.begin()] = a_fab(a_cell, comp);
+  }
+  return true;
+}
+
+#include "NamespaceFooter.H"
@@ -268,9 +268,18 @@ void CFIVS::define(const ProblemDomain&     a_domain,
     {
       m_IVS.define(edgebox);
 
-      LayoutIterator lit = a_fineBoxes.layoutIterator();
-      Box periodicTestBox(a_domain.domainBox());
+      // only the fine boxes that meet edgebox matter; the spatial
+      // index of the layout finds them
+      Vector<LayoutIndex> found;
+      a_fineBoxes.findIntersecting(found, edgebox);
+      for (int i = 0; i < found.size(); i++)
+        {
+          m_IVS -= a_fineBoxes[found[i]];
+        }
 
+      // only do this IF we're periodic _and_ edgebox
+      // adjoins the domain box boundary somewhere
+      Box periodicTestBox(a_domain.domainBox());
       if (a_domain.isPeriodic())
         {
           for (int idir = 0; idir < SpaceDim; idir++)
@@ -280,26 +289,24 @@ void CFIVS::define(const ProblemDomain&     a_domain,
             }
         }
 
-      for (lit.reset(); lit.ok(); ++lit)
+      if (a_domain.isPeriodic() && !periodicTestBox.contains(edgebox))
         {
-          m_IVS -= a_fineBoxes[lit()];
+          ShiftIterator shiftIt = a_domain.shiftIterator();
+          IntVect shiftMult = a_domain.domainBox().size();
 
-          // only do this IF we're periodic _and_ both boxes
-          // adjoin the domain box boundary somewhere
-          if (a_domain.isPeriodic() && !periodicTestBox.contains(edgebox)
-              && !periodicTestBox.contains(a_fineBoxes[lit()]))
+          for (shiftIt.begin(); shiftIt.ok(); ++shiftIt)
             {
-              ShiftIterator shiftIt = a_domain.shiftIterator();
-              IntVect shiftMult = a_domain.domainBox().size();
-              Box shiftedBox = a_fineBoxes[lit()];
+              IntVect shiftVect(shiftMult*shiftIt());
 
-              for (shiftIt.begin(); shiftIt.ok(); ++shiftIt)
+              // fine boxes whose image under this shift meets edgebox
+              Box query(edgebox);
+              query.shift(-shiftVect);
+              a_fineBoxes.findIntersecting(found, query);
+              for (int i = 0; i < found.size(); i++)
                 {
-                  IntVect shiftVect(shiftMult*shiftIt());
-
+                  Box shiftedBox = a_fineBoxes[found[i]];
                   shiftedBox.shift(shiftVect);
                   m_IVS -= shiftedBox;
-                  shiftedBox.shift(-shiftVect);
                 }
             }
         }
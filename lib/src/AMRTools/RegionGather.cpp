@@ -76,47 +76,46 @@ void RegionGather::define(const ProblemDomain& a_domain,
   m_local.define(a_layout);
 
   DataIterator dit = a_layout.dataIterator();
-  LayoutIterator lit = a_layout.layoutIterator();
+  Vector<LayoutIndex> found;
 
   for (dit.begin(); dit.ok(); ++dit)
     {
       const Box& b = a_layout.get(dit());
       IntVect center = (b.smallEnd()+b.bigEnd());
       center /= 2;
-      int w1 = center[0] - a_radius; //moving window optimization
-      int w2 = center[0] + a_radius;
       Vector<RegionGather::Message>& messages =  m_messages[dit];
       Vector<RegionGather::Message>& local    =  m_local[dit];
       int proc = a_layout.procID(dit());
-      for (lit.begin(); lit.ok(); ++lit)
+
+      // a box whose center is within a_radius contains that center, so it
+      // meets this window
+      Box window(center - a_radius*IntVect::Unit, center + a_radius*IntVect::Unit, b.type());
+      a_layout.findIntersecting(found, window);
+      for (int ibox = 0; ibox < found.size(); ++ibox)
         {
-          const Box& box = a_layout.get(lit());
-          if (box.bigEnd()[0] >= w1)
+          const LayoutIndex& lindex = found[ibox];
+          const Box& box = a_layout.get(lindex);
+          IntVect distance = (box.smallEnd()+box.bigEnd());
+          distance /= 2;
+          distance = center - distance;
+          bool connected = true;
+          for (int i=0; i<CH_SPACEDIM; ++i)
+          {
+            if (Abs(distance[i]) > a_radius) connected = false;
+          }
+          if (connected)
             {
-              IntVect distance = (box.smallEnd()+box.bigEnd());
-              distance /= 2;
-              distance = center - distance;
-              bool connected = true;
-              for (int i=0; i<CH_SPACEDIM; ++i)
-              {
-                if (Abs(distance[i]) > a_radius) connected = false;
-              }
-              if (connected)
-                {
-                  RegionGather::Message arc;
-                  arc.distance = distance;
-                  arc.src = dit().intCode();
-                  arc.dest= lit().intCode();
-                  arc.srcIndex  = dit();
-                  arc.destIndex = DataIndex(lit());
-                  arc.procID = a_layout.procID(lit());
-                  if (arc.procID != proc)
-                    messages.push_back(arc);
-                  else
-                    local.push_back(arc);
-                }
-
-              if (box.smallEnd()[0] > w2) lit.end();
+              RegionGather::Message arc;
+              arc.distance = distance;
+              arc.src = dit().intCode();
+              arc.dest= lindex.intCode();
+              arc.srcIndex  = dit();
+              arc.destIndex = DataIndex(lindex);
+              arc.procID = a_layout.procID(lindex);
+              if (arc.procID != proc)
+                messages.push_back(arc);
+              else
+                local.push_back(arc);
             }
         }
       messages.sort();
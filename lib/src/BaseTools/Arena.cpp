@@ -19,6 +19,7 @@ using std::pair;
 //#include "memtrack.H"
 #include "Arena.H"
 #include "MayDay.H"
+#include "CH_Thread.H"
 #include "BaseNamespaceHeader.H"
 
 // DON'T include memtrack.H here, we track Arena allocation
@@ -110,6 +111,392 @@ void BArena::free(void* a_pt)
   ::free(a_pt);
 }
 
+//
+// PArena
+//
+
+// -1 until the environment has been read
+static int s_poolingEnv = -1;
+
+bool      PArena::s_pooling        = false;
+long long PArena::s_maxCachedBytes = 256*1024*1024LL;
+int       PArena::s_frameDepth     = 0;
+std::vector<PArena*>* PArena::s_arenas = NULL;
+
+// Smallest size class, and the page size used for first touch
+static const size_t s_minClassBytes = 256;
+static const size_t s_pageBytes     = 4096;
+
+static inline int threadNum()
+{
+#ifdef _OPENMP
+  return omp_get_thread_num();
+#else
+  return 0;
+#endif
+}
+
+PArena::PArena(const char* a_name)
+{
+#ifdef CH_USE_MEMORY_TRACKING
+  strncpy(name_, a_name, NSIZE);
+  name_[NSIZE-1]=0;
+#endif
+  initialize();
+}
+
+PArena::PArena(const std::string& a_name)
+{
+#ifdef CH_USE_MEMORY_TRACKING
+  strncpy(name_, a_name.c_str(), NSIZE);
+  name_[NSIZE-1]=0;
+#endif
+  initialize();
+}
+
+void PArena::initialize()
+{
+  m_heldBytes     = 0;
+  m_peakHeldBytes = 0;
+  m_frameStart    = 0;
+  m_frameLeftover = 0;
+
+  // One extra cache, shared by the threads outside the range
+  int numThreads = getMaxThreads();
+  m_caches.resize(numThreads + 1);
+  for (int i = 0; i <= numThreads; i++)
+    {
+      m_caches[i] = new ThreadCache;
+      m_caches[i]->m_cachedBytes = 0;
+      m_caches[i]->m_allocs = 0;
+      m_caches[i]->m_frees  = 0;
+      m_caches[i]->m_hits   = 0;
+      m_caches[i]->m_misses = 0;
+    }
+
+#pragma omp critical (PArena_list)
+  {
+    if (s_arenas == NULL)
+      {
+        s_arenas = new std::vector<PArena*>;
+      }
+    s_arenas->push_back(this);
+  }
+}
+
+PArena::~PArena()
+{
+  release();
+  for (int i = 0; i < m_caches.size(); i++)
+    {
+      delete m_caches[i];
+    }
+
+#pragma omp critical (PArena_list)
+  {
+    for (int i = 0; i < s_arenas->size(); i++)
+      {
+        if ((*s_arenas)[i] == this)
+          {
+            s_arenas->erase(s_arenas->begin() + i);
+            break;
+          }
+      }
+  }
+}
+
+size_t PArena::classBytes(int a_class)
+{
+  CH_assert((a_class >= 0) && (a_class < NumClasses));
+  if (a_class == 0)
+    {
+      return s_minClassBytes;
+    }
+  int k = 8 + (a_class - 1)/4;
+  int j = (a_class - 1)%4 + 1;
+  return ((size_t)1 << k) + j*((size_t)1 << (k - 2));
+}
+
+int PArena::sizeClass(size_t a_bytes)
+{
+  if (a_bytes <= s_minClassBytes)
+    {
+      return 0;
+    }
+
+  // 2^k < a_bytes <= 2^(k+1), then a quarter-octave step above 2^k
+  int k = 8;
+  while (((size_t)1 << (k + 1)) < a_bytes)
+    {
+      k++;
+      if (k >= 8 + (NumClasses - 1)/4)
+        {
+          return -1;
+        }
+    }
+  size_t quarter = (size_t)1 << (k - 2);
+  int j = (a_bytes - ((size_t)1 << k) + quarter - 1)/quarter;
+  return 4*(k - 8) + j;
+}
+
+bool PArena::pooling()
+{
+  if (s_poolingEnv < 0)
+    {
+      const char* env = getenv("CH_FAB_POOL");
+      s_pooling = (env != NULL) && (atoi(env) != 0);
+      s_poolingEnv = 1;
+    }
+  return s_pooling;
+}
+
+void PArena::setPooling(bool a_pooling)
+{
+  s_poolingEnv = 1;
+  s_pooling = a_pooling;
+  if (!a_pooling)
+    {
+      releaseAll();
+    }
+}
+
+void PArena::releaseAll()
+{
+  if (s_arenas != NULL)
+    {
+      for (int i = 0; i < s_arenas->size(); i++)
+        {
+          (*s_arenas)[i]->release();
+        }
+    }
+}
+
+void PArena::setMaxCachedBytes(long long a_bytes)
+{
+  s_maxCachedBytes = a_bytes;
+}
+
+long long PArena::maxCachedBytes()
+{
+  return s_maxCachedBytes;
+}
+
+void* PArena::alloc(size_t a_sz)
+{
+  size_t bytes = a_sz + sizeof(Header);
+  int thread = threadNum();
+  int icache = m_caches.size() - 1;
+  bool own = (thread < icache);
+  if (own)
+    {
+      icache = thread;
+      m_caches[icache]->m_allocs++;
+    }
+  else
+    {
+#pragma omp atomic
+      m_caches[icache]->m_allocs++;
+    }
+
+  int c = pooling() ? sizeClass(bytes) : -1;
+  if (c < 0)
+    {
+      return systemAlloc(bytes, -1);
+    }
+
+  if (own)
+    {
+      ThreadCache& cache = *m_caches[icache];
+      std::vector<void*>& list = cache.m_free[c];
+      if (!list.empty())
+        {
+          Header* header = static_cast<Header*>(list.back());
+          list.pop_back();
+          cache.m_cachedBytes -= header->m_bytes;
+          cache.m_hits++;
+          return header + 1;
+        }
+      cache.m_misses++;
+    }
+  else
+    {
+#pragma omp atomic
+      m_caches[icache]->m_misses++;
+    }
+
+  void* block = systemAlloc(classBytes(c), c);
+
+  // First touch by this thread places the pages on its NUMA node
+  char* first = static_cast<char*>(block);
+  for (size_t i = 0; i < classBytes(c) - sizeof(Header); i += s_pageBytes)
+    {
+      first[i] = 0;
+    }
+  return block;
+}
+
+void PArena::free(void* a_pt)
+{
+  if (a_pt == NULL)
+    {
+      return;
+    }
+  Header* header = static_cast<Header*>(a_pt) - 1;
+
+  int thread = threadNum();
+  int icache = m_caches.size() - 1;
+  if (thread < icache)
+    {
+      ThreadCache& cache = *m_caches[thread];
+      cache.m_frees++;
+      if ((header->m_class >= 0) && s_pooling &&
+          (cache.m_cachedBytes + header->m_bytes <= s_maxCachedBytes))
+        {
+          cache.m_free[header->m_class].push_back(header);
+          cache.m_cachedBytes += header->m_bytes;
+          return;
+        }
+    }
+  else
+    {
+#pragma omp atomic
+      m_caches[icache]->m_frees++;
+    }
+  systemFree(header);
+}
+
+void* PArena::systemAlloc(size_t a_bytes, int a_class)
+{
+  Header* header = static_cast<Header*>(malloc(a_bytes));
+  if (header == NULL)
+    {
+      print_memory_line("Out of memory");
+      pout() << " Trying to malloc(" << a_bytes << ") in PArena::alloc()" << std::endl;
+      MayDay::Error("Out of memory in PArena::alloc (BaseFab) ");
+    }
+  header->m_bytes = a_bytes;
+  header->m_class = a_class;
+
+  long long held;
+#pragma omp atomic capture
+  held = m_heldBytes += a_bytes;
+
+  if (held > m_peakHeldBytes)
+    {
+#pragma omp critical (PArena_peak)
+      {
+        if (held > m_peakHeldBytes)
+          {
+            m_peakHeldBytes = held;
+          }
+      }
+    }
+
+  return header + 1;
+}
+
+void PArena::systemFree(Header* a_header)
+{
+  long long bytes = a_header->m_bytes;
+#pragma omp atomic
+  m_heldBytes -= bytes;
+  ::free(a_header);
+}
+
+void PArena::releaseThread(int a_thread)
+{
+  ThreadCache& cache = *m_caches[a_thread];
+  for (int c = 0; c < NumClasses; c++)
+    {
+      std::vector<void*>& list = cache.m_free[c];
+      for (int i = 0; i < list.size(); i++)
+        {
+          systemFree(static_cast<Header*>(list[i]));
+        }
+      std::vector<void*>().swap(list);
+    }
+  cache.m_cachedBytes = 0;
+}
+
+void PArena::release()
+{
+  for (int i = 0; i < m_caches.size(); i++)
+    {
+      releaseThread(i);
+    }
+}
+
+long long PArena::cachedBytes() const
+{
+  long long retval = 0;
+  for (int i = 0; i < m_caches.size(); i++)
+    {
+      retval += m_caches[i]->m_cachedBytes;
+    }
+  return retval;
+}
+
+long long PArena::liveBlocks() const
+{
+  long long retval = 0;
+  for (int i = 0; i < m_caches.size(); i++)
+    {
+      retval += m_caches[i]->m_allocs - m_caches[i]->m_frees;
+    }
+  return retval;
+}
+
+long long PArena::hits() const
+{
+  long long retval = 0;
+  for (int i = 0; i < m_caches.size(); i++)
+    {
+      retval += m_caches[i]->m_hits;
+    }
+  return retval;
+}
+
+long long PArena::misses() const
+{
+  long long retval = 0;
+  for (int i = 0; i < m_caches.size(); i++)
+    {
+      retval += m_caches[i]->m_misses;
+    }
+  return retval;
+}
+
+void PArena::beginFrame()
+{
+  if ((s_frameDepth == 0) && (s_arenas != NULL))
+    {
+      for (int i = 0; i < s_arenas->size(); i++)
+        {
+          (*s_arenas)[i]->m_frameStart = (*s_arenas)[i]->liveBlocks();
+        }
+    }
+  s_frameDepth++;
+}
+
+void PArena::endFrame()
+{
+  CH_assert(s_frameDepth > 0);
+  s_frameDepth--;
+  if ((s_frameDepth == 0) && (s_arenas != NULL))
+    {
+      for (int i = 0; i < s_arenas->size(); i++)
+        {
+          PArena& arena = *(*s_arenas)[i];
+          arena.m_frameLeftover = arena.liveBlocks() - arena.m_frameStart;
+        }
+    }
+}
+
+int PArena::frameDepth()
+{
+  return s_frameDepth;
+}
+
 CArena::CArena(size_t a_hunk_size)
 {
   //
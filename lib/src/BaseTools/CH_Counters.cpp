@@ -19,6 +19,13 @@
 #ifdef _OPENMP
 #include <omp.h>
 #endif
+#ifdef __linux__
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
 
 
 #include "FortranNameMacro.H"
@@ -29,6 +36,12 @@ extern void FORTRAN_BASENAME(FLOPINIT,flopinit)();
 }
 
 long long int ch_counters[NCOUNTERS];
+long long int ch_flopCount = 0;
+long long int ch_byteCount = 0;
+#ifdef _OPENMP
+#pragma omp threadprivate(ch_flopCount, ch_byteCount)
+#endif
+int hwCacheLineSize = 64;
 
 int ch_eventset=0, cacheLevels, cacheSize[3], lineSize[3];
 
@@ -205,4 +218,100 @@ void CountersInit()
 #endif
 }
 
+static bool s_hwCountersOn = false;
+#ifdef __linux__
+static int s_hwGroupFd = -1;
+#endif
+
+bool hwCountersInit()
+{
+  if (s_hwCountersOn) return true;
+#ifdef __linux__
+  const unsigned long long int config[HW_NCOUNTERS] =
+    {
+      PERF_COUNT_HW_CPU_CYCLES,
+      PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_REFERENCES,
+      PERF_COUNT_HW_CACHE_MISSES
+    };
+
+  // One group so that all counters are scheduled, and read, together
+  int fds[HW_NCOUNTERS];
+  for (int i = 0; i < HW_NCOUNTERS; i++)
+    {
+      struct perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+      attr.size           = sizeof(attr);
+      attr.type           = PERF_TYPE_HARDWARE;
+      attr.config         = config[i];
+      attr.disabled       = (i == 0) ? 1 : 0;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv     = 1;
+      attr.read_format    = PERF_FORMAT_GROUP;
+
+      int groupFd = (i == 0) ? -1 : fds[0];
+      fds[i] = syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0);
+      if (fds[i] < 0)
+        {
+          for (int j = 0; j < i; j++)
+            {
+              close(fds[j]);
+            }
+          return false;
+        }
+    }
+
+  long int lineSize = sysconf(_SC_LEVEL3_CACHE_LINESIZE);
+  if (lineSize > 0)
+    {
+      hwCacheLineSize = lineSize;
+    }
+
+  s_hwGroupFd = fds[0];
+  ioctl(s_hwGroupFd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(s_hwGroupFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  s_hwCountersOn = true;
+#endif
+  return s_hwCountersOn;
+}
+
+bool hwCountersOn()
+{
+  return s_hwCountersOn;
+}
+
+void hwCountersRead(long long int a_values[HW_NCOUNTERS])
+{
+#ifdef __linux__
+  if (s_hwCountersOn)
+    {
+      unsigned long long int buf[1 + HW_NCOUNTERS];
+      if (read(s_hwGroupFd, buf, sizeof(buf)) == (ssize_t)sizeof(buf))
+        {
+          for (int i = 0; i < HW_NCOUNTERS; i++)
+            {
+              a_values[i] = buf[1 + i];
+            }
+          return;
+        }
+    }
+#endif
+  for (int i = 0; i < HW_NCOUNTERS; i++)
+    {
+      a_values[i] = 0;
+    }
+}
+
+const char* hwCounterName(int a_counter)
+{
+  switch (a_counter)
+    {
+    case HW_CYCLES:         return "cycles";
+    case HW_INSTRUCTIONS:   return "instructions";
+    case HW_LLC_REFERENCES: return "LLC references";
+    case HW_LLC_MISSES:     return "LLC misses";
+    default:                return "unknown";
+    }
+}
+
 #include "BaseNamespaceFooter.H"
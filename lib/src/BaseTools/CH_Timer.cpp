@@ -17,6 +17,8 @@
 #include "memusage.H"
 #include <fstream>
 #include <set>
+#include <map>
+#include <algorithm>
 #include <vector>
 #include <cstdio>
 #include "CH_assert.H"
@@ -67,6 +69,7 @@ long long int TraceTimer::s_peak = 0;
 TraceTimer*  TraceTimer::s_peakTimer = NULL;
 bool TraceTimer::s_memorySampling = false;
 bool TraceTimer::s_tracing = false;
+bool TraceTimer::s_hwCounters = false;
 
 static int s_depth = TraceTimer::initializer();
 
@@ -295,6 +298,16 @@ int TraceTimer::initializer()
 //#ifndef CH_MPI
   if (timerEnv != NULL)
    { 
+      TraceEvents::initFromEnvironment();
+      if (getenv("CH_TIMER_COUNTERS") != NULL)
+        {
+          s_hwCounters = hwCountersInit();
+          if (!s_hwCounters)
+            {
+              pout()<<"CH_TIMER_COUNTERS was set, but hardware counters are not available"<<std::endl;
+            }
+          hwCountersRead(rootTimer->m_hwEnter);
+        }
       atexit(writeOnExit);
 #ifndef CH_DISABLE_SIGNALS
       signal(SIGABRT, writeOnAbort);
@@ -439,7 +452,7 @@ void TraceTimer::report(bool a_closeAfter)
   root.currentize();
   // flop-counting breaks multidim
 
-  root.m_flops=ch_flops();
+  root.m_flops=ch_allFlops();
 
   int numCounters = root.computeRank();
 
@@ -502,6 +515,7 @@ void TraceTimer::report(bool a_closeAfter)
         reportOneTree(out, *((*it).val));
       subReport(out, "FORT_", root.m_accumulated_WCtime );
       subReport(out, "MPI_", root.m_accumulated_WCtime );
+      reportKernels(out, root.m_accumulated_WCtime );
 
       TraceTimer* bottom = &root;
       reportFullTree(out, root, root.m_accumulated_WCtime, 0, &bottom); //uses recursion
@@ -509,7 +523,11 @@ void TraceTimer::report(bool a_closeAfter)
               root.m_name, bottom->m_name, ((double)(root.m_name-bottom->m_name))/(1024*1024));
       fprintf(out, "[%d] %s\n", bottom->m_rank, bottom->m_name);
       fflush(out);
-      if (a_closeAfter) fclose(out);
+      if (a_closeAfter)
+        {
+          fclose(out);
+          TraceEvents::writeChromeTraceFile(mpirank);
+        }
     }
 
   if (s_memorySampling && !a_closeAfter) samplingOn = true; // enable sampling again.....
@@ -519,6 +537,167 @@ void TraceTimer::report(bool a_closeAfter)
 #endif
 }
 
+// Add the time (in seconds) and count of a_timer and the timers below it
+// to the totals of their labels
+static void sumByLabel(std::map<std::string, std::pair<double, long long int> >& a_totals,
+                       const TraceTimer& a_timer)
+{
+  if (a_timer.isPruned()) return;
+
+  std::pair<double, long long int>& total = a_totals[a_timer.name()];
+  total.first  += a_timer.time()*secondspertick;
+  total.second += a_timer.count();
+
+  const std::vector<TraceTimer*>& children = a_timer.children();
+  for (int i=0; i<children.size(); i++)
+    {
+      sumByLabel(a_totals, *(children[i]));
+    }
+}
+
+struct rankStats
+{
+  std::string label;
+  double minTime, avgTime, maxTime, avgCount;
+
+  bool operator < (const rankStats& rhs) const
+  {
+    return maxTime > rhs.maxTime;
+  }
+};
+
+void TraceTimer::reportRanks()
+{
+#ifdef _OPENMP
+  if(onThread0()){
+#endif
+  char* timerEnv = getenv("CH_TIMER");
+  if (timerEnv == NULL)
+    {
+      return;
+    }
+
+  TraceTimer& root = *(s_roots[0]);
+  root.currentize();
+
+  double elapsedTime = TimerGetTimeStampWC() - zeroTime;
+  unsigned long long int elapsedTicks = ch_ticks() - zeroTicks;
+  secondspertick = elapsedTime/(double)elapsedTicks;
+
+  // Total time of each label on this rank, one line per label
+  std::map<std::string, std::pair<double, long long int> > totals;
+  sumByLabel(totals, root);
+
+  std::string local;
+  char buf[64];
+  std::map<std::string, std::pair<double, long long int> >::const_iterator it;
+  for (it = totals.begin(); it != totals.end(); ++it)
+    {
+      sprintf(buf, "%.9e %lld ", it->second.first, it->second.second);
+      local += buf;
+      local += it->first;
+      local += '\n';
+    }
+
+  int nproc = 1;
+  int rank  = 0;
+  std::vector<int> lengths(1, local.size());
+  std::vector<int> offsets(1, 0);
+  std::string all = local;
+#ifdef CH_MPI
+  nproc = numProc();
+  rank  = procID();
+  int localLength = local.size();
+  lengths.resize(nproc);
+  offsets.resize(nproc);
+  MPI_Gather(&localLength, 1, MPI_INT, &(lengths[0]), 1, MPI_INT, 0, Chombo_MPI::comm);
+  int totalLength = 0;
+  for (int i=0; i<nproc; i++)
+    {
+      offsets[i] = totalLength;
+      totalLength += lengths[i];
+    }
+  std::vector<char> gathered(totalLength + 1, '\0');
+  MPI_Gatherv((void*)local.c_str(), localLength, MPI_CHAR,
+              &(gathered[0]), &(lengths[0]), &(offsets[0]), MPI_CHAR,
+              0, Chombo_MPI::comm);
+  all.assign(&(gathered[0]), totalLength);
+#endif
+
+  if (rank != 0) return;
+
+  // Time and count of each label on every rank; a rank that never entered
+  // a timer contributes zero
+  std::map<std::string, std::vector<double> > times;
+  std::map<std::string, std::vector<double> > counts;
+  for (int proc=0; proc<nproc; proc++)
+    {
+      size_t pos = offsets[proc];
+      size_t end = offsets[proc] + lengths[proc];
+      while (pos < end)
+        {
+          size_t eol = all.find('\n', pos);
+          std::string line = all.substr(pos, eol - pos);
+          pos = eol + 1;
+
+          double seconds;
+          long long int count;
+          int labelStart = 0;
+          if (sscanf(line.c_str(), "%lf %lld %n", &seconds, &count, &labelStart) < 2)
+            {
+              continue;
+            }
+          std::string label = line.substr(labelStart);
+          std::vector<double>& t = times[label];
+          std::vector<double>& c = counts[label];
+          t.resize(nproc, 0.0);
+          c.resize(nproc, 0.0);
+          t[proc] = seconds;
+          c[proc] = count;
+        }
+    }
+
+  std::vector<rankStats> stats;
+  std::map<std::string, std::vector<double> >::const_iterator tit;
+  for (tit = times.begin(); tit != times.end(); ++tit)
+    {
+      const std::vector<double>& t = tit->second;
+      const std::vector<double>& c = counts[tit->first];
+      rankStats st;
+      st.label   = tit->first;
+      st.minTime = t[0];
+      st.maxTime = t[0];
+      st.avgTime = 0;
+      st.avgCount = 0;
+      for (int proc=0; proc<nproc; proc++)
+        {
+          st.minTime = std::min(st.minTime, t[proc]);
+          st.maxTime = std::max(st.maxTime, t[proc]);
+          st.avgTime += t[proc]/nproc;
+          st.avgCount += c[proc]/nproc;
+        }
+      stats.push_back(st);
+    }
+  std::sort(stats.begin(), stats.end());
+
+  FILE* out = fopen("time.summary", "w");
+  if (out == NULL) return;
+  fprintf(out, "Timer summary over %d ranks (seconds, summed over all calls of a label)\n", nproc);
+  fprintf(out, "%12s %12s %12s %8s %12s  %s\n", "min", "avg", "max", "max/avg", "avg count", "label");
+  for (int i=0; i<stats.size(); i++)
+    {
+      const rankStats& st = stats[i];
+      double imbalance = (st.avgTime > 0) ? st.maxTime/st.avgTime : 1.0;
+      fprintf(out, "%12.5f %12.5f %12.5f %8.2f %12.0f  %s\n",
+              st.minTime, st.avgTime, st.maxTime, imbalance, st.avgCount,
+              st.label.c_str());
+    }
+  fclose(out);
+#ifdef _OPENMP
+  }
+#endif
+}
+
 void TraceTimer::reset()
 {
 #ifdef _OPENMP
@@ -546,6 +725,11 @@ void TraceTimer::reset(TraceTimer& node)
 #endif
   node.m_count = 0;
   node.m_accumulated_WCtime = 0;
+  node.m_bytes = 0;
+  for (int i=0; i<HW_NCOUNTERS; i++)
+    {
+      node.m_hw[i] = 0;
+    }
   for (int i=0; i<node.m_children.size(); i++)
     {
       reset(*(node.m_children[i]));
@@ -629,6 +813,71 @@ void TraceTimer::subReport(FILE* out, const char* header, unsigned long long int
 
 
 
+// Achieved rates of the timers that count flops or bytes, and of all timers
+// above 0.1% of the run if hardware counters are on
+void TraceTimer::reportKernels(FILE* out, unsigned long long int totalTime)
+{
+#ifdef _OPENMP
+  if(onThread0()){
+#endif
+  bool header = false;
+  ListIterator<elem> it(tracerlist);
+  for (it.begin(); it.ok(); ++it)
+    {
+      const TraceTimer& timer = *((*it).val);
+      if (timer.isPruned()) continue;
+
+      unsigned long long int t = timer.time();
+      bool counted = (timer.m_flops > 0) || (timer.m_bytes > 0);
+      bool hot = s_hwCounters && ((double)t > 0.001*totalTime);
+      if ((t == 0) || !(counted || hot)) continue;
+
+      if (!header)
+        {
+          fprintf(out, "=======================================================\n");
+          fprintf(out, " Kernel performance (flops and bytes as stated by the kernels");
+          if (s_hwCounters)
+            {
+              fprintf(out, ";\n IPC and miss GB/s = %d bytes per LLC miss, from hardware counters of thread 0", hwCacheLineSize);
+            }
+          fprintf(out, ")\n");
+          fprintf(out, "  %10s %9s %9s %9s", "seconds", "GFlop/s", "GB/s", "flop/byte");
+          if (s_hwCounters)
+            {
+              fprintf(out, " %6s %9s %9s", "IPC", "miss GB/s", "LLC miss%");
+            }
+          fprintf(out, "  timer\n");
+          header = true;
+        }
+
+      double seconds = t*secondspertick;
+      double flops = (double)timer.m_flops;
+      double bytes = (double)timer.m_bytes;
+      fprintf(out, "  %10.5f %9.3f %9.3f", seconds, flops/seconds*1.0e-9, bytes/seconds*1.0e-9);
+      if (bytes > 0)
+        {
+          fprintf(out, " %9.3f", flops/bytes);
+        }
+      else
+        {
+          fprintf(out, " %9s", "-");
+        }
+      if (s_hwCounters)
+        {
+          double cycles = (double)timer.m_hw[HW_CYCLES];
+          double ipc = (cycles > 0) ? timer.m_hw[HW_INSTRUCTIONS]/cycles : 0.0;
+          double missBytes = (double)timer.m_hw[HW_LLC_MISSES]*hwCacheLineSize;
+          double refs = (double)timer.m_hw[HW_LLC_REFERENCES];
+          double missPercent = (refs > 0) ? 100.0*timer.m_hw[HW_LLC_MISSES]/refs : 0.0;
+          fprintf(out, " %6.2f %9.3f %9.1f", ipc, missBytes/seconds*1.0e-9, missPercent);
+        }
+      fprintf(out, "  %s [%d]\n", timer.m_name, timer.m_rank);
+    }
+#ifdef _OPENMP
+  }
+#endif
+}
+
 void TraceTimer::updateMemory(TraceTimer& a_timer)
 {
 #ifdef _OPENMP
@@ -943,15 +1192,27 @@ TraceTimer::TraceTimer(const char* a_name, TraceTimer* parent, int thread_id)
       m_thread_id = thread_id;
       //m_memory = 0;
       //m_peak = 0;
+      m_flops = 0;
+      m_bytes = 0;
+      for (int i=0; i<HW_NCOUNTERS; i++)
+        {
+          m_hwEnter[i] = 0;
+          m_hw[i] = 0;
+        }
     }
 }
 #else
 TraceTimer::TraceTimer(const char* a_name, TraceTimer* parent, int thread_id)
   :m_pruned(false), m_parent(parent), m_name(a_name), m_count(0),
    m_accumulated_WCtime(0),m_last_WCtime_stamp(0), m_thread_id(thread_id),
-   m_memoryMin(0), m_memoryMax(0),m_flops(0)
+   m_memoryMin(0), m_memoryMax(0),m_flops(0),m_bytes(0)
 {
   m_memoryMin--;  // roll it back to the largest possible value;
+  for (int i=0; i<HW_NCOUNTERS; i++)
+    {
+      m_hwEnter[i] = 0;
+      m_hw[i] = 0;
+    }
 }
 #endif
 
@@ -987,7 +1248,7 @@ void TraceTimer::start(char* mutex)
   }
 # endif
 
-  m_flopEnter=ch_flops();
+  countersEnter();
 
   ++m_count;
   *mutex = 1;
@@ -1002,6 +1263,10 @@ void TraceTimer::start(char* mutex)
     {
       sampleMemUsage(m_name);
     }
+  if (TraceEvents::on())
+    {
+      TraceEvents::begin(m_name);
+    }
   m_last_WCtime_stamp = ch_ticks();
 
 #ifdef _OPENMP
@@ -1026,9 +1291,13 @@ unsigned long long int TraceTimer::stop(char* mutex)
   unsigned long long int diff = ch_ticks();
   diff -= m_last_WCtime_stamp;
 
-  m_flops+=ch_flops()-m_flopEnter;
+  countersExit();
   if (diff > overflowLong) diff = 0;
   m_accumulated_WCtime += diff;
+  if (TraceEvents::on())
+    {
+      TraceEvents::end();
+    }
 
   if (s_memorySampling) //here's to hoping a two-bit branch predictor gets this right
     {
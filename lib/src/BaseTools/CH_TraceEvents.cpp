@@ -0,0 +1,210 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+
+#include "CH_TraceEvents.H"
+#include "CH_Counters.H"
+#include "CH_Thread.H"
+#include "CH_assert.H"
+
+#include "BaseNamespaceHeader.H"
+
+bool                      TraceEvents::s_on             = false;
+int                       TraceEvents::s_numThreads     = 0;
+int                       TraceEvents::s_capacity       = 0;
+int                       TraceEvents::s_sampleInterval = 1;
+TraceEvents::ThreadEvents* TraceEvents::s_threads       = NULL;
+double                    TraceEvents::s_zeroTime       = 0;
+unsigned long long int    TraceEvents::s_zeroTicks      = 0;
+
+static const std::vector<TraceEvents::Event> s_noEvents;
+
+void TraceEvents::enable(int a_capacity,
+                         int a_sampleInterval)
+{
+  CH_assert(a_capacity >= 0);
+  CH_assert(a_sampleInterval >= 1);
+
+  disable();
+
+  s_numThreads     = getMaxThreads();
+  s_capacity       = a_capacity;
+  s_sampleInterval = a_sampleInterval;
+  s_threads        = new ThreadEvents[s_numThreads];
+  for (int i = 0; i < s_numThreads; i++)
+    {
+      s_threads[i].m_events.reserve(s_capacity);
+      s_threads[i].m_depth   = 0;
+      s_threads[i].m_calls   = 0;
+      s_threads[i].m_dropped = 0;
+    }
+
+  s_zeroTime  = TimerGetTimeStampWC();
+  s_zeroTicks = ch_ticks();
+  s_on = true;
+}
+
+void TraceEvents::disable()
+{
+  s_on = false;
+  delete[] s_threads;
+  s_threads    = NULL;
+  s_numThreads = 0;
+}
+
+void TraceEvents::initFromEnvironment()
+{
+  const char* capacityEnv = getenv("CH_TIMER_EVENTS");
+  if (capacityEnv == NULL) return;
+
+  int capacity = atoi(capacityEnv);
+  if (capacity <= 0)
+    {
+      // Any other value picks a default of a million events per thread
+      capacity = 1 << 20;
+    }
+
+  int sampleInterval = 1;
+  const char* sampleEnv = getenv("CH_TIMER_EVENTS_SAMPLE");
+  if (sampleEnv != NULL)
+    {
+      sampleInterval = atoi(sampleEnv);
+      if (sampleInterval < 1) sampleInterval = 1;
+    }
+
+  enable(capacity, sampleInterval);
+}
+
+void TraceEvents::clear()
+{
+  for (int i = 0; i < s_numThreads; i++)
+    {
+      s_threads[i].m_events.clear();
+      s_threads[i].m_dropped = 0;
+    }
+}
+
+int TraceEvents::numEvents(int a_thread)
+{
+  return events(a_thread).size();
+}
+
+long long int TraceEvents::numDropped()
+{
+  long long int dropped = 0;
+  for (int i = 0; i < s_numThreads; i++)
+    {
+      dropped += s_threads[i].m_dropped;
+    }
+  return dropped;
+}
+
+const std::vector<TraceEvents::Event>& TraceEvents::events(int a_thread)
+{
+  if ((a_thread < 0) || (a_thread >= s_numThreads))
+    {
+      return s_noEvents;
+    }
+  return s_threads[a_thread].m_events;
+}
+
+// Write a timer label as a JSON string
+static void writeJSONString(std::ostream& a_os, const char* a_str)
+{
+  a_os << '"';
+  for (const char* c = a_str; *c != '\0'; ++c)
+    {
+      if ((*c == '"') || (*c == '\\'))
+        {
+          a_os << '\\' << *c;
+        }
+      else if ((unsigned char)(*c) < 0x20)
+        {
+          a_os << ' ';
+        }
+      else
+        {
+          a_os << *c;
+        }
+    }
+  a_os << '"';
+}
+
+void TraceEvents::writeChromeTrace(std::ostream& a_os,
+                                   int           a_rank)
+{
+  // Calibrate the clock ticks against the wall clock over the whole run
+  double elapsedTime = TimerGetTimeStampWC() - s_zeroTime;
+  unsigned long long int elapsedTicks = ch_ticks() - s_zeroTicks;
+  double microsecondsPerTick = 0;
+  if (elapsedTicks > 0)
+    {
+      microsecondsPerTick = 1.0e6*elapsedTime/(double)elapsedTicks;
+    }
+
+  char buf[128];
+  a_os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+  sprintf(buf, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+          "\"args\":{\"name\":\"rank %d\"}}", a_rank, a_rank);
+  a_os << buf;
+
+  for (int tid = 0; tid < s_numThreads; tid++)
+    {
+      const std::vector<Event>& ev = s_threads[tid].m_events;
+      for (int i = 0; i < ev.size(); i++)
+        {
+          const Event& e = ev[i];
+          const char* category = "chombo";
+          if (strncmp(e.m_name, "MPI_", 4) == 0)
+            {
+              category = "mpi";
+            }
+          else if (strncmp(e.m_name, "FORT_", 5) == 0)
+            {
+              category = "fortran";
+            }
+
+          double ts  = (double)(e.m_begin - s_zeroTicks)*microsecondsPerTick;
+          double dur = (double)(e.m_end - e.m_begin)*microsecondsPerTick;
+
+          a_os << ",\n{\"name\":";
+          writeJSONString(a_os, e.m_name);
+          sprintf(buf, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                  "\"pid\":%d,\"tid\":%d}", category, ts, dur, a_rank, tid);
+          a_os << buf;
+        }
+    }
+
+  long long int dropped = numDropped();
+  sprintf(buf, "\n],\"otherData\":{\"droppedEvents\":%lld,\"sampleInterval\":%d}}\n",
+          dropped, s_sampleInterval);
+  a_os << buf;
+}
+
+void TraceEvents::writeChromeTraceFile(int a_rank)
+{
+  if (!s_on) return;
+
+  char filename[128];
+#ifdef CH_MPI
+  sprintf(filename, "chrome.trace.json.%d", a_rank);
+#else
+  sprintf(filename, "chrome.trace.json");
+#endif
+
+  std::ofstream os(filename);
+  writeChromeTrace(os, a_rank);
+}
+
+#include "BaseNamespaceFooter.H"
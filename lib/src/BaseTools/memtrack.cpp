@@ -390,6 +390,20 @@ void ReportAllocatedMemory(ostream& a_os)
               a_os << temp;
               totalSize += (*a)->bytes;
             }
+
+          const PArena* pool = dynamic_cast<const PArena*>(*a);
+          if ((pool != NULL) && (pool->peakHeldBytes() != 0))
+            {
+              // Blocks kept for reuse; peak is the high-water mark of all
+              // the memory the pool got from the system
+              string entry = "FabPool";
+              long int cached = pool->cachedBytes();
+              sprintf(temp, "%11s %-40s %12ld b  %11.4f Mb  peak=%11.4f\n", entry.data(), (*a)->name_,
+                      cached, (Real)cached/(Real)BYTES_PER_MEG,
+                      (Real)pool->peakHeldBytes()/(Real)BYTES_PER_MEG);
+              a_os << temp;
+              totalSize += cached;
+            }
         }
     }
 
@@ -520,6 +534,12 @@ void overallMemoryUsage(long long& a_currentTotal,
     {
       a_currentTotal += (*a)->bytes;
       a_peak         += (*a)->peak;
+
+      const PArena* pool = dynamic_cast<const PArena*>(*a);
+      if (pool != NULL)
+      {
+        a_currentTotal += pool->cachedBytes();
+      }
     }
   }
 
@@ -61,7 +61,8 @@ WriteAMRHierarchyHDF5(const string& filename,
                       const Real& a_dt,
                       const Real& a_time,
                       const Vector<int>& a_refRatio,
-                      const int& a_numLevels)
+                      const int& a_numLevels,
+                      const Vector<Real>& a_errorBounds)
 {
   CH_TIMERS("WriteAMRHierarchyHDF5");
   CH_TIMER("CreateFile",createFile);
@@ -80,7 +81,8 @@ WriteAMRHierarchyHDF5(const string& filename,
 
   CH_START(writeFile);
   WriteAMRHierarchyHDF5(handle, a_vectGrids, a_vectData, a_vectNames,
-                        a_domain, a_dx, a_dt, a_time, a_refRatio, a_numLevels);
+                        a_domain, a_dx, a_dt, a_time, a_refRatio, a_numLevels,
+                        a_errorBounds);
   CH_STOP(writeFile);
 
 #ifdef CH_MPI
@@ -154,7 +156,8 @@ WriteAMRHierarchyHDF5(HDF5Handle& handle,
                       const Real& a_dt,
                       const Real& a_time,
                       const Vector<int>& a_refRatio,
-                      const int& a_numLevels)
+                      const int& a_numLevels,
+                      const Vector<Real>& a_errorBounds)
 {
   CH_assert(a_numLevels > 0);
   CH_assert(a_vectData.size()  >= a_numLevels);
@@ -200,7 +203,8 @@ WriteAMRHierarchyHDF5(HDF5Handle& handle,
       IntVect ghostVect = a_vectData[0]->ghostVect();
       int eek = writeLevel(handle, ilev, dataLevel,
                            dxLevel, dtLevel, a_time,
-                           domainLevel, refLevel, ghostVect, comps);
+                           domainLevel, refLevel, ghostVect, comps,
+                           a_errorBounds);
       if (eek != 0)
         {
           MayDay::Error("WriteAMRHierarchyHDF5: Error in writeLevel");
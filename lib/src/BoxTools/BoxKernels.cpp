@@ -0,0 +1,252 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include "BoxKernels.H"
+#include "CH_Timer.H"
+#include "NamespaceHeader.H"
+
+// The component counts with a specialization: scalars, vectors and the
+// conserved variables of gas dynamics.  Other counts run the one
+// component kernel on each component.
+
+template <int RADIUS>
+static void laplacianComps(FArrayBox&       a_lhs,
+                           const FArrayBox& a_phi,
+                           const Box&       a_region,
+                           const Real&      a_dx,
+                           const Real&      a_alpha,
+                           const Real&      a_beta)
+{
+  int ncomp = a_lhs.nComp();
+  switch (ncomp)
+    {
+    case 1:
+      BoxKernels::laplacian<1, RADIUS>(a_lhs, a_phi, a_region, a_dx, a_alpha, a_beta);
+      break;
+    case 2:
+      BoxKernels::laplacian<2, RADIUS>(a_lhs, a_phi, a_region, a_dx, a_alpha, a_beta);
+      break;
+    case 3:
+      BoxKernels::laplacian<3, RADIUS>(a_lhs, a_phi, a_region, a_dx, a_alpha, a_beta);
+      break;
+    case 4:
+      BoxKernels::laplacian<4, RADIUS>(a_lhs, a_phi, a_region, a_dx, a_alpha, a_beta);
+      break;
+    case 5:
+      BoxKernels::laplacian<5, RADIUS>(a_lhs, a_phi, a_region, a_dx, a_alpha, a_beta);
+      break;
+    default:
+      for (int comp = 0; comp < ncomp; comp++)
+        {
+          BoxKernels::laplacian<1, RADIUS>(a_lhs, a_phi, a_region, a_dx, a_alpha, a_beta, comp);
+        }
+    }
+}
+
+void BoxKernels::laplacian(FArrayBox&       a_lhs,
+                           const FArrayBox& a_phi,
+                           const Box&       a_region,
+                           const Real&      a_dx,
+                           const Real&      a_alpha,
+                           const Real&      a_beta,
+                           int              a_radius)
+{
+  CH_TIME("BoxKernels::laplacian");
+  CH_assert(a_lhs.nComp() == a_phi.nComp());
+  switch (a_radius)
+    {
+    case 1:
+      laplacianComps<1>(a_lhs, a_phi, a_region, a_dx, a_alpha, a_beta);
+      break;
+    case 2:
+      laplacianComps<2>(a_lhs, a_phi, a_region, a_dx, a_alpha, a_beta);
+      break;
+    default:
+      MayDay::Error("BoxKernels::laplacian: the stencil radius must be 1 or 2");
+    }
+}
+
+void BoxKernels::gsrb(FArrayBox&       a_phi,
+                      const FArrayBox& a_rhs,
+                      const Box&       a_region,
+                      const Real&      a_dx,
+                      const Real&      a_alpha,
+                      const Real&      a_beta,
+                      int              a_color)
+{
+  CH_TIME("BoxKernels::gsrb");
+  CH_assert(a_phi.nComp() == a_rhs.nComp());
+  int ncomp = a_phi.nComp();
+  switch (ncomp)
+    {
+    case 1:
+      gsrb<1>(a_phi, a_rhs, a_region, a_dx, a_alpha, a_beta, a_color);
+      break;
+    case 2:
+      gsrb<2>(a_phi, a_rhs, a_region, a_dx, a_alpha, a_beta, a_color);
+      break;
+    case 3:
+      gsrb<3>(a_phi, a_rhs, a_region, a_dx, a_alpha, a_beta, a_color);
+      break;
+    case 4:
+      gsrb<4>(a_phi, a_rhs, a_region, a_dx, a_alpha, a_beta, a_color);
+      break;
+    case 5:
+      gsrb<5>(a_phi, a_rhs, a_region, a_dx, a_alpha, a_beta, a_color);
+      break;
+    default:
+      for (int comp = 0; comp < ncomp; comp++)
+        {
+          gsrb<1>(a_phi, a_rhs, a_region, a_dx, a_alpha, a_beta, a_color, comp);
+        }
+    }
+}
+
+// The refinement ratios with a specialization are 2 and 4
+template <int NCOMP>
+static void averageRef(FArrayBox&       a_coarse,
+                       const FArrayBox& a_fine,
+                       const Box&       a_coarseBox,
+                       int              a_refRatio,
+                       int              a_comp)
+{
+  switch (a_refRatio)
+    {
+    case 2:
+      BoxKernels::average<NCOMP, 2>(a_coarse, a_fine, a_coarseBox, 2, a_comp);
+      break;
+    case 4:
+      BoxKernels::average<NCOMP, 4>(a_coarse, a_fine, a_coarseBox, 4, a_comp);
+      break;
+    default:
+      BoxKernels::average<NCOMP, 0>(a_coarse, a_fine, a_coarseBox, a_refRatio, a_comp);
+    }
+}
+
+void BoxKernels::average(FArrayBox&       a_coarse,
+                         const FArrayBox& a_fine,
+                         const Box&       a_coarseBox,
+                         int              a_refRatio)
+{
+  CH_TIME("BoxKernels::average");
+  CH_assert(a_coarse.nComp() == a_fine.nComp());
+  int ncomp = a_coarse.nComp();
+  switch (ncomp)
+    {
+    case 1:
+      averageRef<1>(a_coarse, a_fine, a_coarseBox, a_refRatio, 0);
+      break;
+    case 2:
+      averageRef<2>(a_coarse, a_fine, a_coarseBox, a_refRatio, 0);
+      break;
+    case 3:
+      averageRef<3>(a_coarse, a_fine, a_coarseBox, a_refRatio, 0);
+      break;
+    case 4:
+      averageRef<4>(a_coarse, a_fine, a_coarseBox, a_refRatio, 0);
+      break;
+    case 5:
+      averageRef<5>(a_coarse, a_fine, a_coarseBox, a_refRatio, 0);
+      break;
+    default:
+      for (int comp = 0; comp < ncomp; comp++)
+        {
+          averageRef<1>(a_coarse, a_fine, a_coarseBox, a_refRatio, comp);
+        }
+    }
+}
+
+template <int NCOMP>
+static void prolongRef(FArrayBox&       a_fine,
+                       const FArrayBox& a_coarse,
+                       const Box&       a_fineBox,
+                       int              a_refRatio,
+                       int              a_comp)
+{
+  switch (a_refRatio)
+    {
+    case 2:
+      BoxKernels::prolong<NCOMP, 2>(a_fine, a_coarse, a_fineBox, 2, a_comp);
+      break;
+    case 4:
+      BoxKernels::prolong<NCOMP, 4>(a_fine, a_coarse, a_fineBox, 4, a_comp);
+      break;
+    default:
+      BoxKernels::prolong<NCOMP, 0>(a_fine, a_coarse, a_fineBox, a_refRatio, a_comp);
+    }
+}
+
+void BoxKernels::prolong(FArrayBox&       a_fine,
+                         const FArrayBox& a_coarse,
+                         const Box&       a_fineBox,
+                         int              a_refRatio)
+{
+  CH_TIME("BoxKernels::prolong");
+  CH_assert(a_fine.nComp() == a_coarse.nComp());
+  int ncomp = a_fine.nComp();
+  switch (ncomp)
+    {
+    case 1:
+      prolongRef<1>(a_fine, a_coarse, a_fineBox, a_refRatio, 0);
+      break;
+    case 2:
+      prolongRef<2>(a_fine, a_coarse, a_fineBox, a_refRatio, 0);
+      break;
+    case 3:
+      prolongRef<3>(a_fine, a_coarse, a_fineBox, a_refRatio, 0);
+      break;
+    case 4:
+      prolongRef<4>(a_fine, a_coarse, a_fineBox, a_refRatio, 0);
+      break;
+    case 5:
+      prolongRef<5>(a_fine, a_coarse, a_fineBox, a_refRatio, 0);
+      break;
+    default:
+      for (int comp = 0; comp < ncomp; comp++)
+        {
+          prolongRef<1>(a_fine, a_coarse, a_fineBox, a_refRatio, comp);
+        }
+    }
+}
+
+void BoxKernels::fluxDivergence(FArrayBox&     a_div,
+                                const FluxBox& a_flux,
+                                const Box&     a_region,
+                                const Real&    a_scale)
+{
+  CH_TIME("BoxKernels::fluxDivergence");
+  CH_assert(a_div.nComp() == a_flux.nComp());
+  int ncomp = a_div.nComp();
+  switch (ncomp)
+    {
+    case 1:
+      fluxDivergence<1>(a_div, a_flux, a_region, a_scale);
+      break;
+    case 2:
+      fluxDivergence<2>(a_div, a_flux, a_region, a_scale);
+      break;
+    case 3:
+      fluxDivergence<3>(a_div, a_flux, a_region, a_scale);
+      break;
+    case 4:
+      fluxDivergence<4>(a_div, a_flux, a_region, a_scale);
+      break;
+    case 5:
+      fluxDivergence<5>(a_div, a_flux, a_region, a_scale);
+      break;
+    default:
+      for (int comp = 0; comp < ncomp; comp++)
+        {
+          fluxDivergence<1>(a_div, a_flux, a_region, a_scale, comp);
+        }
+    }
+}
+
+#include "NamespaceFooter.H"
@@ -32,6 +32,7 @@ transform(BaseTransform& a_transform)
       Box fullBox = (*m_boxes)[ivec].box;
       (*m_boxes)[ivec].box = a_transform(fullBox);
     }
+  m_spatialIndex->clear();
 }
 
 //need at least one non-inlined function, otherwise
@@ -68,7 +69,9 @@ BoxLayout::BoxLayout()
    m_closed(new bool(false)),
    m_sorted(new bool(false)),
    m_dataIterator(RefCountedPtr<DataIterator>()),
-   m_indicies(new Vector<LayoutIndex>())
+   m_indicies(new Vector<LayoutIndex>()),
+   m_halo(new int(-1)),
+   m_spatialIndex(new BoxSpatialIndex())
 {
 }
 
@@ -80,6 +83,8 @@ BoxLayout& BoxLayout::operator=(const BoxLayout& a_rhs)
   m_closed = a_rhs.m_closed;
   m_sorted = a_rhs.m_sorted;
   m_dataIterator = a_rhs.m_dataIterator;
+  m_halo = a_rhs.m_halo;
+  m_spatialIndex = a_rhs.m_spatialIndex;
 #ifdef CH_MPI
   m_dataIndex = a_rhs.m_dataIndex;
 #endif
@@ -104,6 +109,7 @@ void BoxLayout::closeNoSort()
       *m_closed = true;
       buildDataIndex();
       m_dataIterator = RefCountedPtr<DataIterator>(new DataIterator(*this, m_layout));
+      m_spatialIndex->clear();
     }
 }
 
@@ -115,6 +121,7 @@ void BoxLayout::close()
       *m_closed = true;
       buildDataIndex();
       m_dataIterator = RefCountedPtr<DataIterator>(new DataIterator(*this, m_layout));
+      m_spatialIndex->clear();
     }
 }
 
@@ -192,7 +199,9 @@ BoxLayout::BoxLayout(const Vector<Box>& a_boxes, const Vector<int>& assignments)
    m_layout(new int),
    m_closed(new bool(false)),
    m_sorted(new bool(false)),
-   m_indicies(new Vector<LayoutIndex>())
+   m_indicies(new Vector<LayoutIndex>()),
+   m_halo(new int(-1)),
+   m_spatialIndex(new BoxSpatialIndex())
 {
   define(a_boxes, assignments);
 }
@@ -202,7 +211,9 @@ BoxLayout::BoxLayout(const LayoutData<Box>& a_newLayout)
    m_layout(new int),
    m_closed(new bool(false)),
    m_sorted(new bool(false)),
-   m_indicies(new Vector<LayoutIndex>())
+   m_indicies(new Vector<LayoutIndex>()),
+   m_halo(new int(-1)),
+   m_spatialIndex(new BoxSpatialIndex())
 {
   define(a_newLayout);
 }
@@ -260,11 +271,16 @@ void
 BoxLayout::define(const LayoutData<Box>& a_newLayout)
 {
   const BoxLayout& baseLayout = a_newLayout.boxLayout();
+  if (baseLayout.isDistributed())
+    {
+      MayDay::Error("BoxLayout::define(LayoutData<Box>) needs every box of the base layout; it does not work on a distributed layout");
+    }
 
   // First copy from the base layout.
   m_boxes =  RefCountedPtr<Vector<Entry> >(
                new Vector<Entry>(*(baseLayout.m_boxes)));
   m_layout = baseLayout.m_layout;
+  m_spatialIndex = RefCountedPtr<BoxSpatialIndex>(new BoxSpatialIndex());
 #ifdef CH_MPI
   m_dataIndex = baseLayout.m_dataIndex;
 #endif
@@ -337,6 +353,8 @@ BoxLayout::deepCopy(const BoxLayout& a_source)
   m_boxes =  RefCountedPtr<Vector<Entry> >(
                 new Vector<Entry>(*(a_source.m_boxes)));
   m_layout = a_source.m_layout;
+  m_halo = RefCountedPtr<int>(new int(*a_source.m_halo));
+  m_spatialIndex = RefCountedPtr<BoxSpatialIndex>(new BoxSpatialIndex());
 #ifdef CH_MPI
   m_dataIndex = a_source.m_dataIndex;
 #endif
@@ -370,10 +388,77 @@ bool BoxLayout::sameBoxes(const BoxLayout& a_layout) const
 // Global functions
 // ================
 
+// A box of another processor within a_halo cells of a box of this one is
+// still within the returned number of cells after coarsening or refining
+// all of them
+static int coarsenHalo(int a_halo, int a_refinement)
+{
+  return (a_halo < 0) ? a_halo : a_halo/a_refinement;
+}
+
+static int refineHalo(int a_halo, int a_refinement)
+{
+  return (a_halo < 0) ? a_halo : a_halo*a_refinement;
+}
+
 // For now, we can just have the one coarsen funtion.  If a DisjointBoxLayout
 // enters this function, is coarsened, and then doesn't remain disjoint, it
 // will be caught here at the call to close().  Debugging should not be
 
+void BoxLayout::findIntersecting(Vector<LayoutIndex>& a_indices,
+                                 const Box&           a_box) const
+{
+  const BoxSpatialIndex& index = spatialIndex();
+  Vector<int> found;
+  index.findIntersecting(found, a_box);
+  a_indices.resize(found.size());
+  for (int i = 0; i < found.size(); ++i)
+    {
+      int ibox = found[i];
+      int datInd = ibox;
+#ifdef CH_MPI
+      // The position of a local box among the local boxes
+      datInd = -1;
+      if ((*m_boxes)[ibox].m_procID == CHprocID())
+        {
+          const Vector<DataIndex>& local = *m_dataIndex;
+          int lo = 0;
+          int hi = local.size();
+          while (lo < hi)
+            {
+              int mid = (lo + hi)/2;
+              if (local[mid].intCode() < ibox)
+                {
+                  lo = mid + 1;
+                }
+              else
+                {
+                  hi = mid;
+                }
+            }
+          datInd = lo;
+        }
+#endif
+      a_indices[i] = LayoutIndex(ibox, datInd, m_layout);
+    }
+}
+
+const BoxSpatialIndex& BoxLayout::spatialIndex() const
+{
+  CH_assert(*m_closed);
+  // built on first use, as transform() clears it on a closed layout.  the
+  // test stays inside the critical section: the index's vectors are only
+  // guaranteed to be visible to a thread that took the lock after define
+#pragma omp critical (BoxLayout_spatialIndex)
+  {
+    if (!m_spatialIndex->isDefined())
+      {
+        m_spatialIndex->define(boxArray());
+      }
+  }
+  return *m_spatialIndex;
+}
+
 void
 coarsen(BoxLayout& a_output, const BoxLayout& a_input, int a_refinement)
 {
@@ -387,7 +472,9 @@ coarsen(BoxLayout& a_output, const BoxLayout& a_input, int a_refinement)
     }
   //a_output.deepCopy(a_input);
   a_output.m_boxes      = RefCountedPtr<Vector<Entry> >(new Vector<Entry>(*(a_input.m_boxes)));
+  a_output.m_spatialIndex = RefCountedPtr<BoxSpatialIndex>(new BoxSpatialIndex());
   a_output.m_layout     = a_input.m_layout;
+  a_output.m_halo       = RefCountedPtr<int>(new int(coarsenHalo(*a_input.m_halo, a_refinement)));
 #ifdef CH_MPI
   a_output.m_dataIndex  = a_input.m_dataIndex;
 #endif
@@ -412,7 +499,9 @@ coarsen(BoxLayout& a_output, const BoxLayout& a_input, const IntVect& a_refineme
     }
   //a_output.deepCopy(a_input);
   a_output.m_boxes      = RefCountedPtr<Vector<Entry> >(new Vector<Entry>(*(a_input.m_boxes)));
+  a_output.m_spatialIndex = RefCountedPtr<BoxSpatialIndex>(new BoxSpatialIndex());
   a_output.m_layout     = a_input.m_layout;
+  a_output.m_halo       = RefCountedPtr<int>(new int(coarsenHalo(*a_input.m_halo, a_refinement.max())));
 #ifdef CH_MPI
   a_output.m_dataIndex  = a_input.m_dataIndex;
 #endif
@@ -614,6 +703,7 @@ void refine(BoxLayout& a_output, const BoxLayout& a_input, int a_refinement)
       MayDay::Error("output of refine must be called on open BoxLayout");
     }
   a_output.deepCopy(a_input);
+  *a_output.m_halo = refineHalo(*a_input.m_halo, a_refinement);
 
   for (int ivec = 0; ivec < a_output.m_boxes->size(); ivec++)
     {
@@ -633,6 +723,7 @@ void refine(BoxLayout& a_output, const BoxLayout& a_input, const IntVect& a_refi
       MayDay::Error("output of refine must be called on open BoxLayout");
     }
   a_output.deepCopy(a_input);
+  *a_output.m_halo = refineHalo(*a_input.m_halo, a_refinement.min());
 
   for (int ivec = 0; ivec < a_output.m_boxes->size(); ivec++)
     {
@@ -938,4 +1029,36 @@ void serialMortonOrdering(Vector<Box>& a_boxes)
   bits = maxBits(b.begin(), b.end());
   std::sort(b.begin(), b.end(), MortonOrdering(bits));
 }
+
+class MortonIndexOrdering
+{
+public:
+  MortonIndexOrdering(const Vector<Box>& a_boxes, int a_maxSize)
+    :
+    boxes(a_boxes),
+    order(a_maxSize)
+  {
+  }
+
+  inline bool operator()(int lhs, int rhs) const
+  {
+    return order(boxes[lhs], boxes[rhs]);
+  }
+
+  const Vector<Box>& boxes;
+  MortonOrdering order;
+};
+
+void serialMortonOrdering(Vector<int>& a_order, const Vector<Box>& a_boxes)
+{
+  a_order.resize(a_boxes.size());
+  for (int i = 0; i < a_order.size(); i++)
+    {
+      a_order[i] = i;
+    }
+  std::vector<Box> b = a_boxes.constStdVector();
+  int bits = maxBits(b.begin(), b.end());
+  std::vector<int>& o = a_order.stdVector();
+  std::stable_sort(o.begin(), o.end(), MortonIndexOrdering(a_boxes, bits));
+}
 #include "NamespaceFooter.H"
@@ -0,0 +1,199 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include <algorithm>
+#include "BoxSpatialIndex.H"
+#include "CH_Timer.H"
+#include "NamespaceHeader.H"
+
+// Keep the bin keys well inside a long long
+static const long long s_maxBins = 1LL << 40;
+
+static inline int floorDiv(int a_num, int a_den)
+{
+  return (a_num >= 0) ? a_num/a_den : -((-a_num + a_den - 1)/a_den);
+}
+
+BoxSpatialIndex::BoxSpatialIndex()
+  :
+  m_defined(false)
+{
+}
+
+BoxSpatialIndex::BoxSpatialIndex(const Vector<Box>& a_boxes)
+  :
+  m_defined(false)
+{
+  define(a_boxes);
+}
+
+void BoxSpatialIndex::clear()
+{
+  m_defined = false;
+  m_boxes.resize(0);
+  m_entries.resize(0);
+}
+
+void BoxSpatialIndex::define(const Vector<Box>& a_boxes)
+{
+  CH_TIME("BoxSpatialIndex::define");
+  m_boxes = a_boxes;
+  m_entries.resize(0);
+
+  // Bounding box and largest extent of the nonempty boxes
+  IntVect lo = IntVect::Zero;
+  IntVect hi = IntVect::Zero;
+  m_binSize = IntVect::Unit;
+  bool first = true;
+  for (int i = 0; i < m_boxes.size(); ++i)
+    {
+      const Box& b = m_boxes[i];
+      if (b.isEmpty()) continue;
+      if (first)
+        {
+          lo = b.smallEnd();
+          hi = b.bigEnd();
+          first = false;
+        }
+      else
+        {
+          lo.min(b.smallEnd());
+          hi.max(b.bigEnd());
+        }
+      m_binSize.max(b.bigEnd() - b.smallEnd() + IntVect::Unit);
+    }
+  m_origin = lo;
+
+  // Coarser bins for a very sparse set of boxes
+  long long numBins;
+  do
+    {
+      numBins = 1;
+      for (int dir = 0; dir < SpaceDim; ++dir)
+        {
+          m_numBins[dir] = (hi[dir] - lo[dir])/m_binSize[dir] + 1;
+          numBins *= m_numBins[dir];
+        }
+      if (numBins > s_maxBins)
+        {
+          m_binSize *= 2;
+        }
+    }
+  while (numBins > s_maxBins);
+
+  for (int i = 0; i < m_boxes.size(); ++i)
+    {
+      if (!m_boxes[i].isEmpty())
+        {
+          m_entries.push_back(std::pair<long long, int>(key(bin(m_boxes[i].smallEnd())), i));
+        }
+    }
+  std::sort(m_entries.stdVector().begin(), m_entries.stdVector().end());
+  m_defined = true;
+}
+
+IntVect BoxSpatialIndex::bin(const IntVect& a_iv) const
+{
+  IntVect b;
+  for (int dir = 0; dir < SpaceDim; ++dir)
+    {
+      b[dir] = floorDiv(a_iv[dir] - m_origin[dir], m_binSize[dir]);
+    }
+  return b;
+}
+
+long long BoxSpatialIndex::key(const IntVect& a_bin) const
+{
+  long long k = 0;
+  for (int dir = SpaceDim-1; dir >= 0; --dir)
+    {
+      k = k*m_numBins[dir] + a_bin[dir];
+    }
+  return k;
+}
+
+void BoxSpatialIndex::findIntersecting(Vector<int>& a_indices,
+                                       const Box&   a_box) const
+{
+  CH_assert(m_defined);
+  a_indices.resize(0);
+  if (a_box.isEmpty() || (m_entries.size() == 0))
+    {
+      return;
+    }
+
+  // A box intersecting a_box has its small end at most one bin below
+  IntVect binLo = bin(a_box.smallEnd() - m_binSize + IntVect::Unit);
+  IntVect binHi = bin(a_box.bigEnd());
+  long long numBins = 1;
+  for (int dir = 0; dir < SpaceDim; ++dir)
+    {
+      binLo[dir] = Max(binLo[dir], 0);
+      binHi[dir] = Min(binHi[dir], m_numBins[dir] - 1);
+      if (binLo[dir] > binHi[dir])
+        {
+          return;
+        }
+      numBins *= binHi[dir] - binLo[dir] + 1;
+    }
+
+  const std::vector<std::pair<long long, int> >& entries = m_entries.constStdVector();
+  if (numBins > (long long)entries.size())
+    {
+      // A query this large is cheaper as a plain scan
+      for (int i = 0; i < entries.size(); ++i)
+        {
+          int ibox = entries[i].second;
+          if (m_boxes[ibox].intersectsNotEmpty(a_box))
+            {
+              a_indices.push_back(ibox);
+            }
+        }
+    }
+  else
+    {
+      // The bins along the first direction have consecutive keys, so
+      // each row of bins is one range of the sorted entries
+      IntVect rowLo(binLo);
+      bool done = false;
+      while (!done)
+        {
+          IntVect rowHi(rowLo);
+          rowHi[0] = binHi[0];
+          std::pair<long long, int> first(key(rowLo), -1);
+          long long lastKey = key(rowHi);
+          std::vector<std::pair<long long, int> >::const_iterator it =
+            std::lower_bound(entries.begin(), entries.end(), first);
+          for (; (it != entries.end()) && (it->first <= lastKey); ++it)
+            {
+              if (m_boxes[it->second].intersectsNotEmpty(a_box))
+                {
+                  a_indices.push_back(it->second);
+                }
+            }
+
+          // Next row
+          done = true;
+          for (int dir = 1; dir < SpaceDim; ++dir)
+            {
+              if (rowLo[dir] < binHi[dir])
+                {
+                  rowLo[dir]++;
+                  done = false;
+                  break;
+                }
+              rowLo[dir] = binLo[dir];
+            }
+        }
+    }
+  std::sort(a_indices.stdVector().begin(), a_indices.stdVector().end());
+}
+
+#include "NamespaceFooter.H"
@@ -13,6 +13,7 @@
 #include "CH_HDF5.H"
 #include "MayDay.H"
 #include <cstdio>
+#include <cmath>
 #include "parstream.H"
 #include "NamespaceHeader.H"
 using std::ostream;
@@ -148,9 +149,19 @@ template < > void linearOut(void* const a_outBuf, const Vector<OffsetBuffer>& a_
 #include "BaseNamespaceFooter.H"
 #include "NamespaceHeader.H"
 
+// number of consecutive Morton ordered boxes summarized by one bounding
+// box in the index written next to a BoxLayout
+static const int s_boxIndexBinSize = 16;
+
+static int writeBoxIndex(HDF5Handle& a_handle, const BoxLayout& a_layout, const std::string& name);
+
 int write(HDF5Handle& a_handle, const BoxLayout& a_layout, const std::string& name)
 {
   CH_assert(a_layout.isClosed());
+  if (a_layout.isDistributed())
+    {
+      MayDay::Error("write(HDF5Handle, BoxLayout) needs every box; it does not work on a distributed layout");
+    }
 //  herr_t ret;
 //  ch_offset_t offset[1];
   hsize_t  flatdims[1], count[1];
@@ -251,6 +262,52 @@ int write(HDF5Handle& a_handle, const BoxLayout& a_layout, const std::string& na
   H5Sclose(procdataspace);
   H5Dclose(procdataset);
 
+  return writeBoxIndex(a_handle, a_layout, name);
+}
+
+static int writeBoxIndex(HDF5Handle& a_handle, const BoxLayout& a_layout, const std::string& name)
+{
+  int nbox = a_layout.size();
+  if (nbox == 0)
+    {
+      return 0;
+    }
+  int nbin = (nbox + s_boxIndexBinSize - 1)/s_boxIndexBinSize;
+
+  int dummyInt = 0;
+  Box dummyBox;
+  hid_t orderdataset, orderdataspace, boundsdataset, boundsdataspace;
+  createDataset(orderdataset, orderdataspace, a_handle, name + ":mortonOrder",
+                &dummyInt, nbox);
+  createDataset(boundsdataset, boundsdataspace, a_handle, name + ":mortonBounds",
+                &dummyBox, nbin);
+  if (orderdataset < 0) return orderdataset;
+  if (boundsdataset < 0) return boundsdataset;
+
+  if (procID() == 0)
+    {
+      Vector<Box> vbox(nbox);
+      int b = 0;
+      for (LayoutIterator it = a_layout.layoutIterator(); it.ok(); ++it)
+        {
+          vbox[b++] = a_layout.get(it());
+        }
+      Vector<int> order;
+      serialMortonOrdering(order, vbox);
+
+      Vector<Box> bounds(nbin);
+      for (int i = 0; i < nbox; i++)
+        {
+          bounds[i/s_boxIndexBinSize].minBox(vbox[order[i]]);
+        }
+      writeDataset(orderdataset, orderdataspace, &(order[0]), 0, nbox);
+      writeDataset(boundsdataset, boundsdataspace, &(bounds[0]), 0, nbin);
+    }
+
+  H5Sclose(orderdataspace);
+  H5Dclose(orderdataset);
+  H5Sclose(boundsdataspace);
+  H5Dclose(boundsdataset);
   return 0;
 }
 
@@ -292,6 +349,57 @@ int read(HDF5Handle& a_handle, Vector<Box>& boxes, const std::string& name)
   return 0;
 }
 
+int readLayout(HDF5Handle& a_handle, Vector<Box>& a_boxes,
+               Vector<int>& a_procs, const std::string& name)
+{
+  int error = 0;
+  if (procID() == 0)
+    {
+      error = read(a_handle, a_boxes, name);
+      a_procs.resize(0);
+      hid_t procdataset = -1;
+      if (error == 0)
+        {
+#ifdef H516
+          H5E_auto_t efunc; void* edata;
+          H5Eget_auto(&efunc, &edata);
+          H5Eset_auto(NULL, NULL);
+          procdataset = H5Dopen(a_handle.groupID(), "Processors");
+          H5Eset_auto(efunc, edata);
+#else
+          if (H5Lexists(a_handle.groupID(), "Processors", H5P_DEFAULT) > 0)
+            {
+              procdataset = H5Dopen2(a_handle.groupID(), "Processors", H5P_DEFAULT);
+            }
+#endif
+        }
+      if (procdataset >= 0)
+        {
+          hid_t procdataspace = H5Dget_space(procdataset);
+          hsize_t dims[1], maxdims[1];
+          H5Sget_simple_extent_dims(procdataspace, dims, maxdims);
+          if (dims[0] == a_boxes.size() && dims[0] > 0)
+            {
+              a_procs.resize(dims[0]);
+              hid_t memdataspace = H5Screate_simple(1, dims, NULL);
+              if (H5Dread(procdataset, H5T_NATIVE_INT, memdataspace, procdataspace,
+                          H5P_DEFAULT, &(a_procs[0])) < 0)
+                {
+                  a_procs.resize(0);
+                }
+              H5Sclose(memdataspace);
+            }
+          H5Sclose(procdataspace);
+          H5Dclose(procdataset);
+        }
+    }
+  broadcast(error, 0);
+  if (error != 0) return error;
+  broadcast(a_boxes, 0);
+  broadcast(a_procs, 0);
+  return 0;
+}
+
 int readBoxes(HDF5Handle& a_handle, Vector<Vector<Box> >& boxes)
 {
   int error;
@@ -434,11 +542,215 @@ int readFArrayBox(HDF5Handle& a_handle,
 
 }
 
+bool hasDataset(HDF5Handle& a_handle, const std::string& a_name)
+{
+#ifdef H516
+  H5E_auto_t efunc; void* edata;
+  H5Eget_auto(&efunc, &edata);
+  H5Eset_auto(NULL, NULL);
+  herr_t status = H5Gget_objinfo(a_handle.groupID(), a_name.c_str(), 0, NULL);
+  H5Eset_auto(efunc, edata);
+  return (status >= 0);
+#else
+  return (H5Lexists(a_handle.groupID(), a_name.c_str(), H5P_DEFAULT) > 0);
+#endif
+}
+
+static hid_t openDataset(HDF5Handle& a_handle, const std::string& a_name)
+{
+#ifdef H516
+  return H5Dopen(a_handle.groupID(), a_name.c_str());
+#else
+  return H5Dopen2(a_handle.groupID(), a_name.c_str(), H5P_DEFAULT);
+#endif
+}
+
+// reads a_count entries of a_type starting at a_offset
+static herr_t readSlab(hid_t a_dataset, hid_t a_type, void* a_buffer,
+                       long long a_offset, long long a_count)
+{
+  ch_offset_t offset[1];
+  hsize_t count[1];
+  offset[0] = a_offset;
+  count[0]  = a_count;
+  hid_t dataspace = H5Dget_space(a_dataset);
+  hid_t memdataspace = H5Screate_simple(1, count, NULL);
+  herr_t err = H5Sselect_hyperslab(dataspace, H5S_SELECT_SET,
+                                   offset, NULL, count, NULL);
+  if (err >= 0)
+    {
+      err = H5Dread(a_dataset, a_type, memdataspace, dataspace,
+                    H5P_DEFAULT, a_buffer);
+    }
+  H5Sclose(memdataspace);
+  H5Sclose(dataspace);
+  return err;
+}
+
+static long long datasetSize(hid_t a_dataset)
+{
+  hsize_t dims[1], maxdims[1];
+  hid_t dataspace = H5Dget_space(a_dataset);
+  H5Sget_simple_extent_dims(dataspace, dims, maxdims);
+  H5Sclose(dataspace);
+  return dims[0];
+}
+
+// opens the datasets of a readRegion call and, on every exit, closes
+// them and puts the handle back in the group it was in
+class RegionReadScope
+{
+public:
+  RegionReadScope(HDF5Handle& a_handle)
+    :m_handle(a_handle),
+     m_group(a_handle.getGroup())
+  {
+  }
+
+  ~RegionReadScope()
+  {
+    for (int i = 0; i < m_datasets.size(); i++)
+      {
+        H5Dclose(m_datasets[i]);
+      }
+    m_handle.setGroup(m_group);
+  }
+
+  hid_t open(const std::string& a_name)
+  {
+    hid_t dataset = openDataset(m_handle, a_name);
+    if (dataset >= 0)
+      {
+        m_datasets.push_back(dataset);
+      }
+    return dataset;
+  }
+
+private:
+  HDF5Handle&   m_handle;
+  std::string   m_group;
+  Vector<hid_t> m_datasets;
+};
+
+int readRegion(HDF5Handle& a_handle,
+               FArrayBox&  a_fab,
+               int a_level,
+               const Box& a_region,
+               const Interval& a_components,
+               const std::string& a_dataName)
+{
+  char levelName[100];
+  int error = 0;
+  RegionReadScope scope(a_handle);
+
+  // we want to start in root group
+  error = a_handle.setGroup("/");
+  if (error != 0) return 1;
+  std::string workingGroup = a_handle.getGroup();
+
+  sprintf(levelName, "/level_%i",a_level);
+  std::string levelGroup = workingGroup + levelName;
+  error = a_handle.setGroup(levelGroup);
+  if (error != 0) return 1;
+
+  // ghost cells and components of each box in the file
+  HDF5HeaderData info;
+  error = a_handle.setGroup(levelGroup + "/" + a_dataName + "_attributes");
+  if (error != 0) return 1;
+  info.readFromFile(a_handle);
+  a_handle.setGroup(levelGroup);
+  IntVect outputGhost(IntVect::Zero);
+  if (info.m_intvect.find("outputGhost") != info.m_intvect.end())
+    {
+      outputGhost = info.m_intvect["outputGhost"];
+    }
+  if (a_components.end() >= info.m_int["comps"]) return 1;
+
+  // the boxes that can intersect a_region.  without an index (files
+  // written before there was one) every box is a candidate.
+  hid_t boxdataset = scope.open("boxes");
+  if (boxdataset < 0) return 2;
+  Vector<int> candidates;
+  if (hasDataset(a_handle, "boxes:mortonBounds"))
+    {
+      hid_t boundsdataset = scope.open("boxes:mortonBounds");
+      hid_t orderdataset  = scope.open("boxes:mortonOrder");
+      if (boundsdataset < 0 || orderdataset < 0) return 2;
+      long long nbox = datasetSize(orderdataset);
+      Vector<Box> bounds(datasetSize(boundsdataset));
+      if (bounds.size() > 0 &&
+          readSlab(boundsdataset, HDF5Handle::box_id, &(bounds[0]), 0, bounds.size()) < 0)
+        {
+          return 3;
+        }
+      for (int bin = 0; bin < bounds.size(); bin++)
+        {
+          bounds[bin].computeBoxLen();
+          if (!bounds[bin].intersectsNotEmpty(a_region)) continue;
+          long long first = (long long)bin*s_boxIndexBinSize;
+          long long count = Min((long long)s_boxIndexBinSize, nbox - first);
+          int start = candidates.size();
+          candidates.resize(start + count);
+          if (readSlab(orderdataset, H5T_NATIVE_INT, &(candidates[start]),
+                       first, count) < 0)
+            {
+              return 3;
+            }
+        }
+    }
+  else
+    {
+      candidates.resize(datasetSize(boxdataset));
+      for (int i = 0; i < candidates.size(); i++)
+        {
+          candidates[i] = i;
+        }
+    }
+
+  int ncomp = a_components.size();
+  if (a_fab.box() != a_region || a_fab.nComp() != ncomp)
+    {
+      a_fab.define(a_region, ncomp);
+    }
+
+  std::string namebuff1 = a_dataName + ":offsets=0";
+  std::string namebuff2 = a_dataName + ":datatype=0";
+  hid_t offsetdataset = scope.open(namebuff1);
+  hid_t datadataset   = scope.open(namebuff2);
+  if (offsetdataset < 0 || datadataset < 0) return 2;
+
+  // only the requested components of the intersecting boxes are read
+  FArrayBox fileFab;
+  for (int i = 0; i < candidates.size(); i++)
+    {
+      Box box;
+      if (readSlab(boxdataset, HDF5Handle::box_id, &box, candidates[i], 1) < 0) return 3;
+      box.computeBoxLen();
+      Box overlap = box & a_region;
+      if (overlap.isEmpty()) continue;
+
+      long long offsetLong;
+      if (readSlab(offsetdataset, H5T_NATIVE_LLONG, &offsetLong, candidates[i], 1) < 0) return 3;
+      Box fileBox = grow(box, outputGhost);
+      fileFab.define(fileBox, ncomp);
+      offsetLong += fileBox.numPts() * a_components.begin();
+      if (readSlab(datadataset, H5T_NATIVE_REAL, fileFab.dataPtr(),
+                   offsetLong, fileBox.numPts()*ncomp) < 0)
+        {
+          return 3;
+        }
+      a_fab.copy(fileFab, overlap, 0, overlap, 0, ncomp);
+    }
+
+  return 0;
+}
+
 bool HDF5Handle::initialized = false;
 hid_t HDF5Handle::box_id = 0;
 hid_t HDF5Handle::intvect_id = 0;
 hid_t HDF5Handle::realvect_id = 0;
 map<std::string, std::string> HDF5Handle::groups = map<std::string, std::string>();
+HDF5Compression HDF5Handle::s_defaultCompression;
 
 #ifdef H516
 extern "C"
@@ -597,7 +909,7 @@ void HDF5Handle::initialize()
   initialized = true;
 }
 
-HDF5Handle::HDF5Handle(): m_isOpen(false)
+HDF5Handle::HDF5Handle(): m_isOpen(false), m_compression(s_defaultCompression)
 {
   if (!initialized) initialize();
 }
@@ -608,7 +920,8 @@ HDF5Handle::HDF5Handle(
         const char *a_globalGroupName)
             :
         m_isOpen(false),
-        m_level(-1)
+        m_level(-1),
+        m_compression(s_defaultCompression)
 {
   int err = open(a_filename, a_mode, a_globalGroupName);
   if (err < 0 )
@@ -1215,6 +1528,82 @@ void writeDataset(hid_t a_dataset,
   H5Sclose(memdataspace);
 }
 
+hid_t chunkedProperties(const HDF5Compression& a_compression,
+                        hsize_t a_size,
+                        hsize_t a_largestBox,
+                        size_t a_typeSize)
+{
+  if (a_size == 0)
+    {
+      //nothing to chunk
+      return H5P_DEFAULT;
+    }
+  hsize_t chunk[1];
+  chunk[0] = a_compression.m_chunkSize;
+  if (chunk[0] == 0)
+    {
+      chunk[0] = a_largestBox;
+    }
+  //HDF5 chunks have to stay under 4GB
+  hsize_t maxChunk = ((hsize_t)1 << 31)/a_typeSize;
+  chunk[0] = Min(chunk[0], maxChunk);
+  chunk[0] = Min(chunk[0], a_size);
+  chunk[0] = Max(chunk[0], (hsize_t)1);
+
+  hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+  H5Pset_chunk(dcpl, 1, chunk);
+  if (a_compression.m_deflate > 0)
+    {
+      if (H5Zfilter_avail(H5Z_FILTER_DEFLATE) > 0)
+        {
+          H5Pset_shuffle(dcpl);
+          H5Pset_deflate(dcpl, Min(a_compression.m_deflate, 9));
+        }
+      else
+        {
+          static bool warned = false;
+          if (!warned)
+            {
+              MayDay::Warning("HDF5 has no deflate filter, writing uncompressed chunks");
+              warned = true;
+            }
+        }
+    }
+  return dcpl;
+}
+
+void quantize(Real* a_data,
+              long long a_count,
+              Real a_errorBound)
+{
+  if (a_errorBound <= 0)
+    {
+      return;
+    }
+  // largest power of two not above 2*a_errorBound, so that the rounding
+  // error stays within a_errorBound and the values end in zero bits.
+  int expo;
+  frexp(2*a_errorBound, &expo);
+  Real quantum = ldexp((Real)1, expo-1);
+  for (long long i = 0; i < a_count; i++)
+    {
+      a_data[i] = quantum*floor(a_data[i]/quantum + 0.5);
+    }
+}
+
+bool hasErrorBound(const Vector<Real>& a_errorBounds,
+                   const Interval& a_comps)
+{
+  for (int comp = a_comps.begin(); comp <= a_comps.end(); comp++)
+    {
+      if ((comp < a_errorBounds.size()) && (a_errorBounds[comp] > 0))
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
 void readDataset(hid_t a_dataset,
                  hid_t a_dataspace,
                  void* start,
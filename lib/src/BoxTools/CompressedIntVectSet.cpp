@@ -0,0 +1,1286 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include "CompressedIntVectSet.H"
+#include "TreeIntVectSet.H"
+#include "ProblemDomain.H"
+#include "BoxIterator.H"
+#include "MayDay.H"
+#include "NamespaceHeader.H"
+
+typedef CompressedIntVectSet::Chunk Chunk;
+typedef std::pair<IntVect, int>     Run;
+
+// Side, number of cells, and number of 64-bit words of a chunk.  Chunks
+// have at most s_maxOffsets cells in the offset array; above that the
+// bitmap is smaller.
+static const int s_side       = 1 << CIVS_CHUNKBITS;
+static const int s_cells      = 1 << (CH_SPACEDIM*CIVS_CHUNKBITS);
+static const int s_words      = s_cells/64;
+static const int s_rows       = s_cells/s_side;
+static const int s_maxOffsets = s_cells/16;
+static const unsigned long long s_allBits = ~0ULL;
+static const unsigned long long s_rowMask =
+  (s_side == 64) ? ~0ULL : ((1ULL << (s_side % 64)) - 1);
+
+static inline int popCount(unsigned long long a_x)
+{
+#ifdef __GNUC__
+  return __builtin_popcountll(a_x);
+#else
+  int n = 0;
+  for (; a_x != 0; a_x &= a_x - 1) n++;
+  return n;
+#endif
+}
+
+// Position of the lowest set bit of a_x, which must not be zero
+static inline int lowBit(unsigned long long a_x)
+{
+#ifdef __GNUC__
+  return __builtin_ctzll(a_x);
+#else
+  int n = 0;
+  for (; (a_x & 1ULL) == 0; a_x >>= 1) n++;
+  return n;
+#endif
+}
+
+// Position of the highest set bit of a_x, which must not be zero
+static inline int highBit(unsigned long long a_x)
+{
+#ifdef __GNUC__
+  return 63 - __builtin_clzll(a_x);
+#else
+  int n = 0;
+  for (; a_x > 1; a_x >>= 1) n++;
+  return n;
+#endif
+}
+
+// Bits a_lo through a_hi of a row
+static inline unsigned long long rangeMask(int a_lo, int a_hi)
+{
+  unsigned long long hi = (a_hi >= 63) ? s_allBits : ((1ULL << (a_hi + 1)) - 1);
+  return hi & (s_allBits << a_lo);
+}
+
+static inline int floorDiv(int a_num, int a_den)
+{
+  return (a_num >= 0) ? a_num/a_den : -((-a_num + a_den - 1)/a_den);
+}
+
+static inline IntVect chunkIndex(const IntVect& a_iv)
+{
+  IntVect index;
+  for (int dir = 0; dir < SpaceDim; dir++)
+    {
+      index[dir] = floorDiv(a_iv[dir], s_side);
+    }
+  return index;
+}
+
+static inline int cellOffset(const IntVect& a_iv, const IntVect& a_index)
+{
+  int offset = 0;
+  for (int dir = SpaceDim-1; dir >= 0; dir--)
+    {
+      offset = (offset << CIVS_CHUNKBITS) + (a_iv[dir] - s_side*a_index[dir]);
+    }
+  return offset;
+}
+
+static inline IntVect offsetCell(int a_offset, const IntVect& a_index)
+{
+  IntVect iv;
+  for (int dir = 0; dir < SpaceDim; dir++)
+    {
+      iv[dir] = s_side*a_index[dir] + (a_offset & (s_side - 1));
+      a_offset >>= CIVS_CHUNKBITS;
+    }
+  return iv;
+}
+
+// Morton key of a chunk index: the bits of the components interleaved.
+// Indices too far from the origin to fit can share a key; the index
+// itself breaks the tie.
+static unsigned long long mortonKey(const IntVect& a_index)
+{
+  const int bitsPerDir = 64/SpaceDim;
+  const long long bias = 1LL << (bitsPerDir - 1);
+  unsigned long long key = 0;
+  for (int dir = 0; dir < SpaceDim; dir++)
+    {
+      unsigned long long u = (unsigned long long)(a_index[dir] + bias);
+      for (int b = 0; b < bitsPerDir; b++)
+        {
+          key |= ((u >> b) & 1ULL) << (b*SpaceDim + dir);
+        }
+    }
+  return key;
+}
+
+static inline bool chunkLess(const Chunk& a_lhs, const Chunk& a_rhs)
+{
+  if (a_lhs.m_key != a_rhs.m_key) return a_lhs.m_key < a_rhs.m_key;
+  return a_lhs.m_index.lexLT(a_rhs.m_index);
+}
+
+// Unpack a chunk into a bitmap of s_words words
+static void getBits(const Chunk& a_chunk, unsigned long long* a_words)
+{
+  if (a_chunk.m_count == s_cells)
+    {
+      for (int w = 0; w < s_words; w++) a_words[w] = s_allBits;
+    }
+  else if (a_chunk.m_bits.size() > 0)
+    {
+      memcpy(a_words, &(a_chunk.m_bits[0]), s_words*sizeof(unsigned long long));
+    }
+  else
+    {
+      memset(a_words, 0, s_words*sizeof(unsigned long long));
+      for (int i = 0; i < a_chunk.m_offsets.size(); i++)
+        {
+          int offset = a_chunk.m_offsets[i];
+          a_words[offset >> 6] |= 1ULL << (offset & 63);
+        }
+    }
+}
+
+// Store a bitmap in the cheapest container; returns the number of cells
+static int setBits(Chunk& a_chunk, const unsigned long long* a_words)
+{
+  int count = 0;
+  for (int w = 0; w < s_words; w++)
+    {
+      count += popCount(a_words[w]);
+    }
+  a_chunk.m_count = count;
+  if ((count == s_cells) || (count == 0))
+    {
+      std::vector<unsigned short>().swap(a_chunk.m_offsets);
+      std::vector<unsigned long long>().swap(a_chunk.m_bits);
+    }
+  else if (count <= s_maxOffsets)
+    {
+      std::vector<unsigned long long>().swap(a_chunk.m_bits);
+      a_chunk.m_offsets.resize(0);
+      for (int w = 0; w < s_words; w++)
+        {
+          for (unsigned long long word = a_words[w]; word != 0; word &= word - 1)
+            {
+              a_chunk.m_offsets.push_back(64*w + lowBit(word));
+            }
+        }
+    }
+  else
+    {
+      std::vector<unsigned short>().swap(a_chunk.m_offsets);
+      a_chunk.m_bits.assign(a_words, a_words + s_words);
+    }
+  return count;
+}
+
+static inline bool chunkContains(const Chunk& a_chunk, int a_offset)
+{
+  if (a_chunk.m_count == s_cells)
+    {
+      return true;
+    }
+  if (a_chunk.m_bits.size() > 0)
+    {
+      return (a_chunk.m_bits[a_offset >> 6] >> (a_offset & 63)) & 1ULL;
+    }
+  return std::binary_search(a_chunk.m_offsets.begin(), a_chunk.m_offsets.end(),
+                            (unsigned short)a_offset);
+}
+
+// Row a_row of a bitmap, and the (direction 1 and up) local position of it
+static inline unsigned long long getRow(const unsigned long long* a_words, int a_row)
+{
+  int bit = a_row*s_side;
+  return (a_words[bit >> 6] >> (bit & 63)) & s_rowMask;
+}
+
+static inline int rowCoordinate(int a_row, int a_dir)
+{
+  return (a_row >> ((a_dir - 1)*CIVS_CHUNKBITS)) & (s_side - 1);
+}
+
+// Bitmap of the cells of a_box, in coordinates local to the chunk
+static void boxMask(unsigned long long* a_words, const Box& a_box)
+{
+  memset(a_words, 0, s_words*sizeof(unsigned long long));
+  unsigned long long mask = rangeMask(a_box.smallEnd(0), a_box.bigEnd(0));
+  for (int row = 0; row < s_rows; row++)
+    {
+      bool inside = true;
+      for (int dir = 1; dir < SpaceDim; dir++)
+        {
+          int i = rowCoordinate(row, dir);
+          inside = inside && (i >= a_box.smallEnd(dir)) && (i <= a_box.bigEnd(dir));
+        }
+      if (inside)
+        {
+          int bit = row*s_side;
+          a_words[bit >> 6] |= mask << (bit & 63);
+        }
+    }
+}
+
+static inline Box chunkBox(const IntVect& a_index)
+{
+  IntVect lo = s_side*a_index;
+  return Box(lo, lo + (s_side - 1)*IntVect::Unit);
+}
+
+CompressedIntVectSet::CompressedIntVectSet()
+  :
+  m_minBoxValid(true)
+{
+}
+
+CompressedIntVectSet::CompressedIntVectSet(const Box& a_box)
+{
+  define(a_box);
+}
+
+void CompressedIntVectSet::define(const Box& a_box)
+{
+  std::vector<Run> runs;
+  if (!a_box.isEmpty())
+    {
+      Box rows(a_box);
+      rows.setBig(0, a_box.smallEnd(0));
+      for (BoxIterator bit(rows); bit.ok(); ++bit)
+        {
+          runs.push_back(Run(bit(), a_box.size(0)));
+        }
+    }
+  buildFromRuns(runs);
+}
+
+void CompressedIntVectSet::define(const Vector<Box>& a_boxes)
+{
+  std::vector<Run> runs;
+  for (int i = 0; i < a_boxes.size(); i++)
+    {
+      const Box& b = a_boxes[i];
+      if (b.isEmpty()) continue;
+      Box rows(b);
+      rows.setBig(0, b.smallEnd(0));
+      for (BoxIterator bit(rows); bit.ok(); ++bit)
+        {
+          runs.push_back(Run(bit(), b.size(0)));
+        }
+    }
+  buildFromRuns(runs);
+}
+
+void CompressedIntVectSet::clear()
+{
+  std::vector<Chunk>().swap(m_chunks);
+  m_minBox = Box();
+  m_minBoxValid = true;
+}
+
+#ifndef DOXYGEN
+// One row of one chunk, to be or'ed in
+struct RowPiece
+{
+  IntVect            m_index;
+  int                m_row;
+  unsigned long long m_bits;
+
+  bool operator<(const RowPiece& a_rhs) const
+  {
+    if (m_index != a_rhs.m_index) return m_index.lexLT(a_rhs.m_index);
+    return m_row < a_rhs.m_row;
+  }
+};
+#endif
+
+void CompressedIntVectSet::buildFromRuns(const std::vector<Run>& a_runs)
+{
+  // Cut the runs at the chunk boundaries
+  std::vector<RowPiece> pieces;
+  pieces.reserve(a_runs.size());
+  for (int i = 0; i < a_runs.size(); i++)
+    {
+      const IntVect& start = a_runs[i].first;
+      int lo = start[0];
+      int hi = start[0] + a_runs[i].second - 1;
+      RowPiece piece;
+      piece.m_index = chunkIndex(start);
+      piece.m_row = cellOffset(start, piece.m_index) >> CIVS_CHUNKBITS;
+      while (lo <= hi)
+        {
+          int base = s_side*piece.m_index[0];
+          int top  = Min(hi, base + s_side - 1);
+          piece.m_bits = rangeMask(lo - base, top - base);
+          pieces.push_back(piece);
+          lo = top + 1;
+          piece.m_index[0]++;
+        }
+    }
+  std::sort(pieces.begin(), pieces.end());
+
+  m_chunks.resize(0);
+  unsigned long long words[s_words];
+  int i = 0;
+  while (i < pieces.size())
+    {
+      Chunk chunk;
+      chunk.m_index = pieces[i].m_index;
+      chunk.m_key = mortonKey(chunk.m_index);
+      memset(words, 0, sizeof(words));
+      for (; (i < pieces.size()) && (pieces[i].m_index == chunk.m_index); i++)
+        {
+          int bit = pieces[i].m_row*s_side;
+          words[bit >> 6] |= pieces[i].m_bits << (bit & 63);
+        }
+      setBits(chunk, words);
+      m_chunks.push_back(chunk);
+    }
+  std::sort(m_chunks.begin(), m_chunks.end(), chunkLess);
+  m_minBoxValid = false;
+}
+
+void CompressedIntVectSet::getRuns(std::vector<Run>& a_runs) const
+{
+  unsigned long long words[s_words];
+  for (int ichunk = 0; ichunk < m_chunks.size(); ichunk++)
+    {
+      const Chunk& chunk = m_chunks[ichunk];
+      getBits(chunk, words);
+      IntVect base = s_side*chunk.m_index;
+      for (int row = 0; row < s_rows; row++)
+        {
+          unsigned long long bits = getRow(words, row);
+          if (bits == 0) continue;
+          IntVect start = base;
+          for (int dir = 1; dir < SpaceDim; dir++)
+            {
+              start[dir] += rowCoordinate(row, dir);
+            }
+          while (bits != 0)
+            {
+              int lo = lowBit(bits);
+              unsigned long long rest = ~(bits >> lo);
+              int length = (rest == 0) ? 64 - lo : lowBit(rest);
+              start[0] = base[0] + lo;
+              a_runs.push_back(Run(start, length));
+              bits = (lo + length >= 64) ? 0 : bits & (s_allBits << (lo + length));
+            }
+        }
+    }
+}
+
+int CompressedIntVectSet::findChunk(const IntVect& a_index) const
+{
+  Chunk probe;
+  probe.m_index = a_index;
+  probe.m_key = mortonKey(a_index);
+  std::vector<Chunk>::const_iterator it =
+    std::lower_bound(m_chunks.begin(), m_chunks.end(), probe, chunkLess);
+  if ((it == m_chunks.end()) || (it->m_index != a_index))
+    {
+      return -1;
+    }
+  return it - m_chunks.begin();
+}
+
+CompressedIntVectSet& CompressedIntVectSet::operator|=(const IntVect& a_iv)
+{
+  Chunk probe;
+  probe.m_index = chunkIndex(a_iv);
+  probe.m_key = mortonKey(probe.m_index);
+  int offset = cellOffset(a_iv, probe.m_index);
+  std::vector<Chunk>::iterator it =
+    std::lower_bound(m_chunks.begin(), m_chunks.end(), probe, chunkLess);
+  if ((it == m_chunks.end()) || (it->m_index != probe.m_index))
+    {
+      probe.m_count = 1;
+      probe.m_offsets.push_back(offset);
+      m_chunks.insert(it, probe);
+    }
+  else if (it->m_bits.size() > 0)
+    {
+      unsigned long long& word = it->m_bits[offset >> 6];
+      unsigned long long bit = 1ULL << (offset & 63);
+      if ((word & bit) == 0)
+        {
+          word |= bit;
+          if (++(it->m_count) == s_cells)
+            {
+              std::vector<unsigned long long>().swap(it->m_bits);
+            }
+        }
+    }
+  else if (it->m_count < s_cells)
+    {
+      std::vector<unsigned short>::iterator pos =
+        std::lower_bound(it->m_offsets.begin(), it->m_offsets.end(), (unsigned short)offset);
+      if ((pos == it->m_offsets.end()) || (*pos != offset))
+        {
+          it->m_offsets.insert(pos, offset);
+          it->m_count++;
+          if (it->m_count > s_maxOffsets)
+            {
+              unsigned long long words[s_words];
+              getBits(*it, words);
+              setBits(*it, words);
+            }
+        }
+    }
+
+  if (m_minBoxValid)
+    {
+      m_minBox.minBox(Box(a_iv, a_iv));
+    }
+  return *this;
+}
+
+CompressedIntVectSet& CompressedIntVectSet::operator|=(const Box& a_box)
+{
+  if (!a_box.isEmpty())
+    {
+      CompressedIntVectSet other(a_box);
+      *this |= other;
+    }
+  return *this;
+}
+
+CompressedIntVectSet& CompressedIntVectSet::operator|=(const CompressedIntVectSet& a_ivs)
+{
+  if (a_ivs.isEmpty() || (&a_ivs == this))
+    {
+      return *this;
+    }
+  if (isEmpty())
+    {
+      *this = a_ivs;
+      return *this;
+    }
+
+  std::vector<Chunk> result;
+  result.reserve(m_chunks.size() + a_ivs.m_chunks.size());
+  unsigned long long words[s_words], other[s_words];
+  int i = 0;
+  int j = 0;
+  while ((i < m_chunks.size()) || (j < a_ivs.m_chunks.size()))
+    {
+      if ((j == a_ivs.m_chunks.size()) ||
+          ((i < m_chunks.size()) && chunkLess(m_chunks[i], a_ivs.m_chunks[j])))
+        {
+          result.push_back(Chunk());
+          std::swap(result.back(), m_chunks[i++]);
+        }
+      else if ((i == m_chunks.size()) || chunkLess(a_ivs.m_chunks[j], m_chunks[i]))
+        {
+          result.push_back(a_ivs.m_chunks[j++]);
+        }
+      else
+        {
+          result.push_back(Chunk());
+          std::swap(result.back(), m_chunks[i++]);
+          Chunk& chunk = result.back();
+          if (chunk.m_count < s_cells)
+            {
+              getBits(chunk, words);
+              getBits(a_ivs.m_chunks[j], other);
+              for (int w = 0; w < s_words; w++) words[w] |= other[w];
+              setBits(chunk, words);
+            }
+          j++;
+        }
+    }
+  m_chunks.swap(result);
+  m_minBoxValid = false;
+  return *this;
+}
+
+CompressedIntVectSet& CompressedIntVectSet::operator&=(const CompressedIntVectSet& a_ivs)
+{
+  if (&a_ivs == this)
+    {
+      return *this;
+    }
+
+  std::vector<Chunk> result;
+  unsigned long long words[s_words], other[s_words];
+  int i = 0;
+  int j = 0;
+  while ((i < m_chunks.size()) && (j < a_ivs.m_chunks.size()))
+    {
+      if (chunkLess(m_chunks[i], a_ivs.m_chunks[j]))
+        {
+          i++;
+        }
+      else if (chunkLess(a_ivs.m_chunks[j], m_chunks[i]))
+        {
+          j++;
+        }
+      else
+        {
+          Chunk& chunk = m_chunks[i++];
+          getBits(chunk, words);
+          getBits(a_ivs.m_chunks[j++], other);
+          for (int w = 0; w < s_words; w++) words[w] &= other[w];
+          if (setBits(chunk, words) > 0)
+            {
+              result.push_back(Chunk());
+              std::swap(result.back(), chunk);
+            }
+        }
+    }
+  m_chunks.swap(result);
+  m_minBoxValid = false;
+  return *this;
+}
+
+CompressedIntVectSet& CompressedIntVectSet::operator-=(const CompressedIntVectSet& a_ivs)
+{
+  if (&a_ivs == this)
+    {
+      clear();
+      return *this;
+    }
+
+  std::vector<Chunk> result;
+  result.reserve(m_chunks.size());
+  unsigned long long words[s_words], other[s_words];
+  int i = 0;
+  int j = 0;
+  while (i < m_chunks.size())
+    {
+      if ((j == a_ivs.m_chunks.size()) || chunkLess(m_chunks[i], a_ivs.m_chunks[j]))
+        {
+          result.push_back(Chunk());
+          std::swap(result.back(), m_chunks[i++]);
+        }
+      else if (chunkLess(a_ivs.m_chunks[j], m_chunks[i]))
+        {
+          j++;
+        }
+      else
+        {
+          Chunk& chunk = m_chunks[i++];
+          getBits(chunk, words);
+          getBits(a_ivs.m_chunks[j++], other);
+          for (int w = 0; w < s_words; w++) words[w] &= ~other[w];
+          if (setBits(chunk, words) > 0)
+            {
+              result.push_back(Chunk());
+              std::swap(result.back(), chunk);
+            }
+        }
+    }
+  m_chunks.swap(result);
+  m_minBoxValid = false;
+  return *this;
+}
+
+CompressedIntVectSet& CompressedIntVectSet::operator-=(const IntVect& a_iv)
+{
+  IntVect index = chunkIndex(a_iv);
+  int ichunk = findChunk(index);
+  if (ichunk < 0)
+    {
+      return *this;
+    }
+  Chunk& chunk = m_chunks[ichunk];
+  int offset = cellOffset(a_iv, index);
+  if (!chunkContains(chunk, offset))
+    {
+      return *this;
+    }
+  if (chunk.m_count == 1)
+    {
+      m_chunks.erase(m_chunks.begin() + ichunk);
+    }
+  else if (chunk.m_offsets.size() > 0)
+    {
+      chunk.m_offsets.erase(std::lower_bound(chunk.m_offsets.begin(), chunk.m_offsets.end(),
+                                             (unsigned short)offset));
+      chunk.m_count--;
+    }
+  else
+    {
+      unsigned long long words[s_words];
+      getBits(chunk, words);
+      words[offset >> 6] &= ~(1ULL << (offset & 63));
+      setBits(chunk, words);
+    }
+  m_minBoxValid = false;
+  return *this;
+}
+
+CompressedIntVectSet& CompressedIntVectSet::operator-=(const Box& a_box)
+{
+  if (a_box.isEmpty() || isEmpty())
+    {
+      return *this;
+    }
+  std::vector<Chunk> result;
+  result.reserve(m_chunks.size());
+  unsigned long long words[s_words], mask[s_words];
+  for (int i = 0; i < m_chunks.size(); i++)
+    {
+      Chunk& chunk = m_chunks[i];
+      Box cbox = chunkBox(chunk.m_index);
+      if (cbox.intersectsNotEmpty(a_box))
+        {
+          Box local = a_box & cbox;
+          local.shift(-cbox.smallEnd());
+          boxMask(mask, local);
+          getBits(chunk, words);
+          for (int w = 0; w < s_words; w++) words[w] &= ~mask[w];
+          if (setBits(chunk, words) == 0)
+            {
+              continue;
+            }
+        }
+      result.push_back(Chunk());
+      std::swap(result.back(), chunk);
+    }
+  m_chunks.swap(result);
+  m_minBoxValid = false;
+  return *this;
+}
+
+void CompressedIntVectSet::restrictTo(int a_dir, int a_lo, int a_hi)
+{
+  std::vector<Chunk> result;
+  result.reserve(m_chunks.size());
+  unsigned long long words[s_words];
+  for (int i = 0; i < m_chunks.size(); i++)
+    {
+      Chunk& chunk = m_chunks[i];
+      int base = s_side*chunk.m_index[a_dir];
+      if ((base + s_side - 1 < a_lo) || (base > a_hi))
+        {
+          continue;
+        }
+      if ((base < a_lo) || (base + s_side - 1 > a_hi))
+        {
+          // Written so that a_lo = INT_MIN or a_hi = INT_MAX cannot overflow
+          int lo = (a_lo > base) ? a_lo - base : 0;
+          int hi = (a_hi < base + s_side - 1) ? a_hi - base : s_side - 1;
+          getBits(chunk, words);
+          for (int row = 0; row < s_rows; row++)
+            {
+              int bit = row*s_side;
+              unsigned long long keep;
+              if (a_dir == 0)
+                {
+                  keep = rangeMask(lo, hi);
+                }
+              else
+                {
+                  int coord = rowCoordinate(row, a_dir);
+                  keep = ((coord >= lo) && (coord <= hi)) ? s_rowMask : 0;
+                }
+              words[bit >> 6] &= ~((s_rowMask & ~keep) << (bit & 63));
+            }
+          if (setBits(chunk, words) == 0)
+            {
+              continue;
+            }
+        }
+      result.push_back(Chunk());
+      std::swap(result.back(), chunk);
+    }
+  m_chunks.swap(result);
+  m_minBoxValid = false;
+}
+
+CompressedIntVectSet& CompressedIntVectSet::operator&=(const Box& a_box)
+{
+  if (a_box.isEmpty())
+    {
+      clear();
+      return *this;
+    }
+  for (int dir = 0; dir < SpaceDim; dir++)
+    {
+      restrictTo(dir, a_box.smallEnd(dir), a_box.bigEnd(dir));
+    }
+  return *this;
+}
+
+CompressedIntVectSet& CompressedIntVectSet::operator&=(const ProblemDomain& a_domain)
+{
+  if (!a_domain.isPeriodic())
+    {
+      return *this &= a_domain.domainBox();
+    }
+  CompressedIntVectSet outside(*this);
+  outside -= a_domain.domainBox();
+  *this &= a_domain.domainBox();
+  for (CompressedIntVectSetIterator it(outside); it.ok(); ++it)
+    {
+      IntVect iv = it();
+      if (a_domain.image(iv)) *this |= iv;
+    }
+  return *this;
+}
+
+bool CompressedIntVectSet::operator==(const CompressedIntVectSet& a_ivs) const
+{
+  if (m_chunks.size() != a_ivs.m_chunks.size())
+    {
+      return false;
+    }
+  for (int i = 0; i < m_chunks.size(); i++)
+    {
+      const Chunk& a = m_chunks[i];
+      const Chunk& b = a_ivs.m_chunks[i];
+      if ((a.m_index != b.m_index) || (a.m_count != b.m_count) ||
+          (a.m_offsets != b.m_offsets) || (a.m_bits != b.m_bits))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+bool CompressedIntVectSet::operator<(const CompressedIntVectSet& a_ivs) const
+{
+  int n = numPts();
+  int nother = a_ivs.numPts();
+  if (n != nother)
+    {
+      return n < nother;
+    }
+  for (int i = 0; (i < m_chunks.size()) && (i < a_ivs.m_chunks.size()); i++)
+    {
+      const Chunk& a = m_chunks[i];
+      const Chunk& b = a_ivs.m_chunks[i];
+      if (chunkLess(a, b)) return true;
+      if (chunkLess(b, a)) return false;
+      if (a.m_count != b.m_count) return a.m_count < b.m_count;
+      if (a.m_offsets != b.m_offsets) return a.m_offsets < b.m_offsets;
+      if (a.m_bits != b.m_bits) return a.m_bits < b.m_bits;
+    }
+  return false;
+}
+
+Vector<Box> CompressedIntVectSet::createBoxes() const
+{
+  std::vector<Run> runs;
+  getRuns(runs);
+  Vector<Box> boxes(runs.size());
+  for (int i = 0; i < runs.size(); i++)
+    {
+      boxes[i] = Box(runs[i].first, runs[i].first + (runs[i].second - 1)*BASISV(0));
+    }
+  return boxes;
+}
+
+bool CompressedIntVectSet::contains(const IntVect& a_iv) const
+{
+  IntVect index = chunkIndex(a_iv);
+  int ichunk = findChunk(index);
+  return (ichunk >= 0) && chunkContains(m_chunks[ichunk], cellOffset(a_iv, index));
+}
+
+bool CompressedIntVectSet::contains(const Box& a_box) const
+{
+  if (a_box.isEmpty())
+    {
+      return true;
+    }
+  unsigned long long words[s_words], mask[s_words];
+  Box chunks(chunkIndex(a_box.smallEnd()), chunkIndex(a_box.bigEnd()));
+  for (BoxIterator bit(chunks); bit.ok(); ++bit)
+    {
+      int ichunk = findChunk(bit());
+      if (ichunk < 0)
+        {
+          return false;
+        }
+      const Chunk& chunk = m_chunks[ichunk];
+      if (chunk.m_count == s_cells)
+        {
+          continue;
+        }
+      Box cbox = chunkBox(bit());
+      Box local = a_box & cbox;
+      local.shift(-cbox.smallEnd());
+      boxMask(mask, local);
+      getBits(chunk, words);
+      for (int w = 0; w < s_words; w++)
+        {
+          if ((words[w] & mask[w]) != mask[w]) return false;
+        }
+    }
+  return true;
+}
+
+CompressedIntVectSet CompressedIntVectSet::chop(int a_dir, int a_chopPnt)
+{
+  CompressedIntVectSet hi;
+  chop(a_dir, a_chopPnt, hi);
+  return hi;
+}
+
+void CompressedIntVectSet::chop(int a_dir, int a_chopPnt, CompressedIntVectSet& a_hi)
+{
+  a_hi = *this;
+  a_hi.restrictTo(a_dir, a_chopPnt, INT_MAX);
+  restrictTo(a_dir, INT_MIN, a_chopPnt - 1);
+}
+
+void CompressedIntVectSet::grow(int a_igrow)
+{
+  if (a_igrow == 0) return;
+  if (a_igrow < 0) MayDay::Error("CompressedIntVectSet::grow(int) called with negative value");
+
+  std::vector<Run> runs, grown;
+  getRuns(runs);
+  Box rows(IntVect::Zero, IntVect::Zero);
+  for (int dir = 1; dir < SpaceDim; dir++)
+    {
+      rows.grow(dir, a_igrow);
+    }
+  grown.reserve(runs.size()*rows.numPts());
+  for (int i = 0; i < runs.size(); i++)
+    {
+      IntVect start = runs[i].first - a_igrow*BASISV(0);
+      for (BoxIterator bit(rows); bit.ok(); ++bit)
+        {
+          grown.push_back(Run(start + bit(), runs[i].second + 2*a_igrow));
+        }
+    }
+  buildFromRuns(grown);
+}
+
+void CompressedIntVectSet::grow(int a_dir, int a_igrow)
+{
+  if (a_igrow == 0) return;
+  if (a_igrow < 0) MayDay::Error("CompressedIntVectSet::grow(int) called with negative value");
+
+  std::vector<Run> runs, grown;
+  getRuns(runs);
+  if (a_dir == 0)
+    {
+      for (int i = 0; i < runs.size(); i++)
+        {
+          runs[i].first[0] -= a_igrow;
+          runs[i].second += 2*a_igrow;
+        }
+      buildFromRuns(runs);
+      return;
+    }
+  grown.reserve(runs.size()*(2*a_igrow + 1));
+  for (int i = 0; i < runs.size(); i++)
+    {
+      for (int k = -a_igrow; k <= a_igrow; k++)
+        {
+          grown.push_back(Run(runs[i].first + k*BASISV(a_dir), runs[i].second));
+        }
+    }
+  buildFromRuns(grown);
+}
+
+void CompressedIntVectSet::growHi()
+{
+  std::vector<Run> runs, grown;
+  getRuns(runs);
+  Box rows(IntVect::Zero, IntVect::Zero);
+  for (int dir = 1; dir < SpaceDim; dir++)
+    {
+      rows.growHi(dir, 1);
+    }
+  grown.reserve(runs.size()*rows.numPts());
+  for (int i = 0; i < runs.size(); i++)
+    {
+      for (BoxIterator bit(rows); bit.ok(); ++bit)
+        {
+          grown.push_back(Run(runs[i].first + bit(), runs[i].second + 1));
+        }
+    }
+  buildFromRuns(grown);
+}
+
+void CompressedIntVectSet::growHi(int a_dir)
+{
+  std::vector<Run> runs, grown;
+  getRuns(runs);
+  if (a_dir == 0)
+    {
+      for (int i = 0; i < runs.size(); i++)
+        {
+          runs[i].second++;
+        }
+      buildFromRuns(runs);
+      return;
+    }
+  grown.reserve(2*runs.size());
+  for (int i = 0; i < runs.size(); i++)
+    {
+      grown.push_back(runs[i]);
+      grown.push_back(Run(runs[i].first + BASISV(a_dir), runs[i].second));
+    }
+  buildFromRuns(grown);
+}
+
+void CompressedIntVectSet::refine(int a_iref)
+{
+  CH_assert(a_iref > 0);
+  if (a_iref == 1) return;
+
+  std::vector<Run> runs, fine;
+  getRuns(runs);
+  Box rows(IntVect::Zero, IntVect::Zero);
+  for (int dir = 1; dir < SpaceDim; dir++)
+    {
+      rows.setBig(dir, a_iref - 1);
+    }
+  fine.reserve(runs.size()*rows.numPts());
+  for (int i = 0; i < runs.size(); i++)
+    {
+      IntVect start = a_iref*runs[i].first;
+      for (BoxIterator bit(rows); bit.ok(); ++bit)
+        {
+          fine.push_back(Run(start + bit(), a_iref*runs[i].second));
+        }
+    }
+  buildFromRuns(fine);
+}
+
+void CompressedIntVectSet::coarsen(int a_iref)
+{
+  CH_assert(a_iref > 0);
+  if (a_iref == 1) return;
+
+  std::vector<Run> runs;
+  getRuns(runs);
+  for (int i = 0; i < runs.size(); i++)
+    {
+      IntVect& start = runs[i].first;
+      int end = floorDiv(start[0] + runs[i].second - 1, a_iref);
+      for (int dir = 0; dir < SpaceDim; dir++)
+        {
+          start[dir] = floorDiv(start[dir], a_iref);
+        }
+      runs[i].second = end - start[0] + 1;
+    }
+  buildFromRuns(runs);
+}
+
+void CompressedIntVectSet::shift(const IntVect& a_iv)
+{
+  bool aligned = true;
+  for (int dir = 0; dir < SpaceDim; dir++)
+    {
+      aligned = aligned && (a_iv[dir] % s_side == 0);
+    }
+  if (aligned)
+    {
+      // Whole chunks move; only the order changes
+      IntVect chunkShift = a_iv/s_side;
+      for (int i = 0; i < m_chunks.size(); i++)
+        {
+          m_chunks[i].m_index += chunkShift;
+          m_chunks[i].m_key = mortonKey(m_chunks[i].m_index);
+        }
+      std::sort(m_chunks.begin(), m_chunks.end(), chunkLess);
+      if (m_minBoxValid) m_minBox.shift(a_iv);
+      return;
+    }
+
+  std::vector<Run> runs;
+  getRuns(runs);
+  for (int i = 0; i < runs.size(); i++)
+    {
+      runs[i].first += a_iv;
+    }
+  buildFromRuns(runs);
+}
+
+void CompressedIntVectSet::nestingRegion(int a_radius, const Box& a_domain, int a_granularity)
+{
+  TreeIntVectSet tree;
+  Vector<Box> boxes = createBoxes();
+  for (int i = 0; i < boxes.size(); i++)
+    {
+      tree |= boxes[i];
+    }
+  tree.nestingRegion(a_radius, a_domain, a_granularity);
+  define(tree.createBoxes());
+}
+
+void CompressedIntVectSet::nestingRegion(int a_radius, const ProblemDomain& a_domain, int a_granularity)
+{
+  TreeIntVectSet tree;
+  Vector<Box> boxes = createBoxes();
+  for (int i = 0; i < boxes.size(); i++)
+    {
+      tree |= boxes[i];
+    }
+  tree.nestingRegion(a_radius, a_domain, a_granularity);
+  define(tree.createBoxes());
+}
+
+const Box& CompressedIntVectSet::minBox() const
+{
+  if (!m_minBoxValid)
+    {
+      recalcMinBox();
+    }
+  return m_minBox;
+}
+
+void CompressedIntVectSet::recalcMinBox() const
+{
+  m_minBox = Box();
+  unsigned long long words[s_words];
+  for (int i = 0; i < m_chunks.size(); i++)
+    {
+      const Chunk& chunk = m_chunks[i];
+      if (chunk.m_count == s_cells)
+        {
+          m_minBox.minBox(chunkBox(chunk.m_index));
+          continue;
+        }
+      getBits(chunk, words);
+      IntVect lo, hi;
+      bool first = true;
+      for (int row = 0; row < s_rows; row++)
+        {
+          unsigned long long bits = getRow(words, row);
+          if (bits == 0) continue;
+          IntVect rowLo, rowHi;
+          rowLo[0] = lowBit(bits);
+          rowHi[0] = highBit(bits);
+          for (int dir = 1; dir < SpaceDim; dir++)
+            {
+              rowLo[dir] = rowCoordinate(row, dir);
+              rowHi[dir] = rowLo[dir];
+            }
+          if (first)
+            {
+              lo = rowLo;
+              hi = rowHi;
+              first = false;
+            }
+          else
+            {
+              lo.min(rowLo);
+              hi.max(rowHi);
+            }
+        }
+      IntVect base = s_side*chunk.m_index;
+      m_minBox.minBox(Box(base + lo, base + hi));
+    }
+  m_minBoxValid = true;
+}
+
+int CompressedIntVectSet::numPts() const
+{
+  int n = 0;
+  for (int i = 0; i < m_chunks.size(); i++)
+    {
+      n += m_chunks[i].m_count;
+    }
+  return n;
+}
+
+void CompressedIntVectSet::compact() const
+{
+  // logically const
+  std::vector<Chunk>& chunks = (std::vector<Chunk>&)m_chunks;
+  for (int i = 0; i < chunks.size(); i++)
+    {
+      std::vector<unsigned short>(chunks[i].m_offsets).swap(chunks[i].m_offsets);
+    }
+  std::vector<Chunk>(chunks).swap(chunks);
+}
+
+long long CompressedIntVectSet::memory() const
+{
+  long long bytes = m_chunks.capacity()*sizeof(Chunk);
+  for (int i = 0; i < m_chunks.size(); i++)
+    {
+      bytes += m_chunks[i].m_offsets.capacity()*sizeof(unsigned short);
+      bytes += m_chunks[i].m_bits.capacity()*sizeof(unsigned long long);
+    }
+  return bytes;
+}
+
+// The linear form is the number of chunks, then for each chunk its index,
+// its count, and the offsets or the bitmap the count calls for.
+int CompressedIntVectSet::linearSize() const
+{
+  int size = sizeof(int);
+  for (int i = 0; i < m_chunks.size(); i++)
+    {
+      size += (SpaceDim + 1)*sizeof(int);
+      size += m_chunks[i].m_offsets.size()*sizeof(unsigned short);
+      size += m_chunks[i].m_bits.size()*sizeof(unsigned long long);
+    }
+  return size;
+}
+
+void CompressedIntVectSet::linearOut(void* const a_outBuf) const
+{
+  char* buf = (char*)a_outBuf;
+  int n = m_chunks.size();
+  memcpy(buf, &n, sizeof(int));
+  buf += sizeof(int);
+  for (int i = 0; i < n; i++)
+    {
+      const Chunk& chunk = m_chunks[i];
+      memcpy(buf, chunk.m_index.dataPtr(), SpaceDim*sizeof(int));
+      buf += SpaceDim*sizeof(int);
+      memcpy(buf, &(chunk.m_count), sizeof(int));
+      buf += sizeof(int);
+      int nbytes = chunk.m_offsets.size()*sizeof(unsigned short);
+      if (nbytes > 0)
+        {
+          memcpy(buf, &(chunk.m_offsets[0]), nbytes);
+          buf += nbytes;
+        }
+      nbytes = chunk.m_bits.size()*sizeof(unsigned long long);
+      if (nbytes > 0)
+        {
+          memcpy(buf, &(chunk.m_bits[0]), nbytes);
+          buf += nbytes;
+        }
+    }
+}
+
+void CompressedIntVectSet::linearIn(const void* const a_inBuf)
+{
+  const char* buf = (const char*)a_inBuf;
+  int n;
+  memcpy(&n, buf, sizeof(int));
+  buf += sizeof(int);
+  m_chunks.resize(n);
+  for (int i = 0; i < n; i++)
+    {
+      Chunk& chunk = m_chunks[i];
+      memcpy(chunk.m_index.dataPtr(), buf, SpaceDim*sizeof(int));
+      buf += SpaceDim*sizeof(int);
+      memcpy(&(chunk.m_count), buf, sizeof(int));
+      buf += sizeof(int);
+      chunk.m_key = mortonKey(chunk.m_index);
+      chunk.m_offsets.resize(0);
+      chunk.m_bits.resize(0);
+      if (chunk.m_count <= s_maxOffsets)
+        {
+          chunk.m_offsets.resize(chunk.m_count);
+          memcpy(&(chunk.m_offsets[0]), buf, chunk.m_count*sizeof(unsigned short));
+          buf += chunk.m_count*sizeof(unsigned short);
+        }
+      else if (chunk.m_count < s_cells)
+        {
+          chunk.m_bits.resize(s_words);
+          memcpy(&(chunk.m_bits[0]), buf, s_words*sizeof(unsigned long long));
+          buf += s_words*sizeof(unsigned long long);
+        }
+    }
+  m_minBoxValid = false;
+}
+
+//====================================================================
+CompressedIntVectSetIterator::CompressedIntVectSetIterator()
+  :
+  m_ivs(NULL),
+  m_chunk(0),
+  m_offset(0),
+  m_position(0)
+{
+}
+
+CompressedIntVectSetIterator::CompressedIntVectSetIterator(const CompressedIntVectSet& a_ivs)
+{
+  define(a_ivs);
+}
+
+void CompressedIntVectSetIterator::define(const CompressedIntVectSet& a_ivs)
+{
+  m_ivs = &a_ivs;
+  begin();
+}
+
+void CompressedIntVectSetIterator::begin()
+{
+  m_chunk = 0;
+  m_offset = 0;
+  m_position = 0;
+  seek();
+}
+
+void CompressedIntVectSetIterator::end()
+{
+  if (m_ivs != NULL)
+    {
+      m_chunk = m_ivs->m_chunks.size();
+    }
+}
+
+void CompressedIntVectSetIterator::operator++()
+{
+  m_offset++;
+  m_position++;
+  seek();
+}
+
+void CompressedIntVectSetIterator::seek()
+{
+  if (m_ivs == NULL) return;
+  const std::vector<Chunk>& chunks = m_ivs->m_chunks;
+  while (m_chunk < chunks.size())
+    {
+      const Chunk& chunk = chunks[m_chunk];
+      if (chunk.m_count == s_cells)
+        {
+          if (m_offset < s_cells) break;
+        }
+      else if (chunk.m_bits.size() > 0)
+        {
+          if (m_offset < s_cells)
+            {
+              int w = m_offset >> 6;
+              unsigned long long word = chunk.m_bits[w] & (s_allBits << (m_offset & 63));
+              while ((word == 0) && (++w < s_words))
+                {
+                  word = chunk.m_bits[w];
+                }
+              if (word != 0)
+                {
+                  m_offset = 64*w + lowBit(word);
+                  break;
+                }
+            }
+        }
+      else if (m_position < chunk.m_offsets.size())
+        {
+          m_offset = chunk.m_offsets[m_position];
+          break;
+        }
+      m_chunk++;
+      m_offset = 0;
+      m_position = 0;
+    }
+  if (m_chunk < chunks.size())
+    {
+      m_current = offsetCell(m_offset, chunks[m_chunk].m_index);
+    }
+}
+
+#include "NamespaceFooter.H"
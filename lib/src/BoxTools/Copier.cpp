@@ -13,12 +13,13 @@
 #include "Copier.H"
 #include "MayDay.H"
 #include "LayoutIterator.H"
-#include "NeighborIterator.H"
+#include "DistributedBoxIndex.H"
 #include "BoxIterator.H"
 #include "SPMD.H"
 #include "CH_Timer.H"
 #include "memtrack.H"
 #include "parstream.H"
+#include <algorithm>
 #include <chrono>
 
 #include <vector>
@@ -518,6 +519,12 @@ void Copier::define(const BoxLayout& a_level,
   CH_assert(a_dest.isClosed());
   //  CH_assert(a_level.checkPeriodic(a_domain));
 
+  if (a_level.isDistributed() || a_dest.isDistributed())
+    {
+      defineDistributed(a_level, a_dest, a_domain, a_ghost, a_exchange, a_shift);
+      return;
+    }
+
   clear();
   m_isDefined = true;
   buffersAllocated = false;
@@ -525,12 +532,6 @@ void Copier::define(const BoxLayout& a_level,
   const BoxLayout& level = a_level;
   const BoxLayout& dest = a_dest;
 
-  // set up vector of dataIndexes to keep track of which
-  // "to" boxes are not completely contained within the primary
-  // domain.  these boxes are then candidates for filling by
-  // periodic images of the "from" data.
-  Vector<DataIndex> periodicallyFilledToVect;
-
   // in order to cull which "from" data may be needed to
   // fill the "to" data, keep track of the radius around the
   // primary domain in which all these cells lie.
@@ -606,188 +607,106 @@ void Copier::define(const BoxLayout& a_level,
 
   unsigned int myprocID = procID();
 
-  // The following 4 for loops are the result of a performance optimization.
-  // When increasing the size of the problem, we found that the code was
-  // looping over every destination box for every source box which was N1*N2
-  // loop iterations (essentially an N-squared approach).
-  // The following code attempts to simply reduce N1 and N2 by first separating
-  // the boxes (or LayoutIndexes to boxes) that reside on the current processor.
-  // Then the loop to determine which boxes of the first list intersect with
-  // which boxes of the second list can be done in N1' * N2' iterations,
-  // where N1' is the reduced N1 and N2' is the reduced N2.
-  // We have to break up the assigning of MotionItems into two separate
-  // loops and be careful about the local copies.  These 4 loops are
-  // significantly faster than the original for loop -- _especially_
-  // for large problems.  (ndk)
-
-#ifdef CH_MPI  // don't need to do this in serial
-  // make a vector of boxes (or LayoutIndexes to boxes) from destination layout
-  // that are known to reside on this processor.
-  vector<DataIndex> vectorDestDI;
-  vector<DataIndex> vectorDestOnProcDI;
-  for (LayoutIterator to(a_dest.layoutIterator()); to.ok(); ++to)
-  {
-    vectorDestDI.push_back(DataIndex(to()));
-    if (myprocID == dest.procID(to()))
-    {
-      vectorDestOnProcDI.push_back(DataIndex(to()));
-    }
-  }
-
-  // make a vector of boxes (or LayoutIndexes to boxes) from "level"/src layout
-  // that are known to reside on this processor.
-  vector<DataIndex> vectorLevelDI;
-  vector<DataIndex> vectorLevelOnProcDI;
-  for (LayoutIterator from(a_level.layoutIterator()); from.ok(); ++from)
-  {
-    vectorLevelDI.push_back(DataIndex(from()));
-    if (myprocID == level.procID(from()))
-    {
-      vectorLevelOnProcDI.push_back(DataIndex(from()));
-    }
-  }
-#else
-  // in serial, it's not very interesting as it's all of them.
-  vector<DataIndex> vectorDestOnProcDI;
-  vector<DataIndex> vectorLevelDI;
-  for (LayoutIterator to(a_dest.layoutIterator()); to.ok(); ++to)
-  {
-    vectorDestOnProcDI.push_back(DataIndex(to()));
-  }
-  for (LayoutIterator from(a_level.layoutIterator()); from.ok(); ++from)
-  {
-    vectorLevelDI.push_back(DataIndex(from()));
-  }
-#endif
-
-  bool isSorted = (a_level.isSorted() && a_dest.isSorted());
+  // Rather than looping over every destination box for every source box
+  // (N1*N2 iterations), each box of this processor asks the spatial index
+  // of the other layout for the boxes it meets (see
+  // BoxLayout::findIntersecting), which costs about the number of
+  // intersections found.  Local copies are made in the first loop only.
+  Vector<LayoutIndex> found;
 
   // loop over all dest/to DI's on my processor
-  for (vector<DataIndex>::iterator vdi = vectorDestOnProcDI.begin();
-      vdi != vectorDestOnProcDI.end(); ++vdi)
+  for (DataIterator dit = dest.dataIterator(); dit.ok(); ++dit)
   {
     // at this point, i know myprocID == toProcID
-    const DataIndex todi(*vdi);
+    const DataIndex todi(dit());
 
     Box ghost(dest[todi]);
     ghost -= a_shift;
 
     ghost.grow(a_ghost);
 
-    //bool isSorted = (a_level.isSorted() && a_dest.isSorted());
-    // then for each level/from DI, see if they intersect
-    for (vector<DataIndex>::iterator vli = vectorLevelDI.begin();
-        vli != vectorLevelDI.end(); ++vli)
+    // then for each level/from DI that it meets
+    level.findIntersecting(found, ghost);
+    for (int i = 0; i < found.size(); ++i)
     {
-      const DataIndex fromdi(*vli);
+      const DataIndex fromdi(found[i]);
       const unsigned int fromProcID = level.procID(fromdi);
       const Box& fromBox = level[fromdi];
-      if ((fromBox.bigEnd(0) < ghost.smallEnd(0)) && isSorted )
-      {
-        //can skip rest cuz we haven't gotten to something interesting
-        continue;
-      }
 
-      if (ghost.intersectsNotEmpty(fromBox))
-      {
-        Box srcBox(ghost); // ??
-        srcBox &= fromBox; // ??
+      Box srcBox(ghost);
+      srcBox &= fromBox;
 
-        Box destBox = srcBox + a_shift;
+      Box destBox = srcBox + a_shift;
 
-        MotionItem* item = new (s_motionItemPool.getPtr())
-          MotionItem(fromdi, todi, srcBox, destBox);
-        if (item == NULL)
-        {
-          MayDay::Error("Out of Memory in copier::define");
-        }
-        if (fromProcID == myprocID)
-        { // local move
-          if (a_exchange && fromdi == todi)
-            s_motionItemPool.returnPtr(item);
-          else
-            m_localMotionPlan.push_back(item);
-        }
+      MotionItem* item = new (s_motionItemPool.getPtr())
+        MotionItem(fromdi, todi, srcBox, destBox);
+      if (item == NULL)
+      {
+        MayDay::Error("Out of Memory in copier::define");
+      }
+      if (fromProcID == myprocID)
+      { // local move
+        if (a_exchange && fromdi == todi)
+          s_motionItemPool.returnPtr(item);
         else
-        {
-          item->procID = fromProcID;
-          m_toMotionPlan.push_back(item);
-        }
+          m_localMotionPlan.push_back(item);
       }
-      if ((fromBox.smallEnd(0) > ghost.bigEnd(0)) && isSorted)
+      else
       {
-        //can break out of loop, since we know that the smallEnd
-        // of all the remaining boxes are lexigraphically beyond this ghosted box.
-        break;
+        item->procID = fromProcID;
+        m_toMotionPlan.push_back(item);
       }
-
     }
   }
 
   // Don't need to worry about this in serial as we already
   // took care of the local copy motion items just above.  skip this.
 #ifdef CH_MPI
-  // loop over all dest/to DI's
-  for (vector<DataIndex>::iterator vdi = vectorDestDI.begin();
-      vdi != vectorDestDI.end(); ++vdi)
+  // loop over all level/from DI's on my processor
+  for (DataIterator dit = level.dataIterator(); dit.ok(); ++dit)
   {
+    // at this point, i know myprocID == fromProcID
+    const DataIndex fromdi(dit());
+    const Box& fromBox = level[fromdi];
 
-    const DataIndex todi(*vdi);
-
-    Box ghost(dest[todi]);
-    ghost -= a_shift;
-
-    ghost.grow(a_ghost);
+    // a dest box whose ghosted, shifted box meets fromBox meets this
+    Box query(fromBox);
+    query.grow(a_ghost);
+    query += a_shift;
 
-    const unsigned int toProcID = dest.procID(todi);
-
-    // then for each level/from DI on this processor, see if they intersect
-    for (vector<DataIndex>::iterator vli = vectorLevelOnProcDI.begin();
-        vli != vectorLevelOnProcDI.end(); ++vli)
+    dest.findIntersecting(found, query);
+    for (int i = 0; i < found.size(); ++i)
     {
-
-      // at this point, i know myprocID == fromProcID
-
-      const DataIndex fromdi(*vli);
-      const Box& fromBox = level[fromdi];
-
-      if ((fromBox.bigEnd(0) < ghost.smallEnd(0)) && isSorted)
-      {
-        //can skip rest cuz we haven't gotten to something interesting
+      const DataIndex todi(found[i]);
+      const unsigned int toProcID = dest.procID(todi);
+      if (toProcID == myprocID)
+      { // local move
+        // don't push back here!  or you will get two.
+        //     we already did it above...
         continue;
       }
 
+      Box ghost(dest[todi]);
+      ghost -= a_shift;
+
+      ghost.grow(a_ghost);
+
       if (ghost.intersectsNotEmpty(fromBox))
       {
-        Box srcBox(ghost); // ??
-        srcBox &= fromBox; // ??
+        Box srcBox(ghost);
+        srcBox &= fromBox;
 
         Box destBox = srcBox + a_shift;
 
-        if (toProcID == myprocID)
-        { // local move
-          // don't push back here!  or you will get two.
-          //     we already did it above...
-          //m_localMotionPlan.push_back(item);
-        }
-        else
+        MotionItem* item = new (s_motionItemPool.getPtr())
+          MotionItem(fromdi, todi, srcBox, destBox);
+        if (item == NULL)
         {
-          MotionItem* item = new (s_motionItemPool.getPtr())
-            MotionItem(fromdi, todi, srcBox, destBox);
-          if (item == NULL)
-          {
-            MayDay::Error("Out of Memory in copier::define");
-          }
-
-          item->procID = toProcID;
-          m_fromMotionPlan.push_back(item);
+          MayDay::Error("Out of Memory in copier::define");
         }
-      }
-      if ((fromBox.smallEnd(0) > ghost.bigEnd(0)) && isSorted)
-      {
-        //can break out of loop, since we know that the smallEnd
-        // of all the remaining boxes are lexigraphically beyond this ghosted box.
-        break;
+
+        item->procID = toProcID;
+        m_fromMotionPlan.push_back(item);
       }
     }
   }
@@ -810,10 +729,8 @@ void Copier::define(const BoxLayout& a_level,
       // only do this if ghost box hangs over domain edge
       if (!domainBox.contains(ghost))
       {
-        // add the dataIndex for this box to the list
-        // of boxes which we need to come back to
-        periodicallyFilledToVect.push_back(DataIndex(to()));
-        // now check to see if we need to grow the
+        // this box is a candidate for filling by periodic
+        // images of the "from" data.  check to see if we need to grow the
         // periodic check radius
         if (!grownDomainCheckBox.contains(ghost))
         {
@@ -833,8 +750,6 @@ void Copier::define(const BoxLayout& a_level,
     } // end if periodic
   }
 
-  // Here ends the so-called N-squared optimizations.  the rest is unchanged. (ndk)
-
   // now do periodic checking, if necessary
   if (isPeriodic)
     {
@@ -899,59 +814,63 @@ void Copier::define(const BoxLayout& a_level,
                     } // end if we need to grow domain check box
                 } // end if fromBox is outside domain
 
-              // now loop over those "to" boxes which were not contained
-              // in the domain
-              for (int toRef = 0; toRef < periodicallyFilledToVect.size(); toRef++)
+              // now loop over shift vectors and find the "to" boxes,
+              // among those which were not contained in the domain,
+              // whose shifted ghosted box meets fromBox
+              for (shiftIt.begin(); shiftIt.ok(); ++shiftIt)
                 {
-                  DataIndex toIndex = periodicallyFilledToVect[toRef];
-                  unsigned int toProcID = dest.procID(toIndex);
-
-                  // don't worry about anything that doesn't involve this proc
-                  if (toProcID != myprocID && fromProcID != myprocID)
-                    {
-                      // do nothing
-                    }
-                  else
+                  IntVect shiftVect(shiftIt()*shiftMult);
+                  Box query(fromBox);
+                  query.shift(-shiftVect);
+                  query.grow(a_ghost);
+                  dest.findIntersecting(found, query);
+                  for (int i = 0; i < found.size(); ++i)
                     {
+                      DataIndex toIndex(found[i]);
+                      unsigned int toProcID = dest.procID(toIndex);
+
+                      // don't worry about anything that doesn't involve this proc
+                      if (toProcID != myprocID && fromProcID != myprocID)
+                        {
+                          continue;
+                        }
+
                       Box ghost(dest[toIndex]);
                       ghost.grow(a_ghost);
-                      // now need to loop over shift vectors and look at images
-                      for (shiftIt.begin(); shiftIt.ok(); ++shiftIt)
+                      if (domainBox.contains(ghost))
                         {
-                          IntVect shiftVect(shiftIt()*shiftMult);
-                          ghost.shift(shiftVect);
-                          if (ghost.intersectsNotEmpty(fromBox)) // rarely happens
+                          continue;
+                        }
+                      ghost.shift(shiftVect);
+                      if (ghost.intersectsNotEmpty(fromBox)) // rarely happens
+                        {
+                          Box intersectBox(ghost);
+                          intersectBox &= fromBox;
+                          Box toBox(intersectBox);
+                          toBox.shift(-shiftVect);
+                          MotionItem* item = new (s_motionItemPool.getPtr())
+                            MotionItem(DataIndex(from()), toIndex,
+                                       intersectBox, toBox);
+                          if (item == NULL)
                             {
-                              Box intersectBox(ghost);
-                              intersectBox &= fromBox;
-                              Box toBox(intersectBox);
-                              toBox.shift(-shiftVect);
-                              MotionItem* item = new (s_motionItemPool.getPtr())
-                                MotionItem(DataIndex(from()), DataIndex(toIndex),
-                                           intersectBox, toBox);
-                              if (item == NULL)
-                                {
-                                  MayDay::Error("Out of Memory in copier::define");
-                                }
-                              if (toProcID == fromProcID) // local move
-                                m_localMotionPlan.push_back(item);
-                              else if (fromProcID == myprocID)
-                                {
-                                  item->procID = toProcID;
-                                  m_fromMotionPlan.push_back(item);
-                                }
-                              else
-                                {
-                                  item->procID = fromProcID;
-                                  m_toMotionPlan.push_back(item);
-                                }
-
-                            } // end if shifted box intersects
+                              MayDay::Error("Out of Memory in copier::define");
+                            }
+                          if (toProcID == fromProcID) // local move
+                            m_localMotionPlan.push_back(item);
+                          else if (fromProcID == myprocID)
+                            {
+                              item->procID = toProcID;
+                              m_fromMotionPlan.push_back(item);
+                            }
+                          else
+                            {
+                              item->procID = fromProcID;
+                              m_toMotionPlan.push_back(item);
+                            }
 
-                          ghost.shift(-shiftVect);
-                        } // end loop over shift vectors
-                    } // end if either from box or to box are on this proc
-                } // end loop over destination boxes
+                        } // end if shifted box intersects
+                    } // end loop over destination boxes
+                } // end loop over shift vectors
             } // end if source box is close to domain boundary
         } // end loop over destination boxes
 
@@ -1066,16 +985,225 @@ void Copier::ghostDefine(const DisjointBoxLayout& a_src,
   define(src, a_dest, a_domain, a_destGhost);
 }
 
+// Index of the box a_box in a_layout, or -1
+static int findBox(const BoxLayout& a_layout, const Box& a_box)
+{
+  if (!a_layout.isSorted()) return -1;
+  const std::vector<Entry>& v = a_layout.rawPtr()->constStdVector();
+  std::vector<Entry>::const_iterator it =
+    std::lower_bound(v.begin(), v.end(), Entry(a_box));
+  if ((it != v.end()) && (it->box == a_box))
+    {
+      return it - v.begin();
+    }
+  return -1;
+}
+
+void Copier::defineDistributed(const BoxLayout& a_level,
+                               const BoxLayout& a_dest,
+                               const ProblemDomain& a_domain,
+                               const IntVect& a_ghost,
+                               bool a_exchange,
+                               IntVect a_shift)
+{
+  CH_TIME("Copier::defineDistributed");
+  clear();
+  m_isDefined = true;
+  buffersAllocated = false;
+
+  // The periodic shifts to try; a ghost region may only wrap once
+  Vector<IntVect> shifts(1, IntVect::Zero);
+  if (a_domain.isPeriodic())
+    {
+      if (a_shift != IntVect::Zero)
+        {
+          MayDay::Error("Copier::define - domain periodic and a non-zero shift in the copy is not implemented");
+        }
+      IntVect period = a_domain.domainBox().size();
+      for (int dir = 0; dir < SpaceDim; dir++)
+        {
+          if (a_domain.isPeriodic(dir) && (a_ghost[dir] > period[dir]))
+            {
+              MayDay::Error("Copier::define - multiple periodic wraps are not supported for distributed layouts");
+            }
+        }
+      ShiftIterator shiftIt = a_domain.shiftIterator();
+      for (shiftIt.begin(); shiftIt.ok(); ++shiftIt)
+        {
+          shifts.push_back(shiftIt()*period);
+        }
+    }
+
+  // The local boxes, the destination ones grown to the region they receive
+  Vector<Box> srcBoxes, destBoxes;
+  Vector<DataIndex> srcIndices, destIndices;
+  for (DataIterator dit = a_level.dataIterator(); dit.ok(); ++dit)
+    {
+      srcBoxes.push_back(a_level[dit]);
+      srcIndices.push_back(dit());
+    }
+  for (DataIterator dit = a_dest.dataIterator(); dit.ok(); ++dit)
+    {
+      Box ghost(a_dest[dit]);
+      ghost -= a_shift;
+      ghost.grow(a_ghost);
+      destBoxes.push_back(ghost);
+      destIndices.push_back(dit());
+    }
+
+  // Processors send their source boxes to the processors whose destination
+  // regions they intersect, and the other way around.  Both sides decide
+  // from the two indices alone.
+  DistributedBoxIndex srcIndex(srcBoxes);
+  DistributedBoxIndex destIndex(destBoxes);
+  const int myRank = procID();
+  Vector<int> srcSendRanks, srcRecvRanks, destSendRanks, destRecvRanks;
+  Vector<Vector<Box> > srcSend, destSend, remoteSrc, remoteDest;
+  for (int irank = 0; irank < numProc(); ++irank)
+    {
+      if (irank == myRank) continue;
+      if (DistributedBoxIndex::intersects(destIndex.rankBox(irank), srcIndex.rankBox(myRank), a_domain))
+        {
+          srcSendRanks.push_back(irank);
+          srcSend.push_back(Vector<Box>());
+          for (int i = 0; i < srcBoxes.size(); ++i)
+            {
+              if (DistributedBoxIndex::intersects(destIndex.rankBox(irank), srcBoxes[i], a_domain))
+                {
+                  srcSend.back().push_back(srcBoxes[i]);
+                }
+            }
+          destRecvRanks.push_back(irank);
+        }
+      if (DistributedBoxIndex::intersects(destIndex.rankBox(myRank), srcIndex.rankBox(irank), a_domain))
+        {
+          srcRecvRanks.push_back(irank);
+          destSendRanks.push_back(irank);
+          destSend.push_back(Vector<Box>());
+          for (int i = 0; i < destBoxes.size(); ++i)
+            {
+              if (DistributedBoxIndex::intersects(destBoxes[i], srcIndex.rankBox(irank), a_domain))
+                {
+                  destSend.back().push_back(destBoxes[i]);
+                }
+            }
+        }
+    }
+  DistributedBoxIndex::exchange(remoteSrc, srcRecvRanks, srcSend, srcSendRanks);
+  DistributedBoxIndex::exchange(remoteDest, destRecvRanks, destSend, destSendRanks);
+
+  // Remote boxes that the layouts hold in their halos keep their index
+  // there, which trimEdges() needs; the others get a null index, which is
+  // never dereferenced
+  LayoutIterator srcLit  = a_level.layoutIterator();
+  LayoutIterator destLit = a_dest.layoutIterator();
+
+  // Destination regions on this processor, filled from local and remote
+  // sources
+  for (int idest = 0; idest < destBoxes.size(); ++idest)
+    {
+      const Box& ghost = destBoxes[idest];
+      for (int ishift = 0; ishift < shifts.size(); ++ishift)
+        {
+          Box image(ghost);
+          image.shift(shifts[ishift]);
+          for (int isrc = 0; isrc < srcBoxes.size(); ++isrc)
+            {
+              if ((ishift == 0) && a_exchange && (srcIndices[isrc] == destIndices[idest]))
+                {
+                  continue;
+                }
+              if (image.intersectsNotEmpty(srcBoxes[isrc]))
+                {
+                  Box fromRegion = image & srcBoxes[isrc];
+                  Box toRegion   = fromRegion - shifts[ishift] + a_shift;
+                  MotionItem* item = new (s_motionItemPool.getPtr())
+                    MotionItem(srcIndices[isrc], destIndices[idest], fromRegion, toRegion);
+                  m_localMotionPlan.push_back(item);
+                }
+            }
+          for (int irecv = 0; irecv < remoteSrc.size(); ++irecv)
+            {
+              for (int ibox = 0; ibox < remoteSrc[irecv].size(); ++ibox)
+                {
+                  const Box& fromBox = remoteSrc[irecv][ibox];
+                  if (image.intersectsNotEmpty(fromBox))
+                    {
+                      int index = findBox(a_level, fromBox);
+                      DataIndex fromIndex = (index >= 0) ? DataIndex(srcLit[index]) : DataIndex();
+                      Box fromRegion = image & fromBox;
+                      Box toRegion   = fromRegion - shifts[ishift] + a_shift;
+                      MotionItem* item = new (s_motionItemPool.getPtr())
+                        MotionItem(fromIndex, destIndices[idest], fromRegion, toRegion);
+                      item->procID = srcRecvRanks[irecv];
+                      m_toMotionPlan.push_back(item);
+                    }
+                }
+            }
+        }
+    }
+
+  // Local sources sent to the destination regions of other processors
+  for (int irecv = 0; irecv < remoteDest.size(); ++irecv)
+    {
+      for (int ibox = 0; ibox < remoteDest[irecv].size(); ++ibox)
+        {
+          const Box& ghost = remoteDest[irecv][ibox];
+          Box toBox(ghost);
+          toBox.grow(-a_ghost);
+          toBox += a_shift;
+          int index = findBox(a_dest, toBox);
+          DataIndex toIndex = (index >= 0) ? DataIndex(destLit[index]) : DataIndex();
+          for (int ishift = 0; ishift < shifts.size(); ++ishift)
+            {
+              Box image(ghost);
+              image.shift(shifts[ishift]);
+              for (int isrc = 0; isrc < srcBoxes.size(); ++isrc)
+                {
+                  if (image.intersectsNotEmpty(srcBoxes[isrc]))
+                    {
+                      Box fromRegion = image & srcBoxes[isrc];
+                      Box toRegion   = fromRegion - shifts[ishift] + a_shift;
+                      MotionItem* item = new (s_motionItemPool.getPtr())
+                        MotionItem(srcIndices[isrc], toIndex, fromRegion, toRegion);
+                      item->procID = destRecvRanks[irecv];
+                      m_fromMotionPlan.push_back(item);
+                    }
+                }
+            }
+        }
+    }
+
+  sort();
+}
+
 void Copier::exchangeDefine(const DisjointBoxLayout& a_grids,
                             const IntVect& a_ghost, bool a_includeSelf)
 {
   CH_TIME("Copier::exchangeDefine");
+  if (a_grids.isDistributed() && (a_ghost.max() > a_grids.haloWidth()))
+    {
+      // The neighbors in the halo are not enough
+      defineDistributed(a_grids, a_grids, a_grids.physDomain(), a_ghost, true, IntVect::Zero);
+      if (a_includeSelf)
+        {
+          for (DataIterator dit = a_grids.dataIterator(); dit.ok(); ++dit)
+            {
+              Box bghost(a_grids[dit]);
+              bghost.grow(a_ghost);
+              MotionItem* item = new (s_motionItemPool.getPtr()) MotionItem(dit(), dit(), bghost);
+              m_localMotionPlan.push_back(item);
+            }
+        }
+      return;
+    }
   clear();
   const DataIterator dit = a_grids.dataIterator();
   
   const int myprocID = procID();
 
   const int nbox = dit.size();
+  const ProblemDomain& physDomain = a_grids.physDomain();
 
 #pragma omp parallel
   {
@@ -1083,7 +1211,10 @@ void Copier::exchangeDefine(const DisjointBoxLayout& a_grids,
     Vector<MotionItem*> toMotionPlan;
     Vector<MotionItem*> fromMotionPlan;        
 
-    NeighborIterator nit(a_grids);
+    // the boxes within the ghost width, periodic images included; these
+    // come from the spatial index of the layout, so ghost widths wider
+    // than the cached one-cell neighbor lists are handled too
+    Vector<std::pair<int, LayoutIndex> > neighbors;
 
 #pragma omp for schedule(runtime)
     for (int mybox = 0; mybox < nbox; mybox++) 
@@ -1102,15 +1233,21 @@ void Copier::exchangeDefine(const DisjointBoxLayout& a_grids,
         localMotionPlan.push_back(item);
       }
       
-      for (nit.begin(din); nit.ok(); ++nit)
+      a_grids.neighbors(neighbors, din, a_ghost.max());
+      for (int inbr = 0; inbr < neighbors.size(); inbr++)
         {
-          Box neighbor = nit.box();
-          int fromProcID = a_grids.procID(nit());
+          const int shift = neighbors[inbr].first;
+          const DataIndex nbr(neighbors[inbr].second);
+          Box neighbor = a_grids[nbr];
+          if (shift >= 0) physDomain.shiftIt(neighbor, shift);
+          int fromProcID = a_grids.procID(nbr);
           if (neighbor.intersectsNotEmpty(bghost))
             {
               Box box(neighbor & bghost);
+              Box unshifted(box);
+              if (shift >= 0) physDomain.unshiftIt(unshifted, shift);
 
-              MotionItem* item = new (s_motionItemPool.getPtr()) MotionItem(DataIndex(nit()), din, nit.unshift(box), box);
+              MotionItem* item = new (s_motionItemPool.getPtr()) MotionItem(nbr, din, unshifted, box);
               if (fromProcID == myprocID)
               { // local move
                 localMotionPlan.push_back(item);
@@ -1125,7 +1262,9 @@ void Copier::exchangeDefine(const DisjointBoxLayout& a_grids,
           if (neighbor.intersectsNotEmpty(b) && fromProcID != myprocID)
             {
               Box box(neighbor & b);
-              MotionItem* item = new (s_motionItemPool.getPtr()) MotionItem(din, DataIndex(nit()), box, nit.unshift(box) );
+              Box unshifted(box);
+              if (shift >= 0) physDomain.unshiftIt(unshifted, shift);
+              MotionItem* item = new (s_motionItemPool.getPtr()) MotionItem(din, nbr, box, unshifted);
               item->procID = fromProcID;
               fromMotionPlan.push_back(item);
             }
@@ -14,11 +14,20 @@
 #include "DataIterator.H"
 #include "LayoutIterator.H"
 #include "LoadBalance.H"
+#include "DistributedBoxIndex.H"
 #include "SliceSpec.H"
 #include <list>
+#include <algorithm>
 #include "CH_Timer.H"
 #include "NamespaceHeader.H"
 
+static Box grownBox(const Box& a_box, int a_halo)
+{
+  Box grown(a_box);
+  grown.grow(a_halo);
+  return grown;
+}
+
 DisjointBoxLayout::DisjointBoxLayout()
   :BoxLayout()
 {
@@ -124,6 +133,7 @@ DisjointBoxLayout::close()
       buildDataIndex();
       m_dataIterator = RefCountedPtr<DataIterator>(
                         new DataIterator(*this, m_layout));
+      m_spatialIndex->clear();
       computeNeighbors();
     }
 }
@@ -137,6 +147,7 @@ DisjointBoxLayout::closeNO()
       *m_closed = true;
       m_dataIterator = RefCountedPtr<DataIterator>(
                         new DataIterator(*this, m_layout));
+      m_spatialIndex->clear();
       //computeNeighbors(); don't build neighbors
     }
 }
@@ -152,6 +163,7 @@ DisjointBoxLayout::closeNoSort()
       *m_closed = true;
       m_dataIterator = RefCountedPtr<DataIterator>(
                         new DataIterator(*this, m_layout));
+      m_spatialIndex->clear();
       //computeNeighbors(); don't build neighbors
     }
 }
@@ -167,6 +179,7 @@ DisjointBoxLayout::closeN(RefCountedPtr<Vector<Vector<std::pair<int, LayoutIndex
       *m_closed = true;
       m_dataIterator = RefCountedPtr<DataIterator>(
                         new DataIterator(*this, m_layout));
+      m_spatialIndex->clear();
       m_neighbors = neighbors;
     }
 }
@@ -174,100 +187,64 @@ DisjointBoxLayout::closeN(RefCountedPtr<Vector<Vector<std::pair<int, LayoutIndex
 void DisjointBoxLayout::computeNeighbors()
 {
   CH_TIME("DisjointBoxLayout::computeNeighbors");
-  const Vector<Entry>& boxes = *m_boxes;
-  int n = boxes.size();
-  int maxI=0;
-  for (int i=0; i<n; ++i)
+  m_neighbors = RefCountedPtr<Vector<Vector<std::pair<int, LayoutIndex > > > >(
+            new Vector<Vector<std::pair<int, LayoutIndex> > >());
+  m_neighbors->resize(size());
+
+  for (DataIterator dit=dataIterator(); dit.ok(); ++dit)
     {
-      maxI = Max(maxI, boxes[i].box.size(0));
+      neighbors((*m_neighbors)[dit().intCode()], dit(), 1);
     }
-  std::list<std::pair<int, LayoutIndex> > periodicImages;
-  if (!m_physDomain.isEmpty() && m_physDomain.isPeriodic())
+}
+
+// Periodic images in the order of their boxes, then of their shifts
+static bool imageLT(const std::pair<int, LayoutIndex>& a_lhs,
+                    const std::pair<int, LayoutIndex>& a_rhs)
+{
+  if (a_lhs.second.intCode() != a_rhs.second.intCode())
     {
-      Box periodicTestBox(m_physDomain.domainBox());
-      for (int idir=0; idir<CH_SPACEDIM; idir++)
-        {
-          if (m_physDomain.isPeriodic(idir))
-            {
-              periodicTestBox.grow(idir,-1);
-            }
-        }
+      return a_lhs.second.intCode() < a_rhs.second.intCode();
+    }
+  return a_lhs.first < a_rhs.first;
+}
 
-      LayoutIterator lit = layoutIterator();
-      unsigned int index = 0;
-      ShiftIterator shiftIt = m_physDomain.shiftIterator();
-      for (lit.reset(); lit.ok(); ++lit,++index)
-        {
-          const Box& box = this->operator[](lit);
-          // if periodic, also need to add periodic images
-          // only do this IF we're periodic and box
-          // adjacent to  the domain box boundary somewhere
-          if (!periodicTestBox.contains(box))
-            {
-              //IntVect shiftMult(m_physDomain.domainBox().size());
-              //Box shiftedBox(box);
-              for (shiftIt.begin(); shiftIt.ok(); ++shiftIt)
-                {
-                  //IntVect shiftVect = shiftMult*shiftIt();
-                  //shiftedBox.shift(shiftVect);
+void
+DisjointBoxLayout::neighbors(Vector<std::pair<int, LayoutIndex> >& a_neighbors,
+                             const DataIndex&                      a_index,
+                             int                                   a_ghost) const
+{
+  a_neighbors.resize(0);
+  Box gbox = grownBox(get(a_index), a_ghost);
 
-                  periodicImages.push_back(std::pair<int, LayoutIndex>(shiftIt.index(), lit()));
-                  //shiftedBox.shift(-shiftVect);
-                } // end loop over periodic shift directions
-            } // end if periodic
+  Vector<LayoutIndex> found;
+  findIntersecting(found, gbox);
+  for (int i = 0; i < found.size(); ++i)
+    {
+      //don't include yourself as neighbor
+      if (found[i].intCode() != a_index.intCode())
+        {
+          a_neighbors.push_back(std::pair<int, LayoutIndex>(-1, found[i]));
         }
     }
-  //  OK, for this work, we don't use a standard LayoutIterator, since I want to
-  // be pushing the start of the window forward, which LayoutIterator is not built to do.
-  unsigned int id = 0;
-  unsigned int start = 0;
-  unsigned int end   = size();
-  m_neighbors = RefCountedPtr<Vector<Vector<std::pair<int, LayoutIndex > > > >(
-            new Vector<Vector<std::pair<int, LayoutIndex> > >());
-  DataIterator dit = dataIterator();
-  m_neighbors->resize(size());
-  LayoutIterator lit = layoutIterator();
-  const Vector<LayoutIndex>& vecLayoutIndex = *(lit.m_indicies);
 
-  for (DataIterator dit=dataIterator(); dit.ok(); ++dit)
+  //now the periodic images: the boxes that meet gbox shifted back
+  if (!m_physDomain.isEmpty() && m_physDomain.isPeriodic() &&
+      !m_physDomain.domainBox().contains(gbox))
     {
-      Box gbox = get(dit());
-      gbox.grow(1);
-      Vector<std::pair<int, LayoutIndex> >& neighbors = (*m_neighbors)[dit().intCode()];
-      int low =  gbox.smallEnd()[0] - maxI;
-      int high = gbox.smallEnd()[0] + maxI + 1;
-      for (id=start; id<end; ++id)
-        {
-          if (id != index(dit()))
-          {
-            //don't include yourself as neighbor
-            const Box& b = boxes[id].box;
-            const IntVect& s = b.smallEnd();
-            if (s[0]< low) start = id+1;
-            else if (s[0] > high) id=end;
-            if (gbox.intersectsNotEmpty(b))
-              {
-                neighbors.push_back(std::pair<int, LayoutIndex>(-1, vecLayoutIndex[id]));
-              }
-          }
-        }
-      //now run through periodic boxes.
-      if(!m_physDomain.isEmpty() && !m_physDomain.domainBox().contains(gbox))
+      Vector<std::pair<int, LayoutIndex> > images;
+      ShiftIterator shiftIt = m_physDomain.shiftIterator();
+      for (shiftIt.begin(); shiftIt.ok(); ++shiftIt)
         {
-          std::list<std::pair<int, LayoutIndex> >::iterator it;
-          for (it=periodicImages.begin(); it!=periodicImages.end(); ++it)
+          Box image(gbox);
+          m_physDomain.unshiftIt(image, shiftIt.index());
+          findIntersecting(found, image);
+          for (int i = 0; i < found.size(); ++i)
             {
-              Box b = (*m_boxes)[(*it).second.intCode()].box;
-              m_physDomain.shiftIt(b, (*it).first);
-              if (gbox.intersectsNotEmpty(b))
-                {
-                  pair<int, LayoutIndex> entry(*it);
-                  //HERE
-                  entry.second = (*it).second;
-                  neighbors.push_back(entry);
-                }
+              images.push_back(std::pair<int, LayoutIndex>(shiftIt.index(), found[i]));
             }
         }
+      std::sort(images.stdVector().begin(), images.stdVector().end(), imageLT);
+      a_neighbors.append(images);
     }
 }
 
@@ -362,6 +339,79 @@ DisjointBoxLayout::defineAndLoadBalance(const Vector<Box>& a_boxes,
     this->define( a_boxes, procIDs, a_physDomain );
 }
 
+// Box grown by a_halo cells (grow() is hidden by the member functions)
+void
+DisjointBoxLayout::defineDistributed(const Vector<Box>& a_localBoxes,
+                                     const ProblemDomain& a_physDomain,
+                                     int a_halo)
+{
+  CH_TIME("DisjointBoxLayout::defineDistributed");
+  CH_assert(a_halo >= 0);
+
+  DistributedBoxIndex index(a_localBoxes);
+  const int myRank = CHprocID();
+  const Box& myBounds = index.rankBox(myRank);
+
+  // A processor sends its boxes to another if its halo region reaches the
+  // other's boxes; the receiver can tell the same from the index.  Only
+  // the boxes that are near the receiver's bounding box are sent.
+  Vector<int> sendRanks, recvRanks;
+  Vector<Vector<Box> > send, recv;
+  for (int irank = 0; irank < numProc(); ++irank)
+    {
+      if ((irank == myRank) || (index.numBoxes(irank) == 0))
+        {
+          continue;
+        }
+      if ((a_localBoxes.size() > 0) &&
+          DistributedBoxIndex::intersects(grownBox(myBounds, a_halo), index.rankBox(irank), a_physDomain))
+        {
+          sendRanks.push_back(irank);
+          send.push_back(Vector<Box>());
+          for (int i = 0; i < a_localBoxes.size(); ++i)
+            {
+              if (DistributedBoxIndex::intersects(grownBox(a_localBoxes[i], a_halo), index.rankBox(irank), a_physDomain))
+                {
+                  send.back().push_back(a_localBoxes[i]);
+                }
+            }
+        }
+      if ((a_localBoxes.size() > 0) &&
+          DistributedBoxIndex::intersects(grownBox(index.rankBox(irank), a_halo), myBounds, a_physDomain))
+        {
+          recvRanks.push_back(irank);
+        }
+    }
+  DistributedBoxIndex::exchange(recv, recvRanks, send, sendRanks);
+
+  Vector<Box> boxes(a_localBoxes);
+  Vector<int> procIDs(a_localBoxes.size(), myRank);
+  Box myHalo = grownBox(myBounds, a_halo);
+  for (int irecv = 0; irecv < recv.size(); ++irecv)
+    {
+      for (int ibox = 0; ibox < recv[irecv].size(); ++ibox)
+        {
+          const Box& remote = recv[irecv][ibox];
+          if (!DistributedBoxIndex::intersects(myHalo, remote, a_physDomain))
+            {
+              continue;
+            }
+          for (int i = 0; i < a_localBoxes.size(); ++i)
+            {
+              if (DistributedBoxIndex::intersects(grownBox(a_localBoxes[i], a_halo), remote, a_physDomain))
+                {
+                  boxes.push_back(remote);
+                  procIDs.push_back(recvRanks[irecv]);
+                  break;
+                }
+            }
+        }
+    }
+
+  m_halo = RefCountedPtr<int>(new int(a_halo));
+  define(boxes, procIDs, a_physDomain);
+}
+
 bool
 DisjointBoxLayout::isDisjoint() const
 {
@@ -534,7 +584,10 @@ coarsen(DisjointBoxLayout& a_output, const DisjointBoxLayout& a_input,
   // copy first, then coarsen everything
   // a_output.deepCopy(a_input);
   a_output.m_boxes      = RefCountedPtr<Vector<Entry> >(new Vector<Entry>(*(a_input.m_boxes)));
+  a_output.m_spatialIndex = RefCountedPtr<BoxSpatialIndex>(new BoxSpatialIndex());
   a_output.m_layout     = a_input.m_layout;
+  a_output.m_halo       = RefCountedPtr<int>(new int(a_input.isDistributed() ?
+                                                     a_input.haloWidth()/a_refinement : -1));
 #ifdef CH_MPI
   a_output.m_dataIndex  = a_input.m_dataIndex;
 #endif
@@ -579,6 +632,10 @@ void refine(DisjointBoxLayout& a_output,
 
   // first copy, then refine everything
   a_output.deepCopy(a_input);
+  if (a_input.isDistributed())
+    {
+      *a_output.m_halo = a_input.haloWidth()*a_refinement;
+    }
 
   // start by refining the physDomain
   a_output.m_physDomain = refine(a_input.m_physDomain,a_refinement);
@@ -0,0 +1,235 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include "DistributedBoxIndex.H"
+#include "SPMD.H"
+#include "CH_Timer.H"
+#include "NamespaceHeader.H"
+
+// A box travels as its corners and its index type
+static const int s_intsPerBox = 3*CH_SPACEDIM;
+
+static void packBox(int* a_buf, const Box& a_box)
+{
+  const IntVect& lo = a_box.smallEnd();
+  const IntVect& hi = a_box.bigEnd();
+  const IntVect  ty = a_box.type();
+  for (int dir = 0; dir < SpaceDim; ++dir)
+    {
+      a_buf[dir]              = lo[dir];
+      a_buf[dir +   SpaceDim] = hi[dir];
+      a_buf[dir + 2*SpaceDim] = ty[dir];
+    }
+}
+
+static Box unpackBox(const int* a_buf)
+{
+  IntVect lo, hi, ty;
+  for (int dir = 0; dir < SpaceDim; ++dir)
+    {
+      lo[dir] = a_buf[dir];
+      hi[dir] = a_buf[dir +   SpaceDim];
+      ty[dir] = a_buf[dir + 2*SpaceDim];
+    }
+  return Box(lo, hi, ty);
+}
+
+DistributedBoxIndex::DistributedBoxIndex()
+  :
+  m_numBoxes(0),
+  m_offset(0)
+{
+}
+
+DistributedBoxIndex::DistributedBoxIndex(const Vector<Box>& a_localBoxes)
+{
+  define(a_localBoxes);
+}
+
+void DistributedBoxIndex::define(const Vector<Box>& a_localBoxes)
+{
+  CH_TIME("DistributedBoxIndex::define");
+  Box bounds;
+  for (int i = 0; i < a_localBoxes.size(); ++i)
+    {
+      if (i == 0)
+        {
+          bounds = a_localBoxes[i];
+        }
+      else
+        {
+          bounds.minBox(a_localBoxes[i]);
+        }
+    }
+
+  int nproc = numProc();
+  m_rankBoxes.resize(nproc);
+  m_rankCounts.resize(nproc);
+
+  // The count comes first; the box is only meaningful if it is positive
+  Vector<int> local(1 + s_intsPerBox, 0);
+  local[0] = a_localBoxes.size();
+  if (local[0] > 0)
+    {
+      packBox(&local[1], bounds);
+    }
+  Vector<int> all((1 + s_intsPerBox)*nproc);
+#ifdef CH_MPI
+  MPI_Allgather(&local[0], 1 + s_intsPerBox, MPI_INT,
+                &all[0],   1 + s_intsPerBox, MPI_INT, Chombo_MPI::comm);
+#else
+  all = local;
+#endif
+
+  m_numBoxes = 0;
+  m_offset   = 0;
+  int myRank = procID();
+  for (int irank = 0; irank < nproc; ++irank)
+    {
+      const int* entry = &all[(1 + s_intsPerBox)*irank];
+      m_rankCounts[irank] = entry[0];
+      m_rankBoxes[irank]  = (entry[0] > 0) ? unpackBox(entry + 1) : Box();
+      if (irank < myRank)
+        {
+          m_offset += entry[0];
+        }
+      m_numBoxes += entry[0];
+    }
+}
+
+void DistributedBoxIndex::ranksIntersecting(Vector<int>&         a_ranks,
+                                            const Box&           a_box,
+                                            const ProblemDomain& a_domain) const
+{
+  a_ranks.resize(0);
+  int myRank = procID();
+  for (int irank = 0; irank < m_rankBoxes.size(); ++irank)
+    {
+      if ((irank != myRank) && (m_rankCounts[irank] > 0) &&
+          intersects(a_box, m_rankBoxes[irank], a_domain))
+        {
+          a_ranks.push_back(irank);
+        }
+    }
+}
+
+bool DistributedBoxIndex::intersects(const Box&           a_A,
+                                     const Box&           a_B,
+                                     const ProblemDomain& a_domain)
+{
+  if (a_A.isEmpty() || a_B.isEmpty())
+    {
+      return false;
+    }
+  if (a_A.intersectsNotEmpty(a_B))
+    {
+      return true;
+    }
+  if (!a_domain.isPeriodic())
+    {
+      return false;
+    }
+
+  IntVect period = a_domain.domainBox().size();
+  ShiftIterator shiftIt = a_domain.shiftIterator();
+  for (shiftIt.begin(); shiftIt.ok(); ++shiftIt)
+    {
+      Box image(a_A);
+      image.shift(shiftIt()*period);
+      if (image.intersectsNotEmpty(a_B))
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+void DistributedBoxIndex::exchange(Vector<Vector<Box> >&       a_recv,
+                                   const Vector<int>&          a_recvRanks,
+                                   const Vector<Vector<Box> >& a_send,
+                                   const Vector<int>&          a_sendRanks)
+{
+  CH_TIME("DistributedBoxIndex::exchange");
+  CH_assert(a_send.size() == a_sendRanks.size());
+  a_recv.resize(a_recvRanks.size());
+#ifdef CH_MPI
+  int nrecv = a_recvRanks.size();
+  int nsend = a_sendRanks.size();
+  const int countTag = 28013;
+  const int boxTag   = 28014;
+
+  // First the number of boxes in each message, then the boxes
+  Vector<MPI_Request> requests(nrecv + nsend);
+  Vector<int> recvCounts(nrecv + 1, 0);
+  Vector<int> sendCounts(nsend + 1, 0);
+  for (int i = 0; i < nrecv; ++i)
+    {
+      MPI_Irecv(&recvCounts[i], 1, MPI_INT, a_recvRanks[i], countTag,
+                Chombo_MPI::comm, &requests[i]);
+    }
+  for (int i = 0; i < nsend; ++i)
+    {
+      sendCounts[i] = a_send[i].size();
+      MPI_Isend(&sendCounts[i], 1, MPI_INT, a_sendRanks[i], countTag,
+                Chombo_MPI::comm, &requests[nrecv + i]);
+    }
+  if (nrecv + nsend > 0)
+    {
+      MPI_Waitall(nrecv + nsend, &requests[0], MPI_STATUSES_IGNORE);
+    }
+
+  Vector<Vector<int> > recvBufs(nrecv);
+  Vector<Vector<int> > sendBufs(nsend);
+  int nrequests = 0;
+  for (int i = 0; i < nrecv; ++i)
+    {
+      if (recvCounts[i] > 0)
+        {
+          recvBufs[i].resize(recvCounts[i]*s_intsPerBox);
+          MPI_Irecv(&recvBufs[i][0], recvCounts[i]*s_intsPerBox, MPI_INT,
+                    a_recvRanks[i], boxTag, Chombo_MPI::comm,
+                    &requests[nrequests++]);
+        }
+    }
+  for (int i = 0; i < nsend; ++i)
+    {
+      if (sendCounts[i] > 0)
+        {
+          sendBufs[i].resize(sendCounts[i]*s_intsPerBox);
+          for (int ibox = 0; ibox < sendCounts[i]; ++ibox)
+            {
+              packBox(&sendBufs[i][ibox*s_intsPerBox], a_send[i][ibox]);
+            }
+          MPI_Isend(&sendBufs[i][0], sendCounts[i]*s_intsPerBox, MPI_INT,
+                    a_sendRanks[i], boxTag, Chombo_MPI::comm,
+                    &requests[nrequests++]);
+        }
+    }
+  if (nrequests > 0)
+    {
+      MPI_Waitall(nrequests, &requests[0], MPI_STATUSES_IGNORE);
+    }
+
+  for (int i = 0; i < nrecv; ++i)
+    {
+      a_recv[i].resize(recvCounts[i]);
+      for (int ibox = 0; ibox < recvCounts[i]; ++ibox)
+        {
+          a_recv[i][ibox] = unpackBox(&recvBufs[i][ibox*s_intsPerBox]);
+        }
+    }
+#else
+  // There is only one rank, and it does not send to itself
+  CH_assert(a_recvRanks.size() == 0);
+  CH_assert(a_sendRanks.size() == 0);
+#endif
+}
+
+#include "NamespaceFooter.H"
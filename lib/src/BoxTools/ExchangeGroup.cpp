@@ -0,0 +1,307 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include <algorithm>
+#include "ExchangeGroup.H"
+#include "CH_Timer.H"
+#include "Misc.H"
+#include "NamespaceHeader.H"
+
+#ifdef CH_MPI
+// Tag of the group's messages, apart from those of BoxLayoutData
+static const int s_exchangeGroupTag = 1000;
+#endif
+
+// Order of the items to or from one processor: by processor, then by
+// destination region, as CopierBuffer::bufEntry orders them
+struct ExchangeGroupEntryLess
+{
+  template <class E>
+  bool operator()(const E& a_lhs, const E& a_rhs) const
+  {
+    if (a_lhs.m_item->procID != a_rhs.m_item->procID)
+      {
+        return a_lhs.m_item->procID < a_rhs.m_item->procID;
+      }
+    const Box& left  = a_lhs.m_item->toRegion;
+    const Box& right = a_rhs.m_item->toRegion;
+    if (left.smallEnd() == right.smallEnd())
+      {
+        return left.bigEnd().lexLT(right.bigEnd());
+      }
+    return left < right;
+  }
+};
+
+struct ExchangeGroupProcLess
+{
+  template <class E>
+  bool operator()(const E& a_lhs, const E& a_rhs) const
+  {
+    return a_lhs.m_item->procID < a_rhs.m_item->procID;
+  }
+};
+
+ExchangeGroup::ExchangeGroup()
+  : m_numSends(0),
+    m_pending(false)
+{
+}
+
+ExchangeGroup::~ExchangeGroup()
+{
+  if (m_pending)
+    {
+      exchangeEnd();
+    }
+  clear();
+}
+
+void ExchangeGroup::clear()
+{
+  CH_assert(!m_pending);
+  for (int i = 0; i < m_fields.size(); i++)
+    {
+      delete m_fields[i];
+    }
+  for (int i = 0; i < m_copiers.size(); i++)
+    {
+      delete m_copiers[i];
+    }
+  m_fields.resize(0);
+  m_ghosts.resize(0);
+  m_copiers.resize(0);
+  m_sends.resize(0);
+  m_receives.resize(0);
+  m_grids = DisjointBoxLayout();
+}
+
+void ExchangeGroup::addField(Field* a_field, const DisjointBoxLayout& a_grids)
+{
+  CH_assert(!m_pending);
+  if (m_fields.size() == 0 && m_copiers.size() == 0)
+    {
+      m_grids = a_grids;
+    }
+  else if (!m_grids.compatible(a_grids))
+    {
+      MayDay::Error("ExchangeGroup: the fields must all be on the same DisjointBoxLayout");
+    }
+  m_fields.push_back(a_field);
+}
+
+const Copier* ExchangeGroup::exchangeCopier(const DisjointBoxLayout& a_grids,
+                                            const IntVect&           a_ghost)
+{
+  if (m_fields.size() == 0 && m_copiers.size() == 0)
+    {
+      m_grids = a_grids;
+    }
+  else if (!m_grids.compatible(a_grids))
+    {
+      MayDay::Error("ExchangeGroup: the fields must all be on the same DisjointBoxLayout");
+    }
+  for (int i = 0; i < m_ghosts.size(); i++)
+    {
+      if (m_ghosts[i] == a_ghost)
+        {
+          return m_copiers[i];
+        }
+    }
+  CH_TIME("ExchangeGroup::exchangeCopier");
+  Copier* copier = new Copier;
+  copier->exchangeDefine(m_grids, a_ghost);
+  m_ghosts.push_back(a_ghost);
+  m_copiers.push_back(copier);
+  return copier;
+}
+
+size_t ExchangeGroup::makeEntries(std::vector<Entry>&          a_entries,
+                                  CopyIterator::local_from_to a_type)
+{
+  bool send = (a_type == CopyIterator::FROM);
+  a_entries.resize(0);
+  for (int f = 0; f < m_fields.size(); f++)
+    {
+      Field* field = m_fields[f];
+      size_t first = a_entries.size();
+      CopyIterator it(*(field->m_copier), a_type);
+      int items = it.size();
+      for (int n = 0; n < items; n++)
+        {
+          Entry entry;
+          entry.m_field  = field;
+          entry.m_item   = &(it[n]);
+          entry.m_offset = 0;
+          entry.m_size   = field->size(it[n], send);
+          a_entries.push_back(entry);
+        }
+      std::sort(a_entries.begin() + first, a_entries.end(), ExchangeGroupEntryLess());
+    }
+  // Keep the fields in order within the message to each processor
+  std::stable_sort(a_entries.begin(), a_entries.end(), ExchangeGroupProcLess());
+
+  size_t offset = 0;
+  for (int i = 0; i < a_entries.size(); i++)
+    {
+      a_entries[i].m_offset = offset;
+      offset += a_entries[i].m_size;
+    }
+  return offset;
+}
+
+void ExchangeGroup::exchange()
+{
+  exchangeBegin();
+  exchangeEnd();
+}
+
+void ExchangeGroup::exchangeBegin()
+{
+  CH_TIME("ExchangeGroup::exchangeBegin");
+  CH_assert(!m_pending);
+  m_numSends = 0;
+
+#ifdef CH_MPI
+  bool threadSafe = true;
+  for (int f = 0; f < m_fields.size(); f++)
+    {
+      threadSafe = threadSafe && m_fields[f]->threadSafe();
+    }
+
+  size_t sendSize    = makeEntries(m_sends, CopyIterator::FROM);
+  size_t receiveSize = makeEntries(m_receives, CopyIterator::TO);
+  if (m_sendBuffer.size() < sendSize)
+    {
+      m_sendBuffer.resize(sendSize);
+    }
+  if (m_receiveBuffer.size() < receiveSize)
+    {
+      m_receiveBuffer.resize(receiveSize);
+    }
+
+  {
+    CH_TIME("ExchangeGroup::pack");
+    int numEntries = m_sends.size();
+#pragma omp parallel for if(threadSafe)
+    for (int i = 0; i < numEntries; i++)
+      {
+        const Entry& entry = m_sends[i];
+        entry.m_field->linearOut(*(entry.m_item), &(m_sendBuffer[entry.m_offset]));
+      }
+  }
+
+  // One message, cut into pieces of at most CH_MAX_MPI_MESSAGE_SIZE, per
+  // processor in each direction
+  m_requests.resize(0);
+  for (int pass = 0; pass < 2; pass++)
+    {
+      bool receive = (pass == 0);
+      const std::vector<Entry>& entries = receive ? m_receives : m_sends;
+      char* buffer = receive ? (entries.size() > 0 ? &(m_receiveBuffer[0]) : NULL)
+                             : (entries.size() > 0 ? &(m_sendBuffer[0]) : NULL);
+      int i = 0;
+      while (i < entries.size())
+        {
+          int proc = entries[i].m_item->procID;
+          size_t start = entries[i].m_offset;
+          size_t bytes = 0;
+          while (i < entries.size() && entries[i].m_item->procID == proc)
+            {
+              bytes += entries[i].m_size;
+              i++;
+            }
+          char* ptr = buffer + start;
+          int tag = s_exchangeGroupTag;
+          while (bytes > 0)
+            {
+              size_t piece = Min<size_t>(bytes, CH_MAX_MPI_MESSAGE_SIZE);
+              m_requests.push_back(MPI_Request());
+              if (receive)
+                {
+                  MPI_Irecv(ptr, piece, MPI_BYTE, proc, tag,
+                            Chombo_MPI::comm, &(m_requests.back()));
+                  CH_MaxMPIRecvSize = Max<long long>(CH_MaxMPIRecvSize, piece);
+                }
+              else
+                {
+                  MPI_Isend(ptr, piece, MPI_BYTE, proc, tag,
+                            Chombo_MPI::comm, &(m_requests.back()));
+                  CH_MaxMPISendSize = Max<long long>(CH_MaxMPISendSize, piece);
+                  m_numSends++;
+                }
+              ptr   += piece;
+              bytes -= piece;
+              tag++;
+            }
+        }
+    }
+#endif
+
+  {
+    CH_TIME("ExchangeGroup::local copying");
+    for (int f = 0; f < m_fields.size(); f++)
+      {
+        Field* field = m_fields[f];
+        CopyIterator it(*(field->m_copier), CopyIterator::LOCAL);
+        int items = it.size();
+#ifdef _OPENMP
+        bool fieldThreadSafe = field->threadSafe();
+#endif
+#pragma omp parallel for if(fieldThreadSafe)
+        for (int n = 0; n < items; n++)
+          {
+            field->copy(it[n]);
+          }
+      }
+  }
+  m_pending = true;
+}
+
+void ExchangeGroup::exchangeEnd()
+{
+  CH_TIME("ExchangeGroup::exchangeEnd");
+  if (!m_pending)
+    {
+      return;
+    }
+#ifdef CH_MPI
+  if (m_requests.size() > 0)
+    {
+      CH_TIME("MPI_Waitall");
+      std::vector<MPI_Status> status(m_requests.size());
+      int result = MPI_Waitall(m_requests.size(), &(m_requests[0]), &(status[0]));
+      if (result != MPI_SUCCESS)
+        {
+          MayDay::Error("ExchangeGroup: MPI_Waitall failed");
+        }
+    }
+  m_requests.resize(0);
+
+  bool threadSafe = true;
+  for (int f = 0; f < m_fields.size(); f++)
+    {
+      threadSafe = threadSafe && m_fields[f]->threadSafe();
+    }
+  {
+    CH_TIME("ExchangeGroup::unpack");
+    int numEntries = m_receives.size();
+#pragma omp parallel for if(threadSafe)
+    for (int i = 0; i < numEntries; i++)
+      {
+        const Entry& entry = m_receives[i];
+        entry.m_field->linearIn(*(entry.m_item), &(m_receiveBuffer[entry.m_offset]));
+      }
+  }
+#endif
+  m_pending = false;
+}
+
+#include "NamespaceFooter.H"
@@ -15,6 +15,7 @@
 long int IntVectSet::count = 0;
 long int IntVectSet::peakcount = 0;
 int      IntVectSet::s_maxDense = 6400000;
+bool     IntVectSet::s_useCompressed = false;
 
 IntVectSet::~IntVectSet()
 {
@@ -24,22 +25,37 @@ IntVectSet::~IntVectSet()
 void IntVectSet::define()
 {
   m_ivs.clear();
+  m_compressed.clear();
   m_dense = DenseIntVectSet();
   m_isdense = true;
+  m_iscompressed = false;
 }
 
 void IntVectSet::define(const DenseIntVectSet& a_dense)
 {
   m_ivs.clear();
+  m_compressed.clear();
   m_dense = a_dense;
   m_isdense = true;
+  m_iscompressed = false;
 }
 
 void IntVectSet::define(const TreeIntVectSet& a_tree)
 {
   m_ivs = a_tree;
+  m_compressed.clear();
   m_dense = DenseIntVectSet();
   m_isdense = false;
+  m_iscompressed = false;
+}
+
+void IntVectSet::define(const CompressedIntVectSet& a_compressed)
+{
+  m_ivs.clear();
+  m_compressed = a_compressed;
+  m_dense = DenseIntVectSet();
+  m_isdense = false;
+  m_iscompressed = true;
 }
 
 IntVectSet::IntVectSet(const DenseIntVectSet& a_dense)
@@ -54,6 +70,12 @@ IntVectSet::IntVectSet(const TreeIntVectSet& a_tree)
   define(a_tree);
 }
 
+IntVectSet::IntVectSet(const CompressedIntVectSet& a_compressed)
+{
+  count++;
+  define(a_compressed);
+}
+
 IntVectSet::IntVectSet(const IntVect& iv_in)
 {
   count++;
@@ -78,8 +100,17 @@ IntVectSet::setMaxDense(const int& a_maxDense)
 {
   s_maxDense = a_maxDense;
 }
+
+void
+IntVectSet::setUseCompressed(bool a_compressed)
+{
+  s_useCompressed = a_compressed;
+}
+
 void IntVectSet::define(const Box& b)
 {
+  m_compressed.clear();
+  m_iscompressed = false;
   if (b.numPts() < s_maxDense)
     {
       m_ivs.clear();
@@ -177,13 +208,18 @@ IntVectSet& IntVectSet::operator|=(const IntVect& iv)
         if (!m_dense.box().contains(iv))
         {
           convert();
-          m_ivs |= iv;
+          if (m_iscompressed) m_compressed |= iv;
+          else               m_ivs |= iv;
         }
         else
         {
           m_dense |= iv;
         }
   }
+  else if (m_iscompressed)
+  {
+        m_compressed |= iv;
+  }
   else
   {
         m_ivs |= iv;
@@ -198,13 +234,18 @@ IntVectSet& IntVectSet::operator|=(const Box& b)
         if (!m_dense.box().contains(b))
         {
           convert();
-          m_ivs |= b;
+          if (m_iscompressed) m_compressed |= b;
+          else               m_ivs |= b;
         }
         else
         {
           m_dense |= b;
         }
   }
+  else if (m_iscompressed)
+  {
+        m_compressed |= b;
+  }
   else
   {
         m_ivs |= b;
@@ -233,7 +274,16 @@ IntVectSet& IntVectSet::operator|=(const IntVectSet& ivs)
     {
       ivs.convert();
     }
-  m_ivs |= ivs.m_ivs;
+  if (m_iscompressed || ivs.m_iscompressed)
+    {
+      toCompressed();
+      ivs.toCompressed();
+      m_compressed |= ivs.m_compressed;
+    }
+  else
+    {
+      m_ivs |= ivs.m_ivs;
+    }
   return *this;
 }
 
@@ -266,15 +316,31 @@ IntVectSet& IntVectSet::operator-=(const IntVectSet& ivs)
       if (ivs.m_isdense) m_dense-=ivs.m_dense;
       else
         {
-          for (TreeIntVectSetIterator it(ivs.m_ivs); it.ok(); ++it) m_dense -= it();
+          for (IVSIterator it(ivs); it.ok(); ++it) m_dense -= it();
         }
     }
+  else if (m_iscompressed)
+    {
+      if (ivs.m_isdense || !ivs.m_iscompressed)
+        {
+          CompressedIntVectSet other;
+          other.define(ivs.boxes());
+          m_compressed -= other;
+        }
+      else
+        m_compressed -= ivs.m_compressed;
+    }
   else
     {
       if (ivs.m_isdense)
         {
           for (DenseIntVectSetIterator it(ivs.m_dense);it.ok(); ++it) m_ivs -= it();
         }
+      else if (ivs.m_iscompressed)
+        {
+          Vector<Box> b = ivs.m_compressed.createBoxes();
+          for (int i = 0; i < b.size(); ++i) m_ivs -= b[i];
+        }
       else
         m_ivs -= ivs.m_ivs;
     }
@@ -290,6 +356,8 @@ bool IntVectSet::operator==(const IntVectSet& a_lhs) const
     return m_dense == a_lhs.m_dense;
   }
   if (a_lhs.m_isdense) return false;
+  if (m_iscompressed != a_lhs.m_iscompressed) return false;
+  if (m_iscompressed) return m_compressed == a_lhs.m_compressed;
   return m_ivs == a_lhs.m_ivs;
 }
 
@@ -308,6 +376,15 @@ bool IntVectSet::operator<(const IntVectSet& a_ivs) const
   {
     if ( !a_ivs.m_isdense )
     {
+      // Tree sorts before Compressed
+      if ( m_iscompressed != a_ivs.m_iscompressed )
+      {
+        return a_ivs.m_iscompressed;
+      }
+      if ( m_iscompressed )
+      {
+        return m_compressed < a_ivs.m_compressed;
+      }
       return m_ivs < a_ivs.m_ivs;
     } else
     {
@@ -319,6 +396,7 @@ bool IntVectSet::operator<(const IntVectSet& a_ivs) const
 int IntVectSet::linearSize() const
 {
   if (m_isdense) return m_dense.linearSize() + sizeof(int);
+  if (m_iscompressed) return m_compressed.linearSize() + sizeof(int);
   return m_ivs.linearSize() + sizeof(int);
 }
 
@@ -330,11 +408,19 @@ void IntVectSet::linearIn(const void* const inBuf)
   if (*b == 0)
   {
     m_isdense = true;
+    m_iscompressed = false;
     m_dense.linearIn(buf);
   }
+  else if (*b == 2)
+  {
+    m_isdense = false;
+    m_iscompressed = true;
+    m_compressed.linearIn(buf);
+  }
   else
   {
     m_isdense = false;
+    m_iscompressed = false;
     m_ivs.linearIn(buf);
   }
 }
@@ -348,6 +434,11 @@ void IntVectSet::linearOut(void* const a_outBuf) const
     *b=0;
     m_dense.linearOut(buf);
   }
+  else if (m_iscompressed)
+  {
+    *b=2;
+    m_compressed.linearOut(buf);
+  }
   else
   {
     *b=1;
@@ -358,6 +449,7 @@ void IntVectSet::linearOut(void* const a_outBuf) const
 IntVectSet& IntVectSet::operator-=(const IntVect& iv)
 {
   if (m_isdense) m_dense -= iv;
+  else if (m_iscompressed) m_compressed -= iv;
   else          m_ivs   -= iv;
   return *this;
 }
@@ -365,6 +457,7 @@ IntVectSet& IntVectSet::operator-=(const IntVect& iv)
 IntVectSet& IntVectSet::operator-=(const Box& b)
 {
   if (m_isdense) m_dense -= b;
+  else if (m_iscompressed) m_compressed -= b;
   else          m_ivs   -= b;
   return *this;
 }
@@ -393,6 +486,7 @@ IntVectSet operator&(const Box& b, const IntVectSet& ivs)
 IntVectSet& IntVectSet::operator&=(const Box& b)
 {
   if (m_isdense) m_dense &= b;
+  else if (m_iscompressed) m_compressed &= b;
   else          m_ivs   &= b;
   return *this;
 }
@@ -400,6 +494,7 @@ IntVectSet& IntVectSet::operator&=(const Box& b)
 IntVectSet& IntVectSet::operator&=(const ProblemDomain& d)
 {
   if (m_isdense) m_dense &= d;
+  else if (m_iscompressed) m_compressed &= d;
   else          m_ivs   &= d;
   return *this;
 }
@@ -408,24 +503,31 @@ IntVectSet& IntVectSet::operator&=(const IntVectSet& ivs)
 {
   if (!(minBox().intersects(ivs.minBox())))
     {
-      m_ivs.clear();
-      m_isdense = true;
-      m_dense = DenseIntVectSet();
+      define();
       return *this;
     }
   if (m_isdense)
     {
-      if (ivs.m_isdense) m_dense&=ivs.m_dense;
-      else
+      if (ivs.m_isdense)
         {
-          convert();
-          m_ivs &= ivs.m_ivs;
+          m_dense&=ivs.m_dense;
+          return *this;
         }
+      convert();
+    }
+  else if (ivs.m_isdense)
+    {
+      ivs.convert();
+    }
+  if (m_iscompressed || ivs.m_iscompressed)
+    {
+      toCompressed();
+      ivs.toCompressed();
+      m_compressed &= ivs.m_compressed;
     }
   else
     {
-      if (ivs.m_isdense) ivs.convert();
-        m_ivs &= ivs.m_ivs;
+      m_ivs &= ivs.m_ivs;
     }
 
   return *this;
@@ -441,6 +543,7 @@ IntVectSet grow(const IntVectSet& ivs, int igrow)
 void IntVectSet::grow(int igrow)
 {
   if (m_isdense) m_dense.grow(igrow);
+  else if (m_iscompressed) m_compressed.grow(igrow);
   else          m_ivs.grow(igrow);
   //  return *this;
 }
@@ -448,12 +551,14 @@ void IntVectSet::grow(int igrow)
 void IntVectSet::nestingRegion(int radius, const Box& domain, int granularity)
 {
   if (m_isdense) m_dense.nestingRegion(radius, domain);
+  else if (m_iscompressed) m_compressed.nestingRegion(radius, domain, granularity);
   else          m_ivs.nestingRegion(radius, domain, granularity);
 }
 
 void IntVectSet::nestingRegion(int radius, const ProblemDomain& domain, int granularity)
 {
   if (m_isdense) m_dense.nestingRegion(radius, domain);
+  else if (m_iscompressed) m_compressed.nestingRegion(radius, domain, granularity);
   else          m_ivs.nestingRegion(radius, domain, granularity);
 }
 
@@ -462,6 +567,7 @@ IntVectSet& IntVectSet::grow(int idir, int igrow)
   CH_assert(idir >= 0);
   CH_assert(idir < SpaceDim);
   if (m_isdense) m_dense.grow(idir, igrow);
+  else if (m_iscompressed) m_compressed.grow(idir, igrow);
   else          m_ivs.grow(idir, igrow);
   return *this;
 }
@@ -469,12 +575,14 @@ IntVectSet& IntVectSet::grow(int idir, int igrow)
 void IntVectSet::growHi()
 {
   if (m_isdense) m_dense.growHi();
+  else if (m_iscompressed) m_compressed.growHi();
   else          m_ivs.growHi();
 }
 
 void IntVectSet::growHi(const int a_dir)
 {
   if (m_isdense) m_dense.growHi(a_dir);
+  else if (m_iscompressed) m_compressed.growHi(a_dir);
   else          m_ivs.growHi(a_dir);
 }
 
@@ -488,6 +596,7 @@ IntVectSet refine(const IntVectSet& ivs, int iref)
 IntVectSet& IntVectSet::refine(int iref)
 {
   if (m_isdense) m_dense.refine(iref);
+  else if (m_iscompressed) m_compressed.refine(iref);
   else          m_ivs.refine(iref);
   return *this;
 }
@@ -502,6 +611,7 @@ IntVectSet coarsen(const IntVectSet& ivs, int iref)
 IntVectSet& IntVectSet::coarsen(int iref)
 {
   if (m_isdense) m_dense.coarsen(iref);
+  else if (m_iscompressed) m_compressed.coarsen(iref);
   else          m_ivs.coarsen(iref);
   return *this;
 }
@@ -509,24 +619,28 @@ IntVectSet& IntVectSet::coarsen(int iref)
 void IntVectSet::shift(const IntVect& iv)
 {
   if (m_isdense) m_dense.shift(iv);
+  else if (m_iscompressed) m_compressed.shift(iv);
   else          m_ivs.shift(iv);
 }
 
 void IntVectSet::makeEmpty()
 {
   if (m_isdense) m_dense = DenseIntVectSet();
+  else if (m_iscompressed) m_compressed.clear();
   else          m_ivs.clear();
 }
 
 void IntVectSet::makeEmptyBits()
 {
   if (m_isdense) m_dense.makeEmptyBits();
+  else if (m_iscompressed) m_compressed.clear();
   else          m_ivs.clear();
 }
 
 void IntVectSet::compact() const
 {
   if (m_isdense) m_dense.compact();
+  else if (m_iscompressed) m_compressed.compact();
   else          m_ivs.compact();
 }
 
@@ -538,6 +652,12 @@ IntVectSet IntVectSet::chop(int dir, int chop_pnt)
         IntVectSet rtn(r);
         return rtn;
   }
+  else if (m_iscompressed)
+  {
+        CompressedIntVectSet c = m_compressed.chop(dir, chop_pnt);
+        IntVectSet rtn(c);
+        return rtn;
+  }
   else
   {
         TreeIntVectSet t = m_ivs.chop(dir, chop_pnt);
@@ -551,16 +671,25 @@ void IntVectSet::chop(int dir, int chop_pnt, IntVectSet& a_hi)
 {
   if (m_isdense)
     a_hi = chop(dir, chop_pnt);
+  else if (m_iscompressed)
+    {
+      a_hi.define();
+      m_compressed.chop(dir, chop_pnt, a_hi.m_compressed);
+      a_hi.m_isdense = false;
+      a_hi.m_iscompressed = true;
+    }
   else
     {
       m_ivs.chop(dir, chop_pnt, a_hi.m_ivs);
       a_hi.m_isdense = false;
+      a_hi.m_iscompressed = false;
     }
 
 }
 const Box& IntVectSet::minBox() const
 {
   if (m_isdense) return m_dense.mBox();
+  if (m_iscompressed) return m_compressed.minBox();
   m_ivs.recalcMinBox();
   return m_ivs.minBox();
 }
@@ -569,6 +698,8 @@ void IntVectSet::recalcMinBox() const
 {
    if (m_isdense)
      m_dense.recalcMinBox();
+   else if (m_iscompressed)
+     m_compressed.recalcMinBox();
    else
      m_ivs.recalcMinBox();
 }
@@ -576,18 +707,21 @@ void IntVectSet::recalcMinBox() const
 bool IntVectSet::isEmpty() const
 {
   if (m_isdense) return m_dense.isEmpty();
+  if (m_iscompressed) return m_compressed.isEmpty();
   return m_ivs.isEmpty();
 }
 
 int IntVectSet::numPts() const
 {
   if (m_isdense) return m_dense.numPts();
+  if (m_iscompressed) return m_compressed.numPts();
   return m_ivs.numPts();
 }
 
 bool IntVectSet::contains(const IntVect& iv) const
 {
   if (m_isdense) return m_dense[iv];
+  if (m_iscompressed) return m_compressed.contains(iv);
   return m_ivs.contains(iv);
 }
 
@@ -606,12 +740,14 @@ bool IntVectSet::contains(const IntVectSet& ivs) const
 bool IntVectSet::contains(const Box& box) const
 {
   if (m_isdense) return m_dense.contains(box);
+  if (m_iscompressed) return m_compressed.contains(box);
   return m_ivs.contains(box);
 }
 
 Vector<Box> IntVectSet::boxes() const
 {
   if (m_isdense) return m_dense.createBoxes();
+  if (m_iscompressed) return m_compressed.createBoxes();
   return m_ivs.createBoxes();
 }
 
@@ -630,6 +766,11 @@ std::ostream& operator<<(std::ostream& os, const IntVectSet& ivs)
 void IntVectSet::convert() const
 {
   if (!m_isdense) return; //already converted
+  if (s_useCompressed)
+  {
+    toCompressed();
+    return;
+  }
   if (m_dense.isEmpty())
   {
     // do nothing
@@ -648,6 +789,25 @@ void IntVectSet::convert() const
       m_ivs.compact();
     }
   (bool&)m_isdense = false;
+  (bool&)m_iscompressed = false;
+}
+
+void IntVectSet::toCompressed() const
+{
+  if (!m_isdense && m_iscompressed) return; //already converted
+  CompressedIntVectSet& compressed = (CompressedIntVectSet&)m_compressed;
+  if (m_isdense)
+  {
+    compressed.define(m_dense.createBoxes());
+    (DenseIntVectSet&)m_dense = DenseIntVectSet();
+  }
+  else
+  {
+    compressed.define(m_ivs.createBoxes());
+    ((TreeIntVectSet&)m_ivs).clear();
+  }
+  (bool&)m_isdense = false;
+  (bool&)m_iscompressed = true;
 }
 
 // if you are in this function, you better really
@@ -675,11 +835,19 @@ void IVSIterator::define(const IntVectSet& ivs)
   if (ivs.m_isdense)
     {
       m_isdense = true;
+      m_iscompressed = false;
       m_dense.define(ivs.m_dense);
     }
+  else if (ivs.m_iscompressed)
+    {
+      m_isdense = false;
+      m_iscompressed = true;
+      m_compressed.define(ivs.m_compressed);
+    }
   else
     {
       m_isdense = false;
+      m_iscompressed = false;
       m_tree.define(ivs.m_ivs);
     }
 }
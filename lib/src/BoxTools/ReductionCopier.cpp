@@ -202,6 +202,10 @@ void ReductionCopier::define(const BoxLayout& a_level,
 #ifdef MULTIDIM_TIMER
   CH_TIME("ReductionCopier::define")
 #endif
+  if (a_level.isDistributed() || a_dest.isDistributed())
+    {
+      MayDay::Error("ReductionCopier::define does not support distributed layouts");
+    }
   m_isDefined = true;
   m_transverseDir = a_transverseDir;
 
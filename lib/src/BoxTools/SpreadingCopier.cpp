@@ -202,6 +202,10 @@ void SpreadingCopier::define(const BoxLayout& a_level,
 #ifdef MULTIDIM_TIMER
   CH_TIME("SpreadingCopier::define")
 #endif
+  if (a_level.isDistributed() || a_dest.isDistributed())
+    {
+      MayDay::Error("SpreadingCopier::define does not support distributed layouts");
+    }
   m_isDefined = true;
   m_transverseDir = a_transverseDir;
 
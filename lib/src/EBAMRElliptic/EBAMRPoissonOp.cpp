@@ -645,7 +645,12 @@ defineStencils()
       const EBGraph& curEBGraph = curEBISBox.getEBGraph();
       Vector<VolIndex>& rhsSetList = m_rhsSetList[dit[mybox]];
 
-      IntVectSet notRegular = curEBISBox.getIrregIVS(curBox);
+      //regular boxes get empty iterators and empty stencils
+      IntVectSet notRegular;
+      if (!m_eblg.isRegular(dit[mybox]))
+        {
+          notRegular = curEBISBox.getIrregIVS(curBox);
+        }
 
       BaseIVFAB<VoFStencil>& curStencilBaseIVFAB = opStencil[dit[mybox]];
       BaseIVFAB<VoFStencil>& relStencilBaseIVFAB = relStencil[dit[mybox]];
@@ -1519,12 +1524,15 @@ getInvDiagRHS(LevelData<EBCellFAB>&       a_lhs,
                          CHF_BOX(dblBox));
       CH_STOP(t1);
 
-      CH_START(t2);
-      const BaseIVFAB<Real>& curAlphaWeight = m_alphaDiagWeight[dit()];
-      const BaseIVFAB<Real>& curBetaWeight =  m_betaDiagWeight[dit()];
+      if (!m_eblg.isRegular(dit()))
+        {
+          CH_START(t2);
+          const BaseIVFAB<Real>& curAlphaWeight = m_alphaDiagWeight[dit()];
+          const BaseIVFAB<Real>& curBetaWeight =  m_betaDiagWeight[dit()];
 
-      m_invDiagEBStencil[dit]->apply(lhs, rhs, 1., m_alpha, curAlphaWeight, m_beta, curBetaWeight, 1., false);
-      CH_STOP(t2);
+          m_invDiagEBStencil[dit]->apply(lhs, rhs, 1., m_alpha, curAlphaWeight, m_beta, curBetaWeight, 1., false);
+          CH_STOP(t2);
+        }
     }
 }
 
@@ -1653,6 +1661,12 @@ applyOpNoCFBCs(LevelData<EBCellFAB>&                    a_opPhi,
                              a_dit[mybox],
                              m_beta);
 
+      //no irregular, domain-inhomogeneous or EB flux terms on a regular box
+      if (m_eblg.isRegular(a_dit[mybox]))
+        {
+          continue;
+        }
+
       const BaseIVFAB<Real>& alphaWeight = m_alphaDiagWeight[a_dit[mybox]];
       m_opEBStencil[a_dit[mybox]]->apply(curOpPhiEBCellFAB, curPhiEBCellFAB, alphaWeight, m_alpha, m_beta, false);
 
@@ -1765,6 +1779,11 @@ mvBetaLaplacianGrid(EBCellFAB         &  a_lph,
                      CHF_CONST_REALVECT(m_dx),
                      CHF_BOX(grid));
 
+  if (m_eblg.isRegular(a_dit))
+    {
+      return;
+    }
+
   Real alpha = 0;
   Real beta = m_beta;
   const BaseIVFAB<Real>& alphaWeight = m_alphaDiagWeight[a_dit];
@@ -3286,6 +3305,20 @@ AMRRestrict(LevelData<EBCellFAB>&       a_resCoar,
   CH_assert(a_resCoar.nComp() == 1);
   CH_assert(a_correction.nComp() == 1);
 
+  residualAndRestrict(a_resCoar, a_residual, a_correction, a_coarCorrection, m_resThisLevel);
+}
+/****/
+void EBAMRPoissonOp::
+residualAndRestrict(LevelData<EBCellFAB>&       a_resCoar,
+                    const LevelData<EBCellFAB>& a_residual,
+                    const LevelData<EBCellFAB>& a_correction,
+                    const LevelData<EBCellFAB>& a_coarCorrection,
+                    LevelData<EBCellFAB>&       a_scratch)
+{
+  CH_TIME("EBAMRPoissonOp::residualAndRestrict");
+  CH_assert(a_residual.nComp() == 1);
+  CH_assert(a_correction.nComp() == 1);
+
   LevelData<EBCellFAB>& resThisLevel = m_resThisLevel;
   bool homogeneousPhys = true;
   bool homogeneousCF =   false;
@@ -3294,8 +3327,14 @@ AMRRestrict(LevelData<EBCellFAB>&       a_resCoar,
 
   //API says that we must average(a_residual - L(correction, coarCorrection))
   applyOp(resThisLevel, a_correction, &a_coarCorrection, homogeneousPhys, homogeneousCF);
-  incr(resThisLevel, a_residual, -1.0);
-  scale(resThisLevel,-1.0);
+  DataIterator dit = resThisLevel.dataIterator();
+  int nbox = dit.size();
+#pragma omp parallel for
+  for (int mybox = 0; mybox < nbox; mybox++)
+    {
+      EBCellFAB& res = resThisLevel[dit[mybox]];
+      res.axby(a_residual[dit[mybox]], res, 1.0, -1.0);
+    }
 
   //use our nifty averaging operator
   Interval variables(0, 0);
@@ -3536,14 +3575,21 @@ colorGS(LevelData<EBCellFAB>&       a_phi,
       const EBCellFAB& rhsfab = a_rhs[dit()];
       BaseFab<Real>& phiBaseFAB = (a_phi[dit()]).getSingleValuedFAB();
       const BaseFab<Real>& rhsBaseFAB = (a_rhs[dit()] ).getSingleValuedFAB();
+      const bool regular = m_eblg.isRegular(dit());
 
-      m_colorEBStencil[a_icolor][dit()]->cachePhi(phifab);
+      if (!regular)
+        {
+          m_colorEBStencil[a_icolor][dit()]->cachePhi(phifab);
+        }
 
       GSColorAllRegular(phiBaseFAB, rhsBaseFAB, a_icolor, weight, homogeneous, dit());
 
-      m_colorEBStencil[a_icolor][dit()]->uncachePhi(phifab);
+      if (!regular)
+        {
+          m_colorEBStencil[a_icolor][dit()]->uncachePhi(phifab);
 
-      GSColorAllIrregular(phifab, rhsfab, a_icolor, homogeneous, dit());
+          GSColorAllIrregular(phifab, rhsfab, a_icolor, homogeneous, dit());
+        }
     }
 }
 
@@ -3677,9 +3723,10 @@ levelGSRB(LevelData<EBCellFAB>&       a_phi,
         {
           EBCellFAB& phifab = a_phi[dit[mybox]];
           const EBCellFAB& rhsfab = a_rhs[dit[mybox]];
+          const bool regular = m_eblg.isRegular(dit[mybox]);
 
           //cache phi
-          for (int c = 0; c < m_colors.size()/2; ++c)
+          for (int c = 0; c < m_colors.size()/2 && !regular; ++c)
             {
               m_colorEBStencil[m_colors.size()/2*redBlack+c][dit[mybox]]->cachePhi(phifab);
             }
@@ -3703,12 +3750,12 @@ levelGSRB(LevelData<EBCellFAB>&       a_phi,
             }
 
           //uncache phi
-          for (int c = 0; c < m_colors.size()/2; ++c)
+          for (int c = 0; c < m_colors.size()/2 && !regular; ++c)
             {
               m_colorEBStencil[m_colors.size()/2*redBlack+c][dit[mybox]]->uncachePhi(phifab);
             }
 
-          for (int c = 0; c < m_colors.size()/2; ++c)
+          for (int c = 0; c < m_colors.size()/2 && !regular; ++c)
             {
               GSColorAllIrregular(phifab, rhsfab, m_colors.size()/2*redBlack+c, homogeneous, dit[mybox]);
             }
@@ -560,10 +560,14 @@ defineStencils()
         const EBISBox& ebisBox = m_eblg.getEBISL()[dit[mybox]];
         const EBGraph& ebgraph = ebisBox.getEBGraph();
 
-        IntVectSet irregIVS = ebisBox.getIrregIVS(curBox);
-        IntVectSet multiIVS = ebisBox.getMultiCells(curBox);
-
-        BaseIVFAB<VoFStencil> opStencil(irregIVS,ebgraph, 1);
+        //regular boxes get empty iterators and no stencil
+        bool regular = m_eblg.isRegular(dit[mybox]);
+        IntVectSet irregIVS, multiIVS;
+        if (!regular)
+          {
+            irregIVS = ebisBox.getIrregIVS(curBox);
+            multiIVS = ebisBox.getMultiCells(curBox);
+          }
 
         //cache the vofIterators
         m_alphaDiagWeight[dit[mybox]].define(irregIVS,ebisBox.getEBGraph(), 1);
@@ -580,7 +584,12 @@ defineStencils()
             m_vofIterDomLo[idir][dit[mybox]].define(loIrreg,ebisBox.getEBGraph());
             m_vofIterDomHi[idir][dit[mybox]].define(hiIrreg,ebisBox.getEBGraph());
           }
+        if (regular)
+          {
+            continue;
+          }
 
+        BaseIVFAB<VoFStencil> opStencil(irregIVS,ebgraph, 1);
         VoFIterator& vofit = m_vofIterIrreg[dit[mybox]];
         for (vofit.reset(); vofit.ok(); ++vofit)
           {
@@ -694,6 +703,17 @@ defineColorStencils(Box a_sideBoxLo[SpaceDim],
           const EBGraph& curEBGraph = curEBISBox.getEBGraph();
           Box dblBox( m_eblg.getDBL().get(dit[mybox]) );
 
+          if (m_eblg.isRegular(dit[mybox]))
+            {
+              IntVectSet emptyIVS;
+              for (int idir = 0; idir < SpaceDim; idir++)
+                {
+                  m_vofItIrregColorDomLo[icolor][idir][dit[mybox]].define(emptyIVS,curEBGraph);
+                  m_vofItIrregColorDomHi[icolor][idir][dit[mybox]].define(emptyIVS,curEBGraph);
+                }
+              continue;
+            }
+
           IntVectSet ivsColor(DenseIntVectSet(dblBox, false));
 
           VoFIterator& vofit = m_vofIterIrreg[dit[mybox]];
@@ -1039,10 +1059,21 @@ applyOp(LevelData<EBCellFAB>&                    a_lhs,
   incr( a_lhs, a_phi, m_alpha); //this multiplies by alpha
   DataIterator dit = m_eblg.getDBL().dataIterator(); 
   int nbox = dit.size();
-#pragma omp parallel for
+
+  // Work of the regular stencil: phi, acoef and the face bcoefs are read,
+  // lhs is read and written.  Stated here, on the thread running this
+  // timer, rather than by the threads of the loop
+  long long int numPts = 0;
   for(int mybox=0; mybox<nbox; mybox++)
     {
+      numPts += m_eblg.getDBL()[dit[mybox]].numPts();
+    }
+  CH_FLOPS(numPts*(2 + 6*SpaceDim));
+  CH_BYTES(numPts*sizeof(Real)*(4 + SpaceDim));
 
+#pragma omp parallel for
+  for(int mybox=0; mybox<nbox; mybox++)
+    {
       a_lhs[dit[mybox]].mult((*m_acoef)[dit[mybox]], 0, 0, 1);
 
       Box loBox[SpaceDim],hiBox[SpaceDim];
@@ -1075,7 +1106,10 @@ applyOp(LevelData<EBCellFAB>&                    a_lhs,
             }
         }
 
-      applyOpIrregular(a_lhs[dit[mybox]], a_phi[dit[mybox]], a_homogeneousPhysBC, dit[mybox]);
+      if (!m_eblg.isRegular(dit[mybox]))
+        {
+          applyOpIrregular(a_lhs[dit[mybox]], a_phi[dit[mybox]], a_homogeneousPhysBC, dit[mybox]);
+        }
     }
 }
 //-----------------------------------------------------------------------
@@ -1549,9 +1583,10 @@ relaxGSRBFast(LevelData<EBCellFAB>&       a_phi,
               {
                 EBCellFAB& phifab = a_phi[dit[mybox]];
                 const EBCellFAB& rhsfab = a_rhs[dit[mybox]];
+                const bool regular = m_eblg.isRegular(dit[mybox]);
                 
                 //cache phi
-                for (int c = 0; c < m_colors.size()/2; ++c)
+                for (int c = 0; c < m_colors.size()/2 && !regular; ++c)
                   {
                     m_colorEBStencil[m_colors.size()/2*redBlack+c][dit[mybox]]->cachePhi(phifab);
                   }
@@ -1599,12 +1634,12 @@ relaxGSRBFast(LevelData<EBCellFAB>&       a_phi,
                   }
 
                 //uncache phi
-                for (int c = 0; c < m_colors.size()/2; ++c)
+                for (int c = 0; c < m_colors.size()/2 && !regular; ++c)
                   {
                     m_colorEBStencil[m_colors.size()/2*redBlack+c][dit[mybox]]->uncachePhi(phifab);
                   }
                 
-                for (int c = 0; c < m_colors.size()/2; ++c)
+                for (int c = 0; c < m_colors.size()/2 && !regular; ++c)
                   {
                     GSColorAllIrregular(phifab, rhsfab, m_colors.size()/2*redBlack+c, dit[mybox]);
                   }
@@ -1488,22 +1488,25 @@ void EBAMRGodunov::readCheckpointLevel(HDF5Handle& a_handle)
 
   // Get the grids
   Vector<Box> vboxGrids;
-  const int gridStatus = read(a_handle, vboxGrids);
+  Vector<int> proc_map;
+  const int gridStatus = readCheckpointGrids(a_handle, vboxGrids, proc_map);
   if (gridStatus != 0)
     {
       MayDay::Error("readCheckpointLevel: file has no grids");
     }
 
-  Vector<int> proc_map;
-  if (s_isLoadBalanceSet)
-    {
-      s_loadBalance(proc_map,vboxGrids, m_domainBox, false);
-    }
-  else
+  if (proc_map.size() == 0)
     {
-      LoadBalance(proc_map,vboxGrids);
+      if (s_isLoadBalanceSet)
+        {
+          s_loadBalance(proc_map,vboxGrids, m_domainBox, false);
+        }
+      else
+        {
+          LoadBalance(proc_map,vboxGrids);
+        }
+      broadcast(proc_map, uniqueProc(SerialTask::compute));
     }
-  broadcast(proc_map, uniqueProc(SerialTask::compute));
 
   m_grids= DisjointBoxLayout(vboxGrids,proc_map);
 
@@ -55,9 +55,20 @@ setValidBox(const Box&        a_validBox,
   m_time     = a_cumulativeTime;
   m_validBox = a_validBox;
   m_ebisBox  = a_ebisBox;
+  m_validBoxG4  = grow(m_validBox, 4);
+  m_validBoxG4 &= m_domain;
+
+  //if every cell this patch can touch is regular, all the irregular
+  //sets below are empty and we can skip looking for them
+  m_isRegularBox = (m_ebisBox.isAllRegular() ||
+                    (!m_ebisBox.isAllCovered() && m_ebisBox.isRegular(m_validBoxG4)));
 
   //define the interpolation stencils
-  IntVectSet ivsIrreg = m_ebisBox.getIrregIVS(m_validBox);
+  IntVectSet ivsIrreg;
+  if (!m_isRegularBox)
+    {
+      ivsIrreg = m_ebisBox.getIrregIVS(m_validBox);
+    }
   FaceStop::WhichFaces facestop = FaceStop::SurroundingWithBoundary;
   for (int idir = 0; idir < SpaceDim; idir++)
     {
@@ -77,8 +88,6 @@ setValidBox(const Box&        a_validBox,
   //really important that all these things are the same size.
   //This allows me to make all kinds of wacky stenciling assumptions down
   //the road.  Mess with these definitions at thy peril.
-  m_validBoxG4  = grow(m_validBox, 4);
-  m_validBoxG4 &= m_domain;
   int numFlux = numFluxes();
   int numPrim = numPrimitives();
   m_primState.define(   m_ebisBox, m_validBoxG4, numPrim);
@@ -132,9 +141,19 @@ setValidBox(const Box&        a_validBox,
             }
         }
     }
-  IntVectSet        ivsIrregG4 =  m_ebisBox.getIrregIVS(m_validBoxG4);
+  IntVectSet        ivsIrregG4;
+  if (!m_isRegularBox)
+    {
+      ivsIrregG4 = m_ebisBox.getIrregIVS(m_validBoxG4);
+    }
   VoFIterator vofit(ivsIrregG4,   m_ebisBox.getEBGraph());
   m_irregVoFs = vofit.getVector();
+  //multi-valued face layouts that the face offsets refer to
+  for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      m_irrFaceG4[idir].define(   m_validBoxG4, m_ebisBox.getEBGraph(), idir, 1);
+      m_irrFaceValid[idir].define(m_validBox,   m_ebisBox.getEBGraph(), idir, 1);
+    }
   m_updateStencil.resize(m_irregVoFs.size());
   for (int ivof = 0; ivof<m_irregVoFs.size(); ivof++)
     {
@@ -235,6 +254,90 @@ fillUpdateStencil(EBPatchGodunov::updateStencil_t& a_stencil, const VolIndex& a_
           a_stencil.m_vofOffset.m_offset +=    iv[2]*ncells[0]*ncells[1];
         }
     }
+
+  //face offsets into face data over m_validBoxG4 (the transverse fluxes)
+  //and, for vofs in the valid box, over m_validBox (the level fluxes)
+  fillFaceOffsets(a_stencil.m_faceOffsets, a_vof, m_validBoxG4, m_irrFaceG4);
+  if (m_validBox.contains(a_vof.gridIndex()))
+    {
+      fillFaceOffsets(a_stencil.m_validFaceOffsets, a_vof, m_validBox, m_irrFaceValid);
+    }
+}
+/****/
+void
+EBPatchGodunov::
+fillFaceOffsets(Vector<pointerOffset_t> a_offsets[SpaceDim][2],
+                const VolIndex&         a_vof,
+                const Box&              a_cellRegion,
+                const MiniIFFAB<Real>   a_irrFace[SpaceDim])
+{
+  for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      //the single-valued part of face data over a_cellRegion
+      const Box faceBox = surroundingNodes(a_cellRegion, idir);
+      const IntVect nfaces = faceBox.size();
+      const Vector<FaceIndex>& multiFaces = a_irrFace[idir].getFaces();
+      for (SideIterator sit; sit.ok(); ++sit)
+        {
+          Vector<FaceIndex> faces = m_ebisBox.getFaces(a_vof, idir, sit());
+          Vector<pointerOffset_t>& offsets = a_offsets[idir][sit()];
+          offsets.resize(faces.size());
+          for (int iface = 0; iface < faces.size(); iface++)
+            {
+              const FaceIndex& face = faces[iface];
+              bool multiValued = false;
+              for (int jface = 0; jface < multiFaces.size(); jface++)
+                {
+                  if (multiFaces[jface] == face)
+                    {
+                      multiValued = true;
+                      break;
+                    }
+                }
+              offsets[iface].m_multiValued = multiValued;
+              if (multiValued)
+                {
+                  offsets[iface].m_offset = a_irrFace[idir].getIndex(face, 0) - a_irrFace[idir].dataPtr(0);
+                }
+              else
+                {
+                  IntVect iv = face.gridIndex(Side::Hi) - faceBox.smallEnd();
+                  offsets[iface].m_offset = iv[0] + iv[1]*nfaces[0];
+                  if (SpaceDim==3)
+                    {
+                      offsets[iface].m_offset += iv[2]*nfaces[0]*nfaces[1];
+                    }
+                }
+            }
+        }
+    }
+}
+/****/
+Real
+EBPatchGodunov::
+averageFaceValue(const Real*                    a_regPtr,
+                 const Real*                    a_irrPtr,
+                 const Vector<pointerOffset_t>& a_offsets)
+{
+  Real retval = 0.0;
+  const int nfaces = a_offsets.size();
+  for (int iface = 0; iface < nfaces; iface++)
+    {
+      const pointerOffset_t& faceOff = a_offsets[iface];
+      if (faceOff.m_multiValued)
+        {
+          retval += a_irrPtr[faceOff.m_offset];
+        }
+      else
+        {
+          retval += a_regPtr[faceOff.m_offset];
+        }
+    }
+  if (nfaces > 1)
+    {
+      retval /= Real(nfaces);
+    }
+  return retval;
 }
 /****/
 void
@@ -345,6 +448,7 @@ EBPatchGodunov::EBPatchGodunov()
   m_isDefined     = false;
   m_isBCSet       = false;
   m_isBoxSet      = false;
+  m_isRegularBox  = false;
   m_useAgg = false;
   m_bc = NULL;
 }
@@ -1083,6 +1187,33 @@ updateCons(EBCellFAB&              a_consState,
     uncacheEBCF(a_consState, cache);
   }
   //update the irregular vofs
+  if (a_flux.getCellRegion() == m_validBoxG4)
+    {
+      //the flux and the state share the layout the offsets were built
+      //for, so gather the face fluxes of all irregular vofs one variable
+      //at a time instead of searching the graph for each of them
+      CH_TIME("EBPatchGodunov::updateConsIrregularCached");
+      for (int ivar = 0; ivar < a_consState.nComp(); ivar++)
+        {
+          Real*       consSV = a_consState.getSingleValuedFAB().dataPtr(ivar);
+          Real*       consMV = a_consState.getMultiValuedFAB().dataPtr(ivar);
+          const Real* fluxSV = a_flux.getSingleValuedFAB().dataPtr(ivar);
+          const Real* fluxMV = a_flux.getMultiValuedFAB().dataPtr(ivar);
+          for (int ivof = 0; ivof<m_irregVoFs.size(); ivof++)
+            {
+              if (a_box.contains(m_irregVoFs[ivof].gridIndex()))
+                {
+                  const updateStencil_t& sten = m_updateStencil[ivof];
+                  const pointerOffset_t& vofOff = sten.m_vofOffset;
+                  Real& cons = vofOff.m_multiValued ? consMV[vofOff.m_offset] : consSV[vofOff.m_offset];
+                  //dx is already divided out (part of scale)
+                  cons +=  a_scale*averageFaceValue(fluxSV, fluxMV, sten.m_faceOffsets[a_dir][Side::Lo]);
+                  cons += -a_scale*averageFaceValue(fluxSV, fluxMV, sten.m_faceOffsets[a_dir][Side::Hi]);
+                }
+            }
+        }
+    }
+  else
   {
     CH_TIME("EBPatchGodunov::updateConsIrregular");
     for (int ivof = 0; ivof<m_irregVoFs.size(); ivof++)
@@ -1699,8 +1830,12 @@ setSlopeStuff()
 
   for (int idir = 0; idir < SpaceDim; idir++)
     {
-      IntVectSet        ivsIrregG4 =  m_ebisBox.getIrregIVS(m_validBoxG4);
-      ivsIrregG4 &= m_entireBox[idir] ;
+      IntVectSet        ivsIrregG4;
+      if (!m_isRegularBox)
+        {
+          ivsIrregG4 = m_ebisBox.getIrregIVS(m_validBoxG4);
+          ivsIrregG4 &= m_entireBox[idir] ;
+        }
       VoFIterator vofit(ivsIrregG4,   m_ebisBox.getEBGraph());
       const Vector<VolIndex>& vofs = vofit.getVector();
       m_slopVec[idir].resize(vofs.size());
@@ -2487,6 +2622,51 @@ nonconservativeDivergence(EBCellFAB&             a_divF,
                      CHF_CONST_REAL(m_dx[idir]));
 
     }
+  //the level hands in fluxes over the valid box, the patch over the G4 box
+  bool overG4 = true;
+  bool overValid = true;
+  for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      overG4    = overG4    && (a_flux[idir].getCellRegion() == m_validBoxG4);
+      overValid = overValid && (a_flux[idir].getCellRegion() == m_validBox);
+    }
+  if ((overG4 || overValid) && m_validBox.contains(a_box))
+    {
+      //same divergence as below but with the face fluxes gathered
+      //through the offsets cached in setValidBox
+      CH_TIME("EBPatchGodunov::nonconservativeDivergenceIrregCached");
+      for (int ivar = 0; ivar < ncons; ivar++)
+        {
+          const Real* fluxSV[SpaceDim];
+          const Real* fluxMV[SpaceDim];
+          for (int idir = 0; idir < SpaceDim; idir++)
+            {
+              fluxSV[idir] = a_flux[idir].getSingleValuedFAB().dataPtr(ivar);
+              fluxMV[idir] = a_flux[idir].getMultiValuedFAB().dataPtr(ivar);
+            }
+          for (int ivof = 0; ivof<m_irregVoFs.size(); ivof++)
+            {
+              const VolIndex& vof = m_irregVoFs[ivof];
+              if (a_box.contains(vof.gridIndex()))
+                {
+                  const updateStencil_t& sten = m_updateStencil[ivof];
+                  typedef Vector<pointerOffset_t> FaceOffsets[SpaceDim][2];
+                  const FaceOffsets& offsets = overG4 ? sten.m_faceOffsets : sten.m_validFaceOffsets;
+                  Real irregDiv = 0.0;
+                  for (int idir = 0; idir < SpaceDim; idir++)
+                    {
+                      Real fluxLo = averageFaceValue(fluxSV[idir], fluxMV[idir], offsets[idir][Side::Lo]);
+                      Real fluxHi = averageFaceValue(fluxSV[idir], fluxMV[idir], offsets[idir][Side::Hi]);
+                      irregDiv += -fluxLo/m_dx[idir];
+                      irregDiv +=  fluxHi/m_dx[idir];
+                    }
+                  a_divF(vof, ivar) = irregDiv;
+                }
+            }
+        }
+    }
+  else
+  {
   //update the irregular vofsn
     for (int ivof = 0; ivof<m_irregVoFs.size(); ivof++)
       {
@@ -2523,6 +2703,7 @@ nonconservativeDivergence(EBCellFAB&             a_divF,
               }//end loop over variables
           }
     }//end loop over irreg vofs
+  }
 
   //now correct for the covered fluxes
   for (int idir = 0; idir < SpaceDim; idir++)
@@ -3532,6 +3713,13 @@ computeCoveredFaces(Vector<VolIndex>&     a_coveredFace,
                     const Box&            a_region)
 {
   CH_TIME("EBPatchGodunov::computeCoveredFaces");
+  if (m_isRegularBox && m_validBoxG4.contains(a_region))
+    {
+      a_coveredFace.resize(0);
+      a_coveredSets = IntVectSet();
+      a_irregIVS    = IntVectSet();
+      return;
+    }
 
   EBArith::computeCoveredFaces(a_coveredFace, a_coveredSets,
                                a_irregIVS, a_idir, a_sd,
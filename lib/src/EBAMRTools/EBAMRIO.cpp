@@ -33,6 +33,7 @@ using std::string;
 
 static int g_whichCellIndex = 0;
 static Real g_coveredCellValue = -98.7654321;
+static bool g_sparseEBOutput = false;
 
 void
 writeEBHDF5(const string& a_filename,
@@ -1931,6 +1932,190 @@ writeEBInfo(HDF5Handle& a_handle,
         std::string("M"), a_ghost, Interval(), true);
 }
 
+// cells of a_region that are not covered, in BoxIterator order.
+// these are the cells whose single-valued data goes into "CUncovered".
+static void
+uncoveredCells(Vector<IntVect>& a_cells,
+               const EBISBox&   a_ebisBox,
+               const Box&       a_region)
+{
+  a_cells.resize(0);
+  if (a_ebisBox.isAllCovered())
+    {
+      return;
+    }
+  bool allRegular = a_ebisBox.isAllRegular();
+  for (BoxIterator bit(a_region); bit.ok(); ++bit)
+    {
+      if (allRegular || !a_ebisBox.isCovered(bit()))
+        {
+          a_cells.push_back(bit());
+        }
+    }
+}
+
+// writes the single-valued data of the uncovered cells of each
+// (ghosted) box, all components of a cell together, into "CUncovered".
+// "CUncoveredOffsets" holds where each box starts, and its "comps"
+// attribute the number of components per cell.  covered cells are
+// left out; the reader recovers them from the EBISLayout.
+static void
+writeUncovered(HDF5Handle&                 a_handle,
+               const LevelData<EBCellFAB>& a_data,
+               const IntVect&              a_ghost,
+               const Interval&             a_interval)
+{
+  const DisjointBoxLayout& dbl = a_data.disjointBoxLayout();
+  int ncomps = a_interval.size();
+
+  OffsetBuffer boff;
+  for (DataIterator dit = a_data.dataIterator(); dit.ok(); ++dit)
+    {
+      const EBISBox& ebisBox = a_data[dit()].getEBISBox();
+      Box region = grow(dbl.get(dit()), a_ghost);
+      region &= ebisBox.getDomain();
+      Vector<IntVect> cells;
+      uncoveredCells(cells, ebisBox, region);
+      boff.index.push_back(dbl.index(dit()));
+      boff.offsets.push_back(Vector<int>(1, ncomps*cells.size()));
+    }
+
+  Vector<OffsetBuffer> gathering(numProc());
+  gather(gathering, boff, uniqueProc(SerialTask::compute));
+  broadcast(gathering,  uniqueProc(SerialTask::compute));
+
+  Vector<long long> offsets(dbl.size()+1, 0);
+  for (int i=0; i<numProc(); ++i)
+    {
+      OffsetBuffer& offbuf = gathering[i];
+      for (int num=0; num<offbuf.index.size(); num++)
+        {
+          offsets[offbuf.index[num] + 1] = offbuf.offsets[num][0];
+        }
+    }
+  for (int i=0; i<dbl.size(); i++)
+    {
+      offsets[i+1] += offsets[i];
+    }
+
+  hid_t dataset, dataspace;
+  long long dummyOffset = 0;
+  createDataset(dataset, dataspace, a_handle, "CUncoveredOffsets",
+                &dummyOffset, dbl.size()+1);
+  if (procID() == 0)
+    writeDataset(dataset, dataspace, &(offsets[0]), 0, dbl.size()+1);
+  HDF5HeaderData info;
+  info.m_int["comps"] = ncomps;
+  info.writeToLocation(dataset);
+  H5Sclose(dataspace);
+  H5Dclose(dataset);
+
+  if (offsets.back() == 0)
+    {
+      return;
+    }
+  // chunked and compressed as the handle asks, like the dense level data
+  hsize_t largestBox = 0;
+  for (int i=0; i<dbl.size(); i++)
+    {
+      largestBox = Max(largestBox, (hsize_t)(offsets[i+1] - offsets[i]));
+    }
+  hsize_t flatdims[1];
+  flatdims[0] = offsets.back();
+  dataspace = H5Screate_simple(1, flatdims, NULL);
+  CH_assert(dataspace >= 0);
+  hid_t dcpl = H5P_DEFAULT;
+  if (a_handle.getCompression().isChunked())
+    {
+      dcpl = chunkedProperties(a_handle.getCompression(), flatdims[0],
+                               largestBox, sizeof(Real));
+    }
+#ifdef H516
+  dataset = H5Dcreate(a_handle.groupID(), "CUncovered", H5T_NATIVE_REAL,
+                      dataspace, dcpl);
+#else
+  dataset = H5Dcreate2(a_handle.groupID(), "CUncovered", H5T_NATIVE_REAL,
+                       dataspace, H5P_DEFAULT, dcpl, H5P_DEFAULT);
+#endif
+  CH_assert(dataset >= 0);
+  if (dcpl != H5P_DEFAULT)
+    {
+      H5Pclose(dcpl);
+    }
+
+  // the boxes of this rank go into one buffer and one union of
+  // hyperslabs, written by a single collective H5Dwrite, as
+  // writeChunked does; filtered datasets need that in parallel
+  long long localCount = 0;
+  for (DataIterator dit = a_data.dataIterator(); dit.ok(); ++dit)
+    {
+      int index = dbl.index(dit());
+      localCount += offsets[index+1] - offsets[index];
+    }
+  Vector<Real> buffer(localCount + 1);
+  long long v = 0;
+  bool isFirstHyperslab = true;
+  H5Sselect_none(dataspace);
+  for (DataIterator dit = a_data.dataIterator(); dit.ok(); ++dit)
+    {
+      int index = dbl.index(dit());
+      int size = offsets[index+1] - offsets[index];
+      if (size > 0)
+        {
+          const EBCellFAB& fab = a_data[dit()];
+          const BaseFab<Real>& regFAB = fab.getSingleValuedFAB();
+          Box region = grow(dbl.get(dit()), a_ghost);
+          region &= fab.getEBISBox().getDomain();
+          Vector<IntVect> cells;
+          uncoveredCells(cells, fab.getEBISBox(), region);
+          CH_assert(size == ncomps*cells.size());
+
+          for (int icell = 0; icell < cells.size(); icell++)
+            {
+              for (int comp = a_interval.begin(); comp <= a_interval.end(); comp++)
+                {
+                  buffer[v] = regFAB(cells[icell], comp);
+                  v++;
+                }
+            }
+          hsize_t count[1];
+          ch_offset_t offset[1];
+          offset[0] = offsets[index];
+          count[0] = size;
+          herr_t err = H5Sselect_hyperslab(dataspace,
+                                           (isFirstHyperslab ? H5S_SELECT_SET : H5S_SELECT_OR),
+                                           offset, NULL, count, NULL);
+          CH_assert(err >= 0);
+          isFirstHyperslab = false;
+        }
+    }
+
+  hid_t DXPL = H5Pcreate(H5P_DATASET_XFER);
+#ifdef CH_MPI
+  if (a_handle.openMode() != HDF5Handle::CREATE_SERIAL)
+    {
+      H5Pset_dxpl_mpio(DXPL, H5FD_MPIO_COLLECTIVE);
+    }
+#endif
+  hsize_t memCount[1];
+  memCount[0] = (localCount > 0) ? localCount : 1;
+  hid_t memdataspace = H5Screate_simple(1, memCount, NULL);
+  if (localCount == 0)
+    {
+      H5Sselect_none(memdataspace);
+    }
+  herr_t err = H5Dwrite(dataset, H5T_NATIVE_REAL, memdataspace, dataspace,
+                        DXPL, &(buffer[0]));
+  if (err < 0)
+    {
+      MayDay::Error("writeUncovered: H5Dwrite of CUncovered failed");
+    }
+  H5Sclose(memdataspace);
+  H5Pclose(DXPL);
+  H5Sclose(dataspace);
+  H5Dclose(dataset);
+}
+
 void
 writeCellCentered(HDF5Handle& a_handle,
                   int a_level,
@@ -1957,12 +2142,19 @@ writeCellCentered(HDF5Handle& a_handle,
     a_interval = a_data->interval();
 
   // write out cell centered level data
-  LevelData<FArrayBox> aliasDense;
-  aliasEB(aliasDense, (LevelData<EBCellFAB>&)*a_data);
-  a_handle.setGroup(levelName);
+  if (g_sparseEBOutput)
+    {
+      writeUncovered(a_handle, *a_data, ghost, a_interval);
+    }
+  else
+    {
+      LevelData<FArrayBox> aliasDense;
+      aliasEB(aliasDense, (LevelData<EBCellFAB>&)*a_data);
+      a_handle.setGroup(levelName);
 
-  write(a_handle, (const BoxLayoutData<FArrayBox>&)aliasDense,
-        std::string("C"), ghost, a_interval, true);
+      write(a_handle, (const BoxLayoutData<FArrayBox>&)aliasDense,
+            std::string("C"), ghost, a_interval, true);
+    }
 
   a_handle.setGroup(levelName); //just to be safe
 
@@ -2080,6 +2272,74 @@ readCellCentered(HDF5Handle& a_handle,
   LevelData<FArrayBox> aliasDense;
   aliasEB(aliasDense, *a_data);
 
+  if (hasDataset(a_handle, "CUncoveredOffsets"))
+  {
+    // sparse output: only uncovered cells are in the file
+    Vector<long long> offsets;
+    read(a_handle, "CUncoveredOffsets", offsets, H5T_NATIVE_LLONG);
+    // the file knows how many components it holds per cell; it has to
+    // be the NumC that a_data was defined with
+#ifdef H516
+    hid_t offsetset = H5Dopen(a_handle.groupID(), "CUncoveredOffsets");
+#else
+    hid_t offsetset = H5Dopen2(a_handle.groupID(), "CUncoveredOffsets", H5P_DEFAULT);
+#endif
+    HDF5HeaderData info;
+    info.readFromLocation(offsetset);
+    H5Dclose(offsetset);
+    if ((info.m_int.find("comps") == info.m_int.end()) ||
+        (info.m_int["comps"] != ncomp))
+      {
+        MayDay::Error("readCellCentered: CUncovered does not hold NumC components per cell");
+      }
+    hid_t dataset = -1, dataspace = -1;
+    if (offsets.back() > 0)
+      {
+#ifdef H516
+        dataset = H5Dopen(a_handle.groupID(), "CUncovered");
+#else
+        dataset = H5Dopen2(a_handle.groupID(), "CUncovered", H5P_DEFAULT);
+#endif
+        dataspace = H5Dget_space(dataset);
+      }
+    for (DataIterator dit = a_data->dataIterator(); dit.ok(); ++dit)
+      {
+        FArrayBox& regFAB = aliasDense[dit()];
+        regFAB.setVal(g_coveredCellValue);
+        int index = dbl.index(dit());
+        int size = offsets[index+1] - offsets[index];
+        if (size > 0)
+          {
+            const EBISBox& ebisBox = (*a_data)[dit()].getEBISBox();
+            Box region = grow(dbl.get(dit()), ghost);
+            region &= ebisBox.getDomain();
+            Vector<IntVect> cells;
+            uncoveredCells(cells, ebisBox, region);
+            if (size != ncomp*cells.size())
+              {
+                MayDay::Error("readCellCentered: CUncovered does not match the uncovered cells of the EBISLayout");
+              }
+
+            Vector<Real> buffer(size);
+            readDataset(dataset, dataspace, &(buffer[0]), offsets[index], size);
+            int v = 0;
+            for (int icell = 0; icell < cells.size(); icell++)
+              {
+                for (int comp = 0; comp < ncomp; comp++)
+                  {
+                    regFAB(cells[icell], comp) = buffer[v];
+                    v++;
+                  }
+              }
+          }
+      }
+    if (dataset >= 0)
+      {
+        H5Sclose(dataspace);
+        H5Dclose(dataset);
+      }
+  }
+  else
   {
 #ifdef H516
     hid_t dataset   = H5Dopen(a_handle.groupID(), "CRegular");
@@ -2133,6 +2393,8 @@ readCellCentered(HDF5Handle& a_handle,
 
   }
 
+  //the writer leaves this out when the level has no irregular cells
+  if (hasDataset(a_handle, "CIrregular"))
   {
     hid_t dataset, dataspace;
 #ifdef H516
@@ -2191,7 +2453,17 @@ void setCoveredCellValue(Real a_coveredCellValue)
 
 Real getCoveredCellValue()
 {
-  return g_whichCellIndex;
+  return g_coveredCellValue;
+}
+
+void setSparseEBOutput(bool a_sparseEBOutput)
+{
+  g_sparseEBOutput = a_sparseEBOutput;
+}
+
+bool getSparseEBOutput()
+{
+  return g_sparseEBOutput;
 }
 
 //adding non-uniform mesh spacing output
@@ -0,0 +1,60 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include "EBAMRProbe.H"
+#include "NamespaceHeader.H"
+
+bool probeValue(Real*            a_values,
+                const EBCellFAB& a_fab,
+                const IntVect&   a_cell,
+                const Interval&  a_comps)
+{
+  const EBISBox& ebisBox = a_fab.getEBISBox();
+  if (ebisBox.isCovered(a_cell))
+  {
+    return false;
+  }
+  if (ebisBox.isRegular(a_cell))
+  {
+    VolIndex vof(a_cell, 0);
+    for (int comp = a_comps.begin(); comp <= a_comps.end(); comp++)
+    {
+      a_values[comp - a_comps.begin()] = a_fab(vof, comp);
+    }
+    return true;
+  }
+
+  Vector<VolIndex> vofs = ebisBox.getVoFs(a_cell);
+  Real volume = 0.0;
+  for (int comp = a_comps.begin(); comp <= a_comps.end(); comp++)
+  {
+    a_values[comp - a_comps.begin()] = 0.0;
+  }
+  for (int ivof = 0; ivof < vofs.size(); ivof++)
+  {
+    Real volFrac = ebisBox.volFrac(vofs[ivof]);
+    volume += volFrac;
+    for (int comp = a_comps.begin(); comp <= a_comps.end(); comp++)
+    {
+      a_values[comp - a_comps.begin()] += volFrac*a_fab(vofs[ivof], comp);
+    }
+  }
+  if (volume <= 0)
+  {
+    return false;
+  }
+  for (int comp = a_comps.begin(); comp <= a_comps.end(); comp++)
+  {
+    a_values[comp - a_comps.begin()] /= volume;
+  }
+  return true;
+}
+
+#include "NamespaceFooter.H"
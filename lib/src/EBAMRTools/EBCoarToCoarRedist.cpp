@@ -14,6 +14,7 @@
 #include "VoFIterator.H"
 #include "EBCellFactory.H"
 #include "CH_Timer.H"
+#include "SPMD.H"
 #include "NamespaceHeader.H"
 /***********************/
 /***********************/
@@ -70,12 +71,14 @@ resetWeights(const LevelData<EBCellFAB>& a_modifier,
           massStenFAB(thisVoF, 0) = newSten;
         }
     }
+  compileStencils();
 }
 /**********************/
 EBCoarToCoarRedist::
 EBCoarToCoarRedist()
 {
   m_isDefined = false;
+  m_needsExchange = true;
 }
 /**********************/
 EBCoarToCoarRedist::
@@ -133,6 +136,7 @@ define(const DisjointBoxLayout& a_dblFine,
   defineDataHolders();
   //initialize the buffers to zero
   setToZero();
+  compileStencils();
 }
 /**********************/
 void
@@ -172,6 +176,7 @@ define(const EBLevelGrid& a_eblgFine,
   defineDataHolders();
   //initialize the buffers to zero
   setToZero();
+  compileStencils();
 }
 /***/
 void
@@ -275,44 +280,85 @@ redistribute(LevelData<EBCellFAB>& a_coarSolution,
              const Interval& a_variables)
 {
   CH_TIME("EBCoarToCoarRedist::redistribute");
-  m_regsCoar.exchange(a_variables);
+  //the ghost cells of the buffer are only read if some
+  //stencil crosses a box boundary
+  if (m_needsExchange)
+    {
+      m_regsCoar.exchange(a_variables);
+    }
   //at all points in the buffer, subtract off the redistributed values
   for (DataIterator dit = m_gridsCoar.dataIterator(); dit.ok(); ++dit)
     {
+      const Vector<redistEntry_t>& entries = m_entries[dit()];
+      if (entries.size() == 0)
+        {
+          continue;
+        }
       const BaseIVFAB<Real>& regCoar = m_regsCoar[dit()];
-      const IntVectSet& ivsCoar = m_setsCoar[dit()];
-      const EBISBox& ebisBoxCoar = m_ebislCoar[dit()];
-      const BaseIVFAB<VoFStencil>& stenFAB = m_stenCoar[dit()];
-      const Box& coarBox = m_gridsCoar.get(dit());
+      const Real* regPtr = regCoar.dataPtr(0);
+      const int regStride = regCoar.numVoFs();
 
       EBCellFAB& solFAB = a_coarSolution[dit()];
 
-      for (VoFIterator vofit(ivsCoar,ebisBoxCoar.getEBGraph()); vofit.ok(); ++vofit)
+      //the compiled stencils only hold terms that land in the valid region
+      for (int ient = 0; ient < entries.size(); ient++)
+        {
+          const redistEntry_t& entry = entries[ient];
+          for (int ivar = a_variables.begin();
+              ivar <= a_variables.end();  ivar++)
+            {
+              Real dmFine = regPtr[entry.m_srcOffset + ivar*regStride];
+              Real dUCoar = dmFine*entry.m_weight;
+              //SUBTRACTING because this is re-redistribution.
+              solFAB(entry.m_dstVoF, ivar) -= dUCoar;
+            }
+        }
+    }
+}
+/**********************/
+void
+EBCoarToCoarRedist::
+compileStencils()
+{
+  CH_TIME("EBCoarToCoarRedist::compileStencils");
+  m_entries.define(m_gridsCoar);
+  int crossesBoxes = 0;
+  for (DataIterator dit = m_gridsCoar.dataIterator(); dit.ok(); ++dit)
+    {
+      Vector<redistEntry_t>& entries = m_entries[dit()];
+      const BaseIVFAB<Real>& regCoar = m_regsCoar[dit()];
+      const BaseIVFAB<VoFStencil>& stenFAB = m_stenCoar[dit()];
+      const Box& coarBox = m_gridsCoar.get(dit());
+      for (VoFIterator vofit(m_setsCoar[dit()], m_ebislCoar[dit()].getEBGraph());
+          vofit.ok(); ++vofit)
         {
           const VolIndex& srcVoF = vofit();
           const VoFStencil& vofsten = stenFAB(srcVoF, 0);
           for (int isten = 0; isten < vofsten.size(); isten++)
             {
-              const Real& weight = vofsten.weight(isten);
               const VolIndex& dstVoF = vofsten.vof(isten);
-              //since we are just using the input redist stencil,
-              //have to check if out of bounds
+              //only mass that lands in the valid region is kept
               if (coarBox.contains(dstVoF.gridIndex()))
                 {
-                  for (int ivar = a_variables.begin();
-                      ivar <= a_variables.end();  ivar++)
+                  redistEntry_t entry;
+                  entry.m_srcOffset = regCoar.offset(srcVoF, 0);
+                  entry.m_dstVoF    = dstVoF;
+                  entry.m_weight    = vofsten.weight(isten);
+                  entries.push_back(entry);
+                  if (!coarBox.contains(srcVoF.gridIndex()))
                     {
-                      Real dmFine = regCoar(srcVoF, ivar);
-                      //ucoar+= massfine/volcoar, ie.
-                      //ucoar+= (wcoar*dmCoar*volFracfine/volfraccoar)=massfine/volcoar
-                      Real dUCoar = dmFine*weight;
-                      //SUBTRACTING because this is re-redistribution.
-                      solFAB(dstVoF, ivar) -= dUCoar;
+                      //mass comes from a neighboring box
+                      crossesBoxes = 1;
                     }
                 }
             }
         }
     }
+#ifdef CH_MPI
+  int localCrosses = crossesBoxes;
+  MPI_Allreduce(&localCrosses, &crossesBoxes, 1, MPI_INT, MPI_MAX, Chombo_MPI::comm);
+#endif
+  m_needsExchange = (crossesBoxes != 0);
 }
 /**********************/
 bool
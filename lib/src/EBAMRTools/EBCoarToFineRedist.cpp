@@ -16,12 +16,14 @@
 #include "EBIndexSpace.H"
 #include "CH_Timer.H"
 #include "EBCellFactory.H"
+#include "SPMD.H"
 #include "NamespaceHeader.H"
 /**********************/
 EBCoarToFineRedist::
 EBCoarToFineRedist()
 {
   m_isDefined = false;
+  m_needsCopy = true;
 }
 /**********************/
 EBCoarToFineRedist::
@@ -83,6 +85,7 @@ resetWeights(const LevelData<EBCellFAB>& a_modifierCoar,
           massStenFAB(vofCoar, 0) = newSten;
         }
     }
+  compileStencils();
 }
 /**********************/
 void
@@ -159,6 +162,7 @@ define(const EBLevelGrid&  a_eblgFine,
   }
   defineDataHolders();
   setToZero();
+  compileStencils();
 }
 /************/
 void
@@ -272,10 +276,12 @@ define(const DisjointBoxLayout& a_dblFine,
         IntVectSet localIVS = m_ebislCedFine[dit()].getIrregIVS(grownBox);
         //subtract off all boxes on fine level so we get stuff at the
         //coarse-fine interface that will redistribute to this grid
-        for (LayoutIterator lit = m_gridsCedFine.layoutIterator();
-            lit.ok(); ++lit)
+        //(only the ones that meet grownBox matter)
+        Vector<LayoutIndex> found;
+        m_gridsCedFine.findIntersecting(found, grownBox);
+        for (int ibox = 0; ibox < found.size(); ibox++)
           {
-            localIVS -= m_gridsCedFine.get(lit());
+            localIVS -= m_gridsCedFine.get(found[ibox]);
           }
         m_setsCedFine[dit()] = localIVS;
       }
@@ -292,19 +298,22 @@ define(const DisjointBoxLayout& a_dblFine,
         //make the complement set the whole
         IntVectSet cfIntComp(coarBox);
         //subtract the CF Interface from each coarsened fine box
-        //from the complement
-        for (LayoutIterator lit1 = m_gridsCedFine.layoutIterator();
-            lit1.ok(); ++lit1)
+        //from the complement.  only the coarsened fine boxes within
+        //the redistribution radius of this box can reach it.
+        Vector<LayoutIndex> near;
+        m_gridsCedFine.findIntersecting(near, grow(coarBox, m_redistRad));
+        for (int ibox1 = 0; ibox1 < near.size(); ibox1++)
           {
-            Box grownBox = grow(m_gridsCedFine.get(lit1()), m_redistRad);
+            Box grownBox = grow(m_gridsCedFine.get(near[ibox1]), m_redistRad);
             grownBox &= m_domainCoar;
             IntVectSet cedCFIVS(grownBox);
             //subtract off all boxes on fine level so we get stuff at the
             //coarse-fine interface that will redistribute to this grid
-            for (LayoutIterator lit2 = m_gridsCedFine.layoutIterator();
-                lit2.ok(); ++lit2)
+            Vector<LayoutIndex> found;
+            m_gridsCedFine.findIntersecting(found, grownBox);
+            for (int ibox2 = 0; ibox2 < found.size(); ibox2++)
               {
-                cedCFIVS -= m_gridsCedFine.get(lit2());
+                cedCFIVS -= m_gridsCedFine.get(found[ibox2]);
               }
 
             cfIntComp -=cedCFIVS;
@@ -325,6 +334,53 @@ define(const DisjointBoxLayout& a_dblFine,
 
   //initialize the buffers to zero
   setToZero();
+  compileStencils();
+}
+/**********************/
+void
+EBCoarToFineRedist::
+compileStencils()
+{
+  CH_TIME("EBCoarToFineRedist::compileStencils");
+  m_entries.define(m_gridsCedFine);
+  int hasEntries = 0;
+  for (DataIterator dit = m_gridsCedFine.dataIterator(); dit.ok(); ++dit)
+    {
+      Vector<redistEntry_t>& entries = m_entries[dit()];
+      const BaseIVFAB<Real>& regCoar = m_regsCedFine[dit()];
+      const BaseIVFAB<VoFStencil>& stenFAB = m_stenCedFine[dit()];
+      const EBISBox& ebisBoxCoar = m_ebislCedFine[dit()];
+      for (VoFIterator vofitCoar(m_setsCedFine[dit()], ebisBoxCoar.getEBGraph());
+          vofitCoar.ok(); ++vofitCoar)
+        {
+          const VolIndex& srcVoFCoar = vofitCoar();
+          const VoFStencil& vofsten = stenFAB(srcVoFCoar, 0);
+          for (int isten = 0; isten < vofsten.size(); isten++)
+            {
+              //piecewise constant: every fine vof under the
+              //destination gets the coarse weight
+              Vector<VolIndex> vofsFine =
+                m_ebislCedFine.refine(vofsten.vof(isten), m_refRat, dit());
+              for (int ifine = 0; ifine < vofsFine.size(); ifine++)
+                {
+                  redistEntry_t entry;
+                  entry.m_srcOffset = regCoar.offset(srcVoFCoar, 0);
+                  entry.m_dstVoF    = vofsFine[ifine];
+                  entry.m_weight    = vofsten.weight(isten);
+                  entries.push_back(entry);
+                }
+            }
+        }
+      if (entries.size() > 0)
+        {
+          hasEntries = 1;
+        }
+    }
+#ifdef CH_MPI
+  int localEntries = hasEntries;
+  MPI_Allreduce(&localEntries, &hasEntries, 1, MPI_INT, MPI_MAX, Chombo_MPI::comm);
+#endif
+  m_needsCopy = (hasEntries != 0);
 }
 /**********************/
 void
@@ -372,43 +428,36 @@ redistribute(LevelData<EBCellFAB>& a_fineSolution,
              const Interval& a_variables)
 {
   CH_TIME("EBCoarToFineRedist::redistribute");
-  //copy the buffer to the fine layout
-  m_regsCoar.copyTo(a_variables, m_regsCedFine, a_variables);
+  //copy the buffer to the fine layout.  if no coarse
+  //cell redistributes to the fine level, there is nothing to copy.
+  if (m_needsCopy)
+    {
+      m_regsCoar.copyTo(a_variables, m_regsCedFine, a_variables);
+    }
   //redistribute the coarsened fine registers to the fine solution
   for (DataIterator dit = m_gridsFine.dataIterator(); dit.ok(); ++dit)
     {
+      const Vector<redistEntry_t>& entries = m_entries[dit()];
+      if (entries.size() == 0)
+        {
+          continue;
+        }
       const BaseIVFAB<Real>& regCoar = m_regsCedFine[dit()];
-      const IntVectSet& ivsCoar = m_setsCedFine[dit()];
-      const EBISBox& ebisBoxCoar = m_ebislCedFine[dit()];
-      const BaseIVFAB<VoFStencil>& stenFAB = m_stenCedFine[dit()];
+      const Real* regPtr = regCoar.dataPtr(0);
+      const int regStride = regCoar.numVoFs();
 
       EBCellFAB& solFAB = a_fineSolution[dit()];
 
-      for (VoFIterator vofitCoar(ivsCoar, ebisBoxCoar.getEBGraph());
-          vofitCoar.ok(); ++vofitCoar)
+      for (int ient = 0; ient < entries.size(); ient++)
         {
-          const VolIndex& srcVoFCoar = vofitCoar();
-          const VoFStencil& vofsten = stenFAB(srcVoFCoar, 0);
-          for (int isten = 0; isten < vofsten.size(); isten++)
+          const redistEntry_t& entry = entries[ient];
+          for (int ivar = a_variables.begin();
+              ivar <= a_variables.end();  ivar++)
             {
-              const Real& weight = vofsten.weight(isten);
-              const VolIndex& dstVoFCoar = vofsten.vof(isten);
-              Vector<VolIndex> vofsFine =
-                m_ebislCedFine.refine(dstVoFCoar,m_refRat, dit());
-
-              for (int ivar = a_variables.begin();
-                  ivar <= a_variables.end();  ivar++)
-                {
-                  Real dmCoar = regCoar(srcVoFCoar, ivar);
-                  for (int ifine = 0; ifine < vofsFine.size(); ifine++)
-                    {
-
-                      const VolIndex& dstVoFFine = vofsFine[ifine];
-                      //ufine += (wcoar*dmCoar) (piecewise constant density diff)
-                      Real dUFine = dmCoar*weight;
-                      solFAB(dstVoFFine, ivar) += dUFine;
-                    }
-                }
+              Real dmCoar = regPtr[entry.m_srcOffset + ivar*regStride];
+              //ufine += (wcoar*dmCoar) (piecewise constant density diff)
+              Real dUFine = dmCoar*entry.m_weight;
+              solFAB(entry.m_dstVoF, ivar) += dUFine;
             }
         }
     }
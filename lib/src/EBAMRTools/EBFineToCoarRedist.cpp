@@ -18,6 +18,7 @@
 #include "EBCellFactory.H"
 #include "EBArith.H"
 #include "CH_Timer.H"
+#include "SPMD.H"
 #include "NamespaceHeader.H"
 /***********************/
 /***********************/
@@ -83,11 +84,13 @@ resetWeights(const LevelData<EBCellFAB>& a_modifierCoar,
 
         }
     }
+  compileStencils();
 }
 /**********************/
 EBFineToCoarRedist::EBFineToCoarRedist()
 {
   m_isDefined = false;
+  m_needsCopy = true;
 }
 /**********************/
 EBFineToCoarRedist::~EBFineToCoarRedist()
@@ -159,6 +162,7 @@ define(const EBLevelGrid& a_eblgFine,
   }
   defineDataHolders();
   setToZero();
+  compileStencils();
 }
 /**********************/
 void
@@ -288,6 +292,7 @@ define(const DisjointBoxLayout& a_dblFine,
   }
   defineDataHolders();
   setToZero();
+  compileStencils();
 }
 /***/
 void
@@ -405,31 +410,66 @@ redistribute(LevelData<EBCellFAB>& a_coarSolution,
              const Interval& a_variables)
 {
   CH_TIME("EBFineToCoarRedist::redistribute");
+  //copy the buffer to the coarse layout.  if no fine
+  //cell redistributes to the coarse level, there is nothing to copy.
+  if (m_needsCopy)
+    {
+      m_regsFine.copyTo(a_variables, m_regsRefCoar, a_variables);
+    }
+  //redistribute the refined coarse registers to the coarse solution
+  for (DataIterator dit = m_gridsCoar.dataIterator(); dit.ok(); ++dit)
+    {
+      const Vector<redistEntry_t>& entries = m_entries[dit()];
+      if (entries.size() == 0)
+        {
+          continue;
+        }
+      const BaseIVFAB<Real>& regRefCoar = m_regsRefCoar[dit()];
+      const Real* regPtr = regRefCoar.dataPtr(0);
+      const int regStride = regRefCoar.numVoFs();
+
+      EBCellFAB& solFAB = a_coarSolution[dit()];
+
+      for (int ient = 0; ient < entries.size(); ient++)
+        {
+          const redistEntry_t& entry = entries[ient];
+          for (int ivar = a_variables.begin();
+              ivar <= a_variables.end();  ivar++)
+            {
+              Real dmFine = regPtr[entry.m_srcOffset + ivar*regStride];
+              //ucoar+= massfine/volcoar, the volume fractions are
+              //in the compiled weight
+              solFAB(entry.m_dstVoF, ivar) += dmFine*entry.m_weight;
+            }
+        }
+    }
+}
+/**********************/
+void
+EBFineToCoarRedist::
+compileStencils()
+{
+  CH_TIME("EBFineToCoarRedist::compileStencils");
   Real nrefD = 1.0;
   for (int idir = 0; idir < SpaceDim; idir++)
     nrefD *= m_refRat;
-  //copy the buffer to the coarse layout
-  m_regsFine.copyTo(a_variables, m_regsRefCoar, a_variables);
-  //redistribute the refined coarse registers to the coarse solution
-  int ibox = 0;
+  m_entries.define(m_gridsCoar);
+  int hasEntries = 0;
   for (DataIterator dit = m_gridsCoar.dataIterator(); dit.ok(); ++dit)
     {
+      Vector<redistEntry_t>& entries = m_entries[dit()];
       const BaseIVFAB<Real>& regRefCoar = m_regsRefCoar[dit()];
-      const IntVectSet& ivsRefCoar = m_setsRefCoar[dit()];
       const EBISBox& ebisBoxRefCoar = m_ebislRefCoar[dit()];
       const EBISBox& ebisBoxCoar = m_ebislCoar[dit()];
       const BaseIVFAB<VoFStencil>& stenFAB = m_stenRefCoar[dit()];
 
-      EBCellFAB& solFAB = a_coarSolution[dit()];
-
-      for (VoFIterator vofit(ivsRefCoar, ebisBoxRefCoar.getEBGraph());
+      for (VoFIterator vofit(m_setsRefCoar[dit()], ebisBoxRefCoar.getEBGraph());
           vofit.ok(); ++vofit)
         {
           const VolIndex& srcVoFFine = vofit();
           const VoFStencil& vofsten = stenFAB(srcVoFFine, 0);
           for (int isten = 0; isten < vofsten.size(); isten++)
             {
-              const Real& weight = vofsten.weight(isten);
               const VolIndex& dstVoFFine = vofsten.vof(isten);
               VolIndex dstVoFCoar =
                 m_ebislRefCoar.coarsen(dstVoFFine,m_refRat, dit());
@@ -437,20 +477,24 @@ redistribute(LevelData<EBCellFAB>& a_coarSolution,
               CH_assert(m_gridsCoar.get(dit()).contains(dstVoFCoar.gridIndex()));
               Real dstVolFracFine = ebisBoxRefCoar.volFrac(dstVoFFine);
               Real dstVolFracCoar = ebisBoxCoar.volFrac(dstVoFCoar);
-              Real denom = dstVolFracCoar*nrefD;
-              for (int ivar = a_variables.begin();
-                  ivar <= a_variables.end();  ivar++)
-                {
-                  Real dmFine = regRefCoar(srcVoFFine, ivar);
-                  //ucoar+= massfine/volcoar, ie.
-                  //ucoar+= (wcoar*dmCoar*volFracfine/volfraccoar)=massfine/volcoar
-                  Real dUCoar = dmFine*weight*dstVolFracFine/denom;
-                  solFAB(dstVoFCoar, ivar) += dUCoar;
-                }
+              //ucoar+= (wcoar*dmCoar*volFracfine/volfraccoar)=massfine/volcoar
+              redistEntry_t entry;
+              entry.m_srcOffset = regRefCoar.offset(srcVoFFine, 0);
+              entry.m_dstVoF    = dstVoFCoar;
+              entry.m_weight    = vofsten.weight(isten)*dstVolFracFine/(dstVolFracCoar*nrefD);
+              entries.push_back(entry);
             }
         }
-      ibox++;
+      if (entries.size() > 0)
+        {
+          hasEntries = 1;
+        }
     }
+#ifdef CH_MPI
+  int localEntries = hasEntries;
+  MPI_Allreduce(&localEntries, &hasEntries, 1, MPI_INT, MPI_MAX, Chombo_MPI::comm);
+#endif
+  m_needsCopy = (hasEntries != 0);
 }
 /**********************/
 bool
@@ -15,12 +15,14 @@
 #include "EBIndexSpace.H"
 #include "CH_Timer.H"
 #include "CH_OpenMP.H"
+#include "SPMD.H"
 #include "NamespaceHeader.H"
 /***********************/
 /***********************/
 EBLevelRedist::EBLevelRedist()
 {
   m_isDefined = false;
+  m_needsExchange = true;
 }
 /***********************/
 /***********************/
@@ -47,6 +49,7 @@ resetWeights(const LevelData<EBCellFAB>& a_modifier,
              const int& a_ivar)
 {
   m_stencil.resetWeights(a_modifier, a_ivar);
+  compileStencils();
 }
 /***********************/
 /***********************/
@@ -92,6 +95,55 @@ define(const DisjointBoxLayout& a_dbl,
   IntVect ivghost = redistRad*IntVect::Unit;
   m_buffer.define(m_grids, m_ncomp, ivghost, factory);
   setToZero();
+  compileStencils();
+}
+/***********************/
+/***********************/
+void
+EBLevelRedist::compileStencils()
+{
+  CH_TIME("EBLevelRedist::compileStencils");
+  m_entries.define(m_grids);
+  int crossesBoxes = 0;
+  DataIterator dit = m_grids.dataIterator();
+  int nbox=dit.size();
+#pragma omp parallel for reduction(max:crossesBoxes)
+  for (int mybox=0;mybox<nbox; mybox++)
+    {
+      Vector<redistEntry_t>& entries = m_entries[dit[mybox]];
+      const BaseIVFAB<Real>& bufFAB = m_buffer[dit[mybox]];
+      const BaseIVFAB<VoFStencil>& stenFAB = m_stencil[dit[mybox]];
+      const Box& grid = m_grids.get(dit[mybox]);
+      for (VoFIterator vofit(m_sets[dit[mybox]], m_ebisl[dit[mybox]].getEBGraph());
+          vofit.ok(); ++vofit)
+        {
+          const VolIndex& srcVoF = vofit();
+          const VoFStencil& vofsten = stenFAB(srcVoF, 0);
+          for (int isten = 0; isten < vofsten.size(); isten++)
+            {
+              const VolIndex& dstVoF = vofsten.vof(isten);
+              //only mass that lands in the valid region is kept
+              if (grid.contains(dstVoF.gridIndex()))
+                {
+                  redistEntry_t entry;
+                  entry.m_srcOffset = bufFAB.offset(srcVoF, 0);
+                  entry.m_dstVoF    = dstVoF;
+                  entry.m_weight    = vofsten.weight(isten);
+                  entries.push_back(entry);
+                  if (!grid.contains(srcVoF.gridIndex()))
+                    {
+                      //mass comes from a neighboring box
+                      crossesBoxes = 1;
+                    }
+                }
+            }
+        }
+    }
+#ifdef CH_MPI
+  int localCrosses = crossesBoxes;
+  MPI_Allreduce(&localCrosses, &crossesBoxes, 1, MPI_INT, MPI_MAX, Chombo_MPI::comm);
+#endif
+  m_needsExchange = (crossesBoxes != 0);
 }
 /***********************/
 /***********************/
@@ -121,6 +173,11 @@ increment(const BaseIVFAB<Real>& a_massDiff,
   BaseIVFAB<Real>& bufFAB = m_buffer[a_datInd];
   const IntVectSet& fabIVS = a_massDiff.getIVS();
   const IntVectSet& bufIVS = m_sets[a_datInd];
+  if (bufIVS.isEmpty())
+    {
+      //no irregular cells near this box
+      return;
+    }
 
   IntVectSet ivs = m_ebisl[a_datInd].getIrregIVS(m_grids.get(a_datInd));;
   CH_assert(fabIVS.contains(ivs));
@@ -160,54 +217,46 @@ redistribute(LevelData<EBCellFAB>& a_solution,
 
   CH_assert(isDefined());
 
-  //pout() << "redistribute 0" << endl;
   //exchange ghost cell information of the buffer.
   //this way the redistribution from ghost cells will
-  //account for fine-fine interfaces.
-  Interval wholeInterv(0, m_ncomp-1);
-  m_buffer.exchange(wholeInterv);
-  //pout() << "redistribute 1" << endl;
+  //account for fine-fine interfaces.  if no stencil
+  //crosses a box boundary, the ghost cells are never read.
+  if (m_needsExchange)
+    {
+      Interval wholeInterv(0, m_ncomp-1);
+      m_buffer.exchange(wholeInterv);
+    }
   //loop over grids.
   DataIterator dit = m_grids.dataIterator(); 
   int nbox=dit.size();
 #pragma omp parallel for
   for (int mybox=0;mybox<nbox; mybox++)
     {
+      const Vector<redistEntry_t>& entries = m_entries[dit[mybox]];
+      if (entries.size() == 0)
+        {
+          //no irregular cells within the redistribution radius
+          continue;
+        }
       const BaseIVFAB<Real>& bufFAB = m_buffer[dit[mybox]];
-      const BaseIVFAB<VoFStencil>& stenFAB = m_stencil[dit[mybox]];
-      const Box& grid = m_grids.get(dit[mybox]);
       EBCellFAB& solFAB = a_solution[dit[mybox]];
+      const Real* bufPtr = bufFAB.dataPtr(0);
+      const int bufStride = bufFAB.numVoFs();
 
-      //pout() << "redistribute 2" << endl;
-      //loop over the irregular vofs in the grown box.
-      for (VoFIterator vofit(m_sets[dit[mybox]], m_ebisl[dit[mybox]].getEBGraph());
-          vofit.ok(); ++vofit)
+      //the compiled stencils only hold terms that land in the valid region
+      for (int ient = 0; ient < entries.size(); ient++)
         {
-          const VolIndex& srcVoF = vofit();
-          const VoFStencil& vofsten = stenFAB(srcVoF, 0);
-          for (int isten = 0; isten < vofsten.size(); isten++)
+          const redistEntry_t& entry = entries[ient];
+          for (int ivar = 0; ivar < a_srcVar.size(); ivar++)
             {
-              const Real& weight = vofsten.weight(isten);
-              const VolIndex& dstVoF = vofsten.vof(isten);
-              //only add the mass to the solution if it is in the
-              //solutions valid region --- because the buffer is over
-              //the grown box, this prevents redistribution off
-              //the end of the world.
-              if (grid.contains(dstVoF.gridIndex()))
-                {
-                  for (int ivar = 0; ivar < a_srcVar.size(); ivar++)
-                    {
-                      int isrc = ivar + a_srcVar.begin();
-                      int idst = ivar + a_dstVar.begin();
+              int isrc = ivar + a_srcVar.begin();
+              int idst = ivar + a_dstVar.begin();
 
-                      const Real& mass = bufFAB(srcVoF, isrc);
-                      const Real& solu = solFAB(dstVoF, idst);
-                      solFAB(dstVoF, idst) = mass*weight + solu;
-                    }
-                  //ch_flops()+=a_srcVar.size()*2; 
-                } //end check if adding to valid soltuion
-            } //end loop over vof stencil
-        } //end loop over irregular vofs in grown box
+              const Real& mass = bufPtr[entry.m_srcOffset + isrc*bufStride];
+              Real& solu = solFAB(entry.m_dstVoF, idst);
+              solu = mass*entry.m_weight + solu;
+            }
+        } //end loop over compiled stencil terms
     } //end loop over grids.
 }
 /***********************/
@@ -227,6 +276,10 @@ fixExplicitLap(const LevelData<EBCellFAB>& a_kappaLap,
 #pragma omp parallel for 
   for (int mybox=0;mybox<nbox; mybox++)
     {
+      if (m_sets[dit[mybox]].isEmpty())
+        {
+          continue;
+        }
       const BaseIVFAB<VoFStencil>& stenFAB = m_stencil[dit[mybox]];
       const Box& grid = m_grids.get(dit[mybox]);
       EBCellFAB& solFAB = a_solution[dit[mybox]];
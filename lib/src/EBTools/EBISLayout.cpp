@@ -66,6 +66,10 @@ EBISLayoutImplem::define(const ProblemDomain& a_domain,
 #ifdef CH_MPI
   MPI_Barrier(Chombo_MPI::comm);
 #endif
+  // the cache in EBISLevel widens a layout in place, so keep what the
+  // holders of the narrower one asked for
+  int maxCoarsen = m_defined ? m_maxCoarseningRatio : 0;
+  int maxRefine  = m_defined ? m_maxRefinementRatio : 0;
   m_domain = a_domain;
   m_nghost = a_nghost;
   m_dblInputDom = a_grids;
@@ -160,6 +164,18 @@ EBISLayoutImplem::define(const ProblemDomain& a_domain,
       }
   }
   m_defined = true;
+
+  if (m_ebisPtr != NULL)
+    {
+      if (maxCoarsen > m_maxCoarseningRatio)
+        {
+          setMaxCoarseningRatio(maxCoarsen, m_ebisPtr);
+        }
+      if (maxRefine > m_maxRefinementRatio)
+        {
+          setMaxRefinementRatio(maxRefine, m_ebisPtr);
+        }
+    }
 }
 
 bool EBISLayout::isDefined() const
@@ -179,6 +195,7 @@ EBISLayoutImplem::EBISLayoutImplem()
   m_maxCoarseningRatio = 1;
   m_maxRefinementRatio = 1;
   m_defined = false;
+  m_ebisPtr = NULL;
 }
 /****************/
 EBISLayoutImplem::~EBISLayoutImplem()
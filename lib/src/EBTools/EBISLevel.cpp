@@ -8,6 +8,10 @@
  */
 #endif
 
+#include <algorithm>
+#include <climits>
+#include <vector>
+
 #include "parstream.H"
 #include "memtrack.H"
 #include "CH_Attach.H"
@@ -36,6 +40,7 @@
 EBIndexSpace* Chombo_EBIS::s_instance = NULL;
 bool          Chombo_EBIS::s_aliased  = false;
 int EBISLevel::s_ebislGhost = 6;
+int EBISLevel::s_cacheRetain = 2;
 bool EBISLevel::s_distributedData = false;
 EBIndexSpace* Chombo_EBIS::instance()
 {
@@ -1147,7 +1152,8 @@ void EBISLevel::fillEBISLayout(EBISLayout&              a_ebisLayout,
   //a_ebisLayout.define(m_domain, a_grids, a_nghost, m_graph, m_data);
   //return; // caching disabled for now.... ugh.  bvs
 
-  EBISLayout& l = m_cache[a_grids];
+  EBISLayoutCacheEntry& entry = m_cache[a_grids];
+  EBISLayout& l = entry.m_ebisl;
   if (!l.isDefined() || (a_nghost > l.getGhost()))
     {
       CH_TIME("ebisllevel::fillebislayout cache miss");
@@ -1163,7 +1169,9 @@ void EBISLevel::fillEBISLayout(EBISLayout&              a_ebisLayout,
       CH_TIME("cache_hit");
       m_cacheHits++;
     }
+  entry.m_lastUse = m_cacheHits + m_cacheMisses;
   a_ebisLayout = l;// refcount is at least 2 now.
+  a_ebisLayout.m_nghost = a_nghost;
   if (m_cacheStale == 1)
     {
       refreshCache();
@@ -1186,10 +1194,27 @@ void EBISLevel::dumpCache() const
 } 
 void EBISLevel::refreshCache() const
 {
+  //layouts only the cache holds are dropped, except the
+  //s_cacheRetain most recently used of them
+  std::vector<int> unheld;
+  for (dmap::iterator d = m_cache.begin(); d != m_cache.end(); ++d)
+    {
+      if (d->second.m_ebisl.refCount() == 1)
+        {
+          unheld.push_back(d->second.m_lastUse);
+        }
+    }
+  if ((int)unheld.size() <= s_cacheRetain)
+    {
+      return;
+    }
+  std::sort(unheld.begin(), unheld.end());
+  int oldestKept = (s_cacheRetain > 0) ? unheld[unheld.size() - s_cacheRetain] : INT_MAX;
+
   dmap::iterator d = m_cache.begin();
   while (d != m_cache.end())
     {
-      if(d->second.refCount() ==1)
+      if ((d->second.m_ebisl.refCount() == 1) && (d->second.m_lastUse < oldestKept))
         {
           m_cache.erase(d++);
         }
@@ -31,6 +31,27 @@ setDefaultValues()
   m_nghost = -99;
   m_ebisPtr = NULL;
   m_cfivs = RefCountedPtr<LayoutData<IntVectSet> >(0);
+  m_regularBoxes = RefCountedPtr<LayoutData<bool> >(0);
+}
+/****/
+void
+EBLevelGrid::
+defineRegularBoxes()
+{
+  m_regularBoxes = RefCountedPtr<LayoutData<bool> >(new LayoutData<bool>(m_grids));
+  for (DataIterator dit = m_grids.dataIterator(); dit.ok(); ++dit)
+    {
+      const EBISBox& ebisBox = m_ebisl[dit()];
+      bool regular = ebisBox.isAllRegular();
+      if (!regular && !ebisBox.isAllCovered())
+        {
+          //the graph tag is conservative so look at the cells themselves
+          Box ghosted = grow(m_grids.get(dit()), m_nghost);
+          ghosted &= m_domain;
+          regular = ebisBox.isRegular(ghosted);
+        }
+      (*m_regularBoxes)[dit()] = regular;
+    }
 }
 /****/
 void
@@ -98,6 +119,7 @@ define(const DisjointBoxLayout& a_dbl,
 
   m_cfivs = RefCountedPtr<LayoutData<IntVectSet> >(new LayoutData<IntVectSet>());
   EBArith::defineCFIVS(*m_cfivs, m_grids, m_domain);
+  defineRegularBoxes();
 }
 
 /****/
@@ -118,6 +140,7 @@ define(const DisjointBoxLayout& a_dbl,
   //pout() << "eblg: filling cfivs " << endl;
   m_cfivs = RefCountedPtr<LayoutData<IntVectSet> >(new LayoutData<IntVectSet>());
   EBArith::defineCFIVS(*m_cfivs, m_grids, m_domain);
+  defineRegularBoxes();
   //pout() << "eblg: leaving " << endl;
 }
 
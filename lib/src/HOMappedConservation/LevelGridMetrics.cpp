@@ -387,6 +387,11 @@ LevelGridMetrics::define(
     {
       m_coarserLevelGridMetrics = a_coarserLevelGridMetrics;
       a_coarserLevelGridMetrics->m_finerLevelGridMetrics = this;
+      // Share the metric cache of the coarser level unless we have our own
+      if (m_metricCache.isNull())
+        {
+          m_metricCache = a_coarserLevelGridMetrics->m_metricCache;
+        }
     }
 
   // Re-definition of the class forces all metrics to be undefined
@@ -1108,6 +1113,26 @@ LevelGridMetrics::computeValidU(LevelData<FArrayBox>&       a_U,
     }
 }
 
+/*--------------------------------------------------------------------*/
+//  Memoize per-box metric terms in a cache
+/** When set, \f$N\f$ and \f$\mathcal{N}^s\f$ are computed for a box
+ *  only the first time it is seen (or after eviction).  Boxes that
+ *  persist across a regrid, and boxes that are translates in
+ *  mappings reporting NewFourthOrderCoordSys::metricsShareKey, reuse
+ *  the stored values.  Finer levels defined after this call inherit
+ *  the same cache.
+ *  \param[in]  a_metricCache
+ *                      The cache.  May be shared between levels.  A
+ *                      null pointer disables caching.
+ *//*-----------------------------------------------------------------*/
+
+void
+LevelGridMetrics::setMetricCache(
+  const RefCountedPtr<MetricCache>& a_metricCache)
+{
+  m_metricCache = a_metricCache;
+}
+
 /*--------------------------------------------------------------------*/
 //  Compute the minimum grid buffer size for a fourth-order
 //  interpolation
@@ -1494,7 +1519,14 @@ LevelGridMetrics::getN(LevelData<FluxBox>& a_N)
       const NewFourthOrderCoordSys *const coordSys = getCoordSys(baseBox);
       FluxBox& N = a_N[dit];
       const Box bx = N.box();
-      coordSys->getN(N, bx);
+      if (m_metricCache.isNull())
+        {
+          coordSys->getN(N, bx);
+        }
+      else
+        {
+          m_metricCache->getN(N, coordSys, getBlock(baseBox), bx);
+        }
       for (int idir=0; idir<SpaceDim; idir++)
         N[idir] /= m_dxVect[idir];
     }
@@ -1614,7 +1646,15 @@ LevelGridMetrics::getScriptN(LevelData<CodimBox<FArrayBox> >& a_scrN)
           scrN.getDirections(iOr, dir);
           FArrayBox& hyperEdge = scrN.getSequential(iOr);
           Box oBox = hyperEdge.box();    // An orientated box
-          coordSys->integrateScriptN(hyperEdge, dir[0], dir[1], oBox);
+          if (m_metricCache.isNull())
+            {
+              coordSys->integrateScriptN(hyperEdge, dir[0], dir[1], oBox);
+            }
+          else
+            {
+              m_metricCache->getScriptN(hyperEdge, coordSys, getBlock(box),
+                                        dir[0], dir[1], oBox);
+            }
         }
     }
 }
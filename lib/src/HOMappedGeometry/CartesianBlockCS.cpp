@@ -127,4 +127,16 @@ CartesianBlockCS::volFlux(FluxBox& a_volFlux,
   // computeMetricTermProductAverage(a_volFlux, X, a_Nt, SpaceDim, X, a_box);
 }
 
+bool
+CartesianBlockCS::metricsShareKey(const Box& a_box,
+                                  IntVect&   a_shift,
+                                  int&       a_shareClass) const
+{
+  // dX/dXi is the identity everywhere, so metrics depend only on the
+  // size and centering of the box.
+  a_shift = a_box.smallEnd();
+  a_shareClass = 0;
+  return true;
+}
+
 #include "NamespaceFooter.H"
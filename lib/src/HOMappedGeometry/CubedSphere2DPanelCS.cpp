@@ -637,6 +637,19 @@ void CubedSphere2DPanelCS::getAvgJ(FArrayBox& a_avgJ,
   a_avgJ /= mappedVol;
 }
 
+/// N and J depend only on the index relative to the panel origin
+bool CubedSphere2DPanelCS::metricsShareKey(const Box& a_box,
+                                           IntVect&   a_shift,
+                                           int&       a_shareClass) const
+{
+  // The normals and cell volumes are functions of (i - m_ix) only and are
+  // identical on all six panels (see CUBEDSPHERE2DNORMAL and
+  // CUBEDSPHERE2DCELLVOL).
+  a_shift = m_ix;
+  a_shareClass = 0;
+  return true;
+}
+
 /// computes cell-averaged J
 void CubedSphere2DPanelCS::getAvgJ(FArrayBox& a_avgJ,
                                    const FluxBox& a_volFlux,
@@ -0,0 +1,343 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+
+/******************************************************************************/
+/**
+ * \file MetricCache.cpp
+ *
+ * \brief Non-inline definitions for classes in MetricCache.H
+ *
+ *//*+*************************************************************************/
+
+#include "MetricCache.H"
+#include "CH_Timer.H"
+
+#include "NamespaceHeader.H"
+
+
+/*******************************************************************************
+ *
+ * Class MetricCache: member definitions
+ *
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------*/
+//  Ordering of keys
+/*--------------------------------------------------------------------*/
+
+bool
+MetricCache::Key::operator<(const Key& a_key) const
+{
+  if (m_shared != a_key.m_shared) return m_shared < a_key.m_shared;
+  if (m_csType != a_key.m_csType)
+    {
+      // Ordering of type_info is implementation defined but consistent
+      return m_csType->before(*a_key.m_csType);
+    }
+  if (m_block != a_key.m_block) return m_block < a_key.m_block;
+  if (m_kind != a_key.m_kind) return m_kind < a_key.m_kind;
+  if (m_dir0 != a_key.m_dir0) return m_dir0 < a_key.m_dir0;
+  if (m_dir1 != a_key.m_dir1) return m_dir1 < a_key.m_dir1;
+  if (m_box.ixType() != a_key.m_box.ixType())
+    {
+      return m_box.ixType() < a_key.m_box.ixType();
+    }
+  if (m_box.smallEnd() != a_key.m_box.smallEnd())
+    {
+      return m_box.smallEnd().lexLT(a_key.m_box.smallEnd());
+    }
+  if (m_box.bigEnd() != a_key.m_box.bigEnd())
+    {
+      return m_box.bigEnd().lexLT(a_key.m_box.bigEnd());
+    }
+  for (int dir = 0; dir != SpaceDim; ++dir)
+    {
+      if (m_dx[dir] != a_key.m_dx[dir]) return m_dx[dir] < a_key.m_dx[dir];
+    }
+  return false;
+}
+
+/*--------------------------------------------------------------------*/
+//  Constructor
+/** \param[in]  a_memoryBudget
+ *                      Maximum number of bytes held by the cache.
+ *                      0 means unlimited.
+ *//*-----------------------------------------------------------------*/
+
+MetricCache::MetricCache(const long long a_memoryBudget)
+  :
+  m_memoryBudget(a_memoryBudget),
+  m_bytes(0),
+  m_numHits(0),
+  m_numMisses(0),
+  m_numEvictions(0)
+{
+}
+
+/*--------------------------------------------------------------------*/
+//  Destructor
+/*--------------------------------------------------------------------*/
+
+MetricCache::~MetricCache()
+{
+  clear();
+}
+
+/*--------------------------------------------------------------------*/
+//  Free all cached metrics
+/*--------------------------------------------------------------------*/
+
+void
+MetricCache::clear()
+{
+  m_entries.clear();
+  m_lru.clear();
+  m_bytes = 0;
+}
+
+/*--------------------------------------------------------------------*/
+//  Set the memory budget
+/** Entries are evicted immediately if the new budget is exceeded
+ *  \param[in]  a_memoryBudget
+ *                      Maximum number of bytes held by the cache.
+ *                      0 means unlimited.
+ *//*-----------------------------------------------------------------*/
+
+void
+MetricCache::setMemoryBudget(const long long a_memoryBudget)
+{
+  m_memoryBudget = a_memoryBudget;
+  evict(0);
+}
+
+/*--------------------------------------------------------------------*/
+//  Fill \f$N\f$ on the faces of a box
+/** \param[out] a_N     \f$N\f$ on the faces of a_box.  Must be
+ *                      defined on a box containing a_box.
+ *  \param[in]  a_coordSys
+ *                      Coordinate system for the block
+ *  \param[in]  a_block Block index
+ *  \param[in]  a_box   Cell box on which to get N
+ *  \return             T - satisfied from the cache
+ *//*-----------------------------------------------------------------*/
+
+bool
+MetricCache::getN(FluxBox&                            a_N,
+                  const NewFourthOrderCoordSys *const a_coordSys,
+                  const int                           a_block,
+                  const Box&                          a_box)
+{
+  CH_TIME("MetricCache::getN");
+  CH_assert(a_N.box().contains(a_box));
+  const int nComp = a_N.nComp();
+  IntVect shift;
+  const Key key =
+    makeKey(shift, a_coordSys, a_block, MetricN, -1, -1, a_box);
+  Entry* entry = find(key);
+  const bool hit = (entry != NULL);
+  if (!hit)
+    {
+      ++m_numMisses;
+      long long bytes = 0;
+      for (int dir = 0; dir != SpaceDim; ++dir)
+        {
+          bytes += surroundingNodes(a_box, dir).numPts()*nComp*sizeof(Real);
+        }
+      if (m_memoryBudget > 0 && bytes > m_memoryBudget)
+        {
+          // Will never fit.  Compute directly
+          a_coordSys->getN(a_N, a_box);
+          return false;
+        }
+      entry = &insert(key, bytes);
+      entry->m_fluxBox = RefCountedPtr<FluxBox>(new FluxBox(a_box, nComp));
+      FluxBox& N = *(entry->m_fluxBox);
+      a_coordSys->getN(N, a_box);
+      N.shift(-shift);
+    }
+  else
+    {
+      ++m_numHits;
+    }
+  const FluxBox& N = *(entry->m_fluxBox);
+  CH_assert(N.nComp() == nComp);
+  for (int dir = 0; dir != SpaceDim; ++dir)
+    {
+      const Box destBox = surroundingNodes(a_box, dir);
+      const Box srcBox = destBox - shift;
+      a_N[dir].copy(N[dir], srcBox, 0, destBox, 0, nComp);
+    }
+  return hit;
+}
+
+/*--------------------------------------------------------------------*/
+//  Fill \f$\mathcal{N}^s\f$ on a set of hyperedges
+/** \param[out] a_scrN  FArrayBox orientated on the hyperedge
+ *  \param[in]  a_coordSys
+ *                      Coordinate system for the block
+ *  \param[in]  a_block Block index
+ *  \param[in]  a_dir0  The first orthogonal direction specifying the
+ *                      orientation of the hyperedge
+ *  \param[in]  a_dir1  The second orthogonal direction specifying the
+ *                      orientation of the hyperedge
+ *  \param[in]  a_box   Orientated box of hyperedges
+ *  \return             T - satisfied from the cache
+ *//*-----------------------------------------------------------------*/
+
+bool
+MetricCache::getScriptN(FArrayBox&                          a_scrN,
+                        const NewFourthOrderCoordSys *const a_coordSys,
+                        const int                           a_block,
+                        const int                           a_dir0,
+                        const int                           a_dir1,
+                        const Box&                          a_box)
+{
+  CH_TIME("MetricCache::getScriptN");
+  CH_assert(a_scrN.box().contains(a_box));
+  const int nComp = a_scrN.nComp();
+  IntVect shift;
+  const Key key =
+    makeKey(shift, a_coordSys, a_block, MetricScriptN, a_dir0, a_dir1, a_box);
+  CH_assert(shift == IntVect::Zero);
+  Entry* entry = find(key);
+  const bool hit = (entry != NULL);
+  if (!hit)
+    {
+      ++m_numMisses;
+      const long long bytes = a_box.numPts()*nComp*sizeof(Real);
+      if (m_memoryBudget > 0 && bytes > m_memoryBudget)
+        {
+          a_coordSys->integrateScriptN(a_scrN, a_dir0, a_dir1, a_box);
+          return false;
+        }
+      entry = &insert(key, bytes);
+      entry->m_fab = RefCountedPtr<FArrayBox>(new FArrayBox(a_box, nComp));
+      a_coordSys->integrateScriptN(*(entry->m_fab), a_dir0, a_dir1, a_box);
+    }
+  else
+    {
+      ++m_numHits;
+    }
+  a_scrN.copy(*(entry->m_fab), a_box, 0, a_box, 0, nComp);
+  return hit;
+}
+
+/*--------------------------------------------------------------------*/
+//  Print statistics
+/*--------------------------------------------------------------------*/
+
+void
+MetricCache::report(std::ostream& a_os) const
+{
+  a_os << "MetricCache: " << numEntries() << " entries, " << m_bytes
+       << " bytes (budget " << m_memoryBudget << "), " << m_numHits
+       << " hits, " << m_numMisses << " misses, " << m_numEvictions
+       << " evictions" << std::endl;
+}
+
+/*--------------------------------------------------------------------*/
+//  Construct the key for a request
+/** \param[out] a_shift Shift from a_box to the canonical box of the
+ *                      key
+ *//*-----------------------------------------------------------------*/
+
+MetricCache::Key
+MetricCache::makeKey(IntVect&                            a_shift,
+                     const NewFourthOrderCoordSys *const a_coordSys,
+                     const int                           a_block,
+                     const int                           a_kind,
+                     const int                           a_dir0,
+                     const int                           a_dir1,
+                     const Box&                          a_box) const
+{
+  Key key;
+  key.m_kind = a_kind;
+  key.m_dir0 = a_dir0;
+  key.m_dir1 = a_dir1;
+  key.m_dx   = a_coordSys->dx();
+  a_shift = IntVect::Zero;
+  int shareClass = 0;
+  // Script N depends on the physical coordinates and is never shared
+  key.m_shared = (a_kind != MetricScriptN) &&
+    a_coordSys->metricsShareKey(a_box, a_shift, shareClass);
+  if (key.m_shared)
+    {
+      key.m_csType = &typeid(*a_coordSys);
+      key.m_block  = shareClass;
+      key.m_box    = a_box - a_shift;
+    }
+  else
+    {
+      a_shift = IntVect::Zero;
+      key.m_csType = &typeid(MetricCache);
+      key.m_block  = a_block;
+      key.m_box    = a_box;
+    }
+  return key;
+}
+
+/*--------------------------------------------------------------------*/
+//  Find an entry and mark it most recently used
+/*--------------------------------------------------------------------*/
+
+MetricCache::Entry*
+MetricCache::find(const Key& a_key)
+{
+  EntryMap::iterator it = m_entries.find(a_key);
+  if (it == m_entries.end())
+    {
+      return NULL;
+    }
+  Entry& entry = it->second;
+  m_lru.splice(m_lru.begin(), m_lru, entry.m_lru);
+  return &entry;
+}
+
+/*--------------------------------------------------------------------*/
+//  Insert a new entry
+/** Least-recently-used entries are first evicted so that a_bytes
+ *  fit in the budget
+ *//*-----------------------------------------------------------------*/
+
+MetricCache::Entry&
+MetricCache::insert(const Key& a_key, const long long a_bytes)
+{
+  evict(a_bytes);
+  m_lru.push_front(a_key);
+  Entry& entry = m_entries[a_key];
+  entry.m_bytes = a_bytes;
+  entry.m_lru = m_lru.begin();
+  m_bytes += a_bytes;
+  return entry;
+}
+
+/*--------------------------------------------------------------------*/
+//  Evict least-recently-used entries
+/** \param[in]  a_needed
+ *                      Bytes that are about to be added
+ *//*-----------------------------------------------------------------*/
+
+void
+MetricCache::evict(const long long a_needed)
+{
+  if (m_memoryBudget <= 0) return;
+  while (!m_lru.empty() && m_bytes + a_needed > m_memoryBudget)
+    {
+      EntryMap::iterator it = m_entries.find(m_lru.back());
+      CH_assert(it != m_entries.end());
+      m_bytes -= it->second.m_bytes;
+      m_entries.erase(it);
+      m_lru.pop_back();
+      ++m_numEvictions;
+    }
+}
+
+#include "NamespaceFooter.H"
@@ -1188,7 +1188,8 @@ void AMRLevelCons::readCheckpointLevel(HDF5Handle& a_handle)
 
   // Get the grids
   Vector<Box> grids;
-  const int gridStatus = read(a_handle, grids);
+  Vector<int> procs;
+  const int gridStatus = readCheckpointGrids(a_handle, grids, procs);
 
   if (gridStatus != 0)
     {
@@ -1196,7 +1197,15 @@ void AMRLevelCons::readCheckpointLevel(HDF5Handle& a_handle)
     }
 
   // Create level domain
-  m_grids = loadBalance(grids);
+  if (procs.size() > 0)
+    {
+      m_grids = DisjointBoxLayout(grids, procs, m_problem_domain);
+      m_grids.close();
+    }
+  else
+    {
+      m_grids = loadBalance(grids);
+    }
 
   // Indicate/guarantee that the indexing below is only for reading
   // otherwise an error/assertion failure occurs
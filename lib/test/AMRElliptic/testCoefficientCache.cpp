@@ -0,0 +1,392 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+// Test program for the coefficient handling of the variable-coefficient
+// operators.
+// Test 1: ViscousTensorOp::applyOp with s_fusedFluxes matches it
+//         without, also after setAlphaAndBeta, resetACoefficient,
+//         resetBCoefficient and a define on larger boxes.
+// Test 2: VCAMRPoissonOp2::setTime interpolates the b coefficient once per
+//         time, and again after setBCoefInterpolator.
+
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+using std::endl;
+
+#include "ViscousTensorOp.H"
+#include "VCAMRPoissonOp2.H"
+#include "CoefficientInterpolator.H"
+#include "BCFunc.H"
+#include "BoxIterator.H"
+#include "LoadBalance.H"
+#include "BRMeshRefine.H"
+#include "parstream.H"
+#ifdef CH_MPI
+#include "mpi.h"
+#endif
+
+#include "UsingNamespace.H"
+
+/// Global variables for handling output:
+static const char* pgmname = "testCoefficientCache" ;
+static const char* indent = "   ";
+static const char* indent2 = "      " ;
+static bool verbose = true ;
+
+static const int  s_nCells    = 32;
+static const Real s_tolerance = 1.0e-10;
+
+static void
+zeroValue(Real* a_pos, int* a_dir, Side::LoHiSide* a_side, Real* a_values)
+{
+  for (int comp = 0; comp < SpaceDim; comp++)
+    {
+      a_values[comp] = 0.;
+    }
+}
+
+/// Homogeneous Dirichlet conditions on the domain boundary
+static void
+diriBC(FArrayBox&           a_state,
+       const Box&           a_valid,
+       const ProblemDomain& a_domain,
+       Real                 a_dx,
+       bool                 a_homogeneous)
+{
+  for (int dir = 0; dir < SpaceDim; dir++)
+    {
+      for (SideIterator sit; sit.ok(); ++sit)
+        {
+          Box ghost = adjCellBox(a_valid, dir, sit(), 1);
+          if (!a_domain.domainBox().contains(ghost))
+            {
+              DiriBC(a_state, a_valid, a_dx, true, zeroValue, dir, sit());
+            }
+        }
+    }
+}
+
+/// Smooth values on every cell of every component
+static void
+fill(LevelData<FArrayBox>& a_data, Real a_shift)
+{
+  for (DataIterator dit = a_data.dataIterator(); dit.ok(); ++dit)
+    {
+      FArrayBox& fab = a_data[dit];
+      for (BoxIterator bit(fab.box()); bit.ok(); ++bit)
+        {
+          for (int comp = 0; comp < fab.nComp(); comp++)
+            {
+              Real val = 1.5 + a_shift;
+              for (int dir = 0; dir < SpaceDim; dir++)
+                {
+                  val += 0.5*sin(0.2*(dir + 1)*bit()[dir] + comp + a_shift);
+                }
+              fab(bit(), comp) = val;
+            }
+        }
+    }
+}
+
+static void
+fill(LevelData<FluxBox>& a_data, Real a_shift)
+{
+  for (DataIterator dit = a_data.dataIterator(); dit.ok(); ++dit)
+    {
+      for (int dir = 0; dir < SpaceDim; dir++)
+        {
+          FArrayBox& fab = a_data[dit][dir];
+          for (BoxIterator bit(fab.box()); bit.ok(); ++bit)
+            {
+              fab(bit(), 0) = 1.5 + cos(0.3*bit()[dir] + a_shift);
+            }
+        }
+    }
+}
+
+/// Largest difference on the valid cells
+static Real
+maxDifference(const LevelData<FArrayBox>& a_lhs, const LevelData<FArrayBox>& a_rhs)
+{
+  Real diff = 0;
+  const DisjointBoxLayout& dbl = a_lhs.disjointBoxLayout();
+  for (DataIterator dit = dbl.dataIterator(); dit.ok(); ++dit)
+    {
+      for (BoxIterator bit(dbl[dit]); bit.ok(); ++bit)
+        {
+          for (int comp = 0; comp < a_lhs.nComp(); comp++)
+            {
+              diff = Max(diff, Abs(a_lhs[dit](bit(), comp) - a_rhs[dit](bit(), comp)));
+            }
+        }
+    }
+#ifdef CH_MPI
+  Real sendBuf = diff;
+  MPI_Allreduce(&sendBuf, &diff, 1, MPI_CH_REAL, MPI_MAX, Chombo_MPI::comm);
+#endif
+  return diff;
+}
+
+static DisjointBoxLayout
+makeGrids(const ProblemDomain& a_domain)
+{
+  Vector<Box> boxes;
+  domainSplit(a_domain, boxes, s_nCells/2);
+  Vector<int> procs;
+  LoadBalance(procs, boxes);
+  return DisjointBoxLayout(boxes, procs, a_domain);
+}
+
+/// Difference between applyOp with and without s_fusedFluxes
+static Real
+fusedDifference(ViscousTensorOp& a_op, const LevelData<FArrayBox>& a_phi)
+{
+  LevelData<FArrayBox> fused, plain;
+  a_op.create(fused, a_phi);
+  a_op.create(plain, a_phi);
+
+  ViscousTensorOp::s_fusedFluxes = true;
+  a_op.applyOp(fused, a_phi, true);
+  ViscousTensorOp::s_fusedFluxes = false;
+  a_op.applyOp(plain, a_phi, true);
+
+  return maxDifference(fused, plain);
+}
+
+int
+testViscousTensorFused()
+{
+  ProblemDomain domain(Box(IntVect::Zero, (s_nCells - 1)*IntVect::Unit));
+  DisjointBoxLayout grids = makeGrids(domain);
+  Real dx = 1./s_nCells;
+
+  RefCountedPtr<LevelData<FArrayBox> > acoef(new LevelData<FArrayBox>(grids, 1, IntVect::Zero));
+  RefCountedPtr<LevelData<FluxBox> >   eta(new LevelData<FluxBox>(grids, 1, IntVect::Zero));
+  RefCountedPtr<LevelData<FluxBox> >   lambda(new LevelData<FluxBox>(grids, 1, IntVect::Zero));
+  fill(*acoef, 0.);
+  fill(*eta, 1.);
+  fill(*lambda, 2.);
+
+  ViscousTensorOp op(grids, DisjointBoxLayout(), DisjointBoxLayout(),
+                     eta, lambda, acoef, 0.5, -1.0, 2, 2, domain, dx, 2*dx, diriBC);
+
+  LevelData<FArrayBox> phi(grids, SpaceDim, IntVect::Unit);
+  fill(phi, 3.);
+
+  Real diff = fusedDifference(op, phi);
+  if (diff > s_tolerance)
+    {
+      pout() << indent2 << "applyOp differs by " << diff << endl;
+      return 1;
+    }
+
+  op.setAlphaAndBeta(2.0, -0.25);
+  diff = fusedDifference(op, phi);
+  if (diff > s_tolerance)
+    {
+      pout() << indent2 << "after setAlphaAndBeta, applyOp differs by " << diff << endl;
+      return 2;
+    }
+
+  fill(*acoef, 4.);
+  op.resetACoefficient(acoef);
+  diff = fusedDifference(op, phi);
+  if (diff > s_tolerance)
+    {
+      pout() << indent2 << "after resetACoefficient, applyOp differs by " << diff << endl;
+      return 3;
+    }
+
+  RefCountedPtr<LevelData<FluxBox> > newEta(new LevelData<FluxBox>(grids, 1, IntVect::Zero));
+  RefCountedPtr<LevelData<FluxBox> > newLambda(new LevelData<FluxBox>(grids, 1, IntVect::Zero));
+  fill(*newEta, 5.);
+  fill(*newLambda, 6.);
+  op.resetBCoefficient(newEta, newLambda);
+  diff = fusedDifference(op, phi);
+  if (diff > s_tolerance)
+    {
+      pout() << indent2 << "after resetBCoefficient, applyOp differs by " << diff << endl;
+      return 4;
+    }
+
+  //one box for the whole domain, so the face scratch has to grow
+  Vector<Box> bigBoxes(1, domain.domainBox());
+  Vector<int> procs;
+  LoadBalance(procs, bigBoxes);
+  DisjointBoxLayout bigGrids(bigBoxes, procs, domain);
+  RefCountedPtr<LevelData<FArrayBox> > bigACoef(new LevelData<FArrayBox>(bigGrids, 1, IntVect::Zero));
+  RefCountedPtr<LevelData<FluxBox> >   bigEta(new LevelData<FluxBox>(bigGrids, 1, IntVect::Zero));
+  RefCountedPtr<LevelData<FluxBox> >   bigLambda(new LevelData<FluxBox>(bigGrids, 1, IntVect::Zero));
+  fill(*bigACoef, 1.);
+  fill(*bigEta, 2.);
+  fill(*bigLambda, 3.);
+  BCHolder bc(diriBC);
+  op.define(bigGrids, DisjointBoxLayout(), DisjointBoxLayout(),
+            bigEta, bigLambda, bigACoef, 0.5, -1.0, 2, 2, domain, dx, 2*dx, bc);
+  LevelData<FArrayBox> bigPhi(bigGrids, SpaceDim, IntVect::Unit);
+  fill(bigPhi, 3.);
+  diff = fusedDifference(op, bigPhi);
+  if (diff > s_tolerance)
+    {
+      pout() << indent2 << "after define on new grids, applyOp differs by " << diff << endl;
+      return 5;
+    }
+  return 0;
+}
+
+/// Sets the b coefficient to 1 + time and counts the calls
+class CountingInterpolator: public CoefficientInterpolator<LevelData<FluxBox>, LevelData<FArrayBox> >
+{
+public:
+  CountingInterpolator()
+    :CoefficientInterpolator<LevelData<FluxBox>, LevelData<FArrayBox> >(1),
+     m_calls(0)
+  {
+  }
+
+  virtual void interpolate(LevelData<FluxBox>& a_result, Real a_time)
+  {
+    m_calls++;
+    for (DataIterator dit = a_result.dataIterator(); dit.ok(); ++dit)
+      {
+        a_result[dit].setVal(1. + a_time);
+      }
+  }
+
+  int m_calls;
+};
+
+int
+testInterpolatorCache()
+{
+  ProblemDomain domain(Box(IntVect::Zero, (s_nCells - 1)*IntVect::Unit));
+  Vector<DisjointBoxLayout> grids(1, makeGrids(domain));
+  Vector<int> refRatios(1, 2);
+  Real dx = 1./s_nCells;
+
+  Vector<RefCountedPtr<LevelData<FArrayBox> > > aCoef(1);
+  Vector<RefCountedPtr<LevelData<FluxBox> > >   bCoef(1);
+  aCoef[0] = RefCountedPtr<LevelData<FArrayBox> >(new LevelData<FArrayBox>(grids[0], 1, IntVect::Zero));
+  bCoef[0] = RefCountedPtr<LevelData<FluxBox> >(new LevelData<FluxBox>(grids[0], 1, IntVect::Zero));
+  fill(*aCoef[0], 0.);
+  fill(*bCoef[0], 1.);
+
+  VCAMRPoissonOp2Factory factory;
+  factory.define(domain, grids, refRatios, dx, diriBC, 0.5, aCoef, -1.0, bCoef);
+  VCAMRPoissonOp2* op = dynamic_cast<VCAMRPoissonOp2*>(factory.AMRnewOp(domain));
+  CH_assert(op != NULL);
+
+  CountingInterpolator* counter = new CountingInterpolator;
+  RefCountedPtr<CoefficientInterpolator<LevelData<FluxBox>, LevelData<FArrayBox> > > interp(counter);
+  op->setBCoefInterpolator(interp);
+
+  op->setTime(0.5);
+  op->setTime(0.5);
+  int status = 0;
+  if (counter->m_calls != 1)
+    {
+      pout() << indent2 << "same time: " << counter->m_calls << " interpolations" << endl;
+      status = 1;
+    }
+  op->setTime(0.75);
+  if (status == 0 && counter->m_calls != 2)
+    {
+      pout() << indent2 << "new time: " << counter->m_calls << " interpolations" << endl;
+      status = 2;
+    }
+  op->setBCoefInterpolator(interp);
+  op->setTime(0.75);
+  if (status == 0 && counter->m_calls != 3)
+    {
+      pout() << indent2 << "new interpolator: " << counter->m_calls << " interpolations" << endl;
+      status = 3;
+    }
+
+  // The b coefficient and the relaxation coefficient follow the last time
+  if (status == 0)
+    {
+      DataIterator dit = op->BCoef().dataIterator();
+      for (dit.begin(); dit.ok(); ++dit)
+        {
+          if (Abs(op->BCoef()[dit][0].max() - 1.75) > s_tolerance) status = 4;
+        }
+    }
+  delete op;
+  return status;
+}
+
+///
+// Parse the standard test options (-v -q -h) out of the command line
+///
+void
+parseTestOptions( int argc ,char* argv[] )
+{
+  for ( int i = 1 ; i < argc ; ++i )
+    {
+      if ( argv[i][0] == '-' ) //if it is an option
+        {
+          // compare 3 chars to differentiate -x from -xx
+          if ( strncmp( argv[i] ,"-v" ,3 ) == 0 )
+            {
+              verbose = true ;
+            }
+          else if ( strncmp( argv[i] ,"-q" ,3 ) == 0 )
+            {
+              verbose = false ;
+            }
+          else if ( strncmp( argv[i] ,"-h" ,3 ) == 0 )
+            {
+              pout() << "usage: " << pgmname << " [-hqv]" << std::endl ;
+              exit( 99 ) ;
+            }
+        }
+    }
+  return;
+}
+
+int
+main(int argc ,char* argv[])
+{
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  parseTestOptions( argc ,argv ) ;
+  if ( verbose )
+    pout() << indent2 << "Beginning " << pgmname << endl ;
+
+  int stat_all = 0;
+  int (*tests[])() = {testViscousTensorFused, testInterpolatorCache};
+  for (int t = 0; t < 2; t++)
+    {
+      int status = tests[t]();
+      if ( status == 0 )
+        {
+          if ( verbose ) pout() << indent << pgmname << " passed test " << t+1 << "." << endl ;
+        }
+      else
+        {
+          pout() << indent << pgmname << " failed test " << t+1 << " with return code "
+                 << status << endl ;
+          stat_all = status ;
+        }
+    }
+
+  if ( stat_all == 0 )
+    pout() << indent << pgmname << ": passed all tests." << endl ;
+  else
+    pout() << indent << pgmname << ": failed one or more tests." << endl ;
+
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+  return stat_all ;
+}
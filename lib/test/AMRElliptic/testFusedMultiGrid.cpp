@@ -0,0 +1,328 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+// Test program for the fused multigrid operations of AMRPoissonOp and
+// VCAMRPoissonOp2, on a fine level with coarse-fine and domain boundaries.
+// Test 1: prolongAndRelax matches prolongIncrement followed by relax.
+// Test 2: residualAndRestrict matches AMRRestrictS.
+
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+using std::endl;
+
+#include "AMRPoissonOp.H"
+#include "VCAMRPoissonOp2.H"
+#include "BCFunc.H"
+#include "BoxIterator.H"
+#include "LoadBalance.H"
+#include "BRMeshRefine.H"
+#include "parstream.H"
+#ifdef CH_MPI
+#include "mpi.h"
+#endif
+
+#include "UsingNamespace.H"
+
+/// Global variables for handling output:
+static const char* pgmname = "testFusedMultiGrid" ;
+static const char* indent = "   ";
+static const char* indent2 = "      " ;
+static bool verbose = true ;
+
+static const int  s_nCells    = 32;
+static const Real s_tolerance = 1.0e-10;
+
+static void
+zeroValue(Real* a_pos, int* a_dir, Side::LoHiSide* a_side, Real* a_values)
+{
+  a_values[0] = 0.;
+}
+
+/// Homogeneous Dirichlet conditions on the domain boundary
+static void
+diriBC(FArrayBox&           a_state,
+       const Box&           a_valid,
+       const ProblemDomain& a_domain,
+       Real                 a_dx,
+       bool                 a_homogeneous)
+{
+  for (int dir = 0; dir < SpaceDim; dir++)
+    {
+      for (SideIterator sit; sit.ok(); ++sit)
+        {
+          Box ghost = adjCellBox(a_valid, dir, sit(), 1);
+          if (!a_domain.domainBox().contains(ghost))
+            {
+              DiriBC(a_state, a_valid, a_dx, true, zeroValue, dir, sit());
+            }
+        }
+    }
+}
+
+/// Smooth values on the valid cells, a_ghost elsewhere
+static void
+fill(LevelData<FArrayBox>& a_data, Real a_shift, Real a_ghost)
+{
+  const DisjointBoxLayout& dbl = a_data.disjointBoxLayout();
+  for (DataIterator dit = dbl.dataIterator(); dit.ok(); ++dit)
+    {
+      FArrayBox& fab = a_data[dit];
+      fab.setVal(a_ghost);
+      for (BoxIterator bit(dbl[dit]); bit.ok(); ++bit)
+        {
+          Real val = a_shift;
+          for (int dir = 0; dir < SpaceDim; dir++)
+            {
+              val += sin(0.2*(dir + 1)*bit()[dir] + a_shift);
+            }
+          fab(bit(), 0) = val;
+        }
+    }
+}
+
+static void
+fill(LevelData<FluxBox>& a_data, Real a_shift)
+{
+  for (DataIterator dit = a_data.dataIterator(); dit.ok(); ++dit)
+    {
+      for (int dir = 0; dir < SpaceDim; dir++)
+        {
+          FArrayBox& fab = a_data[dit][dir];
+          for (BoxIterator bit(fab.box()); bit.ok(); ++bit)
+            {
+              fab(bit(), 0) = 1.5 + cos(0.3*bit()[dir] + a_shift);
+            }
+        }
+    }
+}
+
+/// Largest difference on the valid cells
+static Real
+maxDifference(const LevelData<FArrayBox>& a_lhs, const LevelData<FArrayBox>& a_rhs)
+{
+  Real diff = 0;
+  const DisjointBoxLayout& dbl = a_lhs.disjointBoxLayout();
+  for (DataIterator dit = dbl.dataIterator(); dit.ok(); ++dit)
+    {
+      for (BoxIterator bit(dbl[dit]); bit.ok(); ++bit)
+        {
+          diff = Max(diff, Abs(a_lhs[dit](bit(), 0) - a_rhs[dit](bit(), 0)));
+        }
+    }
+#ifdef CH_MPI
+  Real sendBuf = diff;
+  MPI_Allreduce(&sendBuf, &diff, 1, MPI_CH_REAL, MPI_MAX, Chombo_MPI::comm);
+#endif
+  return diff;
+}
+
+/// Two levels; the fine one touches the low side of the domain in direction 0
+struct Hierarchy
+{
+  Hierarchy()
+  {
+    m_domains.resize(2);
+    m_grids.resize(2);
+    m_refRatios.resize(2, 2);
+    m_dx = 1./s_nCells;
+
+    m_domains[0] = ProblemDomain(Box(IntVect::Zero, (s_nCells - 1)*IntVect::Unit));
+    m_domains[1] = refine(m_domains[0], 2);
+
+    Vector<Box> coarseBoxes;
+    domainSplit(m_domains[0], coarseBoxes, s_nCells/2);
+    Vector<int> procs;
+    LoadBalance(procs, coarseBoxes);
+    m_grids[0].define(coarseBoxes, procs, m_domains[0]);
+
+    Box covered(s_nCells/4*IntVect::Unit, (3*s_nCells/4 - 1)*IntVect::Unit);
+    covered.setSmall(0, 0);
+    Vector<Box> fineBoxes;
+    domainSplit(refine(covered, 2), fineBoxes, s_nCells/2);
+    LoadBalance(procs, fineBoxes);
+    m_grids[1].define(fineBoxes, procs, m_domains[1]);
+  }
+
+  Vector<ProblemDomain>     m_domains;
+  Vector<DisjointBoxLayout> m_grids;
+  Vector<int>               m_refRatios;
+  Real                      m_dx;
+};
+
+/// The fine level operator of an AMRPoissonOp and a VCAMRPoissonOp2 factory
+static AMRLevelOp<LevelData<FArrayBox> >*
+newFineOp(const Hierarchy& a_hier, bool a_variable)
+{
+  if (!a_variable)
+    {
+      AMRPoissonOpFactory factory;
+      factory.define(a_hier.m_domains[0], a_hier.m_grids, a_hier.m_refRatios,
+                     a_hier.m_dx, diriBC, 0.5, 1.0);
+      return factory.AMRnewOp(a_hier.m_domains[1]);
+    }
+
+  Vector<RefCountedPtr<LevelData<FArrayBox> > > aCoef(2);
+  Vector<RefCountedPtr<LevelData<FluxBox> > >   bCoef(2);
+  for (int lev = 0; lev < 2; lev++)
+    {
+      aCoef[lev] = RefCountedPtr<LevelData<FArrayBox> >(
+        new LevelData<FArrayBox>(a_hier.m_grids[lev], 1, IntVect::Zero));
+      bCoef[lev] = RefCountedPtr<LevelData<FluxBox> >(
+        new LevelData<FluxBox>(a_hier.m_grids[lev], 1, IntVect::Zero));
+      fill(*aCoef[lev], 2., 0.);
+      fill(*bCoef[lev], 1.);
+    }
+  VCAMRPoissonOp2Factory factory;
+  factory.define(a_hier.m_domains[0], a_hier.m_grids, a_hier.m_refRatios,
+                 a_hier.m_dx, diriBC, 0.5, aCoef, 1.0, bCoef);
+  return factory.AMRnewOp(a_hier.m_domains[1]);
+}
+
+int
+testProlongAndRelax()
+{
+  Hierarchy hier;
+  for (int variable = 0; variable < 2; variable++)
+    {
+      AMRLevelOp<LevelData<FArrayBox> >* op = newFineOp(hier, variable == 1);
+
+      LevelData<FArrayBox> phi(hier.m_grids[1], 1, IntVect::Unit);
+      LevelData<FArrayBox> rhs(hier.m_grids[1], 1, IntVect::Zero);
+      fill(phi, 0., 3.);
+      fill(rhs, 1., 0.);
+      LevelData<FArrayBox> coarse;
+      op->createCoarser(coarse, phi, true);
+      fill(coarse, 2., 5.);
+
+      LevelData<FArrayBox> exact(hier.m_grids[1], 1, IntVect::Unit);
+      for (DataIterator dit = phi.dataIterator(); dit.ok(); ++dit)
+        {
+          exact[dit].copy(phi[dit]);
+        }
+      op->prolongIncrement(exact, coarse);
+      op->relax(exact, rhs, 2);
+
+      op->prolongAndRelax(phi, coarse, rhs, 2);
+
+      Real diff = maxDifference(phi, exact);
+      delete op;
+      if (diff > s_tolerance)
+        {
+          pout() << indent2 << (variable ? "VCAMRPoissonOp2" : "AMRPoissonOp")
+                 << ": prolongAndRelax differs by " << diff << endl;
+          return 1 + variable;
+        }
+    }
+  return 0;
+}
+
+int
+testResidualAndRestrict()
+{
+  Hierarchy hier;
+  for (int variable = 0; variable < 2; variable++)
+    {
+      AMRLevelOp<LevelData<FArrayBox> >* op = newFineOp(hier, variable == 1);
+
+      LevelData<FArrayBox> correction(hier.m_grids[1], 1, IntVect::Unit);
+      LevelData<FArrayBox> residual(hier.m_grids[1], 1, IntVect::Zero);
+      LevelData<FArrayBox> coarseCorrection(hier.m_grids[0], 1, IntVect::Unit);
+      fill(correction, 0., 3.);
+      fill(residual, 1., 0.);
+      fill(coarseCorrection, 2., 5.);
+
+      LevelData<FArrayBox> scratch, exact, resCoarse;
+      op->create(scratch, residual);
+      op->createCoarsened(exact, residual, 2);
+      op->createCoarsened(resCoarse, residual, 2);
+
+      op->AMRRestrictS(exact, residual, correction, coarseCorrection, scratch);
+      op->residualAndRestrict(resCoarse, residual, correction, coarseCorrection, scratch);
+
+      Real diff = maxDifference(resCoarse, exact);
+      delete op;
+      if (diff > s_tolerance)
+        {
+          pout() << indent2 << (variable ? "VCAMRPoissonOp2" : "AMRPoissonOp")
+                 << ": residualAndRestrict differs by " << diff << endl;
+          return 1 + variable;
+        }
+    }
+  return 0;
+}
+
+///
+// Parse the standard test options (-v -q -h) out of the command line
+///
+void
+parseTestOptions( int argc ,char* argv[] )
+{
+  for ( int i = 1 ; i < argc ; ++i )
+    {
+      if ( argv[i][0] == '-' ) //if it is an option
+        {
+          // compare 3 chars to differentiate -x from -xx
+          if ( strncmp( argv[i] ,"-v" ,3 ) == 0 )
+            {
+              verbose = true ;
+            }
+          else if ( strncmp( argv[i] ,"-q" ,3 ) == 0 )
+            {
+              verbose = false ;
+            }
+          else if ( strncmp( argv[i] ,"-h" ,3 ) == 0 )
+            {
+              pout() << "usage: " << pgmname << " [-hqv]" << std::endl ;
+              exit( 99 ) ;
+            }
+        }
+    }
+  return;
+}
+
+int
+main(int argc ,char* argv[])
+{
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  parseTestOptions( argc ,argv ) ;
+  if ( verbose )
+    pout() << indent2 << "Beginning " << pgmname << endl ;
+
+  int stat_all = 0;
+  int (*tests[])() = {testProlongAndRelax, testResidualAndRestrict};
+  for (int t = 0; t < 2; t++)
+    {
+      int status = tests[t]();
+      if ( status == 0 )
+        {
+          if ( verbose ) pout() << indent << pgmname << " passed test " << t+1 << "." << endl ;
+        }
+      else
+        {
+          pout() << indent << pgmname << " failed test " << t+1 << " with return code "
+                 << status << endl ;
+          stat_all = status ;
+        }
+    }
+
+  if ( stat_all == 0 )
+    pout() << indent << pgmname << ": passed all tests." << endl ;
+  else
+    pout() << indent << pgmname << ": failed one or more tests." << endl ;
+
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+  return stat_all ;
+}
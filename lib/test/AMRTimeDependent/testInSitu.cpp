@@ -0,0 +1,495 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+// Test program for the in-situ analysis stages, run through an
+// InSituPipeline on a two level hierarchy holding u = x and u = 1.
+// Test 1: reductions give the min, max and integral of the valid data.
+// Test 2: a slice through both levels is written.
+// Test 3: the iso-surface x = 1/2 is found on both levels, once.
+// Test 4: the downsampled projection along x integrates x to 1/2.
+// Test 5: a probe at the center reads x = 1/2 and writes a time series.
+// Test 6: a pipeline scheduled on an AMR run sees the data every level
+//         returns from analysisData(), on every scheduled step.
+
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+using std::endl;
+
+#include "InSituAnalysis.H"
+#include "AMR.H"
+#include "AMRLevel.H"
+#include "BRMeshRefine.H"
+#include "BoxIterator.H"
+#include "LoadBalance.H"
+#include "parstream.H"
+#include "UsingNamespace.H"
+
+/// Global variables for handling output:
+static const char* pgmname = "testInSitu" ;
+static const char* indent = "   ";
+static const char* indent2 = "      " ;
+static bool verbose = true ;
+
+static const int s_step = 3;
+static const Real s_tol = 1.0e-12;
+
+static void
+defineLevel(LevelData<FArrayBox>& a_data, const Box& a_box, Real a_dx)
+{
+  Vector<Box> boxes;
+  domainSplit(a_box, boxes, 8);
+  Vector<int> procs;
+  LoadBalance(procs, boxes);
+  DisjointBoxLayout grids(boxes, procs);
+  a_data.define(grids, 2);
+  for (DataIterator dit = grids.dataIterator(); dit.ok(); ++dit)
+    {
+      FArrayBox& fab = a_data[dit()];
+      for (BoxIterator bit(grids[dit()]); bit.ok(); ++bit)
+        {
+          fab(bit(), 0) = (bit()[0] + 0.5)*a_dx;
+          fab(bit(), 1) = 1.0;
+        }
+    }
+}
+
+/// Level 0 is 16^D cells on the unit cube; level 1 refines the middle half
+static void
+defineHierarchy(InSituHierarchy& a_hierarchy)
+{
+  Box domain(IntVect::Zero, 15*IntVect::Unit);
+  a_hierarchy.m_dxCoarse = 1.0/16;
+  a_hierarchy.m_step = s_step;
+  a_hierarchy.m_time = 0.5;
+  a_hierarchy.m_refRatios.resize(2, 2);
+  a_hierarchy.m_domains.push_back(ProblemDomain(domain));
+  a_hierarchy.m_domains.push_back(ProblemDomain(refine(domain, 2)));
+
+  a_hierarchy.m_data.push_back(new LevelData<FArrayBox>);
+  a_hierarchy.m_data.push_back(new LevelData<FArrayBox>);
+  defineLevel(*a_hierarchy.m_data[0], domain, a_hierarchy.dx(0));
+  Box fine(4*IntVect::Unit, 11*IntVect::Unit);
+  defineLevel(*a_hierarchy.m_data[1], refine(fine, 2), a_hierarchy.dx(1));
+}
+
+static bool
+fileExists(const char* a_filename)
+{
+  std::ifstream file(a_filename);
+  return file.good();
+}
+
+int
+testInSitu()
+{
+  InSituHierarchy hierarchy;
+  defineHierarchy(hierarchy);
+
+  InSituReduction* minX = new InSituReduction("testInSitu.dat", InSituReduction::Min, 0);
+  InSituReduction* maxX = new InSituReduction("testInSitu.dat", InSituReduction::Max, 0);
+  InSituReduction* volume = new InSituReduction("testInSitu.dat", InSituReduction::Sum, 1);
+  InSituSlice* slice = new InSituSlice("testInSituSlice", SliceSpec(0, 10), Vector<std::string>());
+  InSituIsoSurface* iso = new InSituIsoSurface("testInSituIso", 0, 0.5);
+  InSituProjection* projection = new InSituProjection("testInSituProj", 0, 0, 2);
+  AMRProbe centerProbe(hierarchy.m_domains[0], hierarchy.m_dxCoarse);
+  centerProbe.addPoint("center", 0.5*RealVect::Unit);
+  Vector<std::string> names(2);
+  names[0] = "x";
+  names[1] = "one";
+  InSituProbe* probe = new InSituProbe("testInSituProbe.h5", centerProbe, names);
+
+  InSituPipeline pipeline(hierarchy.m_dxCoarse);
+  pipeline.add(RefCountedPtr<InSituStage>(minX));
+  pipeline.add(RefCountedPtr<InSituStage>(maxX));
+  pipeline.add(RefCountedPtr<InSituStage>(volume));
+  pipeline.add(RefCountedPtr<InSituStage>(slice));
+  pipeline.add(RefCountedPtr<InSituStage>(iso));
+  pipeline.add(RefCountedPtr<InSituStage>(projection));
+  pipeline.add(RefCountedPtr<InSituStage>(probe));
+  pipeline.process(hierarchy);
+
+  int retval = 0;
+
+  // Test 1
+  if ((Abs(minX->value() - 0.5/16) > s_tol) ||
+      (Abs(maxX->value() - 15.5/16) > s_tol) ||
+      (Abs(volume->value() - 1.0) > s_tol))
+    {
+      pout() << indent << "wrong reductions: " << minX->value() << " "
+             << maxX->value() << " " << volume->value() << endl;
+      retval = 1;
+    }
+
+  // Test 2
+  char filename[1024];
+  sprintf(filename, "testInSituSlice%06d.%dd.hdf5", s_step, SpaceDim);
+  if (slice->filename() != filename)
+    {
+      pout() << indent << "wrong slice file name: " << slice->filename() << endl;
+      retval = 2;
+    }
+#ifdef CH_USE_HDF5
+  else if ((procID() == 0) && !fileExists(filename))
+    {
+      pout() << indent << "no slice file" << endl;
+      retval = 2;
+    }
+#endif
+
+  // Test 3
+  if (procID() == 0)
+    {
+      // A crossing in each row of fine cells and in each row of coarse
+      // cells not covered by the fine level
+      int numRows = 1, numFineRows = 1;
+      for (int idir = 1; idir < SpaceDim; ++idir)
+        {
+          numRows *= 16;
+          numFineRows *= 8;
+        }
+      const Vector<Real>& points = iso->points();
+      if (points.size() != SpaceDim*(2*numRows - numFineRows))
+        {
+          pout() << indent << "wrong number of iso points: "
+                 << points.size()/SpaceDim << endl;
+          retval = 3;
+        }
+      for (int i = 0; i < points.size(); i += SpaceDim)
+        {
+          if (Abs(points[i] - 0.5) > s_tol)
+            {
+              pout() << indent << "iso point off the surface: " << points[i] << endl;
+              retval = 3;
+              break;
+            }
+        }
+    }
+
+  // Test 4
+  const FArrayBox& image = projection->image();
+  Box imageBox = image.box();
+  int numPixels = 1;
+  for (int idir = 1; idir < SpaceDim; ++idir)
+    {
+      numPixels *= 8;
+    }
+  if ((imageBox.size(0) != 1) || (imageBox.numPts() != numPixels))
+    {
+      pout() << indent << "wrong image box: " << imageBox << endl;
+      retval = 4;
+    }
+  for (BoxIterator bit(imageBox); bit.ok(); ++bit)
+    {
+      if (Abs(image(bit(), 0) - 0.5) > s_tol)
+        {
+          pout() << indent << "wrong projection at " << bit() << ": "
+                 << image(bit(), 0) << endl;
+          retval = 4;
+          break;
+        }
+    }
+
+  // Test 5
+  if (procID() == 0)
+    {
+      const Vector<Real>& values = probe->values();
+      if ((values.size() != 2) || (Abs(values[0] - 0.5) > s_tol) ||
+          (Abs(values[1] - 1.0) > s_tol))
+        {
+          pout() << indent << "wrong probe values" << endl;
+          retval = 5;
+        }
+#ifdef CH_USE_HDF5
+      else if (!fileExists("testInSituProbe.h5"))
+        {
+          pout() << indent << "no probe file" << endl;
+          retval = 5;
+        }
+#endif
+    }
+
+  pipeline.conclude(s_step, hierarchy.m_time);
+  delete hierarchy.m_data[0];
+  delete hierarchy.m_data[1];
+
+  if (procID() == 0)
+    {
+      std::remove("testInSitu.dat");
+      std::remove("testInSituProbe.h5");
+      std::remove(filename);
+      sprintf(filename, "testInSituIso%06d.csv", s_step);
+      std::remove(filename);
+      sprintf(filename, "testInSituProj%06d.hdf5", s_step);
+      std::remove(filename);
+    }
+  return retval;
+}
+
+/// An AMRLevel that only holds u = x and u = level + 1 for the pipeline
+class AnalysisLevel : public AMRLevel
+{
+public:
+  AnalysisLevel()
+  {
+  }
+
+  virtual ~AnalysisLevel()
+  {
+  }
+
+  virtual Real advance()
+  {
+    m_time += m_dt;
+    return m_dt;
+  }
+
+  virtual void postTimeStep()
+  {
+  }
+
+  virtual void tagCells(IntVectSet& a_tags)
+  {
+    tagCellsInit(a_tags);
+  }
+
+  virtual void tagCellsInit(IntVectSet& a_tags)
+  {
+    if (m_level == 0)
+      {
+        a_tags |= Box(4*IntVect::Unit, 11*IntVect::Unit);
+      }
+  }
+
+  virtual void regrid(const Vector<Box>& a_new_grids)
+  {
+    initialGrid(a_new_grids);
+    initialData();
+  }
+
+  virtual void initialGrid(const Vector<Box>& a_new_grids)
+  {
+    m_level_grids = a_new_grids;
+    Vector<int> procs;
+    LoadBalance(procs, a_new_grids);
+    m_data.define(DisjointBoxLayout(a_new_grids, procs, m_problem_domain), 2);
+  }
+
+  virtual void initialData()
+  {
+    Real dx = 1.0/m_problem_domain.domainBox().size(0);
+    const DisjointBoxLayout& grids = m_data.disjointBoxLayout();
+    for (DataIterator dit = grids.dataIterator(); dit.ok(); ++dit)
+      {
+        FArrayBox& fab = m_data[dit()];
+        for (BoxIterator bit(grids[dit()]); bit.ok(); ++bit)
+          {
+            fab(bit(), 0) = (bit()[0] + 0.5)*dx;
+            fab(bit(), 1) = m_level + 1;
+          }
+      }
+  }
+
+  virtual void postInitialize()
+  {
+  }
+
+#ifdef CH_USE_HDF5
+  virtual void writeCheckpointHeader(HDF5Handle& a_handle) const
+  {
+  }
+
+  virtual void writeCheckpointLevel(HDF5Handle& a_handle) const
+  {
+  }
+
+  virtual void readCheckpointHeader(HDF5Handle& a_handle)
+  {
+  }
+
+  virtual void readCheckpointLevel(HDF5Handle& a_handle)
+  {
+  }
+
+  virtual void writePlotHeader(HDF5Handle& a_handle) const
+  {
+  }
+
+  virtual void writePlotLevel(HDF5Handle& a_handle) const
+  {
+  }
+#endif
+
+  virtual Real computeDt()
+  {
+    return 0.1;
+  }
+
+  virtual Real computeInitialDt()
+  {
+    return 0.1;
+  }
+
+  virtual LevelData<FArrayBox>* analysisData()
+  {
+    return &m_data;
+  }
+
+protected:
+  LevelData<FArrayBox> m_data;
+};
+
+class AnalysisLevelFactory : public AMRLevelFactory
+{
+public:
+  virtual AMRLevel* new_amrlevel() const
+  {
+    return new AnalysisLevel();
+  }
+};
+
+/// Records the steps it is run on and what the hierarchy held
+class RecordingStage : public InSituStage
+{
+public:
+  virtual void process(const InSituHierarchy& a_hierarchy)
+  {
+    m_steps.push_back(a_hierarchy.m_step);
+    m_numLevels = a_hierarchy.m_data.size();
+    m_fineVolume = 0;
+    if (m_numLevels > 1)
+      {
+        const DisjointBoxLayout& grids = a_hierarchy.m_data[1]->disjointBoxLayout();
+        Real cellVolume = pow(a_hierarchy.dx(1), SpaceDim);
+        for (LayoutIterator lit = grids.layoutIterator(); lit.ok(); ++lit)
+          {
+            m_fineVolume += grids[lit()].numPts()*cellVolume;
+          }
+      }
+  }
+
+  Vector<int> m_steps;
+  int m_numLevels;
+  Real m_fineVolume;
+};
+
+int
+testScheduledPipeline()
+{
+  Box domain(IntVect::Zero, 15*IntVect::Unit);
+  const int maxLevel = 1;
+  Vector<int> refRatios(maxLevel+1, 2);
+  AnalysisLevelFactory factory;
+
+  AMR amr;
+  amr.define(maxLevel, refRatios, domain, &factory);
+  amr.verbosity(0);
+  amr.setupForNewAMRRun();
+
+  RecordingStage* record = new RecordingStage;
+  InSituReduction* sum = new InSituReduction("testInSituAMR.dat", InSituReduction::Sum, 1);
+  RefCountedPtr<InSituPipeline> pipeline(new InSituPipeline(1.0/16));
+  pipeline->add(RefCountedPtr<InSituStage>(record));
+  pipeline->add(RefCountedPtr<InSituStage>(sum));
+  RefCountedPtr<Scheduler> scheduler(new Scheduler);
+  scheduler->schedule(RefCountedPtr<Scheduler::PeriodicFunction>(pipeline), 2);
+  amr.schedule(scheduler);
+
+  amr.run(10., 5);
+  amr.conclude();
+
+  int retval = 0;
+  if ((record->m_steps.size() != 3) || (record->m_steps[0] != 0) ||
+      (record->m_steps[1] != 2) || (record->m_steps[2] != 4))
+    {
+      pout() << indent << "pipeline run on " << record->m_steps.size()
+             << " steps" << endl;
+      retval = 6;
+    }
+  else if ((record->m_numLevels != 2) || (record->m_fineVolume <= 0))
+    {
+      pout() << indent << "pipeline saw " << record->m_numLevels << " levels" << endl;
+      retval = 6;
+    }
+  // u = 2 on the fine level and u = 1 on the uncovered coarse cells
+  else if (Abs(sum->value() - (1.0 + record->m_fineVolume)) > s_tol)
+    {
+      pout() << indent << "wrong sum over the AMR levels: " << sum->value() << endl;
+      retval = 6;
+    }
+
+  if (procID() == 0)
+    {
+      std::remove("testInSituAMR.dat");
+    }
+  return retval;
+}
+
+///
+// Parse the standard test options (-v -q -h) out of the command line
+///
+void
+parseTestOptions( int argc ,char* argv[] )
+{
+  for ( int i = 1 ; i < argc ; ++i )
+    {
+      if ( argv[i][0] == '-' ) //if it is an option
+        {
+          // compare 3 chars to differentiate -x from -xx
+          if ( strncmp( argv[i] ,"-v" ,3 ) == 0 )
+            {
+              verbose = true ;
+            }
+          else if ( strncmp( argv[i] ,"-q" ,3 ) == 0 )
+            {
+              verbose = false ;
+            }
+          else if ( strncmp( argv[i] ,"-h" ,3 ) == 0 )
+            {
+              pout() << "usage: " << pgmname << " [-hqv]" << std::endl ;
+              exit( 99 ) ;
+            }
+        }
+    }
+  return;
+}
+
+int
+main(int argc ,char* argv[])
+{
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  parseTestOptions( argc ,argv ) ;
+  if ( verbose )
+    pout() << indent2 << "Beginning " << pgmname << endl ;
+
+  int status = testInSitu();
+  if ( status == 0 )
+    {
+      status = testScheduledPipeline();
+    }
+  if ( status == 0 )
+    {
+      pout() << indent << pgmname << " passed." << endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed with return code "
+             << status << endl ;
+    }
+
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+  return status;
+}
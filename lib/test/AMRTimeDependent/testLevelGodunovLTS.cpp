@@ -0,0 +1,485 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+// Test program for local time stepping in LevelGodunov
+// Advection of a scalar on a periodic domain by a shear flow whose speed
+// varies by a factor of four across the domain.
+// Test 1: boxes are assigned to several time step classes and the scalar
+//         is conserved to roundoff.
+// Test 2: local time stepping takes larger steps than global time stepping
+//         and gives nearly the same solution.
+// Test 3: with a uniform velocity, local time stepping reduces to global
+//         time stepping.
+// Test 4: with time steps within the CFL limit of the fastest box, no box
+//         is subcycled.
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+using std::endl;
+
+#include "LevelGodunov.H"
+#include "AdvectPhysics.H"
+#include "PhysIBC.H"
+#include "LevelFluxRegister.H"
+#include "BRMeshRefine.H"
+#include "LoadBalance.H"
+#include "BoxIterator.H"
+#include "parstream.H"
+#include "UsingNamespace.H"
+
+/// Global variables for handling output:
+static const char* pgmname = "testLevelGodunovLTS" ;
+static const char* indent = "   ";
+static const char* indent2 = "      " ;
+static bool verbose = true ;
+
+static const int s_nCell = 64;
+static const int s_boxSize = 8;
+static const Real s_cfl = 0.5;
+
+/// Velocities covering the domain and its ghost cells
+static FArrayBox s_cellVel;
+static FluxBox   s_faceVel;
+
+/// Periodic domains need no boundary conditions
+class PeriodicIBC : public PhysIBC
+{
+public:
+  PeriodicIBC()
+  {
+  }
+
+  virtual ~PeriodicIBC()
+  {
+  }
+
+  virtual PhysIBC* new_physIBC()
+  {
+    return new PeriodicIBC();
+  }
+
+  virtual void initialize(LevelData<FArrayBox>& a_U)
+  {
+  }
+
+  virtual void primBC(FArrayBox&            a_WGdnv,
+                      const FArrayBox&      a_Wextrap,
+                      const FArrayBox&      a_W,
+                      const int&            a_dir,
+                      const Side::LoHiSide& a_side,
+                      const Real&           a_time)
+  {
+  }
+
+  virtual void setBdrySlopes(FArrayBox&       a_dW,
+                             const FArrayBox& a_W,
+                             const int&       a_dir,
+                             const Real&      a_time)
+  {
+  }
+
+  virtual void artViscBC(FArrayBox&       a_F,
+                         const FArrayBox& a_U,
+                         const FArrayBox& a_divVel,
+                         const int&       a_dir,
+                         const Real&      a_time)
+  {
+  }
+};
+
+/// AdvectPhysics using the static velocities, with the wave speed of a box
+/// taken over that box only
+class LocalAdvectPhysics : public AdvectPhysics
+{
+public:
+  LocalAdvectPhysics()
+  {
+  }
+
+  virtual ~LocalAdvectPhysics()
+  {
+  }
+
+  virtual GodunovPhysics* new_godunovPhysics() const
+  {
+    LocalAdvectPhysics* newPtr = new LocalAdvectPhysics();
+    newPtr->setPhysIBC(getPhysIBC());
+    newPtr->define(m_domain,m_dx);
+    newPtr->setVelocities(&s_cellVel,&s_faceVel);
+    return newPtr;
+  }
+
+  virtual Real getMaxWaveSpeed(const FArrayBox& a_U,
+                               const Box&       a_box)
+  {
+    Real maxSpeed = 0.0;
+    for (int dir = 0; dir < SpaceDim; dir++)
+      {
+        maxSpeed = Max(maxSpeed, s_cellVel.norm(a_box,0,dir,1));
+      }
+    return maxSpeed;
+  }
+};
+
+/// Speed of the shear flow in x, as a function of y
+static Real
+shearSpeed(Real a_y, bool a_uniform)
+{
+  if (a_uniform)
+    {
+      return 1.0;
+    }
+  Real s = sin(M_PI*a_y);
+  return 1.0 + 3.0*s*s;
+}
+
+/// Set the velocities on the domain grown by a_numGhost cells
+static void
+setVelocities(const Box& a_domain, Real a_dx, int a_numGhost, bool a_uniform)
+{
+  Box velBox = grow(a_domain, a_numGhost + 1);
+  s_cellVel.define(velBox, SpaceDim);
+  s_faceVel.define(velBox, 1);
+  s_cellVel.setVal(0.0);
+  s_faceVel.setVal(0.0);
+
+  for (BoxIterator bit(velBox); bit.ok(); ++bit)
+    {
+      const IntVect& iv = bit();
+      Real y = (SpaceDim > 1) ? (iv[SpaceDim-1] + 0.5)*a_dx : 0.0;
+      s_cellVel(iv,0) = shearSpeed(y, a_uniform);
+    }
+  // x faces share the y coordinate of their cells
+  FArrayBox& faceVel = s_faceVel[0];
+  for (BoxIterator bit(faceVel.box()); bit.ok(); ++bit)
+    {
+      const IntVect& iv = bit();
+      Real y = (SpaceDim > 1) ? (iv[SpaceDim-1] + 0.5)*a_dx : 0.0;
+      faceVel(iv,0) = shearSpeed(y, a_uniform);
+    }
+}
+
+/// Advect to a_time, with time steps a_dtScale times those step() allows,
+/// and return the solution, the number of steps and the largest time step
+/// class
+static void
+advect(LevelData<FArrayBox>& a_U,
+       int&                  a_numSteps,
+       int&                  a_maxClass,
+       int                   a_maxTimeStepClass,
+       bool                  a_uniform,
+       Real                  a_time,
+       Real                  a_dtScale = 1.0)
+{
+  Box domainBox(IntVect::Zero, (s_nCell-1)*IntVect::Unit);
+  bool isPeriodic[SpaceDim];
+  for (int dir = 0; dir < SpaceDim; dir++)
+    {
+      isPeriodic[dir] = true;
+    }
+  ProblemDomain domain(domainBox, isPeriodic);
+  Real dx = 1.0/s_nCell;
+
+  Vector<Box> boxes;
+  domainSplit(domainBox, boxes, s_boxSize, s_boxSize);
+  Vector<int> procs;
+  LoadBalance(procs, boxes);
+  DisjointBoxLayout grids(boxes, procs, domain);
+
+  setVelocities(domainBox, dx, 4, a_uniform);
+
+  PeriodicIBC ibc;
+  LocalAdvectPhysics physics;
+  physics.setPhysIBC(&ibc);
+  physics.define(domain, dx);
+  physics.setVelocities(&s_cellVel, &s_faceVel);
+
+  LevelGodunov levelGodunov;
+  levelGodunov.setLocalTimeStepping(a_maxTimeStepClass, s_cfl);
+  levelGodunov.define(grids, DisjointBoxLayout(), domain, 1, dx, &physics,
+                      1, false, true, false, false, false, 0.0,
+                      false, false);
+
+  // A smooth periodic initial condition
+  a_U.define(grids, 1);
+  for (DataIterator dit = grids.dataIterator(); dit.ok(); ++dit)
+    {
+      FArrayBox& U = a_U[dit];
+      for (BoxIterator bit(grids[dit]); bit.ok(); ++bit)
+        {
+          const IntVect& iv = bit();
+          Real val = 1.0;
+          for (int dir = 0; dir < SpaceDim; dir++)
+            {
+              val += 0.5*sin(2.0*M_PI*(iv[dir] + 0.5)*dx);
+            }
+          U(iv,0) = val;
+        }
+    }
+
+  LevelData<FArrayBox> flux[SpaceDim];
+  LevelData<FArrayBox> source;
+  LevelData<FArrayBox> UCoarse;
+  LevelFluxRegister finerFR;
+  LevelFluxRegister coarserFR;
+
+  // The first step uses the time step the first call would return
+  Real time = 0.0;
+  Real dt = 0.0;
+  {
+    LevelData<FArrayBox> U(grids, 1);
+    a_U.copyTo(U);
+    dt = a_dtScale*s_cfl*levelGodunov.step(U, flux, finerFR, coarserFR,
+                                           source, UCoarse, 0.0, UCoarse,
+                                           0.0, 0.0, 0.0);
+  }
+
+  a_numSteps = 0;
+  a_maxClass = 0;
+  while (time < a_time - 1.0e-12)
+    {
+      dt = Min(dt, a_time - time);
+      Real dtNew = levelGodunov.step(a_U, flux, finerFR, coarserFR, source,
+                                     UCoarse, 0.0, UCoarse, 0.0, time, dt);
+      time += dt;
+      dt = a_dtScale*s_cfl*dtNew;
+      a_numSteps++;
+
+      const LayoutData<int>& classes = levelGodunov.timeStepClasses();
+      for (DataIterator dit = grids.dataIterator(); dit.ok(); ++dit)
+        {
+          a_maxClass = Max(a_maxClass, classes[dit]);
+        }
+    }
+}
+
+static Real
+totalMass(const LevelData<FArrayBox>& a_U)
+{
+  Real mass = 0.0;
+  for (DataIterator dit = a_U.dataIterator(); dit.ok(); ++dit)
+    {
+      mass += a_U[dit].sum(a_U.disjointBoxLayout()[dit], 0);
+    }
+  return mass;
+}
+
+static Real
+maxDiff(const LevelData<FArrayBox>& a_A, const LevelData<FArrayBox>& a_B)
+{
+  // The runs have separate (but equal) layouts
+  LevelData<FArrayBox> B(a_A.disjointBoxLayout(), 1);
+  a_B.copyTo(B);
+
+  Real diff = 0.0;
+  for (DataIterator dit = a_A.dataIterator(); dit.ok(); ++dit)
+    {
+      const Box& box = a_A.disjointBoxLayout()[dit];
+      FArrayBox delta(box, 1);
+      delta.copy(a_A[dit]);
+      delta.minus(B[dit], box, 0, 0, 1);
+      diff = Max(diff, delta.norm(box, 0, 0, 1));
+    }
+  return diff;
+}
+
+int
+testConservation()
+{
+  LevelData<FArrayBox> U;
+  int numSteps;
+  int maxClass;
+
+  advect(U, numSteps, maxClass, 0, false, 0.0);
+  Real mass0 = totalMass(U);
+
+  advect(U, numSteps, maxClass, 3, false, 0.25);
+  Real mass1 = totalMass(U);
+
+  if (SpaceDim > 1 && maxClass != 2) return 1;
+  if (Abs(mass1 - mass0) > 1.0e-10*Abs(mass0)) return 2;
+
+  if (verbose)
+    {
+      pout() << indent2 << numSteps << " steps, largest class " << maxClass
+             << ", mass change " << mass1 - mass0 << endl;
+    }
+  return 0;
+}
+
+int
+testAccuracy()
+{
+  LevelData<FArrayBox> UGlobal;
+  LevelData<FArrayBox> ULocal;
+  int numGlobal;
+  int numLocal;
+  int maxClass;
+
+  advect(UGlobal, numGlobal, maxClass, 0, false, 0.25);
+  advect(ULocal, numLocal, maxClass, 2, false, 0.25);
+
+  if (SpaceDim > 1 && numLocal >= numGlobal) return 1;
+  Real diff = maxDiff(UGlobal, ULocal);
+  if (diff > 5.0e-3) return 2;
+
+  if (verbose)
+    {
+      pout() << indent2 << numGlobal << " global steps, " << numLocal
+             << " local steps, max difference " << diff << endl;
+    }
+  return 0;
+}
+
+int
+testUniform()
+{
+  LevelData<FArrayBox> UGlobal;
+  LevelData<FArrayBox> ULocal;
+  int numGlobal;
+  int numLocal;
+  int maxClass;
+
+  advect(UGlobal, numGlobal, maxClass, 0, true, 0.25);
+  advect(ULocal, numLocal, maxClass, 2, true, 0.25);
+
+  if (maxClass != 0) return 1;
+  if (numLocal != numGlobal) return 2;
+  if (maxDiff(UGlobal, ULocal) != 0.0) return 3;
+
+  return 0;
+}
+
+int
+testSmallSteps()
+{
+  LevelData<FArrayBox> UGlobal;
+  LevelData<FArrayBox> ULocal;
+  int numGlobal;
+  int numLocal;
+  int maxClass;
+
+  // The speed varies by a factor of four, so a quarter of the class 0
+  // time step is within the CFL limit of every box
+  advect(UGlobal, numGlobal, maxClass, 0, false, 0.25);
+  advect(ULocal, numLocal, maxClass, 2, false, 0.25, 0.25);
+
+  if (maxClass != 0) return 1;
+  Real diff = maxDiff(UGlobal, ULocal);
+  if (diff > 5.0e-3) return 2;
+
+  if (verbose)
+    {
+      pout() << indent2 << numLocal << " steps, max difference " << diff
+             << endl;
+    }
+
+  return 0;
+}
+
+///
+// Parse the standard test options (-v -q -h) out of the command line
+///
+void
+parseTestOptions( int argc ,char* argv[] )
+{
+  for ( int i = 1 ; i < argc ; ++i )
+    {
+      if ( argv[i][0] == '-' ) //if it is an option
+        {
+          // compare 3 chars to differentiate -x from -xx
+          if ( strncmp( argv[i] ,"-v" ,3 ) == 0 )
+            {
+              verbose = true ;
+            }
+          else if ( strncmp( argv[i] ,"-q" ,3 ) == 0 )
+            {
+              verbose = false ;
+            }
+          else if ( strncmp( argv[i] ,"-h" ,3 ) == 0 )
+            {
+              pout() << "usage: " << pgmname << " [-hqv]" << std::endl ;
+              exit( 99 ) ;
+            }
+        }
+    }
+  return;
+}
+
+int
+main(int argc ,char* argv[])
+{
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  parseTestOptions( argc ,argv ) ;
+  if ( verbose )
+    pout() << indent2 << "Beginning " << pgmname << endl ;
+
+  int stat_all = 0;
+  int status = testConservation();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 1." << endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 1 with return code "
+             << status << endl ;
+      stat_all = status ;
+    }
+
+  status = testAccuracy();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 2." << endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 2 with return code "
+             << status << endl ;
+      stat_all = status ;
+    }
+
+  status = testUniform();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 3." << endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 3 with return code "
+             << status << endl ;
+      stat_all = status ;
+    }
+
+  status = testSmallSteps();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 4." << endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 4 with return code "
+             << status << endl ;
+      stat_all = status ;
+    }
+
+  if ( stat_all == 0 )
+    pout() << indent << pgmname << ": passed all tests." << endl ;
+  else
+    pout() << indent << pgmname << ": failed one or more tests." << endl ;
+
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+  return stat_all ;
+}
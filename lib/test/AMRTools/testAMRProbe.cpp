@@ -0,0 +1,306 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+// samples a two level hierarchy holding a linear function and the level
+// number with an AMRProbe, before and after moving the fine level, and
+// checks the interpolated values, the level each point was taken from
+// and what the HDF5 time series holds.
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include "AMRProbe.H"
+#include "BRMeshRefine.H"
+#include "BoxIterator.H"
+#include "LoadBalance.H"
+#include "CH_HDF5.H"
+#include "UsingNamespace.H"
+
+/// Prototypes:
+int
+testAMRProbe();
+
+void
+parseTestOptions(int argc ,char* argv[]) ;
+
+/// Global variables for handling output:
+static const char* pgmname = "testAMRProbe" ;
+static const char* indent = "   ";
+static const char* indent2 = "      " ;
+static bool verbose = true ;
+static const Real tolerance = 1.0e-12;
+
+int
+main(int argc ,char* argv[])
+{
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  parseTestOptions( argc ,argv ) ;
+  if ( verbose )
+    pout() << indent2 << "Beginning " << pgmname << " ..." << endl ;
+
+  int status = testAMRProbe() ;
+
+  if ( status == 0 )
+    pout() << indent << pgmname << " passed." << endl ;
+  else
+    pout() << indent << pgmname << " failed with return code " << status << endl ;
+
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+  return status ;
+}
+
+static Real
+linearFunction(const RealVect& a_x)
+{
+  Real val = 1.0;
+  for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      val += (idir + 1)*a_x[idir];
+    }
+  return val;
+}
+
+// component 0 is the linear function, component 1 the level
+static void
+defineLevel(LevelData<FArrayBox>& a_data,
+            const Box&            a_box,
+            Real                  a_dx,
+            int                   a_level)
+{
+  Vector<Box> boxes;
+  domainSplit(a_box, boxes, 8);
+  Vector<int> procs;
+  LoadBalance(procs, boxes);
+  DisjointBoxLayout grids(boxes, procs);
+  a_data.define(grids, 2);
+  for (DataIterator dit = grids.dataIterator(); dit.ok(); ++dit)
+    {
+      FArrayBox& fab = a_data[dit()];
+      for (BoxIterator bit(grids[dit()]); bit.ok(); ++bit)
+        {
+          RealVect x = (RealVect(bit()) + 0.5*RealVect::Unit)*a_dx;
+          fab(bit(), 0) = linearFunction(x);
+          fab(bit(), 1) = a_level;
+        }
+    }
+}
+
+// checks the values of the points in set a_set against a_level, the level
+// expected for each point
+static int
+checkSet(const AMRProbe&     a_probe,
+         const Vector<Real>& a_values,
+         int                 a_set,
+         const Vector<int>&  a_level)
+{
+  for (int i = 0; i < a_probe.setSize(a_set); i++)
+    {
+      int ipt = a_probe.setStart(a_set) + i;
+      Real exact = linearFunction(a_probe.points()[ipt]);
+      if ((Abs(a_values[2*ipt] - exact) > tolerance) ||
+          (a_values[2*ipt+1] != a_level[i]))
+        {
+          if ( verbose )
+            pout() << indent2 << a_probe.setName(a_set) << " point " << i
+                   << ": " << a_values[2*ipt] << " (" << exact << ") on level "
+                   << a_values[2*ipt+1] << " (" << a_level[i] << ")" << endl;
+          return 1;
+        }
+    }
+  return 0;
+}
+
+#ifdef CH_USE_HDF5
+static int
+readDataset(Vector<Real>& a_data, Vector<int>& a_dims,
+            hid_t a_file, const char* a_name)
+{
+#ifdef H516
+  hid_t dataset = H5Dopen(a_file, a_name);
+#else
+  hid_t dataset = H5Dopen2(a_file, a_name, H5P_DEFAULT);
+#endif
+  if (dataset < 0) return 1;
+  hid_t space = H5Dget_space(dataset);
+  hsize_t dims[3];
+  int rank = H5Sget_simple_extent_dims(space, dims, NULL);
+  a_dims.resize(rank);
+  int size = 1;
+  for (int i = 0; i < rank; i++)
+    {
+      a_dims[i] = dims[i];
+      size *= dims[i];
+    }
+  a_data.resize(size);
+  herr_t err = H5Dread(dataset, H5T_NATIVE_REAL, H5S_ALL, H5S_ALL,
+                       H5P_DEFAULT, &(a_data[0]));
+  H5Sclose(space);
+  H5Dclose(dataset);
+  return (err < 0) ? 2 : 0;
+}
+#endif
+
+int
+testAMRProbe()
+{
+  // level 0 is 16^D cells on the unit cube, level 1 refines the middle half
+  Box domain(IntVect::Zero, 15*IntVect::Unit);
+  Real dx = 1.0/16;
+  Vector<int> refRatios(1, 2);
+  Vector<LevelData<FArrayBox>*> data(2);
+  data[0] = new LevelData<FArrayBox>;
+  data[1] = new LevelData<FArrayBox>;
+  defineLevel(*data[0], domain, dx, 0);
+  defineLevel(*data[1], refine(Box(4*IntVect::Unit, 11*IntVect::Unit), 2), dx/2, 1);
+
+  AMRProbe probe(ProblemDomain(domain), dx);
+  probe.addPoint("center", 0.5*RealVect::Unit);
+  probe.addPoint("corner", 0.1*RealVect::Unit);
+  probe.addLine("diagonal", 0.1*RealVect::Unit, 0.9*RealVect::Unit, 9);
+  probe.addPlane("plane", 0.3*RealVect::Unit, 0.4*BASISREALV(0), 0.4*BASISREALV(1), 3, 3);
+  if ((probe.numSets() != 4) || (probe.numPoints() != 20))
+    {
+      return 1;
+    }
+
+  int retval = 0;
+  Vector<Real> first;
+  probe.sample(first, data, refRatios, Interval(0, 1));
+  if (procID() == 0)
+    {
+      // the fine level holds the stencils of the points in [0.3,0.7]
+      Vector<int> diagonal(9, 0);
+      for (int i = 2; i <= 6; i++)
+        {
+          diagonal[i] = 1;
+        }
+      if ((checkSet(probe, first, 0, Vector<int>(1, 1)) != 0) ||
+          (checkSet(probe, first, 1, Vector<int>(1, 0)) != 0) ||
+          (checkSet(probe, first, 2, diagonal) != 0) ||
+          (checkSet(probe, first, 3, Vector<int>(9, 1)) != 0))
+        {
+          retval = 2;
+        }
+    }
+
+  // regrid: the fine level moves to the low corner
+  delete data[1];
+  data[1] = new LevelData<FArrayBox>;
+  defineLevel(*data[1], refine(Box(IntVect::Zero, 3*IntVect::Unit), 2), dx/2, 1);
+  Vector<Real> second;
+  probe.sample(second, data, refRatios, Interval(0, 1));
+  if (procID() == 0)
+    {
+      Vector<int> diagonal(9, 0);
+      diagonal[0] = 1;
+      diagonal[1] = 1;
+      if ((checkSet(probe, second, 0, Vector<int>(1, 0)) != 0) ||
+          (checkSet(probe, second, 1, Vector<int>(1, 1)) != 0) ||
+          (checkSet(probe, second, 2, diagonal) != 0) ||
+          (checkSet(probe, second, 3, Vector<int>(9, 0)) != 0))
+        {
+          retval = 3;
+        }
+    }
+
+#ifdef CH_USE_HDF5
+  const char* filename = "testAMRProbe.h5";
+  Vector<std::string> names(2);
+  names[0] = "linear";
+  names[1] = "level";
+  if ((probe.createTimeSeries(filename, names) != 0) ||
+      (probe.appendTimeSeries(filename, 1, 0.1, first) != 0) ||
+      (probe.appendTimeSeries(filename, 2, 0.2, second) != 0))
+    {
+      retval = 4;
+    }
+  if (procID() == 0)
+    {
+      hid_t file = H5Fopen(filename, H5F_ACC_RDONLY, H5P_DEFAULT);
+      Vector<Real> values, time, points;
+      Vector<int> dims, timeDims, pointDims;
+      if ((file < 0) ||
+          (readDataset(values, dims, file, "diagonal/data") != 0) ||
+          (readDataset(time, timeDims, file, "time") != 0) ||
+          (readDataset(points, pointDims, file, "plane/points") != 0))
+        {
+          retval = 5;
+        }
+      else if ((dims.size() != 3) || (dims[0] != 2) || (dims[1] != 9) || (dims[2] != 2) ||
+               (timeDims[0] != 2) || (time[0] != 0.1) || (time[1] != 0.2) ||
+               (pointDims[0] != 9) || (pointDims[1] != SpaceDim))
+        {
+          retval = 6;
+        }
+      else
+        {
+          int start = 2*probe.setStart(2);
+          for (int i = 0; i < 18; i++)
+            {
+              if ((values[i] != first[start + i]) || (values[18 + i] != second[start + i]))
+                {
+                  retval = 7;
+                }
+            }
+          for (int idir = 0; idir < SpaceDim; idir++)
+            {
+              if (points[SpaceDim*8 + idir] != probe.points()[probe.setStart(3) + 8][idir])
+                {
+                  retval = 8;
+                }
+            }
+        }
+      if (file >= 0)
+        {
+          H5Fclose(file);
+        }
+      std::remove(filename);
+    }
+#endif
+
+  delete data[0];
+  delete data[1];
+  return retval;
+}
+
+///
+// Parse the standard test options (-v -q) out of the command line.
+// Stop parsing when a non-option argument is found.
+///
+void
+parseTestOptions( int argc ,char* argv[] )
+{
+  for ( int i = 1 ; i < argc ; ++i )
+    {
+      if ( argv[i][0] == '-' ) //if it is an option
+        {
+          // compare 3 chars to differentiate -x from -xx
+          if ( strncmp( argv[i] ,"-v" ,3 ) == 0 )
+            {
+              verbose = true ;
+            }
+          else if ( strncmp( argv[i] ,"-q" ,3 ) == 0 )
+            {
+              verbose = false ;
+            }
+          else
+            {
+              break ;
+            }
+        }
+    }
+  return ;
+}
@@ -0,0 +1,188 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+// Test program for the kernel performance counters
+// Test 1: CH_FLOPS and CH_BYTES go to the counts of the calling thread,
+//         which add up exactly over the threads.
+// Test 2: the hardware counters either are unavailable and read as zero, or
+//         count cycles and instructions monotonically.
+
+#include <cstring>
+#include <iostream>
+
+#include "CH_Timer.H"
+#include "CH_Counters.H"
+#include "parstream.H"
+#ifdef CH_MPI
+#include "mpi.h"
+#endif
+
+#include "UsingBaseNamespace.H"
+
+/// Global variables for handling output:
+static const char* pgmname = "testKernelCounters" ;
+static const char* indent = "   ";
+static const char* indent2 = "      " ;
+static bool verbose = true ;
+
+static double
+work()
+{
+  volatile double x = 0;
+  for (int i = 0; i < 100000; i++)
+    {
+      x += i*0.5;
+    }
+  return x;
+}
+
+int
+testAnnotations()
+{
+  const int n = 10000;
+  long long int flops = 0;
+  long long int bytes = 0;
+#pragma omp parallel reduction(+:flops,bytes)
+  {
+    long long int flops0 = ch_allFlops();
+    long long int bytes0 = ch_bytes();
+#pragma omp for
+    for (int i = 0; i < n; i++)
+      {
+        ch_countFlops(3);
+        ch_countBytes(i);
+      }
+    flops += ch_allFlops() - flops0;
+    bytes += ch_bytes() - bytes0;
+  }
+
+  if (flops != 3*n) return 1;
+  if (bytes != (long long int)n*(n-1)/2) return 2;
+
+  return 0;
+}
+
+int
+testHardwareCounters()
+{
+  long long int before[HW_NCOUNTERS], after[HW_NCOUNTERS];
+
+  if (!hwCountersInit())
+    {
+      if (hwCountersOn()) return 1;
+      hwCountersRead(after);
+      for (int i = 0; i < HW_NCOUNTERS; i++)
+        {
+          if (after[i] != 0) return 2;
+        }
+      if (verbose)
+        {
+          pout() << indent2 << "hardware counters are not available" << std::endl;
+        }
+      return 0;
+    }
+
+  if (!hwCountersOn()) return 3;
+  hwCountersRead(before);
+  work();
+  hwCountersRead(after);
+
+  for (int i = 0; i < HW_NCOUNTERS; i++)
+    {
+      if (after[i] < before[i]) return 4;
+    }
+  if (after[HW_INSTRUCTIONS] - before[HW_INSTRUCTIONS] < 100000) return 5;
+  if (hwCacheLineSize <= 0) return 6;
+
+  if (verbose)
+    {
+      for (int i = 0; i < HW_NCOUNTERS; i++)
+        {
+          pout() << indent2 << hwCounterName(i) << ": "
+                 << after[i] - before[i] << std::endl;
+        }
+    }
+  return 0;
+}
+
+///
+// Parse the standard test options (-v -q -h) out of the command line
+///
+void
+parseTestOptions( int argc ,char* argv[] )
+{
+  for ( int i = 1 ; i < argc ; ++i )
+    {
+      if ( argv[i][0] == '-' ) //if it is an option
+        {
+          // compare 3 chars to differentiate -x from -xx
+          if ( strncmp( argv[i] ,"-v" ,3 ) == 0 )
+            {
+              verbose = true ;
+            }
+          else if ( strncmp( argv[i] ,"-q" ,3 ) == 0 )
+            {
+              verbose = false ;
+            }
+          else if ( strncmp( argv[i] ,"-h" ,3 ) == 0 )
+            {
+              pout() << "usage: " << pgmname << " [-hqv]" << std::endl ;
+              exit( 99 ) ;
+            }
+        }
+    }
+  return;
+}
+
+int
+main(int argc ,char* argv[])
+{
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  parseTestOptions( argc ,argv ) ;
+  if ( verbose )
+    pout() << indent2 << "Beginning " << pgmname << std::endl ;
+
+  int stat_all = 0;
+  int status = testAnnotations();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 1." << std::endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 1 with return code "
+             << status << std::endl ;
+      stat_all = status ;
+    }
+
+  status = testHardwareCounters();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 2." << std::endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 2 with return code "
+             << status << std::endl ;
+      stat_all = status ;
+    }
+
+  if ( stat_all == 0 )
+    pout() << indent << pgmname << ": passed all tests." << std::endl ;
+  else
+    pout() << indent << pgmname << ": failed one or more tests." << std::endl ;
+
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+  return stat_all ;
+}
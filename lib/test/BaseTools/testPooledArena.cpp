@@ -0,0 +1,302 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+// Test program for the pooled arena PArena
+// Test 1: size classes are increasing and fit the requests they are made for.
+// Test 2: without pooling every block goes back to the system; with pooling
+//         freed blocks are reused and the cache limit is respected.
+// Test 3: frames keep the cached blocks for the next step, count the ones
+//         left in use, and releaseAll returns the cached blocks.
+// Test 4: allocating and freeing from many threads keeps the counts exact.
+
+#include <cstring>
+#include <iostream>
+using std::endl;
+
+#include "Arena.H"
+#include "Vector.H"
+#include "parstream.H"
+#ifdef CH_MPI
+#include "mpi.h"
+#endif
+
+#include "UsingBaseNamespace.H"
+
+/// Global variables for handling output:
+static const char* pgmname = "testPooledArena" ;
+static const char* indent = "   ";
+static const char* indent2 = "      " ;
+static bool verbose = true ;
+
+int
+testSizeClasses()
+{
+  for (int c = 0; c < PArena::NumClasses; c++)
+    {
+      size_t bytes = PArena::classBytes(c);
+      if (PArena::sizeClass(bytes) != c) return 1;
+      if (c > 0)
+        {
+          size_t lower = PArena::classBytes(c-1);
+          if (bytes <= lower) return 2;
+          if (PArena::sizeClass(lower + 1) != c) return 3;
+          // Never more than 25% wasted
+          if (4*(bytes - lower) > lower) return 4;
+        }
+    }
+  if (PArena::sizeClass(1) != 0) return 5;
+  size_t largest = PArena::classBytes(PArena::NumClasses - 1);
+  if (PArena::sizeClass(largest + 1) != -1) return 6;
+
+  return 0;
+}
+
+int
+testPooling()
+{
+  PArena arena("testPooling");
+
+  // No pooling
+  PArena::setPooling(false);
+  void* a = arena.alloc(1000);
+  if (arena.liveBlocks() != 1) return 1;
+  arena.free(a);
+  if ((arena.cachedBytes() != 0) || (arena.heldBytes() != 0)) return 2;
+
+  // Pooling: the block comes back
+  PArena::setPooling(true);
+  a = arena.alloc(1000);
+  memset(a, 1, 1000);
+  arena.free(a);
+  if (arena.cachedBytes() == 0) return 3;
+  void* b = arena.alloc(900);
+  if (b != a) return 4;
+  if ((arena.hits() != 1) || (arena.misses() != 1)) return 5;
+
+  // A block from before pooling was switched off can still be freed
+  PArena::setPooling(false);
+  if (arena.cachedBytes() != 0) return 6;
+  arena.free(b);
+  if (arena.heldBytes() != 0) return 7;
+  PArena::setPooling(true);
+
+  // The cache limit
+  long long maxCached = PArena::maxCachedBytes();
+  PArena::setMaxCachedBytes(10000);
+  Vector<void*> blocks;
+  for (int i = 0; i < 10; i++)
+    {
+      blocks.push_back(arena.alloc(3000));
+    }
+  for (int i = 0; i < blocks.size(); i++)
+    {
+      arena.free(blocks[i]);
+    }
+  if ((arena.cachedBytes() > 10000) || (arena.cachedBytes() == 0)) return 8;
+  if (arena.heldBytes() != arena.cachedBytes()) return 9;
+  if (arena.peakHeldBytes() < 30000) return 10;
+  PArena::setMaxCachedBytes(maxCached);
+
+  arena.release();
+  if ((arena.cachedBytes() != 0) || (arena.heldBytes() != 0)) return 11;
+  if (arena.liveBlocks() != 0) return 12;
+
+  if (verbose)
+    {
+      pout() << indent2 << arena.hits() << " hits, " << arena.misses()
+             << " misses" << endl;
+    }
+  PArena::setPooling(false);
+  return 0;
+}
+
+int
+testFrames()
+{
+  PArena arena("testFrames");
+  PArena::setPooling(true);
+
+  void* outside = arena.alloc(500);
+  void* kept = NULL;
+  {
+    ArenaFrame frame;
+    for (int step = 0; step < 3; step++)
+      {
+        ArenaFrame inner;
+        void* tmp1 = arena.alloc(2000);
+        void* tmp2 = arena.alloc(5000);
+        arena.free(tmp1);
+        arena.free(tmp2);
+      }
+    if (arena.cachedBytes() == 0) return 1;
+    if (arena.misses() != 3) return 2;
+    kept = arena.alloc(700);
+    if (PArena::frameDepth() != 1) return 3;
+  }
+  if (PArena::frameDepth() != 0) return 4;
+  if (arena.frameLeftover() != 1) return 6;
+
+  // The next step is served from the blocks of the last one
+  long long misses = arena.misses();
+  {
+    ArenaFrame frame;
+    void* tmp1 = arena.alloc(2000);
+    void* tmp2 = arena.alloc(5000);
+    arena.free(tmp1);
+    arena.free(tmp2);
+  }
+  if (arena.misses() != misses) return 5;
+  if (arena.frameLeftover() != 0) return 10;
+
+  PArena::releaseAll();
+  if (arena.cachedBytes() != 0) return 11;
+
+  arena.free(kept);
+  arena.free(outside);
+  if (arena.heldBytes() != arena.cachedBytes()) return 7;
+
+  PArena::setPooling(false);
+  if (arena.heldBytes() != 0) return 8;
+  return 0;
+}
+
+int
+testThreads()
+{
+  PArena arena("testThreads");
+  PArena::setPooling(true);
+
+  const int n = 2000;
+  long long errors = 0;
+#pragma omp parallel for reduction(+:errors)
+  for (int i = 0; i < n; i++)
+    {
+      size_t bytes = 100 + 37*(i%50);
+      char* a = static_cast<char*>(arena.alloc(bytes));
+      char* b = static_cast<char*>(arena.alloc(2*bytes));
+      memset(a, i%127, bytes);
+      memset(b, i%127, 2*bytes);
+      for (size_t j = 0; j < bytes; j++)
+        {
+          if (a[j] != b[2*j]) errors++;
+        }
+      arena.free(b);
+      arena.free(a);
+    }
+  if (errors != 0) return 1;
+  if (arena.liveBlocks() != 0) return 2;
+  if (arena.hits() + arena.misses() != 2*n) return 3;
+  if (arena.heldBytes() != arena.cachedBytes()) return 4;
+
+  arena.release();
+  if (arena.heldBytes() != 0) return 5;
+
+  PArena::setPooling(false);
+  return 0;
+}
+
+///
+// Parse the standard test options (-v -q -h) out of the command line
+///
+void
+parseTestOptions( int argc ,char* argv[] )
+{
+  for ( int i = 1 ; i < argc ; ++i )
+    {
+      if ( argv[i][0] == '-' ) //if it is an option
+        {
+          // compare 3 chars to differentiate -x from -xx
+          if ( strncmp( argv[i] ,"-v" ,3 ) == 0 )
+            {
+              verbose = true ;
+            }
+          else if ( strncmp( argv[i] ,"-q" ,3 ) == 0 )
+            {
+              verbose = false ;
+            }
+          else if ( strncmp( argv[i] ,"-h" ,3 ) == 0 )
+            {
+              pout() << "usage: " << pgmname << " [-hqv]" << std::endl ;
+              exit( 99 ) ;
+            }
+        }
+    }
+  return;
+}
+
+int
+main(int argc ,char* argv[])
+{
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  parseTestOptions( argc ,argv ) ;
+  if ( verbose )
+    pout() << indent2 << "Beginning " << pgmname << endl ;
+
+  int stat_all = 0;
+  int status = testSizeClasses();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 1." << endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 1 with return code "
+             << status << endl ;
+      stat_all = status ;
+    }
+
+  status = testPooling();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 2." << endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 2 with return code "
+             << status << endl ;
+      stat_all = status ;
+    }
+
+  status = testFrames();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 3." << endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 3 with return code "
+             << status << endl ;
+      stat_all = status ;
+    }
+
+  status = testThreads();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 4." << endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 4 with return code "
+             << status << endl ;
+      stat_all = status ;
+    }
+
+  if ( stat_all == 0 )
+    pout() << indent << pgmname << ": passed all tests." << endl ;
+  else
+    pout() << indent << pgmname << ": failed one or more tests." << endl ;
+
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+  return stat_all ;
+}
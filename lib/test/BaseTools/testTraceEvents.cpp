@@ -0,0 +1,258 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+// Test program for TraceEvents
+// Test 1: nested regions are recorded per thread with consistent time stamps.
+// Test 2: full buffers drop events and sampling keeps every n-th event.
+// Test 3: the Chrome trace output has one complete event per region.
+
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "CH_TraceEvents.H"
+#include "CH_Thread.H"
+#include "parstream.H"
+#ifdef CH_MPI
+#include "mpi.h"
+#endif
+
+#include "UsingBaseNamespace.H"
+
+/// Global variables for handling output:
+static const char* pgmname = "testTraceEvents" ;
+static const char* indent = "   ";
+static const char* indent2 = "      " ;
+static bool verbose = true ;
+
+static void
+work()
+{
+  volatile double x = 0;
+  for (int i = 0; i < 1000; i++)
+    {
+      x += i*0.5;
+    }
+}
+
+int
+testNesting()
+{
+  TraceEvents::enable(100);
+
+  TraceEvents::begin("outer");
+  work();
+  TraceEvents::begin("inner");
+  work();
+  TraceEvents::end();
+  TraceEvents::end();
+
+  if (TraceEvents::numEvents(0) != 2) return 1;
+
+  // Events are stored in the order they end
+  const std::vector<TraceEvents::Event>& ev = TraceEvents::events(0);
+  const TraceEvents::Event& inner = ev[0];
+  const TraceEvents::Event& outer = ev[1];
+  if (strcmp(inner.m_name, "inner") != 0) return 2;
+  if (strcmp(outer.m_name, "outer") != 0) return 3;
+  if (inner.m_depth != 1 || outer.m_depth != 0) return 4;
+  if (inner.m_begin < outer.m_begin || inner.m_end > outer.m_end) return 5;
+  if (inner.m_begin > inner.m_end) return 6;
+
+  // Each thread records into its own buffer
+  int numThreads = getMaxThreads();
+#pragma omp parallel
+  {
+    AutoTraceEvent autotrace("threaded", true);
+    work();
+  }
+  for (int tid = 0; tid < numThreads; tid++)
+    {
+      int expected = (tid == 0) ? 3 : 1;
+      if (TraceEvents::numEvents(tid) != expected) return 7;
+    }
+  if (TraceEvents::numDropped() != 0) return 8;
+
+  TraceEvents::disable();
+  if (TraceEvents::on()) return 9;
+
+  if (verbose)
+    {
+      pout() << indent2 << numThreads << " thread(s), inner region "
+             << inner.m_end - inner.m_begin << " ticks" << std::endl;
+    }
+  return 0;
+}
+
+int
+testLimits()
+{
+  TraceEvents::enable(4);
+  for (int i = 0; i < 10; i++)
+    {
+      TraceEvents::begin("small");
+      TraceEvents::end();
+    }
+  if (TraceEvents::numEvents(0) != 4) return 1;
+  if (TraceEvents::numDropped() != 6) return 2;
+
+  TraceEvents::clear();
+  if (TraceEvents::numEvents(0) != 0) return 3;
+  if (TraceEvents::numDropped() != 0) return 4;
+
+  TraceEvents::enable(100, 3);
+  for (int i = 0; i < 9; i++)
+    {
+      TraceEvents::begin("sampled");
+      TraceEvents::end();
+    }
+  if (TraceEvents::numEvents(0) != 3) return 5;
+  if (TraceEvents::numDropped() != 0) return 6;
+
+  // Unbalanced ends are ignored
+  TraceEvents::end();
+  if (TraceEvents::numEvents(0) != 3) return 7;
+
+  TraceEvents::disable();
+  return 0;
+}
+
+static int
+countOccurrences(const std::string& a_str, const std::string& a_sub)
+{
+  int n = 0;
+  size_t pos = a_str.find(a_sub);
+  while (pos != std::string::npos)
+    {
+      n++;
+      pos = a_str.find(a_sub, pos + 1);
+    }
+  return n;
+}
+
+int
+testChromeTrace()
+{
+  TraceEvents::enable(100);
+  TraceEvents::begin("LevelData::exchange");
+  TraceEvents::begin("MPI_Waitall");
+  work();
+  TraceEvents::end();
+  TraceEvents::begin("quoted \"label\"");
+  TraceEvents::end();
+  TraceEvents::end();
+
+  std::ostringstream os;
+  TraceEvents::writeChromeTrace(os, 3);
+  TraceEvents::disable();
+  const std::string json = os.str();
+
+  if (json.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[") != 0) return 1;
+  if (countOccurrences(json, "\"ph\":\"X\"") != 3) return 2;
+  if (countOccurrences(json, "\"cat\":\"mpi\"") != 1) return 3;
+  if (json.find("\"name\":\"quoted \\\"label\\\"\"") == std::string::npos) return 4;
+  if (countOccurrences(json, "\"pid\":3") != 4) return 5;
+  if (json.find("\"droppedEvents\":0") == std::string::npos) return 6;
+  if (json[json.size()-2] != '}') return 7;
+
+  if (verbose)
+    {
+      pout() << indent2 << json.size() << " bytes of trace" << std::endl;
+    }
+  return 0;
+}
+
+///
+// Parse the standard test options (-v -q -h) out of the command line
+///
+void
+parseTestOptions( int argc ,char* argv[] )
+{
+  for ( int i = 1 ; i < argc ; ++i )
+    {
+      if ( argv[i][0] == '-' ) //if it is an option
+        {
+          // compare 3 chars to differentiate -x from -xx
+          if ( strncmp( argv[i] ,"-v" ,3 ) == 0 )
+            {
+              verbose = true ;
+            }
+          else if ( strncmp( argv[i] ,"-q" ,3 ) == 0 )
+            {
+              verbose = false ;
+            }
+          else if ( strncmp( argv[i] ,"-h" ,3 ) == 0 )
+            {
+              pout() << "usage: " << pgmname << " [-hqv]" << std::endl ;
+              exit( 99 ) ;
+            }
+        }
+    }
+  return;
+}
+
+int
+main(int argc ,char* argv[])
+{
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  parseTestOptions( argc ,argv ) ;
+  if ( verbose )
+    pout() << indent2 << "Beginning " << pgmname << std::endl ;
+
+  int stat_all = 0;
+  int status = testNesting();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 1." << std::endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 1 with return code "
+             << status << std::endl ;
+      stat_all = status ;
+    }
+
+  status = testLimits();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 2." << std::endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 2 with return code "
+             << status << std::endl ;
+      stat_all = status ;
+    }
+
+  status = testChromeTrace();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 3." << std::endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 3 with return code "
+             << status << std::endl ;
+      stat_all = status ;
+    }
+
+  if ( stat_all == 0 )
+    pout() << indent << pgmname << ": passed all tests." << std::endl ;
+  else
+    pout() << indent << pgmname << ": failed one or more tests." << std::endl ;
+
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+  return stat_all ;
+}
@@ -0,0 +1,315 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+// writes a level through writeLevel with contiguous, chunked lossless and
+// chunked lossy (per component error bound) layouts, and checks what
+// readLevel gets back, the dataset layout and the file sizes.  a handle
+// that takes the default compression, as checkpoint files do, must
+// write exactly.
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "CH_HDF5.H"
+#include "BRMeshRefine.H"
+#include "BoxIterator.H"
+#include "DisjointBoxLayout.H"
+#include "LoadBalance.H"
+#include "UsingNamespace.H"
+
+void
+parseTestOptions( int argc ,char* argv[] ) ;
+
+int
+test();
+
+/// Global variables for handling output:
+static const char *pgmname = "HDF5compression" ;
+static const char *indent = "   ", *indent2 = "      " ;
+static bool verbose = true ;
+
+/// Code:
+
+int
+main(int argc, char* argv[])
+{
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  parseTestOptions( argc ,argv ) ;
+
+  if ( verbose )
+    pout() << indent2 << "Beginning " << pgmname << " ..." << endl ;
+
+  int icode = test();
+  if (icode != 0)
+    {
+      pout() << indent << pgmname <<" failed with code " << icode << endl;
+    }
+  else
+    {
+      pout() << indent << pgmname <<" passed"<<endl;
+    }
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+  return icode;
+}
+
+#ifdef CH_USE_HDF5
+
+static const int s_ncomp = 3;
+
+static Real
+exactValue(const IntVect& a_iv, int a_comp)
+{
+  Real val = a_comp;
+  for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      val += sin(0.1*(idir+1)*a_iv[idir] + 0.3*a_comp);
+    }
+  return val;
+}
+
+static void
+writeFile(const char* a_filename,
+          const LevelData<FArrayBox>& a_data,
+          const Box& a_domain,
+          const HDF5Compression& a_compression,
+          const Vector<Real>& a_errorBounds = Vector<Real>())
+{
+  HDF5Handle handle(a_filename, HDF5Handle::CREATE);
+  handle.setCompression(a_compression);
+  writeLevel(handle, 0, a_data, 1.0, 1.0, 0.0, a_domain, 2,
+             IntVect::Zero, Interval(), a_errorBounds);
+  handle.close();
+}
+
+// largest error of each component after a round trip through a_filename
+static int
+readFile(Vector<Real>& a_maxError,
+         const char* a_filename,
+         const DisjointBoxLayout& a_grids)
+{
+  HDF5Handle handle(a_filename, HDF5Handle::OPEN_RDONLY);
+  LevelData<FArrayBox> data;
+  Real dx, dt, time;
+  Box domain;
+  int refRatio;
+  int error = readLevel(handle, 0, data, dx, dt, time, domain, refRatio);
+  handle.close();
+  if (error != 0)
+    {
+      return error;
+    }
+
+  a_maxError = Vector<Real>(s_ncomp, 0.);
+  for (DataIterator dit = data.dataIterator(); dit.ok(); ++dit)
+    {
+      const FArrayBox& fab = data[dit()];
+      for (BoxIterator bit(data.box(dit())); bit.ok(); ++bit)
+        {
+          for (int comp = 0; comp < s_ncomp; comp++)
+            {
+              Real diff = Abs(fab(bit(), comp) - exactValue(bit(), comp));
+              a_maxError[comp] = Max(a_maxError[comp], diff);
+            }
+        }
+    }
+#ifdef CH_MPI
+  Vector<Real> localError = a_maxError;
+  MPI_Allreduce(&(localError[0]), &(a_maxError[0]), s_ncomp,
+                MPI_CH_REAL, MPI_MAX, Chombo_MPI::comm);
+#endif
+  return 0;
+}
+
+static bool
+isChunkedAndFiltered(const char* a_filename)
+{
+  HDF5Handle handle(a_filename, HDF5Handle::OPEN_RDONLY);
+  handle.setGroupToLevel(0);
+#ifdef H516
+  hid_t dataset = H5Dopen(handle.groupID(), "data:datatype=0");
+#else
+  hid_t dataset = H5Dopen2(handle.groupID(), "data:datatype=0", H5P_DEFAULT);
+#endif
+  hid_t dcpl = H5Dget_create_plist(dataset);
+  bool retval = (H5Pget_layout(dcpl) == H5D_CHUNKED);
+  if (H5Zfilter_avail(H5Z_FILTER_DEFLATE) > 0)
+    {
+      retval = retval && (H5Pget_nfilters(dcpl) > 0);
+    }
+  H5Pclose(dcpl);
+  H5Dclose(dataset);
+  handle.close();
+  return retval;
+}
+
+static long
+fileSize(const char* a_filename)
+{
+  std::ifstream file(a_filename, std::ios::binary | std::ios::ate);
+  return (long)file.tellg();
+}
+
+#endif // CH_USE_HDF5
+
+// returns 0 on all tests passed.
+
+int test()
+{
+#ifdef CH_USE_HDF5
+  Box domain(IntVect::Zero, 31*IntVect::Unit);
+  Vector<Box> boxes;
+  domainSplit(domain, boxes, 8);
+  Vector<int> procs;
+  LoadBalance(procs, boxes);
+  DisjointBoxLayout grids(boxes, procs);
+
+  LevelData<FArrayBox> data(grids, s_ncomp);
+  for (DataIterator dit = data.dataIterator(); dit.ok(); ++dit)
+    {
+      for (BoxIterator bit(grids.get(dit())); bit.ok(); ++bit)
+        {
+          for (int comp = 0; comp < s_ncomp; comp++)
+            {
+              data[dit()](bit(), comp) = exactValue(bit(), comp);
+            }
+        }
+    }
+
+  HDF5Compression plain;
+  HDF5Compression lossless;
+  lossless.m_deflate = 6;
+  Vector<Real> errorBounds(s_ncomp);
+  errorBounds[0] = 0;
+  errorBounds[1] = 1.0e-3;
+  errorBounds[2] = 1.0e-6;
+
+  writeFile("compressionPlain.h5",    data, domain, plain);
+  writeFile("compressionLossless.h5", data, domain, lossless);
+  writeFile("compressionLossy.h5",    data, domain, lossless, errorBounds);
+
+  // a checkpoint-like write through a handle with the default compression
+  HDF5Handle::setDefaultCompression(lossless);
+  {
+    HDF5Handle handle("compressionDefault.h5", HDF5Handle::CREATE);
+    writeLevel(handle, 0, data, 1.0, 1.0, 0.0, domain, 2);
+    handle.close();
+  }
+  HDF5Handle::setDefaultCompression(plain);
+
+  int retval = 0;
+  Vector<Real> maxError;
+  if (readFile(maxError, "compressionLossless.h5", grids) != 0)
+    {
+      return 1;
+    }
+  for (int comp = 0; comp < s_ncomp; comp++)
+    {
+      if (maxError[comp] != 0)
+        {
+          if ( verbose )
+            pout() << indent2 << "lossless component " << comp
+                   << " off by " << maxError[comp] << endl;
+          retval = 2;
+        }
+    }
+
+  if (readFile(maxError, "compressionLossy.h5", grids) != 0)
+    {
+      return 3;
+    }
+  for (int comp = 0; comp < s_ncomp; comp++)
+    {
+      if (maxError[comp] > errorBounds[comp])
+        {
+          if ( verbose )
+            pout() << indent2 << "lossy component " << comp
+                   << " off by " << maxError[comp] << endl;
+          retval = 4;
+        }
+    }
+
+  if (readFile(maxError, "compressionDefault.h5", grids) != 0)
+    {
+      return 7;
+    }
+  for (int comp = 0; comp < s_ncomp; comp++)
+    {
+      if (maxError[comp] != 0)
+        {
+          if ( verbose )
+            pout() << indent2 << "default compression rounded component "
+                   << comp << " by " << maxError[comp] << endl;
+          retval = 8;
+        }
+    }
+
+  if (procID() == 0)
+    {
+      if (!isChunkedAndFiltered("compressionLossless.h5") ||
+          !isChunkedAndFiltered("compressionDefault.h5"))
+        {
+          if ( verbose )
+            pout() << indent2 << "dataset is not chunked and filtered" << endl;
+          retval = 5;
+        }
+      if ((H5Zfilter_avail(H5Z_FILTER_DEFLATE) > 0) &&
+          (fileSize("compressionLossy.h5") >= fileSize("compressionPlain.h5")))
+        {
+          if ( verbose )
+            pout() << indent2 << "lossy file is not smaller: "
+                   << fileSize("compressionLossy.h5") << " vs "
+                   << fileSize("compressionPlain.h5") << endl;
+          retval = 6;
+        }
+      std::remove("compressionPlain.h5");
+      std::remove("compressionLossless.h5");
+      std::remove("compressionLossy.h5");
+      std::remove("compressionDefault.h5");
+    }
+  return retval;
+#else
+  return 0;
+#endif // CH_USE_HDF5
+}
+
+///
+// Parse the standard test options (-v -q) out of the command line.
+// Stop parsing when a non-option argument is found.
+///
+void
+parseTestOptions( int argc ,char* argv[] )
+{
+  for ( int i = 1 ; i < argc ; ++i )
+  {
+    if ( argv[i][0] == '-' ) //if it is an option
+    {
+      // compare 3 chars to differentiate -x from -xx
+      if ( strncmp( argv[i] ,"-v" ,3 ) == 0 )
+      {
+        verbose = true ;
+      }
+      else if ( strncmp( argv[i] ,"-q" ,3 ) == 0 )
+      {
+        verbose = false ;
+      }
+      else
+      {
+        break ;
+      }
+    }
+  }
+  return ;
+}
@@ -0,0 +1,271 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+// writes a level with writeLevel and reads regions of it, with a subset
+// of the components, through readRegion, with and without the box index.
+
+#include <cstdio>
+#include <cstring>
+
+#include "CH_HDF5.H"
+#include "BRMeshRefine.H"
+#include "BoxIterator.H"
+#include "IntVectSet.H"
+#include "LayoutIterator.H"
+#include "DisjointBoxLayout.H"
+#include "LoadBalance.H"
+#include "UsingNamespace.H"
+
+void
+parseTestOptions( int argc ,char* argv[] ) ;
+
+int
+test();
+
+/// Global variables for handling output:
+static const char *pgmname = "HDF5region" ;
+static const char *indent = "   ", *indent2 = "      " ;
+static bool verbose = true ;
+
+/// Code:
+
+int
+main(int argc, char* argv[])
+{
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  parseTestOptions( argc ,argv ) ;
+
+  if ( verbose )
+    pout() << indent2 << "Beginning " << pgmname << " ..." << endl ;
+
+  int icode = test();
+  if (icode != 0)
+    {
+      pout() << indent << pgmname <<" failed with code " << icode << endl;
+    }
+  else
+    {
+      pout() << indent << pgmname <<" passed"<<endl;
+    }
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+  return icode;
+}
+
+#ifdef CH_USE_HDF5
+
+static const int s_ncomp = 4;
+
+static Real
+exactValue(const IntVect& a_iv, int a_comp)
+{
+  Real val = 10*a_comp;
+  for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      val += (idir + 1)*a_iv[idir];
+    }
+  return val;
+}
+
+// reads a_comps on a_region and compares with exactValue on the cells of
+// a_region that are in a box of a_grids; the others must be left alone.
+static int
+checkRegion(const char* a_filename,
+            const Box& a_region,
+            const Interval& a_comps,
+            const DisjointBoxLayout& a_grids)
+{
+  const Real untouched = -1234.;
+  FArrayBox fab(a_region, a_comps.size());
+  fab.setVal(untouched);
+  HDF5Handle handle(a_filename, HDF5Handle::OPEN_RDONLY);
+  int error = readRegion(handle, fab, 0, a_region, a_comps);
+  handle.close();
+  if (error != 0)
+    {
+      if ( verbose )
+        pout() << indent2 << "readRegion returned " << error << endl;
+      return 1;
+    }
+
+  IntVectSet inGrids;
+  for (LayoutIterator lit = a_grids.layoutIterator(); lit.ok(); ++lit)
+    {
+      inGrids |= a_grids[lit()] & a_region;
+    }
+  for (BoxIterator bit(a_region); bit.ok(); ++bit)
+    {
+      for (int comp = 0; comp < a_comps.size(); comp++)
+        {
+          Real expected = inGrids.contains(bit()) ?
+            exactValue(bit(), a_comps.begin() + comp) : untouched;
+          if (fab(bit(), comp) != expected)
+            {
+              if ( verbose )
+                pout() << indent2 << "wrong value " << fab(bit(), comp)
+                       << " at " << bit() << " component " << comp << endl;
+              return 2;
+            }
+        }
+    }
+  return 0;
+}
+
+// removes the box index, as in files written before there was one.
+// returns false if there was no index to remove.
+static bool
+removeIndex(const char* a_filename)
+{
+  HDF5Handle handle(a_filename, HDF5Handle::OPEN_RDWR);
+  handle.setGroupToLevel(0);
+#ifdef H516
+  herr_t orderErr  = H5Gunlink(handle.groupID(), "boxes:mortonOrder");
+  herr_t boundsErr = H5Gunlink(handle.groupID(), "boxes:mortonBounds");
+#else
+  herr_t orderErr  = H5Ldelete(handle.groupID(), "boxes:mortonOrder", H5P_DEFAULT);
+  herr_t boundsErr = H5Ldelete(handle.groupID(), "boxes:mortonBounds", H5P_DEFAULT);
+#endif
+  handle.close();
+  return (orderErr >= 0) && (boundsErr >= 0);
+}
+
+#endif // CH_USE_HDF5
+
+// returns 0 on all tests passed.
+
+int test()
+{
+#ifdef CH_USE_HDF5
+  // the level covers the domain but for a hole in the middle, and has more
+  // boxes than one bin of the index
+  Box domain(IntVect::Zero, 63*IntVect::Unit);
+  Box hole(24*IntVect::Unit, 39*IntVect::Unit);
+  Vector<Box> splitBoxes, boxes;
+  domainSplit(domain, splitBoxes, 8);
+  for (int ibox = 0; ibox < splitBoxes.size(); ibox++)
+    {
+      if (!hole.contains(splitBoxes[ibox]))
+        {
+          boxes.push_back(splitBoxes[ibox]);
+        }
+    }
+  Vector<int> procs;
+  LoadBalance(procs, boxes);
+  DisjointBoxLayout grids(boxes, procs);
+
+  LevelData<FArrayBox> data(grids, s_ncomp, IntVect::Unit);
+  for (DataIterator dit = data.dataIterator(); dit.ok(); ++dit)
+    {
+      data[dit()].setVal(-1.);
+      for (BoxIterator bit(grids.get(dit())); bit.ok(); ++bit)
+        {
+          for (int comp = 0; comp < s_ncomp; comp++)
+            {
+              data[dit()](bit(), comp) = exactValue(bit(), comp);
+            }
+        }
+    }
+
+  const char* filename = "region.h5";
+  {
+    HDF5Handle handle(filename, HDF5Handle::CREATE);
+    writeLevel(handle, 0, data, 1.0, 1.0, 0.0, domain, 2, data.ghostVect());
+    handle.close();
+  }
+
+  // every rank reads the regions on its own; opening the file is collective
+  int retval = 0;
+  Box corner(IntVect::Zero, 5*IntVect::Unit);
+  Box straddle(3*IntVect::Unit, 28*IntVect::Unit);
+  Box inHole(26*IntVect::Unit, 30*IntVect::Unit);
+  Box outside(70*IntVect::Unit, 80*IntVect::Unit);
+  for (int pass = 0; pass < 2 && retval == 0; pass++)
+    {
+      if (pass == 1 && !removeIndex(filename))
+        {
+          if ( verbose )
+            pout() << indent2 << "the file has no box index" << endl;
+          retval = 40;
+          break;
+        }
+      int status = 0;
+      if ((status = checkRegion(filename, corner, Interval(0, s_ncomp-1), grids)) != 0 ||
+          (status = checkRegion(filename, straddle, Interval(2, 3), grids)) != 0 ||
+          (status = checkRegion(filename, inHole, Interval(1, 1), grids)) != 0 ||
+          (status = checkRegion(filename, outside, Interval(0, 1), grids)) != 0 ||
+          (status = checkRegion(filename, domain, Interval(3, 3), grids)) != 0)
+        {
+          if ( verbose )
+            pout() << indent2 << (pass ? "without" : "with")
+                   << " the box index, failed" << endl;
+          retval = 10*(pass + 1) + status;
+        }
+    }
+
+  FArrayBox fab;
+  HDF5Handle handle(filename, HDF5Handle::OPEN_RDONLY);
+  std::string group = handle.getGroup();
+  if (readRegion(handle, fab, 0, corner, Interval(s_ncomp-1, s_ncomp)) != 1)
+    {
+      if ( verbose )
+        pout() << indent2 << "components past the end were not rejected" << endl;
+      retval = 30;
+    }
+  if (handle.getGroup() != group)
+    {
+      if ( verbose )
+        pout() << indent2 << "a failed read left the handle in " << handle.getGroup() << endl;
+      retval = 31;
+    }
+  handle.close();
+#ifdef CH_MPI
+  MPI_Barrier(Chombo_MPI::comm);
+#endif
+  if (procID() == 0)
+    {
+      std::remove(filename);
+    }
+  return retval;
+#else
+  return 0;
+#endif // CH_USE_HDF5
+}
+
+///
+// Parse the standard test options (-v -q) out of the command line.
+// Stop parsing when a non-option argument is found.
+///
+void
+parseTestOptions( int argc ,char* argv[] )
+{
+  for ( int i = 1 ; i < argc ; ++i )
+  {
+    if ( argv[i][0] == '-' ) //if it is an option
+    {
+      // compare 3 chars to differentiate -x from -xx
+      if ( strncmp( argv[i] ,"-v" ,3 ) == 0 )
+      {
+        verbose = true ;
+      }
+      else if ( strncmp( argv[i] ,"-q" ,3 ) == 0 )
+      {
+        verbose = false ;
+      }
+      else
+      {
+        break ;
+      }
+    }
+  }
+  return ;
+}
@@ -0,0 +1,259 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+// writes a level and reads it back the way a restart does: the boxes and
+// the ranks that wrote them through readLayout, and the data through read
+// onto layouts with the written ranks (modulo the number of ranks) and with
+// every box moved to another rank.
+
+#include <cstdio>
+#include <cstring>
+
+#include "CH_HDF5.H"
+#include "BRMeshRefine.H"
+#include "BoxIterator.H"
+#include "DisjointBoxLayout.H"
+#include "LoadBalance.H"
+#include "UsingNamespace.H"
+
+void
+parseTestOptions( int argc ,char* argv[] ) ;
+
+int
+test();
+
+/// Global variables for handling output:
+static const char *pgmname = "HDF5restart" ;
+static const char *indent = "   ", *indent2 = "      " ;
+static bool verbose = true ;
+
+/// Code:
+
+int
+main(int argc, char* argv[])
+{
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  parseTestOptions( argc ,argv ) ;
+
+  if ( verbose )
+    pout() << indent2 << "Beginning " << pgmname << " ..." << endl ;
+
+  int icode = test();
+  if (icode != 0)
+    {
+      pout() << indent << pgmname <<" failed with code " << icode << endl;
+    }
+  else
+    {
+      pout() << indent << pgmname <<" passed"<<endl;
+    }
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+  return icode;
+}
+
+#ifdef CH_USE_HDF5
+
+static const int s_ncomp = 2;
+
+static Real
+exactValue(const IntVect& a_iv, int a_comp)
+{
+  Real val = 100*a_comp;
+  for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      val += (idir + 1)*a_iv[idir];
+    }
+  return val;
+}
+
+// number of valid and ghost cells of a_data that differ from exactValue
+static long
+countWrong(const LevelData<FArrayBox>& a_data)
+{
+  long wrong = 0;
+  for (DataIterator dit = a_data.dataIterator(); dit.ok(); ++dit)
+    {
+      const FArrayBox& fab = a_data[dit()];
+      for (BoxIterator bit(fab.box()); bit.ok(); ++bit)
+        {
+          for (int comp = 0; comp < s_ncomp; comp++)
+            {
+              if (fab(bit(), comp) != exactValue(bit(), comp))
+                {
+                  wrong++;
+                }
+            }
+        }
+    }
+#ifdef CH_MPI
+  long localWrong = wrong;
+  MPI_Allreduce(&localWrong, &wrong, 1, MPI_LONG, MPI_SUM, Chombo_MPI::comm);
+#endif
+  return wrong;
+}
+
+static int
+readOnto(HDF5Handle& a_handle,
+         const Vector<Box>& a_boxes,
+         const Vector<int>& a_procs,
+         const Box& a_domain)
+{
+  DisjointBoxLayout grids(a_boxes, a_procs, ProblemDomain(a_domain));
+  LevelData<FArrayBox> data(grids, s_ncomp, IntVect::Unit);
+  int error = read<FArrayBox>(a_handle, data, "data", grids, Interval(), false);
+  if (error != 0)
+    {
+      return error;
+    }
+  long wrong = countWrong(data);
+  if (wrong != 0)
+    {
+      if ( verbose )
+        pout() << indent2 << wrong << " values read back wrong" << endl;
+      return 1;
+    }
+  return 0;
+}
+
+#endif // CH_USE_HDF5
+
+// returns 0 on all tests passed.
+
+int test()
+{
+#ifdef CH_USE_HDF5
+  Box domain(IntVect::Zero, 31*IntVect::Unit);
+  Vector<Box> boxes;
+  domainSplit(domain, boxes, 8);
+  Vector<int> procs;
+  LoadBalance(procs, boxes);
+  DisjointBoxLayout grids(boxes, procs, ProblemDomain(domain));
+
+  // the ghost cells are written too, and hold exactValue as well
+  LevelData<FArrayBox> data(grids, s_ncomp, IntVect::Unit);
+  for (DataIterator dit = data.dataIterator(); dit.ok(); ++dit)
+    {
+      FArrayBox& fab = data[dit()];
+      for (BoxIterator bit(fab.box()); bit.ok(); ++bit)
+        {
+          for (int comp = 0; comp < s_ncomp; comp++)
+            {
+              fab(bit(), comp) = exactValue(bit(), comp);
+            }
+        }
+    }
+
+  const char* filename = "restart.h5";
+  {
+    HDF5Handle handle(filename, HDF5Handle::CREATE);
+    handle.setGroupToLevel(0);
+    write(handle, grids);
+    write(handle, data, "data", data.ghostVect());
+    handle.close();
+  }
+
+  int retval = 0;
+  HDF5Handle handle(filename, HDF5Handle::OPEN_RDONLY);
+  handle.setGroupToLevel(0);
+  Vector<Box> fileBoxes;
+  Vector<int> fileProcs;
+  if (readLayout(handle, fileBoxes, fileProcs) != 0)
+    {
+      return 1;
+    }
+  if (fileBoxes.size() != boxes.size() || fileProcs.size() != procs.size())
+    {
+      if ( verbose )
+        pout() << indent2 << "readLayout found " << fileBoxes.size() << " boxes and "
+               << fileProcs.size() << " ranks" << endl;
+      return 2;
+    }
+  for (int ibox = 0; ibox < boxes.size(); ibox++)
+    {
+      if (fileBoxes[ibox] != grids[grids.layoutIterator()[ibox]] ||
+          fileProcs[ibox] != grids.procID(grids.layoutIterator()[ibox]))
+        {
+          if ( verbose )
+            pout() << indent2 << "box " << ibox << " read back as " << fileBoxes[ibox]
+                   << " on rank " << fileProcs[ibox] << endl;
+          retval = 3;
+        }
+    }
+
+  // the written ranks modulo numProc(), and every box on the next rank
+  Vector<int> keptProcs(fileProcs);
+  for (int ibox = 0; ibox < keptProcs.size(); ibox++)
+    {
+      keptProcs[ibox] = keptProcs[ibox] % numProc();
+    }
+  if (readOnto(handle, fileBoxes, keptProcs, domain) != 0)
+    {
+      if ( verbose )
+        pout() << indent2 << "reading onto the written ranks failed" << endl;
+      retval = 4;
+    }
+  Vector<int> shiftedProcs(fileProcs.size());
+  for (int ibox = 0; ibox < shiftedProcs.size(); ibox++)
+    {
+      shiftedProcs[ibox] = (fileProcs[ibox] + 1) % numProc();
+    }
+  if (readOnto(handle, fileBoxes, shiftedProcs, domain) != 0)
+    {
+      if ( verbose )
+        pout() << indent2 << "reading onto shifted ranks failed" << endl;
+      retval = 5;
+    }
+  handle.close();
+
+#ifdef CH_MPI
+  MPI_Barrier(Chombo_MPI::comm);
+#endif
+  if (procID() == 0)
+    {
+      std::remove(filename);
+    }
+  return retval;
+#else
+  return 0;
+#endif // CH_USE_HDF5
+}
+
+///
+// Parse the standard test options (-v -q) out of the command line.
+// Stop parsing when a non-option argument is found.
+///
+void
+parseTestOptions( int argc ,char* argv[] )
+{
+  for ( int i = 1 ; i < argc ; ++i )
+  {
+    if ( argv[i][0] == '-' ) //if it is an option
+    {
+      // compare 3 chars to differentiate -x from -xx
+      if ( strncmp( argv[i] ,"-v" ,3 ) == 0 )
+      {
+        verbose = true ;
+      }
+      else if ( strncmp( argv[i] ,"-q" ,3 ) == 0 )
+      {
+        verbose = false ;
+      }
+      else
+      {
+        break ;
+      }
+    }
+  }
+  return ;
+}
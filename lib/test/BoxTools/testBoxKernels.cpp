@@ -0,0 +1,364 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+// Test program for BoxKernels
+// Test 1: the Laplacian of radius 1 and 2 matches a loop over the stencil,
+//         for specialized and other numbers of components.
+// Test 2: red and black Gauss-Seidel sweeps match a point by point sweep.
+// Test 3: averaging and prolongation match loops over the cells, for
+//         the specialized refinement ratios and another, on boxes with
+//         negative indices.
+// Test 4: the flux divergence matches a loop over the faces.
+
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+using std::endl;
+
+#include "BoxKernels.H"
+#include "BoxIterator.H"
+#include "parstream.H"
+#ifdef CH_MPI
+#include "mpi.h"
+#endif
+
+#include "UsingNamespace.H"
+
+/// Global variables for handling output:
+static const char* pgmname = "testBoxKernels" ;
+static const char* indent = "   ";
+static const char* indent2 = "      " ;
+static bool verbose = true ;
+
+static const Real s_tolerance = 1.0e-12;
+
+/// A smooth function that differs between components
+static void
+fill(FArrayBox& a_fab, Real a_shift = 0)
+{
+  for (BoxIterator bit(a_fab.box()); bit.ok(); ++bit)
+    {
+      for (int comp = 0; comp < a_fab.nComp(); comp++)
+        {
+          Real val = a_shift + comp;
+          for (int dir = 0; dir < SpaceDim; dir++)
+            {
+              val += sin(0.3*(dir + 1)*bit()[dir] + comp);
+            }
+          a_fab(bit(), comp) = val;
+        }
+    }
+}
+
+/// Largest difference on a_box
+static Real
+maxDifference(const FArrayBox& a_lhs, const FArrayBox& a_rhs, const Box& a_box)
+{
+  Real diff = 0;
+  for (BoxIterator bit(a_box); bit.ok(); ++bit)
+    {
+      for (int comp = 0; comp < a_lhs.nComp(); comp++)
+        {
+          diff = Max(diff, Abs(a_lhs(bit(), comp) - a_rhs(bit(), comp)));
+        }
+    }
+  return diff;
+}
+
+static Real
+laplacianAt(const FArrayBox& a_phi, const IntVect& a_iv, int a_comp, int a_radius)
+{
+  static const Real weights[2][3] = {{-2., 1., 0.}, {-5./2., 4./3., -1./12.}};
+  const Real* w = weights[a_radius - 1];
+  Real lap = 0;
+  for (int dir = 0; dir < SpaceDim; dir++)
+    {
+      lap += w[0]*a_phi(a_iv, a_comp);
+      for (int r = 1; r <= a_radius; r++)
+        {
+          lap += w[r]*(a_phi(a_iv + r*BASISV(dir), a_comp)
+                       + a_phi(a_iv - r*BASISV(dir), a_comp));
+        }
+    }
+  return lap;
+}
+
+int
+testLaplacian()
+{
+  // An odd size leaves a remainder after the blocks of CH_KERNEL_WIDTH
+  Box region(-3*IntVect::Unit, 13*IntVect::Unit);
+  Real dx = 0.1;
+  Real alpha = 0.5;
+  Real beta = -2.0;
+  int ncomps[] = {1, 3, 5, 7};
+  for (int radius = 1; radius <= 2; radius++)
+    {
+      for (int n = 0; n < 4; n++)
+        {
+          int ncomp = ncomps[n];
+          FArrayBox phi(grow(region, 3), ncomp);
+          fill(phi);
+          FArrayBox lhs(grow(region, 1), ncomp);
+          lhs.setVal(7.);
+          FArrayBox exact(lhs.box(), ncomp);
+          exact.setVal(7.);
+          for (BoxIterator bit(region); bit.ok(); ++bit)
+            {
+              for (int comp = 0; comp < ncomp; comp++)
+                {
+                  exact(bit(), comp) = alpha*phi(bit(), comp)
+                    + beta*laplacianAt(phi, bit(), comp, radius)/(dx*dx);
+                }
+            }
+          BoxKernels::laplacian(lhs, phi, region, dx, alpha, beta, radius);
+          // Nothing outside the region is touched
+          if (maxDifference(lhs, exact, lhs.box()) > s_tolerance*1000)
+            {
+              pout() << indent2 << "radius " << radius << ", " << ncomp
+                     << " components: Laplacian differs by "
+                     << maxDifference(lhs, exact, lhs.box()) << endl;
+              return 1;
+            }
+        }
+    }
+
+  // A range of components of a larger FAB
+  FArrayBox phi(grow(region, 1), 4);
+  fill(phi);
+  FArrayBox lhs(region, 4);
+  lhs.setVal(0.);
+  BoxKernels::laplacian<2, 1>(lhs, phi, region, dx, alpha, beta, 1);
+  for (BoxIterator bit(region); bit.ok(); ++bit)
+    {
+      for (int comp = 0; comp < 4; comp++)
+        {
+          Real exact = 0;
+          if (comp == 1 || comp == 2)
+            {
+              exact = alpha*phi(bit(), comp) + beta*laplacianAt(phi, bit(), comp, 1)/(dx*dx);
+            }
+          if (Abs(lhs(bit(), comp) - exact) > s_tolerance*1000) return 2;
+        }
+    }
+  return 0;
+}
+
+int
+testGSRB()
+{
+  Box region(IntVect::Zero, 10*IntVect::Unit);
+  region.setBig(0, 16);
+  Real dx = 0.25;
+  Real alpha = 1.0;
+  Real beta = -0.5;
+  for (int ncomp = 1; ncomp <= 6; ncomp += 5)
+    {
+      FArrayBox phi(grow(region, 1), ncomp);
+      FArrayBox rhs(region, ncomp);
+      fill(phi);
+      fill(rhs, 2.);
+      FArrayBox exact(phi.box(), ncomp);
+      exact.copy(phi);
+
+      for (int color = 0; color < 2; color++)
+        {
+          Real lambda = 1./(alpha - 2*SpaceDim*beta/(dx*dx));
+          for (BoxIterator bit(region); bit.ok(); ++bit)
+            {
+              if ((bit().sum() + color)%2 != 0) continue;
+              for (int comp = 0; comp < ncomp; comp++)
+                {
+                  Real op = alpha*exact(bit(), comp)
+                    + beta*laplacianAt(exact, bit(), comp, 1)/(dx*dx);
+                  exact(bit(), comp) += lambda*(rhs(bit(), comp) - op);
+                }
+            }
+          BoxKernels::gsrb(phi, rhs, region, dx, alpha, beta, color);
+          if (maxDifference(phi, exact, phi.box()) > s_tolerance)
+            {
+              pout() << indent2 << ncomp << " components, color " << color
+                     << ": GSRB differs by " << maxDifference(phi, exact, phi.box()) << endl;
+              return 1;
+            }
+        }
+    }
+  return 0;
+}
+
+int
+testRestrictProlong()
+{
+  int ratios[] = {2, 4, 3};
+  for (int r = 0; r < 3; r++)
+    {
+      int ref = ratios[r];
+      for (int ncomp = 1; ncomp <= 6; ncomp += 5)
+        {
+          Box coarseBox(-5*IntVect::Unit, 6*IntVect::Unit);
+          Box fineBox = refine(coarseBox, ref);
+          FArrayBox fine(grow(fineBox, 1), ncomp);
+          fill(fine);
+          FArrayBox coarse(grow(coarseBox, 1), ncomp);
+          coarse.setVal(3.);
+          FArrayBox exact(coarse.box(), ncomp);
+          exact.setVal(3.);
+          Box children(IntVect::Zero, (ref - 1)*IntVect::Unit);
+          for (BoxIterator bit(coarseBox); bit.ok(); ++bit)
+            {
+              for (int comp = 0; comp < ncomp; comp++)
+                {
+                  Real sum = 0;
+                  for (BoxIterator cit(children); cit.ok(); ++cit)
+                    {
+                      sum += fine(ref*bit() + cit(), comp);
+                    }
+                  exact(bit(), comp) = sum/children.numPts();
+                }
+            }
+          BoxKernels::average(coarse, fine, coarseBox, ref);
+          if (maxDifference(coarse, exact, coarse.box()) > s_tolerance)
+            {
+              pout() << indent2 << "ratio " << ref << ", " << ncomp
+                     << " components: average differs by "
+                     << maxDifference(coarse, exact, coarse.box()) << endl;
+              return 1;
+            }
+
+          // Prolong onto part of the fine box that starts inside a coarse cell
+          Box part(fineBox.smallEnd() + IntVect::Unit, fineBox.bigEnd() - 2*IntVect::Unit);
+          FArrayBox fineExact(fine.box(), ncomp);
+          fineExact.copy(fine);
+          for (BoxIterator bit(part); bit.ok(); ++bit)
+            {
+              for (int comp = 0; comp < ncomp; comp++)
+                {
+                  fineExact(bit(), comp) += coarse(coarsen(bit(), ref), comp);
+                }
+            }
+          BoxKernels::prolong(fine, coarse, part, ref);
+          if (maxDifference(fine, fineExact, fine.box()) > s_tolerance)
+            {
+              pout() << indent2 << "ratio " << ref << ", " << ncomp
+                     << " components: prolongation differs by "
+                     << maxDifference(fine, fineExact, fine.box()) << endl;
+              return 2;
+            }
+        }
+    }
+  return 0;
+}
+
+int
+testFluxDivergence()
+{
+  Box region(-2*IntVect::Unit, 9*IntVect::Unit);
+  Real scale = 4.;
+  for (int ncomp = 1; ncomp <= 6; ncomp += 5)
+    {
+      FluxBox flux(grow(region, 1), ncomp);
+      for (int dir = 0; dir < SpaceDim; dir++)
+        {
+          fill(flux[dir], dir);
+        }
+      FArrayBox div(grow(region, 1), ncomp);
+      div.setVal(-1.);
+      FArrayBox exact(div.box(), ncomp);
+      exact.setVal(-1.);
+      for (BoxIterator bit(region); bit.ok(); ++bit)
+        {
+          for (int comp = 0; comp < ncomp; comp++)
+            {
+              Real sum = 0;
+              for (int dir = 0; dir < SpaceDim; dir++)
+                {
+                  sum += flux[dir](bit() + BASISV(dir), comp) - flux[dir](bit(), comp);
+                }
+              exact(bit(), comp) = scale*sum;
+            }
+        }
+      BoxKernels::fluxDivergence(div, flux, region, scale);
+      if (maxDifference(div, exact, div.box()) > s_tolerance)
+        {
+          pout() << indent2 << ncomp << " components: divergence differs by "
+                 << maxDifference(div, exact, div.box()) << endl;
+          return 1;
+        }
+    }
+  return 0;
+}
+
+///
+// Parse the standard test options (-v -q -h) out of the command line
+///
+void
+parseTestOptions( int argc ,char* argv[] )
+{
+  for ( int i = 1 ; i < argc ; ++i )
+    {
+      if ( argv[i][0] == '-' ) //if it is an option
+        {
+          // compare 3 chars to differentiate -x from -xx
+          if ( strncmp( argv[i] ,"-v" ,3 ) == 0 )
+            {
+              verbose = true ;
+            }
+          else if ( strncmp( argv[i] ,"-q" ,3 ) == 0 )
+            {
+              verbose = false ;
+            }
+          else if ( strncmp( argv[i] ,"-h" ,3 ) == 0 )
+            {
+              pout() << "usage: " << pgmname << " [-hqv]" << std::endl ;
+              exit( 99 ) ;
+            }
+        }
+    }
+  return;
+}
+
+int
+main(int argc ,char* argv[])
+{
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  parseTestOptions( argc ,argv ) ;
+  if ( verbose )
+    pout() << indent2 << "Beginning " << pgmname << endl ;
+
+  int stat_all = 0;
+  int (*tests[])() = {testLaplacian, testGSRB, testRestrictProlong, testFluxDivergence};
+  for (int t = 0; t < 4; t++)
+    {
+      int status = tests[t]();
+      if ( status == 0 )
+        {
+          if ( verbose ) pout() << indent << pgmname << " passed test " << t+1 << "." << endl ;
+        }
+      else
+        {
+          pout() << indent << pgmname << " failed test " << t+1 << " with return code "
+                 << status << endl ;
+          stat_all = status ;
+        }
+    }
+
+  if ( stat_all == 0 )
+    pout() << indent << pgmname << ": passed all tests." << endl ;
+  else
+    pout() << indent << pgmname << ": failed one or more tests." << endl ;
+
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+  return stat_all ;
+}
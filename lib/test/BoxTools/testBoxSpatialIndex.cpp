@@ -0,0 +1,409 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+// Test program for BoxSpatialIndex and the layout queries built on it
+// Test 1: intersection queries agree with a brute force search.
+// Test 2: BoxLayout::findIntersecting and DisjointBoxLayout::neighbors,
+//         periodic images included, agree with a brute force search.
+// Test 3: Copiers built with the index fill ghost cells and copy between
+//         different layouts correctly on a periodic domain.
+
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+using std::endl;
+
+#include "BoxSpatialIndex.H"
+#include "DisjointBoxLayout.H"
+#include "LevelData.H"
+#include "FArrayBox.H"
+#include "BoxIterator.H"
+#include "LayoutIterator.H"
+#include "LoadBalance.H"
+#include "parstream.H"
+#ifdef CH_MPI
+#include "mpi.h"
+#endif
+
+#include "UsingNamespace.H"
+
+/// Global variables for handling output:
+static const char* pgmname = "testBoxSpatialIndex" ;
+static const char* indent = "   ";
+static const char* indent2 = "      " ;
+static bool verbose = true ;
+
+static const int s_domainSize = 64;
+
+static int
+randomInt(int a_lo, int a_hi)
+{
+  return a_lo + rand()%(a_hi - a_lo + 1);
+}
+
+static Box
+randomBox(int a_lo, int a_hi, int a_maxSize)
+{
+  IntVect lo, hi;
+  for (int dir = 0; dir < SpaceDim; dir++)
+    {
+      lo[dir] = randomInt(a_lo, a_hi);
+      hi[dir] = lo[dir] + randomInt(0, a_maxSize - 1);
+    }
+  return Box(lo, hi);
+}
+
+static ProblemDomain
+periodicDomain()
+{
+  bool isPeriodic[SpaceDim];
+  for (int dir = 0; dir < SpaceDim; dir++)
+    {
+      isPeriodic[dir] = (dir != 1);
+    }
+  return ProblemDomain(IntVect::Zero, (s_domainSize-1)*IntVect::Unit, isPeriodic);
+}
+
+/// Uneven boxes covering the domain, split along lines at random positions
+static void
+unevenLayout(DisjointBoxLayout& a_dbl, const ProblemDomain& a_domain, int a_maxSize)
+{
+  Vector<Box> boxes;
+  Box grid(IntVect::Zero, (s_domainSize/a_maxSize - 1)*IntVect::Unit);
+  for (BoxIterator bit(grid); bit.ok(); ++bit)
+    {
+      Box b(a_maxSize*bit(), a_maxSize*bit() + (a_maxSize-1)*IntVect::Unit);
+      int dir = randomInt(0, SpaceDim-1);
+      int cut = b.smallEnd(dir) + 2*randomInt(1, a_maxSize/2 - 1);
+      Box hi = b.chop(dir, cut);
+      boxes.push_back(b);
+      boxes.push_back(hi);
+    }
+  Vector<int> procs;
+  LoadBalance(procs, boxes);
+  a_dbl.define(boxes, procs, a_domain);
+}
+
+int
+testIndex()
+{
+  srand(17);
+  Vector<Box> boxes;
+  for (int i = 0; i < 500; i++)
+    {
+      boxes.push_back(randomBox(-100, 100, (i%10 == 0) ? 40 : 8));
+    }
+  boxes.push_back(Box());
+
+  BoxSpatialIndex index(boxes);
+  if (!index.isDefined() || (index.size() != boxes.size())) return 1;
+
+  int numFound = 0;
+  for (int iquery = 0; iquery < 500; iquery++)
+    {
+      Box query = randomBox(-120, 120, (iquery%50 == 0) ? 200 : 20);
+      Vector<int> expected;
+      for (int i = 0; i < boxes.size(); i++)
+        {
+          if (!boxes[i].isEmpty() && boxes[i].intersectsNotEmpty(query))
+            {
+              expected.push_back(i);
+            }
+        }
+      Vector<int> found;
+      index.findIntersecting(found, query);
+      if (found.size() != expected.size()) return 2;
+      for (int i = 0; i < found.size(); i++)
+        {
+          if (found[i] != expected[i]) return 3;
+        }
+      numFound += found.size();
+    }
+
+  Vector<int> found;
+  index.findIntersecting(found, Box());
+  if (found.size() != 0) return 4;
+
+  index.clear();
+  if (index.isDefined()) return 5;
+
+  if (verbose)
+    {
+      pout() << indent2 << numFound << " intersections found" << endl;
+    }
+  return 0;
+}
+
+int
+testLayoutQueries()
+{
+  srand(23);
+  ProblemDomain domain = periodicDomain();
+  DisjointBoxLayout dbl;
+  unevenLayout(dbl, domain, 8);
+
+  // findIntersecting
+  for (int iquery = 0; iquery < 100; iquery++)
+    {
+      Box query = randomBox(-10, s_domainSize + 10, 20);
+      Vector<LayoutIndex> found;
+      dbl.findIntersecting(found, query);
+      int ifound = 0;
+      for (LayoutIterator lit = dbl.layoutIterator(); lit.ok(); ++lit)
+        {
+          if (dbl[lit].intersectsNotEmpty(query))
+            {
+              if (ifound >= found.size()) return 1;
+              if (found[ifound] != lit()) return 2;
+              ifound++;
+            }
+        }
+      if (ifound != found.size()) return 3;
+    }
+
+  // Local boxes come back as the same DataIndex the DataIterator gives
+  for (DataIterator dit = dbl.dataIterator(); dit.ok(); ++dit)
+    {
+      Vector<LayoutIndex> found;
+      dbl.findIntersecting(found, dbl[dit]);
+      if ((found.size() != 1) || (DataIndex(found[0]) != dit())) return 4;
+      if (found[0].datInd() != dit().datInd()) return 5;
+    }
+
+  // neighbors, with the periodic images
+  ShiftIterator shiftIt = domain.shiftIterator();
+  for (DataIterator dit = dbl.dataIterator(); dit.ok(); ++dit)
+    {
+      for (int ghost = 1; ghost <= 3; ghost++)
+        {
+          Box gbox = grow(dbl[dit], ghost);
+          Vector<std::pair<int, LayoutIndex> > found;
+          dbl.neighbors(found, dit(), ghost);
+
+          int numExpected = 0;
+          for (LayoutIterator lit = dbl.layoutIterator(); lit.ok(); ++lit)
+            {
+              if ((lit() != dit()) && dbl[lit].intersectsNotEmpty(gbox))
+                {
+                  numExpected++;
+                }
+              if (!domain.domainBox().contains(gbox))
+                {
+                  for (shiftIt.begin(); shiftIt.ok(); ++shiftIt)
+                    {
+                      Box image = dbl[lit];
+                      domain.shiftIt(image, shiftIt.index());
+                      if (image.intersectsNotEmpty(gbox)) numExpected++;
+                    }
+                }
+            }
+          if (found.size() != numExpected) return 6;
+          for (int i = 0; i < found.size(); i++)
+            {
+              Box image = dbl[found[i].second];
+              if (found[i].first >= 0)
+                {
+                  domain.shiftIt(image, found[i].first);
+                }
+              else if (found[i].second == dit())
+                {
+                  return 7;
+                }
+              if (!image.intersectsNotEmpty(gbox)) return 8;
+            }
+        }
+    }
+
+  // A coarsened layout gets an index of its own
+  DisjointBoxLayout coarse;
+  coarsen(coarse, dbl, 2);
+  Vector<LayoutIndex> fine, coar;
+  dbl.findIntersecting(fine, Box(IntVect::Zero, 15*IntVect::Unit));
+  coarse.findIntersecting(coar, Box(IntVect::Zero, 7*IntVect::Unit));
+  if (fine.size() != coar.size()) return 9;
+
+  return 0;
+}
+
+/// The test function, periodic in the periodic directions
+static Real
+value(const IntVect& a_iv)
+{
+  Real val = 0;
+  Real scale = 1;
+  for (int dir = 0; dir < SpaceDim; dir++)
+    {
+      int i = a_iv[dir];
+      if (dir != 1)
+        {
+          i = ((i % s_domainSize) + s_domainSize) % s_domainSize;
+        }
+      val += scale*i;
+      scale *= 1000;
+    }
+  return val;
+}
+
+static void
+setValid(LevelData<FArrayBox>& a_data)
+{
+  for (DataIterator dit = a_data.dataIterator(); dit.ok(); ++dit)
+    {
+      FArrayBox& fab = a_data[dit];
+      fab.setVal(-1);
+      for (BoxIterator bit(a_data.disjointBoxLayout()[dit]); bit.ok(); ++bit)
+        {
+          fab(bit(), 0) = value(bit());
+        }
+    }
+}
+
+/// Number of wrong cells of a_data; ghost cells outside the domain in the
+/// nonperiodic direction are not filled and are skipped
+static int
+countErrors(const LevelData<FArrayBox>& a_data, const ProblemDomain& a_domain)
+{
+  Box filled = a_domain.domainBox();
+  for (int dir = 0; dir < SpaceDim; dir++)
+    {
+      if (a_domain.isPeriodic(dir)) filled.grow(dir, s_domainSize);
+    }
+  int errors = 0;
+  for (DataIterator dit = a_data.dataIterator(); dit.ok(); ++dit)
+    {
+      const FArrayBox& fab = a_data[dit];
+      for (BoxIterator bit(fab.box() & filled); bit.ok(); ++bit)
+        {
+          if (fab(bit(), 0) != value(bit())) errors++;
+        }
+    }
+  return errors;
+}
+
+int
+testCopier()
+{
+  srand(31);
+  ProblemDomain domain = periodicDomain();
+  DisjointBoxLayout src, dest;
+  unevenLayout(src, domain, 8);
+  unevenLayout(dest, domain, 16);
+
+  LevelData<FArrayBox> srcData(src, 1, 3*IntVect::Unit);
+  LevelData<FArrayBox> destData(dest, 1, 2*IntVect::Unit);
+
+  setValid(srcData);
+  srcData.exchange();
+  int errors = countErrors(srcData, domain);
+  if (errors != 0)
+    {
+      pout() << indent2 << errors << " wrong cells after exchange" << endl;
+      return 1;
+    }
+
+  setValid(destData);
+  Copier copier(src, dest, domain, 2*IntVect::Unit);
+  srcData.copyTo(srcData.interval(), destData, destData.interval(), copier);
+  errors = countErrors(destData, domain);
+  if (errors != 0)
+    {
+      pout() << indent2 << errors << " wrong cells after copy" << endl;
+      return 2;
+    }
+
+  return 0;
+}
+
+///
+// Parse the standard test options (-v -q -h) out of the command line
+///
+void
+parseTestOptions( int argc ,char* argv[] )
+{
+  for ( int i = 1 ; i < argc ; ++i )
+    {
+      if ( argv[i][0] == '-' ) //if it is an option
+        {
+          // compare 3 chars to differentiate -x from -xx
+          if ( strncmp( argv[i] ,"-v" ,3 ) == 0 )
+            {
+              verbose = true ;
+            }
+          else if ( strncmp( argv[i] ,"-q" ,3 ) == 0 )
+            {
+              verbose = false ;
+            }
+          else if ( strncmp( argv[i] ,"-h" ,3 ) == 0 )
+            {
+              pout() << "usage: " << pgmname << " [-hqv]" << std::endl ;
+              exit( 99 ) ;
+            }
+        }
+    }
+  return;
+}
+
+int
+main(int argc ,char* argv[])
+{
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  parseTestOptions( argc ,argv ) ;
+  if ( verbose )
+    pout() << indent2 << "Beginning " << pgmname << endl ;
+
+  int stat_all = 0;
+  int status = testIndex();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 1." << endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 1 with return code "
+             << status << endl ;
+      stat_all = status ;
+    }
+
+  status = testLayoutQueries();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 2." << endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 2 with return code "
+             << status << endl ;
+      stat_all = status ;
+    }
+
+  status = testCopier();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 3." << endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 3 with return code "
+             << status << endl ;
+      stat_all = status ;
+    }
+
+  if ( stat_all == 0 )
+    pout() << indent << pgmname << ": passed all tests." << endl ;
+  else
+    pout() << indent << pgmname << ": failed one or more tests." << endl ;
+
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+  return stat_all ;
+}
@@ -0,0 +1,432 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+// Test program for CompressedIntVectSet
+// Test 1: a tagging-like set agrees with a TreeIntVectSet built the same way,
+//         and survives linearization.
+// Test 2: set operations, grow, refine, coarsen, shift and chop agree with
+//         TreeIntVectSet.
+// Test 3: IntVectSet switched to the compressed representation gives the
+//         same results as with the tree representation.
+
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+using std::endl;
+
+#include "CompressedIntVectSet.H"
+#include "TreeIntVectSet.H"
+#include "IntVectSet.H"
+#include "ProblemDomain.H"
+#include "BoxIterator.H"
+#include "CH_Timer.H"
+#include "parstream.H"
+#ifdef CH_MPI
+#include "mpi.h"
+#endif
+
+#include "UsingNamespace.H"
+
+/// Global variables for handling output:
+static const char* pgmname = "testCompressedIntVectSet" ;
+static const char* indent = "   ";
+static const char* indent2 = "      " ;
+static bool verbose = true ;
+
+static int
+randomInt(int a_lo, int a_hi)
+{
+  return a_lo + rand()%(a_hi - a_lo + 1);
+}
+
+/// Cells in blobs around random centers, plus some lone cells, like tags
+static void
+randomTags(Vector<IntVect>& a_tags, const Box& a_region, int a_numBlobs)
+{
+  a_tags.resize(0);
+  for (int iblob = 0; iblob < a_numBlobs; iblob++)
+    {
+      IntVect center;
+      for (int dir = 0; dir < SpaceDim; dir++)
+        {
+          center[dir] = randomInt(a_region.smallEnd(dir), a_region.bigEnd(dir));
+        }
+      int radius = randomInt(1, 6);
+      Box blob(center - radius*IntVect::Unit, center + radius*IntVect::Unit);
+      blob &= a_region;
+      for (BoxIterator bit(blob); bit.ok(); ++bit)
+        {
+          IntVect d = bit() - center;
+          if ((d*d).sum() <= radius*radius && randomInt(0, 9) < 8)
+            {
+              a_tags.push_back(bit());
+            }
+        }
+      IntVect lone;
+      for (int dir = 0; dir < SpaceDim; dir++)
+        {
+          lone[dir] = randomInt(a_region.smallEnd(dir), a_region.bigEnd(dir));
+        }
+      a_tags.push_back(lone);
+    }
+}
+
+/// Number of cells where the two sets differ, or -1 if the sizes differ
+static int
+compare(const CompressedIntVectSet& a_compressed, const TreeIntVectSet& a_tree)
+{
+  a_tree.recalcMinBox();
+  if (a_compressed.numPts() != a_tree.numPts()) return -1;
+  int errors = 0;
+  for (TreeIntVectSetIterator it(a_tree); it.ok(); ++it)
+    {
+      if (!a_compressed.contains(it())) errors++;
+    }
+  int n = 0;
+  for (CompressedIntVectSetIterator it(a_compressed); it.ok(); ++it, ++n)
+    {
+      if (!a_tree.contains(it())) errors++;
+    }
+  if (n != a_tree.numPts()) errors++;
+  if (!a_tree.isEmpty() && (a_compressed.minBox() != a_tree.minBox())) errors++;
+  return errors;
+}
+
+static void
+build(CompressedIntVectSet& a_compressed, TreeIntVectSet& a_tree,
+      const Box& a_region, int a_numBlobs)
+{
+  Vector<IntVect> tags;
+  randomTags(tags, a_region, a_numBlobs);
+  a_compressed.clear();
+  a_tree.clear();
+  for (int i = 0; i < tags.size(); i++)
+    {
+      a_compressed |= tags[i];
+      a_tree |= tags[i];
+    }
+  a_tree.compact();
+}
+
+int
+testTagSet()
+{
+  srand(11);
+  Box region(-100*IntVect::Unit, 155*IntVect::Unit);
+  CompressedIntVectSet compressed;
+  TreeIntVectSet tree;
+  build(compressed, tree, region, 200);
+  if (compare(compressed, tree) != 0) return 1;
+
+  // Take some back out
+  int n = 0;
+  for (TreeIntVectSetIterator it(tree); it.ok(); ++it, ++n)
+    {
+      if (n%3 == 0) compressed -= it();
+    }
+  TreeIntVectSet tree2;
+  n = 0;
+  for (TreeIntVectSetIterator it(tree); it.ok(); ++it, ++n)
+    {
+      if (n%3 != 0) tree2 |= it();
+    }
+  if (compare(compressed, tree2) != 0) return 2;
+
+  // The boxes cover exactly the set
+  Vector<Box> boxes = compressed.createBoxes();
+  int numPts = 0;
+  for (int i = 0; i < boxes.size(); i++)
+    {
+      if (!compressed.contains(boxes[i])) return 3;
+      numPts += boxes[i].numPts();
+    }
+  if (numPts != compressed.numPts()) return 4;
+
+  // Linearization
+  Vector<char> buf(compressed.linearSize());
+  compressed.linearOut(&(buf[0]));
+  CompressedIntVectSet copy;
+  copy.linearIn(&(buf[0]));
+  if (!(copy == compressed)) return 5;
+  if (compare(copy, tree2) != 0) return 6;
+
+  if (verbose)
+    {
+      pout() << indent2 << compressed.numPts() << " cells, linear size "
+             << compressed.linearSize() << " bytes (TreeIntVectSet "
+             << tree2.linearSize() << "), " << compressed.memory()
+             << " bytes in memory" << endl;
+    }
+  return 0;
+}
+
+int
+testOperations()
+{
+  srand(13);
+  Box region(-80*IntVect::Unit, 90*IntVect::Unit);
+  CompressedIntVectSet a, b;
+  TreeIntVectSet ta, tb;
+  build(a, ta, region, 60);
+  build(b, tb, region, 60);
+  Box box(-20*IntVect::Unit, 37*IntVect::Unit);
+  box.growHi(0, 11);
+
+  {
+    CompressedIntVectSet c(a);
+    TreeIntVectSet t(ta);
+    c |= b;
+    t |= tb;
+    if (compare(c, t) != 0) return 1;
+    c &= a;
+    t &= ta;
+    if (compare(c, t) != 0) return 2;
+    c -= b;
+    t -= tb;
+    if (compare(c, t) != 0) return 3;
+    c |= box;
+    t |= box;
+    if (compare(c, t) != 0) return 4;
+    if (!c.contains(box)) return 5;
+    c -= Box(IntVect::Zero, IntVect::Zero);
+    if (c.contains(box)) return 6;
+    c &= grow(box, 5);
+    t &= grow(box, 5);
+    t -= Box(IntVect::Zero, IntVect::Zero);
+    if (compare(c, t) != 0) return 7;
+  }
+
+  {
+    CompressedIntVectSet c(a);
+    TreeIntVectSet t(ta);
+    c.grow(2);
+    t.grow(2);
+    if (compare(c, t) != 0) return 8;
+    c.grow(SpaceDim-1, 3);
+    t.grow(SpaceDim-1, 3);
+    if (compare(c, t) != 0) return 9;
+    c.growHi();
+    t.growHi();
+    if (compare(c, t) != 0) return 10;
+    c.growHi(0);
+    t.growHi(0);
+    if (compare(c, t) != 0) return 11;
+  }
+
+  {
+    CompressedIntVectSet c(a);
+    TreeIntVectSet t(ta);
+    c.coarsen(4);
+    t.coarsen(4);
+    if (compare(c, t) != 0) return 12;
+    c.refine(4);
+    t.refine(4);
+    if (compare(c, t) != 0) return 13;
+    c.coarsen(2);
+    t.coarsen(2);
+    if (compare(c, t) != 0) return 14;
+  }
+
+  {
+    CompressedIntVectSet c(a);
+    TreeIntVectSet t(ta);
+    IntVect aligned = CompressedIntVectSet::chunkSize()*BASISV(0);
+    c.shift(aligned);
+    t.shift(aligned);
+    if (compare(c, t) != 0) return 15;
+    IntVect unaligned = 3*IntVect::Unit - 7*BASISV(0);
+    c.shift(unaligned);
+    t.shift(unaligned);
+    if (compare(c, t) != 0) return 16;
+
+    CompressedIntVectSet hi;
+    TreeIntVectSet thi;
+    c.chop(0, 5, hi);
+    t.chop(0, 5, thi);
+    if (compare(c, t) != 0) return 17;
+    if (compare(hi, thi) != 0) return 18;
+  }
+
+  {
+    bool isPeriodic[SpaceDim];
+    for (int dir = 0; dir < SpaceDim; dir++)
+      {
+        isPeriodic[dir] = (dir == 0);
+      }
+    ProblemDomain domain(IntVect::Zero, 63*IntVect::Unit, isPeriodic);
+    CompressedIntVectSet c(a);
+    TreeIntVectSet t(ta);
+    c &= domain;
+    t &= domain;
+    if (compare(c, t) != 0) return 19;
+  }
+
+  return 0;
+}
+
+/// The same operations on IntVectSet, returned as a TreeIntVectSet
+static int
+intVectSetOps(TreeIntVectSet& a_result, bool a_compressed, const Vector<IntVect>& a_tags)
+{
+  IntVectSet::setUseCompressed(a_compressed);
+  IntVectSet tags(Box(IntVect::Zero, 15*IntVect::Unit));
+  tags.makeEmptyBits();
+  for (int i = 0; i < a_tags.size(); i++)
+    {
+      tags |= a_tags[i];
+    }
+  if (tags.isDense()) return 1;
+  if (tags.isCompressed() != a_compressed) return 2;
+
+  IntVectSet other(tags);
+  other.grow(1);
+  other -= tags;
+  tags.coarsen(2);
+  tags |= coarsen(other, 2);
+  tags.refine(2);
+  tags &= Box(-30*IntVect::Unit, 60*IntVect::Unit);
+  IntVectSet hi = tags.chop(1, 7);
+  tags |= hi;
+
+  // Through linearization, as in a gather or broadcast
+  Vector<char> buf(tags.linearSize());
+  tags.linearOut(&(buf[0]));
+  IntVectSet copy;
+  copy.linearIn(&(buf[0]));
+  if (!(copy == tags)) return 3;
+  if (copy.isCompressed() != a_compressed) return 4;
+
+  int n = 0;
+  a_result.clear();
+  for (IVSIterator it(copy); it.ok(); ++it, ++n)
+    {
+      a_result |= it();
+    }
+  if (n != copy.numPts()) return 5;
+  IntVectSet::setUseCompressed(false);
+  return 0;
+}
+
+int
+testIntVectSet()
+{
+  srand(17);
+  Vector<IntVect> tags;
+  randomTags(tags, Box(-40*IntVect::Unit, 50*IntVect::Unit), 40);
+
+  TreeIntVectSet withTree, withCompressed;
+  int status = intVectSetOps(withTree, false, tags);
+  if (status != 0) return status;
+  status = intVectSetOps(withCompressed, true, tags);
+  if (status != 0) return 10 + status;
+  if (!(withTree == withCompressed)) return 20;
+
+  // Mixing a compressed set with a tree set
+  IntVectSet::setUseCompressed(true);
+  IntVectSet compressed(Box(IntVect::Zero, IntVect::Unit));
+  compressed |= 40*IntVect::Unit;
+  IntVectSet::setUseCompressed(false);
+  IntVectSet tree(Box(IntVect::Zero, IntVect::Unit));
+  tree |= 50*IntVect::Unit;
+  if (!compressed.isCompressed() || tree.isDense() || tree.isCompressed()) return 21;
+  tree |= compressed;
+  if (tree.numPts() != (1 << SpaceDim) + 2) return 22;
+  tree -= compressed;
+  if ((tree.numPts() != 1) || !tree.contains(50*IntVect::Unit)) return 23;
+
+  return 0;
+}
+
+///
+// Parse the standard test options (-v -q -h) out of the command line
+///
+void
+parseTestOptions( int argc ,char* argv[] )
+{
+  for ( int i = 1 ; i < argc ; ++i )
+    {
+      if ( argv[i][0] == '-' ) //if it is an option
+        {
+          // compare 3 chars to differentiate -x from -xx
+          if ( strncmp( argv[i] ,"-v" ,3 ) == 0 )
+            {
+              verbose = true ;
+            }
+          else if ( strncmp( argv[i] ,"-q" ,3 ) == 0 )
+            {
+              verbose = false ;
+            }
+          else if ( strncmp( argv[i] ,"-h" ,3 ) == 0 )
+            {
+              pout() << "usage: " << pgmname << " [-hqv]" << std::endl ;
+              exit( 99 ) ;
+            }
+        }
+    }
+  return;
+}
+
+int
+main(int argc ,char* argv[])
+{
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  parseTestOptions( argc ,argv ) ;
+  if ( verbose )
+    pout() << indent2 << "Beginning " << pgmname << endl ;
+
+  int stat_all = 0;
+  int status = testTagSet();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 1." << endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 1 with return code "
+             << status << endl ;
+      stat_all = status ;
+    }
+
+  status = testOperations();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 2." << endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 2 with return code "
+             << status << endl ;
+      stat_all = status ;
+    }
+
+  status = testIntVectSet();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 3." << endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 3 with return code "
+             << status << endl ;
+      stat_all = status ;
+    }
+
+  if ( stat_all == 0 )
+    pout() << indent << pgmname << ": passed all tests." << endl ;
+  else
+    pout() << indent << pgmname << ": failed one or more tests." << endl ;
+
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+  return stat_all ;
+}
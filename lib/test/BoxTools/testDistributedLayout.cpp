@@ -0,0 +1,353 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+// Test program for distributed DisjointBoxLayouts
+// Test 1: a distributed layout holds the local boxes and exactly those
+//         boxes of the other processors that are within its halo.
+// Test 2: exchange() fills the ghost cells, periodic images included.
+// Test 3: Copiers between distributed layouts, and between a distributed
+//         and a full layout, with different decompositions.
+
+#include <cstring>
+#include <iostream>
+using std::endl;
+
+#include "DisjointBoxLayout.H"
+#include "DistributedBoxIndex.H"
+#include "LevelData.H"
+#include "FArrayBox.H"
+#include "BoxIterator.H"
+#include "LayoutIterator.H"
+#include "LoadBalance.H"
+#include "parstream.H"
+#ifdef CH_MPI
+#include "mpi.h"
+#endif
+
+#include "UsingNamespace.H"
+
+/// Global variables for handling output:
+static const char* pgmname = "testDistributedLayout" ;
+static const char* indent = "   ";
+static const char* indent2 = "      " ;
+static bool verbose = true ;
+
+static const int s_domainSize = 64;
+
+static ProblemDomain
+periodicDomain()
+{
+  bool isPeriodic[SpaceDim];
+  for (int dir = 0; dir < SpaceDim; dir++)
+    {
+      isPeriodic[dir] = true;
+    }
+  return ProblemDomain(IntVect::Zero, (s_domainSize-1)*IntVect::Unit, isPeriodic);
+}
+
+/// The domain split into boxes of a_size, load balanced, possibly reversed
+static void
+splitDomain(Vector<Box>& a_boxes, Vector<int>& a_procs, int a_size, bool a_reverse)
+{
+  a_boxes.resize(0);
+  Box grid(IntVect::Zero, (s_domainSize/a_size - 1)*IntVect::Unit);
+  for (BoxIterator bit(grid); bit.ok(); ++bit)
+    {
+      a_boxes.push_back(Box(a_size*bit(), a_size*bit() + (a_size-1)*IntVect::Unit));
+    }
+  LoadBalance(a_procs, a_boxes);
+  if (a_reverse)
+    {
+      for (int i = 0; i < a_procs.size(); i++)
+        {
+          a_procs[i] = numProc() - 1 - a_procs[i];
+        }
+    }
+}
+
+static Vector<Box>
+localBoxes(const Vector<Box>& a_boxes, const Vector<int>& a_procs)
+{
+  Vector<Box> local;
+  for (int i = 0; i < a_boxes.size(); i++)
+    {
+      if (a_procs[i] == procID()) local.push_back(a_boxes[i]);
+    }
+  return local;
+}
+
+/// The test function, periodic in the domain
+static Real
+value(const IntVect& a_iv)
+{
+  Real val = 0;
+  Real scale = 1;
+  for (int dir = 0; dir < SpaceDim; dir++)
+    {
+      int i = ((a_iv[dir] % s_domainSize) + s_domainSize) % s_domainSize;
+      val += scale*i;
+      scale *= 100;
+    }
+  return val;
+}
+
+static void
+setValid(LevelData<FArrayBox>& a_data)
+{
+  for (DataIterator dit = a_data.dataIterator(); dit.ok(); ++dit)
+    {
+      FArrayBox& fab = a_data[dit];
+      fab.setVal(-1);
+      for (BoxIterator bit(a_data.disjointBoxLayout()[dit]); bit.ok(); ++bit)
+        {
+          fab(bit(), 0) = value(bit());
+        }
+    }
+}
+
+/// Number of cells of a_data (ghost cells included) that are wrong
+static int
+countErrors(const LevelData<FArrayBox>& a_data)
+{
+  int errors = 0;
+  for (DataIterator dit = a_data.dataIterator(); dit.ok(); ++dit)
+    {
+      const FArrayBox& fab = a_data[dit];
+      for (BoxIterator bit(fab.box()); bit.ok(); ++bit)
+        {
+          if (fab(bit(), 0) != value(bit())) errors++;
+        }
+    }
+  return errors;
+}
+
+int
+testHalo()
+{
+  const int halo = 8;
+  ProblemDomain domain = periodicDomain();
+  Vector<Box> boxes;
+  Vector<int> procs;
+  splitDomain(boxes, procs, 8, false);
+  Vector<Box> local = localBoxes(boxes, procs);
+
+  DisjointBoxLayout dbl;
+  dbl.defineDistributed(local, domain, halo);
+  if (!dbl.isDistributed()) return 1;
+  if (dbl.haloWidth() != halo) return 2;
+  if (dbl.dataIterator().size() != local.size()) return 3;
+
+  // Every box of the layout is a box of the full layout, on the same
+  // processor
+  for (LayoutIterator lit = dbl.layoutIterator(); lit.ok(); ++lit)
+    {
+      int found = -1;
+      for (int i = 0; i < boxes.size(); i++)
+        {
+          if (boxes[i] == dbl[lit]) found = i;
+        }
+      if (found < 0) return 4;
+      if ((numProc() > 1) && (dbl.procID(lit()) != procs[found])) return 5;
+    }
+
+  // Every box near a local box is in the layout
+  int numExpected = 0;
+  for (int i = 0; i < boxes.size(); i++)
+    {
+      bool near = (procs[i] == procID());
+      for (int j = 0; j < local.size(); j++)
+        {
+          if (DistributedBoxIndex::intersects(grow(local[j], halo), boxes[i], domain))
+            {
+              near = true;
+            }
+        }
+      if (near) numExpected++;
+    }
+  if (dbl.size() != numExpected) return 6;
+
+  DistributedBoxIndex index(local);
+  if (index.numBoxes() != boxes.size()) return 7;
+
+  // Coarsening keeps a halo that is still complete
+  DisjointBoxLayout coarse;
+  coarsen(coarse, dbl, 2);
+  if (!coarse.isDistributed() || (coarse.haloWidth() != halo/2)) return 8;
+
+  if (verbose)
+    {
+      pout() << indent2 << dbl.size() << " of " << index.numBoxes()
+             << " boxes held by this processor" << endl;
+    }
+  return 0;
+}
+
+int
+testExchange()
+{
+  ProblemDomain domain = periodicDomain();
+  Vector<Box> boxes;
+  Vector<int> procs;
+  splitDomain(boxes, procs, 8, false);
+
+  DisjointBoxLayout dbl;
+  dbl.defineDistributed(localBoxes(boxes, procs), domain, 4);
+
+  LevelData<FArrayBox> data(dbl, 1, 3*IntVect::Unit);
+  setValid(data);
+  data.exchange();
+  int errors = countErrors(data);
+  if (errors != 0)
+    {
+      pout() << indent2 << errors << " wrong cells after exchange" << endl;
+      return 1;
+    }
+
+  // With a general Copier as well
+  setValid(data);
+  Copier exchangeCopier(dbl, dbl, domain, 3*IntVect::Unit, true);
+  data.exchange(exchangeCopier);
+  if (countErrors(data) != 0) return 2;
+
+  return 0;
+}
+
+int
+testCopy()
+{
+  ProblemDomain domain = periodicDomain();
+  Vector<Box> srcBoxes, destBoxes;
+  Vector<int> srcProcs, destProcs;
+  splitDomain(srcBoxes, srcProcs, 8, false);
+  splitDomain(destBoxes, destProcs, 16, true);
+
+  DisjointBoxLayout srcDistributed, destDistributed;
+  srcDistributed.defineDistributed(localBoxes(srcBoxes, srcProcs), domain, 1);
+  destDistributed.defineDistributed(localBoxes(destBoxes, destProcs), domain, 1);
+  DisjointBoxLayout srcFull(srcBoxes, srcProcs, domain);
+
+  LevelData<FArrayBox> src(srcDistributed, 1);
+  LevelData<FArrayBox> srcF(srcFull, 1);
+  LevelData<FArrayBox> dest(destDistributed, 1, 2*IntVect::Unit);
+  setValid(src);
+  setValid(srcF);
+
+  // Distributed to distributed, into the ghost cells too
+  Copier copier(srcDistributed, destDistributed, domain, 2*IntVect::Unit);
+  src.copyTo(src.interval(), dest, dest.interval(), copier);
+  if (countErrors(dest) != 0) return 1;
+
+  // Full to distributed
+  for (DataIterator dit = dest.dataIterator(); dit.ok(); ++dit)
+    {
+      dest[dit].setVal(-1);
+    }
+  Copier mixed(srcFull, destDistributed, domain, 2*IntVect::Unit);
+  srcF.copyTo(srcF.interval(), dest, dest.interval(), mixed);
+  if (countErrors(dest) != 0) return 2;
+
+  // And back, valid cells only
+  setValid(dest);
+  for (DataIterator dit = src.dataIterator(); dit.ok(); ++dit)
+    {
+      src[dit].setVal(-1);
+    }
+  dest.copyTo(src);
+  if (countErrors(src) != 0) return 3;
+
+  return 0;
+}
+
+///
+// Parse the standard test options (-v -q -h) out of the command line
+///
+void
+parseTestOptions( int argc ,char* argv[] )
+{
+  for ( int i = 1 ; i < argc ; ++i )
+    {
+      if ( argv[i][0] == '-' ) //if it is an option
+        {
+          // compare 3 chars to differentiate -x from -xx
+          if ( strncmp( argv[i] ,"-v" ,3 ) == 0 )
+            {
+              verbose = true ;
+            }
+          else if ( strncmp( argv[i] ,"-q" ,3 ) == 0 )
+            {
+              verbose = false ;
+            }
+          else if ( strncmp( argv[i] ,"-h" ,3 ) == 0 )
+            {
+              pout() << "usage: " << pgmname << " [-hqv]" << std::endl ;
+              exit( 99 ) ;
+            }
+        }
+    }
+  return;
+}
+
+int
+main(int argc ,char* argv[])
+{
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  parseTestOptions( argc ,argv ) ;
+  if ( verbose )
+    pout() << indent2 << "Beginning " << pgmname << endl ;
+
+  int stat_all = 0;
+  int status = testHalo();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 1." << endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 1 with return code "
+             << status << endl ;
+      stat_all = status ;
+    }
+
+  status = testExchange();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 2." << endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 2 with return code "
+             << status << endl ;
+      stat_all = status ;
+    }
+
+  status = testCopy();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 3." << endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 3 with return code "
+             << status << endl ;
+      stat_all = status ;
+    }
+
+  if ( stat_all == 0 )
+    pout() << indent << pgmname << ": passed all tests." << endl ;
+  else
+    pout() << indent << pgmname << ": failed one or more tests." << endl ;
+
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+  return stat_all ;
+}
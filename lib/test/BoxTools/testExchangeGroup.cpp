@@ -0,0 +1,302 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+// Test program for ExchangeGroup
+// Test 1: a group of fields of different T and ghost vectors on a periodic
+//         layout gets the same ghost cells as exchanging each field.
+// Test 2: component ranges, a Copier of the caller's, split
+//         exchangeBegin/exchangeEnd and repeated exchanges.
+
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+using std::endl;
+
+#include "ExchangeGroup.H"
+#include "FArrayBox.H"
+#include "FluxBox.H"
+#include "BoxIterator.H"
+#include "LoadBalance.H"
+#include "parstream.H"
+#ifdef CH_MPI
+#include "mpi.h"
+#endif
+
+#include "UsingNamespace.H"
+
+/// Global variables for handling output:
+static const char* pgmname = "testExchangeGroup" ;
+static const char* indent = "   ";
+static const char* indent2 = "      " ;
+static bool verbose = true ;
+
+static const int s_domainSize = 32;
+
+static void
+makeLayout(DisjointBoxLayout& a_dbl)
+{
+  bool isPeriodic[SpaceDim];
+  for (int dir = 0; dir < SpaceDim; dir++)
+    {
+      isPeriodic[dir] = (dir != 1);
+    }
+  ProblemDomain domain(IntVect::Zero, (s_domainSize-1)*IntVect::Unit, isPeriodic);
+  Vector<Box> boxes;
+  Box grid(IntVect::Zero, (s_domainSize/8 - 1)*IntVect::Unit);
+  for (BoxIterator bit(grid); bit.ok(); ++bit)
+    {
+      Box b(8*bit(), 8*bit() + 7*IntVect::Unit);
+      Box hi = b.chop(bit()[0]%SpaceDim, b.smallEnd(bit()[0]%SpaceDim) + 2 + 2*(bit()[1]%2));
+      boxes.push_back(b);
+      boxes.push_back(hi);
+    }
+  Vector<int> procs;
+  LoadBalance(procs, boxes);
+  a_dbl.define(boxes, procs, domain);
+}
+
+static Real
+value(const IntVect& a_iv, int a_comp)
+{
+  Real val = 1000*a_comp;
+  Real scale = 1;
+  for (int dir = 0; dir < SpaceDim; dir++)
+    {
+      val += scale*a_iv[dir];
+      scale *= 100;
+    }
+  return val;
+}
+
+/// Valid cells get value(), ghost cells -1
+template <class T>
+static void
+fill(BaseFab<T>& a_fab, const Box& a_valid)
+{
+  a_fab.setVal(-1);
+  for (BoxIterator bit(a_valid & a_fab.box()); bit.ok(); ++bit)
+    {
+      for (int comp = 0; comp < a_fab.nComp(); comp++)
+        {
+          a_fab(bit(), comp) = (T)value(bit(), comp);
+        }
+    }
+}
+
+template <class T>
+static int
+countDifferences(const BaseFab<T>& a_lhs, const BaseFab<T>& a_rhs)
+{
+  int errors = 0;
+  for (BoxIterator bit(a_lhs.box()); bit.ok(); ++bit)
+    {
+      for (int comp = 0; comp < a_lhs.nComp(); comp++)
+        {
+          if (a_lhs(bit(), comp) != a_rhs(bit(), comp)) errors++;
+        }
+    }
+  return errors;
+}
+
+/// The fields of the tests
+struct Fields
+{
+  Fields(const DisjointBoxLayout& a_dbl)
+    : m_cell(a_dbl, 3, 2*IntVect::Unit),
+      m_face(a_dbl, 2, IntVect::Unit),
+      m_tags(a_dbl, 1, IntVect::Unit + BASISV(0))
+  {
+    for (DataIterator dit = a_dbl.dataIterator(); dit.ok(); ++dit)
+      {
+        fill(m_cell[dit], a_dbl[dit]);
+        for (int dir = 0; dir < SpaceDim; dir++)
+          {
+            fill(m_face[dit][dir], surroundingNodes(a_dbl[dit], dir));
+          }
+        fill(m_tags[dit], a_dbl[dit]);
+      }
+  }
+
+  int countDifferences(const Fields& a_other) const
+  {
+    int errors = 0;
+    for (DataIterator dit = m_cell.dataIterator(); dit.ok(); ++dit)
+      {
+        errors += ::countDifferences(m_cell[dit], a_other.m_cell[dit]);
+        for (int dir = 0; dir < SpaceDim; dir++)
+          {
+            errors += ::countDifferences(m_face[dit][dir], a_other.m_face[dit][dir]);
+          }
+        errors += ::countDifferences(m_tags[dit], a_other.m_tags[dit]);
+      }
+    return errors;
+  }
+
+  LevelData<FArrayBox>     m_cell;
+  LevelData<FluxBox>       m_face;
+  LevelData<BaseFab<int> > m_tags;
+};
+
+int
+testGroup()
+{
+  DisjointBoxLayout dbl;
+  makeLayout(dbl);
+
+  Fields separate(dbl);
+  separate.m_cell.exchange();
+  separate.m_face.exchange();
+  separate.m_tags.exchange();
+
+  Fields grouped(dbl);
+  ExchangeGroup group;
+  group.add(grouped.m_cell);
+  group.add(grouped.m_face);
+  group.add(grouped.m_tags);
+  if (group.size() != 3) return 1;
+  group.exchange();
+
+  int errors = grouped.countDifferences(separate);
+  if (errors != 0)
+    {
+      pout() << indent2 << errors << " cells differ" << endl;
+      return 2;
+    }
+
+  // Ghost cells were filled at all
+  Fields unexchanged(dbl);
+  if (unexchanged.countDifferences(grouped) == 0) return 3;
+
+#ifdef CH_MPI
+  // One message to each neighbor, not one per field
+  if (group.numSends() > numProc()) return 4;
+#else
+  if (group.numSends() != 0) return 4;
+#endif
+
+  if (verbose)
+    {
+      pout() << indent2 << group.numSends() << " messages sent" << endl;
+    }
+  return 0;
+}
+
+int
+testOptions()
+{
+  DisjointBoxLayout dbl;
+  makeLayout(dbl);
+
+  Fields separate(dbl);
+  Copier faceCopier;
+  faceCopier.exchangeDefine(dbl, IntVect::Unit);
+  // Faces on box boundaries belong to two boxes, so repeated exchanges
+  // of m_face need not give what one does
+  for (int iter = 0; iter < 3; iter++)
+    {
+      separate.m_cell.exchange(Interval(1, 2));
+      separate.m_face.exchange(separate.m_face.interval(), faceCopier);
+    }
+
+  Fields grouped(dbl);
+  ExchangeGroup group;
+  group.add(grouped.m_cell, Interval(1, 2));
+  group.add(grouped.m_face, grouped.m_face.interval(), faceCopier);
+  for (int iter = 0; iter < 3; iter++)
+    {
+      group.exchangeBegin();
+      group.exchangeEnd();
+    }
+  if (grouped.countDifferences(separate) != 0) return 1;
+
+  // Unexchanged fields are left alone, and a cleared group does nothing
+  Fields fresh(dbl);
+  if (fresh.countDifferences(grouped) == 0) return 2;
+  group.clear();
+  if (group.size() != 0) return 3;
+  group.exchange();
+
+  return 0;
+}
+
+///
+// Parse the standard test options (-v -q -h) out of the command line
+///
+void
+parseTestOptions( int argc ,char* argv[] )
+{
+  for ( int i = 1 ; i < argc ; ++i )
+    {
+      if ( argv[i][0] == '-' ) //if it is an option
+        {
+          // compare 3 chars to differentiate -x from -xx
+          if ( strncmp( argv[i] ,"-v" ,3 ) == 0 )
+            {
+              verbose = true ;
+            }
+          else if ( strncmp( argv[i] ,"-q" ,3 ) == 0 )
+            {
+              verbose = false ;
+            }
+          else if ( strncmp( argv[i] ,"-h" ,3 ) == 0 )
+            {
+              pout() << "usage: " << pgmname << " [-hqv]" << std::endl ;
+              exit( 99 ) ;
+            }
+        }
+    }
+  return;
+}
+
+int
+main(int argc ,char* argv[])
+{
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  parseTestOptions( argc ,argv ) ;
+  if ( verbose )
+    pout() << indent2 << "Beginning " << pgmname << endl ;
+
+  int stat_all = 0;
+  int status = testGroup();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 1." << endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 1 with return code "
+             << status << endl ;
+      stat_all = status ;
+    }
+
+  status = testOptions();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 2." << endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 2 with return code "
+             << status << endl ;
+      stat_all = status ;
+    }
+
+  if ( stat_all == 0 )
+    pout() << indent << pgmname << ": passed all tests." << endl ;
+  else
+    pout() << indent << pgmname << ": failed one or more tests." << endl ;
+
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+  return stat_all ;
+}
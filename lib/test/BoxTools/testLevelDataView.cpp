@@ -0,0 +1,343 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+// Test program for LevelDataView
+// Test 1: a view of a range of components aliases the original's data, and
+//         its exchange fills only those components.
+// Test 2: a view with fewer ghost cells exchanges only those.
+// Test 3: a view of a region has the pieces of the original's boxes in it,
+//         exchanges and copies within it, and shares its layout with
+//         views defined from it.
+
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+using std::endl;
+
+#include "LevelDataView.H"
+#include "FArrayBox.H"
+#include "BoxIterator.H"
+#include "LoadBalance.H"
+#include "parstream.H"
+#ifdef CH_MPI
+#include "mpi.h"
+#endif
+
+#include "UsingNamespace.H"
+
+/// Global variables for handling output:
+static const char* pgmname = "testLevelDataView" ;
+static const char* indent = "   ";
+static const char* indent2 = "      " ;
+static bool verbose = true ;
+
+static const int s_domainSize = 32;
+static const int s_nComp = 4;
+
+static void
+makeLayout(DisjointBoxLayout& a_dbl)
+{
+  Vector<Box> boxes;
+  Box grid(IntVect::Zero, (s_domainSize/8 - 1)*IntVect::Unit);
+  for (BoxIterator bit(grid); bit.ok(); ++bit)
+    {
+      boxes.push_back(Box(8*bit(), 8*bit() + 7*IntVect::Unit));
+    }
+  Vector<int> procs;
+  LoadBalance(procs, boxes);
+  ProblemDomain domain(Box(IntVect::Zero, (s_domainSize-1)*IntVect::Unit));
+  a_dbl.define(boxes, procs, domain);
+}
+
+static Real
+value(const IntVect& a_iv, int a_comp)
+{
+  Real val = 1000*a_comp;
+  Real scale = 1;
+  for (int dir = 0; dir < SpaceDim; dir++)
+    {
+      val += scale*a_iv[dir];
+      scale *= 100;
+    }
+  return val;
+}
+
+/// Valid cells of components a_comps get value(), everything else -1
+static void
+setValid(LevelData<FArrayBox>& a_data, const Interval& a_comps)
+{
+  for (DataIterator dit = a_data.dataIterator(); dit.ok(); ++dit)
+    {
+      FArrayBox& fab = a_data[dit];
+      fab.setVal(-1);
+      for (BoxIterator bit(a_data.disjointBoxLayout()[dit]); bit.ok(); ++bit)
+        {
+          for (int comp = a_comps.begin(); comp <= a_comps.end(); comp++)
+            {
+              fab(bit(), comp) = value(bit(), comp);
+            }
+        }
+    }
+}
+
+/// Number of cells of a_data that are wrong: cells of component c in
+/// a_filled and the domain should hold value(iv, c + a_compOffset), the
+/// others -1
+static int
+countErrors(const LevelData<FArrayBox>& a_data, int a_compOffset,
+            const Interval& a_comps, const IntVect& a_ghost)
+{
+  const ProblemDomain& domain = a_data.disjointBoxLayout().physDomain();
+  int errors = 0;
+  for (DataIterator dit = a_data.dataIterator(); dit.ok(); ++dit)
+    {
+      const FArrayBox& fab = a_data[dit];
+      Box filled = grow(a_data.disjointBoxLayout()[dit], a_ghost);
+      filled &= domain;
+      for (BoxIterator bit(fab.box()); bit.ok(); ++bit)
+        {
+          for (int comp = 0; comp < fab.nComp(); comp++)
+            {
+              bool isSet = filled.contains(bit()) && a_comps.contains(comp);
+              Real expected = isSet ? value(bit(), comp + a_compOffset) : -1;
+              if (fab(bit(), comp) != expected) errors++;
+            }
+        }
+    }
+  return errors;
+}
+
+int
+testComponents()
+{
+  DisjointBoxLayout dbl;
+  makeLayout(dbl);
+  LevelData<FArrayBox> original(dbl, s_nComp, 2*IntVect::Unit);
+  setValid(original, Interval(1, 2));
+
+  LevelDataView<FArrayBox> view(original, Interval(1, 2));
+  if (view.nComp() != 2) return 1;
+  if (view.ghostVect() != original.ghostVect()) return 2;
+  if (!view.sameLayout()) return 3;
+  if (!view.disjointBoxLayout().compatible(dbl)) return 4;
+
+  for (DataIterator dit = view.dataIterator(); dit.ok(); ++dit)
+    {
+      IntVect iv = dbl[dit].smallEnd();
+      if (&(view[dit](iv, 0)) != &(original[dit](iv, 1))) return 5;
+      if (view[dit].box() != original[dit].box()) return 6;
+    }
+
+  view.exchange();
+  if (countErrors(original, 0, Interval(1, 2), 2*IntVect::Unit) != 0) return 7;
+
+  // Writing through the view writes the original
+  for (DataIterator dit = view.dataIterator(); dit.ok(); ++dit)
+    {
+      view[dit].setVal(-1, 1);
+    }
+  if (countErrors(original, 0, Interval(1, 1), 2*IntVect::Unit) != 0) return 8;
+
+  return 0;
+}
+
+int
+testGhost()
+{
+  DisjointBoxLayout dbl;
+  makeLayout(dbl);
+  LevelData<FArrayBox> original(dbl, s_nComp, 3*IntVect::Unit);
+  setValid(original, Interval(0, s_nComp-1));
+
+  LevelDataView<FArrayBox> view(original, Interval(0, s_nComp-1), IntVect::Unit);
+  if (view.ghostVect() != IntVect::Unit) return 1;
+  view.exchange();
+  if (countErrors(original, 0, Interval(0, s_nComp-1), IntVect::Unit) != 0) return 2;
+
+  // Copying into a view fills its ghost cells, not the original's others
+  LevelData<FArrayBox> other(dbl, 2, 3*IntVect::Unit);
+  setValid(other, Interval(0, 1));
+  other.exchange();
+  setValid(original, Interval(0, s_nComp-1));
+  LevelDataView<FArrayBox> dest(original, Interval(2, 3), 2*IntVect::Unit);
+  other.copyTo(other.interval(), dest, dest.interval());
+  int errors = 0;
+  for (DataIterator dit = dbl.dataIterator(); dit.ok(); ++dit)
+    {
+      const FArrayBox& fab = original[dit];
+      Box filled = grow(dbl[dit], 2);
+      filled &= dbl.physDomain();
+      for (BoxIterator bit(fab.box()); bit.ok(); ++bit)
+        {
+          for (int comp = 2; comp < s_nComp; comp++)
+            {
+              Real expected = filled.contains(bit()) ? value(bit(), comp - 2) : -1;
+              if (fab(bit(), comp) != expected) errors++;
+            }
+        }
+    }
+  if (errors != 0) return 3;
+
+  return 0;
+}
+
+int
+testRegion()
+{
+  DisjointBoxLayout dbl;
+  makeLayout(dbl);
+  LevelData<FArrayBox> original(dbl, s_nComp, 2*IntVect::Unit);
+  setValid(original, Interval(0, s_nComp-1));
+
+  Box region(5*IntVect::Unit, 20*IntVect::Unit);
+  LevelDataView<FArrayBox> view(original, Interval(0, 1), IntVect::Unit, region);
+  if (view.sameLayout()) return 1;
+  const DisjointBoxLayout& pieces = view.disjointBoxLayout();
+  if (pieces.numCells() != region.numPts()) return 2;
+  for (LayoutIterator lit = pieces.layoutIterator(); lit.ok(); ++lit)
+    {
+      if (!region.contains(pieces[lit])) return 3;
+    }
+
+  // The view's data is the original's
+  for (DataIterator dit = pieces.dataIterator(); dit.ok(); ++dit)
+    {
+      for (BoxIterator bit(pieces[dit]); bit.ok(); ++bit)
+        {
+          if (view[dit](bit(), 1) != value(bit(), 1)) return 4;
+        }
+    }
+
+  // Exchange fills the ghost cells of the pieces from the other pieces
+  setValid(original, Interval(0, s_nComp-1));
+  view.exchange();
+  for (DataIterator dit = pieces.dataIterator(); dit.ok(); ++dit)
+    {
+      Box ghosted = grow(pieces[dit], 1);
+      ghosted &= region;
+      for (BoxIterator bit(ghosted); bit.ok(); ++bit)
+        {
+          if (view[dit](bit(), 0) != value(bit(), 0)) return 5;
+        }
+    }
+
+  // A view on the same layout, and a copy out of the region
+  LevelDataView<FArrayBox> view2;
+  view2.defineView(original, Interval(2, 3), IntVect::Zero, view);
+  if (!view2.disjointBoxLayout().compatible(pieces)) return 6;
+  if (view2.region() != region) return 7;
+  LevelData<FArrayBox> copy(dbl, 2, IntVect::Zero);
+  for (DataIterator dit = copy.dataIterator(); dit.ok(); ++dit)
+    {
+      copy[dit].setVal(-1);
+    }
+  view2.copyTo(view2.interval(), copy, copy.interval());
+  for (DataIterator dit = copy.dataIterator(); dit.ok(); ++dit)
+    {
+      for (BoxIterator bit(dbl[dit]); bit.ok(); ++bit)
+        {
+          Real expected = region.contains(bit()) ? value(bit(), 2) : -1;
+          if (copy[dit](bit(), 0) != expected) return 8;
+        }
+    }
+
+  if (verbose)
+    {
+      pout() << indent2 << pieces.size() << " pieces in the region" << endl;
+    }
+  return 0;
+}
+
+///
+// Parse the standard test options (-v -q -h) out of the command line
+///
+void
+parseTestOptions( int argc ,char* argv[] )
+{
+  for ( int i = 1 ; i < argc ; ++i )
+    {
+      if ( argv[i][0] == '-' ) //if it is an option
+        {
+          // compare 3 chars to differentiate -x from -xx
+          if ( strncmp( argv[i] ,"-v" ,3 ) == 0 )
+            {
+              verbose = true ;
+            }
+          else if ( strncmp( argv[i] ,"-q" ,3 ) == 0 )
+            {
+              verbose = false ;
+            }
+          else if ( strncmp( argv[i] ,"-h" ,3 ) == 0 )
+            {
+              pout() << "usage: " << pgmname << " [-hqv]" << std::endl ;
+              exit( 99 ) ;
+            }
+        }
+    }
+  return;
+}
+
+int
+main(int argc ,char* argv[])
+{
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  parseTestOptions( argc ,argv ) ;
+  if ( verbose )
+    pout() << indent2 << "Beginning " << pgmname << endl ;
+
+  int stat_all = 0;
+  int status = testComponents();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 1." << endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 1 with return code "
+             << status << endl ;
+      stat_all = status ;
+    }
+
+  status = testGhost();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 2." << endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 2 with return code "
+             << status << endl ;
+      stat_all = status ;
+    }
+
+  status = testRegion();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 3." << endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 3 with return code "
+             << status << endl ;
+      stat_all = status ;
+    }
+
+  if ( stat_all == 0 )
+    pout() << indent << pgmname << ": passed all tests." << endl ;
+  else
+    pout() << indent << pgmname << ": failed one or more tests." << endl ;
+
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+  return stat_all ;
+}
@@ -0,0 +1,267 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+// samples a linear function held in a LevelData<EBCellFAB> on a ramp with
+// an AMRProbe line crossing the embedded boundary, and checks that points
+// with all stencil cells regular are exact, points with all stencil cells
+// covered are missing and the others stay within the stencil values.
+
+#include <cmath>
+#include "EBIndexSpace.H"
+#include "EBISLayout.H"
+#include "BoxIterator.H"
+#include "ParmParse.H"
+#include "BRMeshRefine.H"
+#include "LoadBalance.H"
+#include "GeometryShop.H"
+#include "LevelData.H"
+#include "EBCellFAB.H"
+#include "EBCellFactory.H"
+#include "VoFIterator.H"
+#include "PlaneIF.H"
+#include "EBAMRProbe.H"
+
+#include "UsingNamespace.H"
+
+/***************/
+/***************/
+int makeGeometry(Box& a_domain,
+                 Real& a_dx);
+/***************/
+/***************/
+int makeLayout(DisjointBoxLayout& a_dbl,
+               const Box& a_domain);
+/***************/
+/***************/
+int testEBProbe(const DisjointBoxLayout& a_grids,
+                const Box& a_domain,
+                const Real& a_dx);
+/***************/
+/***************/
+int
+main(int argc, char** argv)
+{
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  int eekflag = 0;
+  //begin forever present scoping trick
+  {
+    const char* in_file = "levelredist.inputs";
+    //parse input file
+    ParmParse pp(0,NULL,NULL,in_file);
+    Box domain;
+    Real dx;
+    eekflag =  makeGeometry(domain,  dx);
+    CH_assert(eekflag == 0);
+
+    DisjointBoxLayout grids;
+    eekflag = makeLayout(grids, domain);
+    CH_assert(eekflag == 0);
+
+    eekflag = testEBProbe(grids, domain, dx);
+    if (eekflag != 0)
+      {
+        pout() << "non zero eek detected = " << eekflag << endl;
+        MayDay::Error("problem in ebProbeTest");
+      }
+  }//end scoping trick
+  EBIndexSpace* ebisPtr = Chombo_EBIS::instance();
+  ebisPtr->clear();
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+  pout() << "ebProbeTest passed" << endl;
+  return 0;
+}
+/***************/
+/***************/
+Real linearFunc(const RealVect& a_x)
+{
+  Real retval = 1.0;
+  for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      retval += (idir + 1)*a_x[idir];
+    }
+  return retval;
+}
+/***************/
+/***************/
+int testEBProbe(const DisjointBoxLayout& a_grids,
+                const Box& a_domain,
+                const Real& a_dx)
+{
+  const EBIndexSpace* const ebisPtr = Chombo_EBIS::instance();
+  EBISLayout ebisl;
+  ebisPtr->fillEBISLayout(ebisl, a_grids, a_domain, 0);
+
+  //every VoF holds the function at its cell center
+  EBCellFactory factory(ebisl);
+  LevelData<EBCellFAB> data(a_grids, 1, IntVect::Zero, factory);
+  for (DataIterator dit = a_grids.dataIterator(); dit.ok(); ++dit)
+    {
+      data[dit()].setVal(12345.0);
+      IntVectSet ivs(a_grids.get(dit()));
+      for (VoFIterator vofit(ivs, ebisl[dit()].getEBGraph()); vofit.ok(); ++vofit)
+        {
+          RealVect x = (RealVect(vofit().gridIndex()) + 0.5*RealVect::Unit)*a_dx;
+          data[dit()](vofit(), 0) = linearFunc(x);
+        }
+    }
+
+  //a line in the up direction, across the ramp
+  ParmParse pp;
+  int upDir;
+  pp.get("up_dir", upDir);
+  RealVect start = 0.5*RealVect::Unit;
+  RealVect end   = 0.5*RealVect::Unit;
+  start[upDir] = 0.01;
+  end[upDir]   = 0.99;
+  int numPoints = 50;
+  AMRProbe probe(ProblemDomain(a_domain), a_dx);
+  probe.addLine("across", start, end, numPoints);
+
+  Vector<LevelData<EBCellFAB>*> levels(1, &data);
+  Vector<Real> values;
+  probe.sample(values, levels, Vector<int>(), Interval(0, 0));
+
+  //the whole domain on rank 0, to tell what the stencils hold
+  Vector<Box> wholeBox(1, a_domain);
+  Vector<int> wholeProc(1, 0);
+  DisjointBoxLayout whole(wholeBox, wholeProc);
+  EBISLayout ebislWhole;
+  ebisPtr->fillEBISLayout(ebislWhole, whole, a_domain, 0);
+
+  int eekflag = 0;
+  if (procID() == 0)
+    {
+      DataIterator dit = whole.dataIterator();
+      const EBISBox& ebisBox = ebislWhole[dit()];
+      int numRegular = 0, numCovered = 0, numMixed = 0;
+      for (int ipt = 0; ipt < numPoints; ipt++)
+        {
+          const RealVect& point = probe.points()[ipt];
+          IntVect base;
+          for (int idir = 0; idir < SpaceDim; idir++)
+            {
+              base[idir] = (int)floor(point[idir]/a_dx - 0.5);
+            }
+          Box stencil(base, base + IntVect::Unit);
+          stencil &= a_domain;
+          bool allRegular = true, allCovered = true;
+          Real lo = 1.0e30, hi = -1.0e30;
+          for (BoxIterator bit(stencil); bit.ok(); ++bit)
+            {
+              allRegular = allRegular && ebisBox.isRegular(bit());
+              allCovered = allCovered && ebisBox.isCovered(bit());
+              Real val = linearFunc((RealVect(bit()) + 0.5*RealVect::Unit)*a_dx);
+              lo = Min(lo, val);
+              hi = Max(hi, val);
+            }
+          Real value = values[ipt];
+          if (allRegular)
+            {
+              numRegular++;
+              if (Abs(value - linearFunc(point)) > 1.0e-12)
+                {
+                  pout() << "regular point " << ipt << " off: " << value << endl;
+                  eekflag = 1;
+                }
+            }
+          else if (allCovered)
+            {
+              numCovered++;
+              if (value != AMRProbe::s_missingValue)
+                {
+                  pout() << "covered point " << ipt << " not missing: " << value << endl;
+                  eekflag = 2;
+                }
+            }
+          else
+            {
+              numMixed++;
+              if ((value < lo - 1.0e-12) || (value > hi + 1.0e-12))
+                {
+                  pout() << "cut point " << ipt << " out of range: " << value << endl;
+                  eekflag = 3;
+                }
+            }
+        }
+      if ((numRegular == 0) || (numCovered == 0) || (numMixed == 0))
+        {
+          pout() << "line does not cross the ramp: " << numRegular << " "
+                 << numCovered << " " << numMixed << endl;
+          eekflag = 4;
+        }
+    }
+  return eekflag;
+}
+/***************/
+/***************/
+int
+makeLayout(DisjointBoxLayout& a_dbl,
+           const Box& a_domain)
+{
+  ParmParse pp;
+  int maxsize;
+  pp.get("maxboxsize",maxsize);
+  Vector<Box> vbox(1, a_domain);
+  domainSplit(a_domain, vbox,  maxsize);
+  Vector<int>  procAssign;
+  int eekflag = LoadBalance(procAssign,vbox);
+  if (eekflag != 0)
+    {
+      pout() << "problem in loadbalance" << endl;
+      return eekflag;
+    }
+  a_dbl.define(vbox, procAssign);
+  return eekflag;
+}
+/***************/
+// ramp geometry from levelredist.inputs
+/***************/
+int makeGeometry(Box& a_domain,
+                 Real& a_dx)
+{
+  ParmParse pp;
+  RealVect origin = RealVect::Zero;
+#if (CH_SPACEDIM==2)
+  int ncell = 64;
+#else
+  int ncell = 16;
+#endif
+  a_domain = Box(IntVect::Zero, (ncell-1)*IntVect::Unit);
+
+  Real prob_hi;
+  pp.get("prob_hi",prob_hi);
+  a_dx = prob_hi/ncell;
+
+  int upDir;
+  int indepVar;
+  Real startPt;
+  Real slope;
+  pp.get("up_dir",upDir);
+  pp.get("indep_var",indepVar);
+  pp.get("start_pt", startPt);
+  pp.get("ramp_slope", slope);
+
+  RealVect normal = RealVect::Zero;
+  normal[upDir] = 1.0;
+  normal[indepVar] = -slope;
+
+  RealVect point = RealVect::Zero;
+  point[upDir] = -slope*startPt;
+
+  PlaneIF ramp(normal,point,true);
+  GeometryShop workshop(ramp,0,a_dx*RealVect::Unit);
+  EBIndexSpace* ebisPtr = Chombo_EBIS::instance();
+  ebisPtr->define(a_domain, origin, a_dx, workshop);
+  return 0;
+}
@@ -300,6 +300,14 @@ int testConservation(const Vector<DisjointBoxLayout>& a_vecGrids,
                     mediDomain, a_vecRefRat[1],
                     nvar, redistRad);
 
+  //the embedded boundary crosses the coarse-fine interfaces, so the
+  //coarse-fine objects must not skip their communication
+  if (!fineToCoar.needsCopy() || !coarToFine.needsCopy())
+    {
+      pout() << "coarse-fine redistribution skips a needed copy" << endl;
+      return 43;
+    }
+
   //set all the buffers to zero
   mediRedist.setToZero();
   fineToCoar.setToZero();
@@ -57,6 +57,10 @@ int testConservation(const EBISLayout& a_ebisl,
 
 /***************/
 /***************/
+int testSingleBox(const Box& a_domain,
+                  const int& a_redistRad);
+/***************/
+/***************/
 void dumpmemoryatexit();
 /***************/
 /***************/
@@ -103,6 +107,13 @@ main(int argc, char** argv)
         MayDay::Abort(" levelRedistTest found a conservation problem");
 
       }
+
+    eekflag = testSingleBox(domain, redistRad);
+    if (eekflag != 0)
+      {
+        MayDay::Abort(" levelRedistTest found a problem on a single box");
+
+      }
   }//end scoping trick
   EBIndexSpace* ebisPtr = Chombo_EBIS::instance();
   ebisPtr->clear();
@@ -265,6 +276,27 @@ int testConservation(const EBISLayout& a_ebisl,
   return eekflag;
 }
 /***************/
+// with one box no stencil crosses a box boundary, so the
+// redistribution must skip the exchange and still conserve
+/***************/
+int testSingleBox(const Box& a_domain,
+                  const int& a_redistRad)
+{
+  Vector<Box> vbox(1, a_domain);
+  Vector<int> procAssign(1, 0);
+  DisjointBoxLayout grids(vbox, procAssign);
+  EBISLayout ebisl;
+  makeEBISL(ebisl, grids, a_domain, 3*a_redistRad);
+
+  EBLevelRedist distributor(grids, ebisl, a_domain, 1, a_redistRad);
+  if (distributor.needsExchange())
+    {
+      pout() << "single box redistribution wants an exchange" << endl;
+      return 1;
+    }
+  return testConservation(ebisl, grids, a_domain, a_redistRad);
+}
+/***************/
 /***************/
 int makeEBISL(EBISLayout& a_ebisl,
               const DisjointBoxLayout& a_grids,
@@ -0,0 +1,308 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+// writes a level with the dense and with the sparse EB file layout,
+// reads both back with readCellCentered and checks that they agree
+// with the original data and that the sparse file is the smaller one.
+// the sparse layout is also written chunked and deflated.
+
+#include <cstdio>
+#include <fstream>
+#include "EBIndexSpace.H"
+#include "EBISLayout.H"
+#include "BoxIterator.H"
+#include "ParmParse.H"
+#include "BRMeshRefine.H"
+#include "LoadBalance.H"
+#include "GeometryShop.H"
+#include "LevelData.H"
+#include "EBCellFAB.H"
+#include "EBCellFactory.H"
+#include "VoFIterator.H"
+#include "PlaneIF.H"
+#include "EBAMRIO.H"
+#include "CH_HDF5.H"
+
+#include "UsingNamespace.H"
+
+/***************/
+/***************/
+int makeGeometry(Box& a_domain,
+                 Real& a_dx);
+/***************/
+/***************/
+int makeLayout(DisjointBoxLayout& a_dbl,
+               const Box& a_domain);
+/***************/
+/***************/
+int testSparseIO(const DisjointBoxLayout& a_grids,
+                 const Box& a_domain,
+                 const Real& a_dx);
+/***************/
+/***************/
+int
+main(int argc, char** argv)
+{
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  int eekflag = 0;
+  //begin forever present scoping trick
+  {
+    const char* in_file = "levelredist.inputs";
+    //parse input file
+    ParmParse pp(0,NULL,NULL,in_file);
+    Box domain;
+    Real dx;
+    eekflag =  makeGeometry(domain,  dx);
+    CH_assert(eekflag == 0);
+
+    DisjointBoxLayout grids;
+    eekflag = makeLayout(grids, domain);
+    CH_assert(eekflag == 0);
+
+    eekflag = testSparseIO(grids, domain, dx);
+    if (eekflag != 0)
+      {
+        pout() << "non zero eek detected = " << eekflag << endl;
+        MayDay::Error("problem in sparseEBIOTest");
+      }
+  }//end scoping trick
+  EBIndexSpace* ebisPtr = Chombo_EBIS::instance();
+  ebisPtr->clear();
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+  pout() << "sparseEBIOTest passed" << endl;
+  return 0;
+}
+/***************/
+/***************/
+Real dataFunc(const VolIndex& a_vof, int a_comp)
+{
+  const IntVect& iv = a_vof.gridIndex();
+  Real retval = 1.0 + a_comp + 0.25*a_vof.cellIndex();
+  for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      retval += (idir + 1)*0.01*iv[idir];
+    }
+  return retval;
+}
+/***************/
+/***************/
+#ifdef CH_USE_HDF5
+void writeFile(const string& a_filename,
+               const LevelData<EBCellFAB>& a_data,
+               const Box& a_domain,
+               const Real& a_dx,
+               bool a_sparse,
+               int a_deflate = 0)
+{
+  Vector<string> names(a_data.nComp());
+  names[0] = string("first");
+  names[1] = string("second");
+
+  bool sparse = getSparseEBOutput();
+  setSparseEBOutput(a_sparse);
+  HDF5Handle handle;
+  createEBFile(handle, a_filename, 1, Vector<int>(1, 2),
+               a_domain, a_dx*RealVect::Unit, a_data.ghostVect());
+  HDF5Compression compression;
+  compression.m_deflate = a_deflate;
+  handle.setCompression(compression);
+  writeCellCenteredNames(handle, names);
+  writeCellCentered(handle, 0, &a_data);
+  handle.close();
+  setSparseEBOutput(sparse);
+}
+/***************/
+/***************/
+void readFile(LevelData<EBCellFAB>& a_data,
+              const string& a_filename,
+              int a_ebghost)
+{
+  const EBIndexSpace* const ebisPtr = Chombo_EBIS::instance();
+  HDF5Handle handle(a_filename, HDF5Handle::OPEN_RDONLY);
+  LevelData<EBCellFAB> fileData;
+  readCellCentered(handle, 0, ebisPtr, a_ebghost, &fileData);
+  handle.close();
+  fileData.copyTo(a_data);
+}
+/***************/
+/***************/
+long fileSize(const string& a_filename)
+{
+  std::ifstream file(a_filename.c_str(), std::ios::binary | std::ios::ate);
+  return (long)file.tellg();
+}
+#endif
+/***************/
+/***************/
+int testSparseIO(const DisjointBoxLayout& a_grids,
+                 const Box& a_domain,
+                 const Real& a_dx)
+{
+#ifdef CH_USE_HDF5
+  const EBIndexSpace* const ebisPtr = Chombo_EBIS::instance();
+  int ebghost = 2;
+  EBISLayout ebisl;
+  ebisPtr->fillEBISLayout(ebisl, a_grids, a_domain, ebghost);
+
+  int ncomp = 2;
+  EBCellFactory factory(ebisl);
+  LevelData<EBCellFAB> data(a_grids, ncomp, IntVect::Unit, factory);
+  for (DataIterator dit = a_grids.dataIterator(); dit.ok(); ++dit)
+    {
+      //covered values must not survive the sparse round trip
+      data[dit()].setVal(12345.0);
+      IntVectSet ivs(data[dit()].box());
+      for (VoFIterator vofit(ivs, ebisl[dit()].getEBGraph()); vofit.ok(); ++vofit)
+        {
+          for (int comp = 0; comp < ncomp; comp++)
+            {
+              data[dit()](vofit(), comp) = dataFunc(vofit(), comp);
+            }
+        }
+    }
+
+  string denseName("sparseEBIOTest.dense.hdf5");
+  string sparseName("sparseEBIOTest.sparse.hdf5");
+  string deflateName("sparseEBIOTest.deflate.hdf5");
+  writeFile(denseName,  data, a_domain, a_dx, false);
+  writeFile(sparseName, data, a_domain, a_dx, true);
+  writeFile(deflateName, data, a_domain, a_dx, true, 6);
+
+  LevelData<EBCellFAB> denseData(a_grids, ncomp, IntVect::Zero, factory);
+  LevelData<EBCellFAB> sparseData(a_grids, ncomp, IntVect::Zero, factory);
+  readFile(denseData,  denseName,  ebghost);
+  readFile(sparseData, sparseName, ebghost);
+  LevelData<EBCellFAB> deflateData(a_grids, ncomp, IntVect::Zero, factory);
+  readFile(deflateData, deflateName, ebghost);
+
+  int eekflag = 0;
+  for (DataIterator dit = a_grids.dataIterator(); dit.ok(); ++dit)
+    {
+      const Box& grid = a_grids.get(dit());
+      const EBISBox& ebisBox = ebisl[dit()];
+      IntVectSet ivs(grid);
+      for (VoFIterator vofit(ivs, ebisBox.getEBGraph()); vofit.ok(); ++vofit)
+        {
+          for (int comp = 0; comp < ncomp; comp++)
+            {
+              Real exact = dataFunc(vofit(), comp);
+              if ((denseData[dit()](vofit(), comp) != exact) ||
+                  (sparseData[dit()](vofit(), comp) != exact) ||
+                  (deflateData[dit()](vofit(), comp) != exact))
+                {
+                  pout() << "wrong value read back at " << vofit() << endl;
+                  eekflag = 1;
+                }
+            }
+        }
+      const BaseFab<Real>& sparseReg = sparseData[dit()].getSingleValuedFAB();
+      for (BoxIterator bit(grid); bit.ok(); ++bit)
+        {
+          if (ebisBox.isCovered(bit()) &&
+              (sparseReg(bit(), 0) != getCoveredCellValue()))
+            {
+              pout() << "covered cell " << bit() << " was not refilled" << endl;
+              eekflag = 2;
+            }
+        }
+    }
+
+  if ((procID() == 0) && (fileSize(sparseName) >= fileSize(denseName)))
+    {
+      pout() << "sparse file is not smaller than the dense one: "
+             << fileSize(sparseName) << " vs " << fileSize(denseName) << endl;
+      eekflag = 3;
+    }
+#ifdef CH_MPI
+  MPI_Barrier(Chombo_MPI::comm);
+#endif
+  if (procID() == 0)
+    {
+      std::remove(denseName.c_str());
+      std::remove(sparseName.c_str());
+      std::remove(deflateName.c_str());
+    }
+  return eekflag;
+#else
+  return 0;
+#endif
+}
+/***************/
+/***************/
+int
+makeLayout(DisjointBoxLayout& a_dbl,
+           const Box& a_domain)
+{
+  ParmParse pp;
+  int maxsize;
+  pp.get("maxboxsize",maxsize);
+  Vector<Box> vbox(1, a_domain);
+  domainSplit(a_domain, vbox,  maxsize);
+  Vector<int>  procAssign;
+  int eekflag = LoadBalance(procAssign,vbox);
+  if (eekflag != 0)
+    {
+      pout() << "problem in loadbalance" << endl;
+      return eekflag;
+    }
+  a_dbl.define(vbox, procAssign);
+  return eekflag;
+}
+/***************/
+// ramp geometry from levelredist.inputs
+/***************/
+int makeGeometry(Box& a_domain,
+                 Real& a_dx)
+{
+  ParmParse pp;
+  RealVect origin = RealVect::Zero;
+#if (CH_SPACEDIM==2)
+  int ncell = 64;
+#else
+  int ncell = 16;
+#endif
+  a_domain = Box(IntVect::Zero, (ncell-1)*IntVect::Unit);
+
+  Vector<Real> prob_lo(SpaceDim, 1.0);
+  Real prob_hi;
+  pp.getarr("prob_lo",prob_lo,0,SpaceDim);
+  pp.get("prob_hi",prob_hi);
+  a_dx = (prob_hi-prob_lo[0])/ncell;
+  for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      origin[idir] = prob_lo[idir];
+    }
+
+  int upDir;
+  int indepVar;
+  Real startPt;
+  Real slope;
+  pp.get("up_dir",upDir);
+  pp.get("indep_var",indepVar);
+  pp.get("start_pt", startPt);
+  pp.get("ramp_slope", slope);
+
+  RealVect normal = RealVect::Zero;
+  normal[upDir] = 1.0;
+  normal[indepVar] = -slope;
+
+  RealVect point = RealVect::Zero;
+  point[upDir] = -slope*startPt;
+
+  PlaneIF ramp(normal,point,true);
+  GeometryShop workshop(ramp,0,a_dx*RealVect::Unit);
+  EBIndexSpace* ebisPtr = Chombo_EBIS::instance();
+  ebisPtr->define(a_domain, origin, a_dx, workshop);
+  return 0;
+}
@@ -0,0 +1,239 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include <string>
+#include "DataIterator.H"
+#include "SPMD.H"
+#include "BRMeshRefine.H"
+#include "LoadBalance.H"
+#include "ParmParse.H"
+#include "parstream.H"
+#include "EBIndexSpace.H"
+#include "EBISLayout.H"
+#include "SlabService.H"
+#include "BoxIterator.H"
+#include "VoFIterator.H"
+#include "UsingNamespace.H"
+#include "slab.cpp"
+
+/***************/
+/***************/
+int checkNarrowAlias(const Box& a_domain);
+
+/***************/
+/***************/
+int checkWidenKeepsCoarsening(const Box& a_domain);
+
+/***************/
+/***************/
+int checkRetention(const Box& a_domain);
+
+/***************/
+/***************/
+int
+main(int argc, char** argv)
+{
+
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  //begin scoping trick
+  {
+    const char* in_file = "slab.inputs";
+    //parse input file
+    ParmParse pp(0,NULL,NULL,in_file);
+
+    int eekflag = 0;
+    Box domain, coveredDomain;
+    Real dx;
+    //make the gometry.  this makes the first Chombo_EBIS
+    //and defines it using a geometryservice
+    eekflag =  makeGeometry(domain, dx, coveredDomain);
+    if (eekflag != 0)
+      {
+        pout() << "non zero eek detected = " << eekflag << endl;
+        MayDay::Error("problem in makeGeometry");
+      }
+
+    eekflag = checkNarrowAlias(domain);
+    if (eekflag != 0)
+      {
+        pout() << "non zero eek detected = " << eekflag << endl;
+        MayDay::Error("problem in checkNarrowAlias");
+      }
+
+    eekflag = checkWidenKeepsCoarsening(domain);
+    if (eekflag != 0)
+      {
+        pout() << "non zero eek detected = " << eekflag << endl;
+        MayDay::Error("problem in checkWidenKeepsCoarsening");
+      }
+
+    eekflag = checkRetention(domain);
+    if (eekflag != 0)
+      {
+        pout() << "non zero eek detected = " << eekflag << endl;
+        MayDay::Error("problem in checkRetention");
+      }
+
+    pout() << "testEBISLayoutCache test passed" << endl;
+  }//end scoping trick
+  EBIndexSpace* ebisPtr = Chombo_EBIS::instance();
+  ebisPtr->clear();
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+  return 0;
+}
+
+/***************/
+// a narrower request shares the wider layout but reports its own ghost
+/***************/
+int checkNarrowAlias(const Box& a_domain)
+{
+  const EBIndexSpace* const ebisPtr = Chombo_EBIS::instance();
+  ProblemDomain domain(a_domain);
+  DisjointBoxLayout dbl;
+  makeLayout(dbl, a_domain);
+
+  EBISLayout ebislWide, ebislNarrow;
+  makeEBISL(ebislWide, dbl, a_domain, 4);
+  int hits, misses;
+  ebisPtr->getCacheStatistics(hits, misses, domain);
+  makeEBISL(ebislNarrow, dbl, a_domain, 1);
+  int hitsAfter, missesAfter;
+  ebisPtr->getCacheStatistics(hitsAfter, missesAfter, domain);
+
+  if ((hitsAfter != hits + 1) || (missesAfter != misses))
+    {
+      pout() << "narrower request was not a cache hit" << endl;
+      return -1;
+    }
+  if ((ebislWide.getGhost() != 4) || (ebislNarrow.getGhost() != 1))
+    {
+      pout() << "wrong ghost: " << ebislWide.getGhost() << ", "
+             << ebislNarrow.getGhost() << endl;
+      return -2;
+    }
+  //the cache, ebislWide and ebislNarrow
+  if ((ebislNarrow.refCount() != ebislWide.refCount()) || (ebislNarrow.refCount() < 3))
+    {
+      pout() << "narrower layout does not alias the wider one" << endl;
+      return -3;
+    }
+  for (DataIterator dit = dbl.dataIterator(); dit.ok(); ++dit)
+    {
+      Box ghosted = grow(dbl.get(dit()), 4) & a_domain;
+      if (!ebislNarrow[dit()].getRegion().contains(ghosted))
+        {
+          pout() << "aliased EBISBox does not cover the wider ghost" << endl;
+          return -4;
+        }
+    }
+  return 0;
+}
+
+/***************/
+// widening a layout in place keeps the coarsening its holders asked for
+/***************/
+int checkWidenKeepsCoarsening(const Box& a_domain)
+{
+  const EBIndexSpace* const ebisPtr = Chombo_EBIS::instance();
+  DisjointBoxLayout dbl;
+  makeLayout(dbl, a_domain);
+
+  EBISLayout ebislNarrow, ebislWide;
+  makeEBISL(ebislNarrow, dbl, a_domain, 1);
+  ebislNarrow.setMaxCoarseningRatio(4, ebisPtr);
+  makeEBISL(ebislWide, dbl, a_domain, 3);
+
+  if (ebislNarrow.getMaxCoarseningRatio() < 4)
+    {
+      pout() << "widening lost the coarsening ratio" << endl;
+      return -1;
+    }
+  if ((ebislNarrow.getGhost() != 1) || (ebislWide.getGhost() != 3))
+    {
+      pout() << "wrong ghost after widening" << endl;
+      return -2;
+    }
+  for (DataIterator dit = dbl.dataIterator(); dit.ok(); ++dit)
+    {
+      const EBISBox& ebisBox = ebislNarrow[dit()];
+      IntVectSet ivs(dbl.get(dit()));
+      for (VoFIterator vofit(ivs, ebisBox.getEBGraph()); vofit.ok(); ++vofit)
+        {
+          VolIndex coarVoF = ebislNarrow.coarsen(vofit(), 4, dit());
+          if (coarVoF.gridIndex() != coarsen(vofit().gridIndex(), 4))
+            {
+              pout() << "coarsening by 4 went wrong after widening" << endl;
+              return -3;
+            }
+        }
+    }
+  return 0;
+}
+
+/***************/
+// unheld layouts stay in the cache up to EBISLevel::s_cacheRetain
+/***************/
+int checkRetention(const Box& a_domain)
+{
+  const EBIndexSpace* const ebisPtr = Chombo_EBIS::instance();
+  ProblemDomain domain(a_domain);
+  DisjointBoxLayout dblOne, dblTwo, dblThree;
+  makeLayout(dblOne,   a_domain, 4);
+  makeLayout(dblTwo,   a_domain, 2);
+  makeLayout(dblThree, a_domain, 8);
+
+  int retain = EBISLevel::s_cacheRetain;
+  EBISLevel::s_cacheRetain = 1;
+  {
+    EBISLayout ebisl;
+    makeEBISL(ebisl, dblOne, a_domain, 1);
+  }
+  {
+    EBISLayout ebisl;
+    makeEBISL(ebisl, dblTwo, a_domain, 1);
+  }
+  {
+    //this miss drops all but the most recently used unheld layout
+    EBISLayout ebisl;
+    makeEBISL(ebisl, dblThree, a_domain, 1);
+  }
+
+  int hits, misses;
+  ebisPtr->getCacheStatistics(hits, misses, domain);
+  {
+    EBISLayout ebisl;
+    makeEBISL(ebisl, dblTwo, a_domain, 1);
+  }
+  int hitsAfter, missesAfter;
+  ebisPtr->getCacheStatistics(hitsAfter, missesAfter, domain);
+  if ((hitsAfter != hits + 1) || (missesAfter != misses))
+    {
+      pout() << "most recently used unheld layout was dropped" << endl;
+      EBISLevel::s_cacheRetain = retain;
+      return -1;
+    }
+
+  {
+    EBISLayout ebisl;
+    makeEBISL(ebisl, dblOne, a_domain, 1);
+  }
+  ebisPtr->getCacheStatistics(hits, misses, domain);
+  EBISLevel::s_cacheRetain = retain;
+  if (misses != missesAfter + 1)
+    {
+      pout() << "layout beyond s_cacheRetain was kept" << endl;
+      return -2;
+    }
+  return 0;
+}
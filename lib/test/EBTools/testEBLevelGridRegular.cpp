@@ -0,0 +1,129 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include <string>
+#include "DataIterator.H"
+#include "SPMD.H"
+#include "BRMeshRefine.H"
+#include "LoadBalance.H"
+#include "ParmParse.H"
+#include "parstream.H"
+#include "EBIndexSpace.H"
+#include "EBISLayout.H"
+#include "EBLevelGrid.H"
+#include "SlabService.H"
+#include "BoxIterator.H"
+#include "UsingNamespace.H"
+#include "slab.cpp"
+
+/***************/
+/***************/
+int checkRegularBoxes(const Box& a_domain, int a_nghost, int& a_numRegular);
+
+/***************/
+/***************/
+int
+main(int argc, char** argv)
+{
+
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  //begin scoping trick
+  {
+    const char* in_file = "slab.inputs";
+    //parse input file
+    ParmParse pp(0,NULL,NULL,in_file);
+
+    int eekflag = 0;
+    Box domain, coveredDomain;
+    Real dx;
+    //make the gometry.  this makes the first Chombo_EBIS
+    //and defines it using a geometryservice
+    eekflag =  makeGeometry(domain, dx, coveredDomain);
+    if (eekflag != 0)
+      {
+        pout() << "non zero eek detected = " << eekflag << endl;
+        MayDay::Error("problem in makeGeometry");
+      }
+
+    int numRegularNoGhost, numRegularGhost;
+    eekflag = checkRegularBoxes(domain, 0, numRegularNoGhost);
+    if (eekflag != 0)
+      {
+        pout() << "non zero eek detected = " << eekflag << endl;
+        MayDay::Error("problem in checkRegularBoxes without ghost");
+      }
+
+    eekflag = checkRegularBoxes(domain, 2, numRegularGhost);
+    if (eekflag != 0)
+      {
+        pout() << "non zero eek detected = " << eekflag << endl;
+        MayDay::Error("problem in checkRegularBoxes with ghost");
+      }
+
+    //ghost cells can only take boxes out of the regular set
+    if (numRegularGhost > numRegularNoGhost)
+      {
+        pout() << "more regular boxes with ghost cells than without" << endl;
+        MayDay::Error("problem in testEBLevelGridRegular");
+      }
+
+    pout() << "testEBLevelGridRegular test passed" << endl;
+  }//end scoping trick
+  EBIndexSpace* ebisPtr = Chombo_EBIS::instance();
+  ebisPtr->clear();
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+  return 0;
+}
+
+/***************/
+// the classification matches a cell by cell check of the ghosted box
+/***************/
+int checkRegularBoxes(const Box& a_domain, int a_nghost, int& a_numRegular)
+{
+  const EBIndexSpace* const ebisPtr = Chombo_EBIS::instance();
+  ProblemDomain domain(a_domain);
+  DisjointBoxLayout dbl;
+  makeLayout(dbl, a_domain);
+
+  EBLevelGrid eblg(dbl, domain, a_nghost, ebisPtr);
+  //copies share the classification
+  EBLevelGrid eblgCopy(eblg);
+
+  a_numRegular = 0;
+  for (DataIterator dit = dbl.dataIterator(); dit.ok(); ++dit)
+    {
+      const EBISBox& ebisBox = eblg.getEBISL()[dit()];
+      Box ghosted = grow(dbl.get(dit()), a_nghost) & domain;
+      bool regular = true;
+      for (BoxIterator bit(ghosted); bit.ok() && regular; ++bit)
+        {
+          regular = ebisBox.isRegular(bit());
+        }
+      if (eblg.isRegular(dit()) != regular)
+        {
+          pout() << "box " << dbl.get(dit()) << " misclassified" << endl;
+          return -1;
+        }
+      if (eblgCopy.isRegular(dit()) != regular)
+        {
+          pout() << "copy of EBLevelGrid misclassified " << dbl.get(dit()) << endl;
+          return -2;
+        }
+      if (regular)
+        {
+          a_numRegular++;
+        }
+    }
+  return 0;
+}
@@ -0,0 +1,268 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+// Test program for MetricCache
+// Test 1: repeated requests for the same box are satisfied from the cache
+//         and match a direct evaluation.
+// Test 2: metrics on cubed-sphere panels are shared between panels.
+// Test 3: a memory budget evicts least-recently-used entries.
+
+#include <iostream>
+#include <cstring>
+#include <cmath>
+
+#include "parstream.H"
+#include "MetricCache.H"
+#include "CartesianBlockCS.H"
+#include "CubedSphere2DPanelCS.H"
+
+#include "UsingNamespace.H"
+
+using std::endl;
+
+/// Global variables for handling output:
+static const char* pgmname = "testMetricCache" ;
+static const char* indent = "   ";
+static const char* indent2 = "      " ;
+static bool verbose = true ;
+
+#ifdef CH_USE_DOUBLE
+static Real precision = 1.0e-12;
+#else
+static Real precision = 1.0e-5;
+#endif
+
+///
+// Parse the standard test options (-v -q -h) out of the command line
+///
+void
+parseTestOptions( int argc ,char* argv[] )
+{
+  for ( int i = 1 ; i < argc ; ++i )
+    {
+      if ( argv[i][0] == '-' ) //if it is an option
+        {
+          // compare 3 chars to differentiate -x from -xx
+          if ( strncmp( argv[i] ,"-v" ,3 ) == 0 )
+            {
+              verbose = true ;
+            }
+          else if ( strncmp( argv[i] ,"-q" ,3 ) == 0 )
+            {
+              verbose = false ;
+            }
+          else if ( strncmp( argv[i] ,"-h" ,3 ) == 0 )
+            {
+              pout() << "usage: " << pgmname << " [-hqv]" << std::endl ;
+              exit( 99 ) ;
+            }
+        }
+    }
+  return;
+}
+
+/// Maximum difference between two FluxBoxes on the faces of a_box
+Real
+maxDiff(const FluxBox& a_A, const FluxBox& a_B, const Box& a_box)
+{
+  Real diff = 0.;
+  for (int dir = 0; dir != SpaceDim; ++dir)
+    {
+      FArrayBox delta(surroundingNodes(a_box, dir), a_A.nComp());
+      delta.copy(a_A[dir]);
+      delta.minus(a_B[dir], 0, 0, a_A.nComp());
+      diff = Max(diff, delta.norm(0, 0, a_A.nComp()));
+    }
+  return diff;
+}
+
+int
+testCartesian()
+{
+  const RealVect dx(D_DECL6(0.125, 0.125, 0.125, 0.125, 0.125, 0.125));
+  const Box blockBox(IntVect::Zero, 15*IntVect::Unit);
+  CartesianBlockCS cs(0, IntVect::Zero, dx, blockBox);
+  MetricCache cache;
+
+  const int nN = SpaceDim*SpaceDim;
+  const Box box0(IntVect::Zero, 3*IntVect::Unit);
+  const Box box1 = box0 + 8*BASISV(0);
+
+  FluxBox direct(box1, nN);
+  cs.getN(direct, box1);
+
+  FluxBox cached(box0, nN);
+  if (cache.getN(cached, &cs, 0, box0)) return 1;  // First touch is a miss
+  FluxBox translated(box1, nN);
+  // A translate of box0 must come from the cache
+  if (!cache.getN(translated, &cs, 0, box1)) return 2;
+  if (maxDiff(direct, translated, box1) > precision) return 3;
+  if (cache.numEntries() != 1) return 4;
+  if (cache.numHits() != 1 || cache.numMisses() != 1) return 5;
+  if (verbose)
+    {
+      pout() << indent2;
+      cache.report(pout());
+    }
+  return 0;
+}
+
+int
+testCubedSphere()
+{
+#if CH_SPACEDIM == 2
+  const int nCell = 8;
+  RealVect dx = (0.5*M_PI/nCell)*RealVect::Unit;
+  const int nN = SpaceDim*SpaceDim;
+  MetricCache cache;
+  Vector<FluxBox*> N(6);
+  for (int iPanel = 0; iPanel != 6; ++iPanel)
+    {
+      IntVect ix = (iPanel*(nCell + 2))*BASISV(0);
+      CubedSphere2DPanelCS cs(iPanel, dx, ix);
+      const Box box(ix, ix + (nCell - 1)*IntVect::Unit);
+
+      FluxBox direct(box, nN);
+      cs.getN(direct, box);
+      N[iPanel] = new FluxBox(box, nN);
+      const bool hit = cache.getN(*N[iPanel], &cs, iPanel, box);
+      if (hit != (iPanel > 0)) return 1;
+      if (maxDiff(direct, *N[iPanel], box) > precision) return 2;
+    }
+  for (int iPanel = 0; iPanel != 6; ++iPanel)
+    {
+      delete N[iPanel];
+    }
+  // One N entry serves all six panels
+  if (cache.numEntries() != 1) return 4;
+  if (verbose)
+    {
+      pout() << indent2;
+      cache.report(pout());
+    }
+#endif
+  return 0;
+}
+
+int
+testEviction()
+{
+  const RealVect dx(D_DECL6(0.25, 0.25, 0.25, 0.25, 0.25, 0.25));
+  const Box blockBox(IntVect::Zero, 15*IntVect::Unit);
+  CartesianBlockCS cs(0, IntVect::Zero, dx, blockBox);
+
+  // Script N is never shared, so different boxes make different entries
+  const Box box0(IntVect::Zero, 3*IntVect::Unit);
+  const Box box1 = box0 + 4*BASISV(0);
+  const Box box2 = box0 + 8*BASISV(0);
+  const int dir0 = 0;
+  const int dir1 = (SpaceDim > 1) ? 1 : 0;
+  IntVect edgeType = IntVect::Zero;
+  edgeType[dir0] = 1;
+  edgeType[dir1] = 1;
+
+  long long bytesOne = 0;
+  {
+    MetricCache probe;
+    Box oBox(box0);
+    oBox.convert(edgeType);
+    FArrayBox scrN(oBox, SpaceDim);
+    probe.getScriptN(scrN, &cs, 0, dir0, dir1, oBox);
+    bytesOne = probe.bytes();
+  }
+  // Room for two entries
+  MetricCache cache(2*bytesOne);
+  const Box boxes[3] = { box0, box1, box2 };
+  for (int i = 0; i != 3; ++i)
+    {
+      Box oBox(boxes[i]);
+      oBox.convert(edgeType);
+      FArrayBox scrN(oBox, SpaceDim);
+      cache.getScriptN(scrN, &cs, 0, dir0, dir1, oBox);
+    }
+  if (cache.numEntries() != 2) return 1;
+  if (cache.numEvictions() != 1) return 2;
+  if (cache.bytes() > cache.memoryBudget()) return 3;
+  // box0 was least recently used and must have been evicted
+  {
+    Box oBox(box0);
+    oBox.convert(edgeType);
+    FArrayBox scrN(oBox, SpaceDim);
+    if (cache.getScriptN(scrN, &cs, 0, dir0, dir1, oBox)) return 4;
+  }
+  // box2 is still present
+  {
+    Box oBox(box2);
+    oBox.convert(edgeType);
+    FArrayBox scrN(oBox, SpaceDim);
+    if (!cache.getScriptN(scrN, &cs, 0, dir0, dir1, oBox)) return 5;
+  }
+  cache.clear();
+  if (cache.numEntries() != 0 || cache.bytes() != 0) return 6;
+  return 0;
+}
+
+int
+main(int argc ,char* argv[])
+{
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  parseTestOptions( argc ,argv ) ;
+  if ( verbose )
+    pout() << indent2 << "Beginning " << pgmname << endl ;
+
+  int stat_all = 0;
+  int status = testCartesian();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 1." << endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 1 with return code "
+             << status << endl ;
+      stat_all = status ;
+    }
+
+  status = testCubedSphere();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 2." << endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 2 with return code "
+             << status << endl ;
+      stat_all = status ;
+    }
+
+  status = testEviction();
+  if ( status == 0 )
+    {
+      if ( verbose ) pout() << indent << pgmname << " passed test 3." << endl ;
+    }
+  else
+    {
+      pout() << indent << pgmname << " failed test 3 with return code "
+             << status << endl ;
+      stat_all = status ;
+    }
+
+  if ( stat_all == 0 )
+    pout() << indent << pgmname << ": passed all tests." << endl ;
+  else
+    pout() << indent << pgmname << ": failed one or more tests." << endl ;
+
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+  return stat_all ;
+}
@@ -74,7 +74,7 @@ parseCommandLine(PlotParams& a_params, int argc, char* argv[])
       pout() << "no eb geometry filename given in inputs"  << endl;
       exit(0);
     }
-  if(!geomFileFound)
+  if(!outpFileFound)
     {
       pout() << "no output filename given in inputs"  << endl;
       exit(0);